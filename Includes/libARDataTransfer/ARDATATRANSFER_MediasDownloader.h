@@ -65,6 +65,85 @@
  */
 #define ARDATATRANSFER_MEDIA_UUID_SIZE  33
 
+/**
+ * @brief Defines the suggested maximum size in bytes of the thumbnails cache
+ * @see ARDATATRANSFER_MediasDownloader_SetThumbnailsCacheSize ()
+ */
+#define ARDATATRANSFER_MEDIAS_THUMBNAILS_DEFAULT_SIZE  (32 * 1024 * 1024)
+
+/**
+ * @brief Media download priority enum, a queued media is downloaded before all queued medias of lower priority
+ * @see ARDATATRANSFER_MediasDownloader_AddMediaToQueueWithPriority ()
+ */
+typedef enum
+{
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_BULK = 0, /**< Background synchronisation */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_NORMAL, /**< Default priority */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_INTERACTIVE, /**< Media requested by the user */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_MAX,
+
+} eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY;
+
+/**
+ * @brief Medias queue scheduling policy enum, the order of the queued medias of the same priority
+ * @see ARDATATRANSFER_MediasDownloader_SetQueuePolicy ()
+ */
+typedef enum
+{
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_FIFO = 0, /**< In the order they are added, default policy */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_SMALLEST_FIRST, /**< Smallest size first */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_NEWEST_FIRST, /**< Most recent date first, medias without date last */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_MAX,
+
+} eARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY;
+
+/**
+ * @brief Medias list order enum, the order of the medias returned by pages
+ * @note Medias of the same key keep the order of the listing, reversed for the descending orders
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasPage ()
+ */
+typedef enum
+{
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_LISTING = 0, /**< The order of the medias list */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_NEWEST_FIRST, /**< Most recent date first, medias without date last */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_OLDEST_FIRST, /**< Oldest date first, medias without date first */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_SMALLEST_FIRST, /**< Smallest size first */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_LARGEST_FIRST, /**< Largest size first */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_PRODUCT, /**< By product, most recent date first in a product */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_MAX,
+
+} eARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER;
+
+/**
+ * @brief Media type enum, selected in a filter by the bit (1 << type)
+ * @see ARDATATRANSFER_MediasDownloader_Filter_t
+ */
+typedef enum
+{
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_PHOTO = 0, /**< The jpg medias */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_VIDEO, /**< The mp4 and mov medias */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_MAX,
+
+} eARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE;
+
+/**
+ * @brief Filter of the medias listing, a zeroed filter selects all the medias
+ * @param products The products selected, the bit (1 << product) for each eARDISCOVERY_PRODUCT, 0 for all
+ * @param types The media types selected, the bit (1 << type) for each eARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE, 0 for all
+ * @param minTimestamp The oldest media timestamp selected, in seconds since the Epoch, 0 for no bound
+ * @param maxTimestamp The most recent media timestamp selected, in seconds since the Epoch, 0 for no bound
+ * @note The medias without date are not selected when a bound is set
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered ()
+ */
+typedef struct
+{
+    uint64_t products;
+    int types;
+    int64_t minTimestamp;
+    int64_t maxTimestamp;
+
+} ARDATATRANSFER_MediasDownloader_Filter_t;
+
 /**
  * @brief Media structure
  * @param product The the product that the media belong to
@@ -92,6 +171,29 @@ typedef struct
     
 } ARDATATRANSFER_Media_t;
 
+/**
+ * @brief Snapshot of the download process queue
+ * @param queuedCount The number of medias waiting in the queue
+ * @param queuedBytes The sum of the sizes of the medias waiting in the queue
+ * @param inFlightCount The number of medias being downloaded
+ * @param inFlightBytes The sum of the sizes of the medias being downloaded
+ * @param downloadedBytes The number of bytes of the medias being downloaded already received
+ * @param bytesPerSecond The measured download throughput, 0 if not measured yet
+ * @param estimatedTime The estimated time in seconds to download the queued and in flight medias, -1 if unknown
+ * @see ARDATATRANSFER_MediasDownloader_GetQueueStats ()
+ */
+typedef struct
+{
+    int queuedCount;
+    double queuedBytes;
+    int inFlightCount;
+    double inFlightBytes;
+    double downloadedBytes;
+    double bytesPerSecond;
+    double estimatedTime;
+
+} ARDATATRANSFER_MediasDownloader_QueueStats_t;
+
 /**
  * @brief Available media callback called for each media found
  * @param arg The pointer of the user custom argument
@@ -101,6 +203,15 @@ typedef struct
  */
 typedef void (*ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t) (void* arg, ARDATATRANSFER_Media_t *media, int index);
 
+/**
+ * @brief Completion callback of the medias listing, called once after the last available media callback
+ * @param arg The pointer of the user custom argument
+ * @param count The number of medias found
+ * @param error The error status of the listing, the medias already notified are dropped if it is not ARDATATRANSFER_OK
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasStream ()
+ */
+typedef void (*ARDATATRANSFER_MediasDownloader_ListingCompletionCallback_t) (void* arg, int count, eARDATATRANSFER_ERROR error);
+
 /**
  * @brief Progress callback of the Media download
  * @param arg The pointer of the user custom argument
@@ -128,6 +239,19 @@ typedef void (*ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t
  */
 typedef void (*ARDATATRANSFER_MediasDownloader_DeleteMediaCallback_t) (void* arg, ARDATATRANSFER_Media_t *media, eARDATATRANSFER_ERROR error);
 
+/**
+ * @brief Recursive listing callback, lists a remote directory and all its subdirectories in one FTP command
+ * @note The result is the output of a LIST -R like command: the listing of remotePath, then each subdirectory listing after a blank line and a "path:" header line, hidden directories included (LIST -laR)
+ * @param arg The pointer of the user custom argument
+ * @param ftpManager The FTP listing connection
+ * @param remotePath The remote directory to list
+ * @param resultList The address of the allocated listing, freed by the MediasDownloader
+ * @param resultListLen The address of the length of the listing
+ * @retval On success, returns ARUTILS_OK. Otherwise, it returns an error number of eARUTILS_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_SetRecursiveList ()
+ */
+typedef eARUTILS_ERROR (*ARDATATRANSFER_MediasDownloader_RecursiveListCallback_t) (void* arg, ARUTILS_Manager_t *ftpManager, const char *remotePath, char **resultList, uint32_t *resultListLen);
+
 /**
  * @brief Create a new ARDataTransfer MediasDownloader
  * @warning This function allocates memory
@@ -152,6 +276,7 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_Delete (ARDATATRANSFER_Man
 
 /**
  * @brief Get the medias count available form the Device
+ * @note The previous medias list stays available to ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex during the listing, the new one replaces it when the listing succeeds
  * @warning This function allocates memory
  * @param manager The pointer of the ARDataTransfer Manager
  * @param [out] result The On success, set ARDATATRANSFER_OK. Otherwise, it set an error number of eARDATATRANSFER_ERROR
@@ -161,6 +286,37 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_Delete (ARDATATRANSFER_Man
  */
 int ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync (ARDATATRANSFER_Manager_t *manager, int withThumbnail, eARDATATRANSFER_ERROR *result);
 
+/**
+ * @brief Get the medias available from the Device that match a filter
+ * @note The filter is applied before the Device is asked when possible: the product subfolders not selected are not listed,
+ * the DCIM subfolders whose thumbnails match no media of the filter are not listed, and the medias not selected are not allocated.
+ * The medias list then holds the selected medias only, until the next listing.
+ * @warning This function allocates memory
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param withThumbnail The flag to return thumbnail, 0 no thumbnail is returned, 1 thumbnails are returned
+ * @param filter The filter of the medias, NULL to select all the medias
+ * @param [out] result The On success, set ARDATATRANSFER_OK. Otherwise, it set an error number of eARDATATRANSFER_ERROR
+ * @retval On success, the number of media found else 0.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync ()
+ */
+int ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered(ARDATATRANSFER_Manager_t *manager, int withThumbnail, const ARDATATRANSFER_MediasDownloader_Filter_t *filter, eARDATATRANSFER_ERROR *result);
+
+/**
+ * @brief Get the medias list available from the Device, notifying each media as soon as its directory listing is parsed
+ * @note The listing is the one of ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync, but the medias are notified while the next directories are still being listed.
+ * The callbacks are called from the calling thread, the index is the one the media gets in the medias list once the listing completes. They must not start another listing.
+ * @warning This function allocates memory
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param withThumbnail The flag to return thumbnail, 0 no thumbnail is returned, 1 thumbnails are returned
+ * @param availableMediaCallback The available media callback, called for each media in the listing order
+ * @param availableMediaArg The pointer of the user custom argument of the available media callback
+ * @param completionCallback The listing completion callback, NULL if none
+ * @param completionArg The pointer of the user custom argument of the completion callback
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_GetAvailableMediasStream(ARDATATRANSFER_Manager_t *manager, int withThumbnail, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t availableMediaCallback, void *availableMediaArg, ARDATATRANSFER_MediasDownloader_ListingCompletionCallback_t completionCallback, void *completionArg);
+
 /**
  * @brief Get the media form the the medias list at the given index
  * @warning This function allocates memory
@@ -171,6 +327,106 @@ int ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync (ARDATATRANSFER_Manag
  */
  ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(ARDATATRANSFER_Manager_t *manager, int index, eARDATATRANSFER_ERROR *result);
 
+/**
+ * @brief Get the media of the medias list with the given uuid, in constant time
+ * @note If several medias have the same uuid, the first one listed is returned
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param uuid The uuid of the media
+ * @param [out] result The On success, set ARDATATRANSFER_OK. Otherwise, it set an error number of eARDATATRANSFER_ERROR
+ * @retval On success, the adresse of the media found else null.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex ()
+ */
+ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_GetAvailableMediaByUuid(ARDATATRANSFER_Manager_t *manager, const char *uuid, eARDATATRANSFER_ERROR *result);
+
+/**
+ * @brief Get the media of the medias list with the given name, in constant time
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param name The name of the media
+ * @param [out] result The On success, set ARDATATRANSFER_OK. Otherwise, it set an error number of eARDATATRANSFER_ERROR
+ * @retval On success, the adresse of the media found else null.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex ()
+ */
+ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_GetAvailableMediaByName(ARDATATRANSFER_Manager_t *manager, const char *name, eARDATATRANSFER_ERROR *result);
+
+/**
+ * @brief Get the media of the medias list with the given local file path, in constant time
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param filePath The local file path of the media
+ * @param [out] result The On success, set ARDATATRANSFER_OK. Otherwise, it set an error number of eARDATATRANSFER_ERROR
+ * @retval On success, the adresse of the media found else null.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex ()
+ */
+ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_GetAvailableMediaByFilePath(ARDATATRANSFER_Manager_t *manager, const char *filePath, eARDATATRANSFER_ERROR *result);
+
+/**
+ * @brief Get a page of the medias list in the given order, for galleries scrolling large lists
+ * @note The sorted order is built once by the first page asked after a listing, the next pages are copied from it
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param offset The position in the ordered list of the first media of the page
+ * @param count The number of medias of the page, the number of slots of the medias array
+ * @param order The order of the medias
+ * @param [out] medias The array filled with the adresses of the medias of the page
+ * @param [out] result The On success, set ARDATATRANSFER_OK. Otherwise, it set an error number of eARDATATRANSFER_ERROR
+ * @retval On success, the number of medias of the page, less than count at the end of the list, else 0.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex ()
+ */
+int ARDATATRANSFER_MediasDownloader_GetAvailableMediasPage(ARDATATRANSFER_Manager_t *manager, int offset, int count, eARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER order, ARDATATRANSFER_Media_t **medias, eARDATATRANSFER_ERROR *result);
+
+/**
+ * @brief Get the date of a media in seconds since the Epoch
+ * @note The timestamp is parsed from the date of the media, so any media can be given, as the ones of the download callbacks
+ * @param media The media
+ * @retval Returns the timestamp of the media, INT64_MIN if its date is unknown
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasPage ()
+ */
+int64_t ARDATATRANSFER_MediasDownloader_GetMediaTimestamp(const ARDATATRANSFER_Media_t *media);
+
+/**
+ * @brief Get the number of medias of the medias list, without listing the Device
+ * @note The medias list is the one of the last listing, or the persisted catalog loaded by ARDATATRANSFER_MediasDownloader_SetCatalogPersistent until the first listing
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param [out] result The On success, set ARDATATRANSFER_OK. Otherwise, it set an error number of eARDATATRANSFER_ERROR
+ * @retval On success, the number of medias of the list else 0.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex ()
+ */
+int ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(ARDATATRANSFER_Manager_t *manager, eARDATATRANSFER_ERROR *result);
+
+/**
+ * @brief Persist the medias list in a catalog file of the local directory, to show the medias at the next launch before the Device is listed
+ * @note The option is disabled by default and must be enabled after each ARDATATRANSFER_MediasDownloader_New. When enabled, each successful ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync writes the catalog, without the thumbnails.
+ * Enabling it before the first listing maps the catalog written by a previous run, so ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex answers at once.
+ * Calling ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync from a background thread then reconciles the list with the Device, only the directories that changed are parsed again.
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param isPersistent 1 to write the catalog, 0 to stop writing it and remove the catalog file
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetCatalogPersistent(ARDATATRANSFER_Manager_t *manager, int isPersistent);
+
+/**
+ * @brief Reuse the medias list of the last listing for a while instead of listing the Device again
+ * @note Within the TTL, ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync and ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered return the medias list at once when the last listing was done with the same filter and at least the same thumbnails.
+ * After the TTL, if isProbed is 1 and the last listing found all the medias in DCIM, only the DCIM folder is listed: when its listing did not change, the medias list is kept and the TTL starts again, else the Device is listed.
+ * The probe relies on the dates of the DCIM subdirectories, which FTP lists to the minute: an unchanged probe is only trusted once the Device was listed after the minute of the newest of these dates was over, else the Device is listed again.
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param ttlMs The time to live of the medias list in milliseconds, 0 to list the Device at each call
+ * @param isProbed 1 to probe the DCIM folder once the TTL is over, 0 to list the Device
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetCatalogTtl(ARDATATRANSFER_Manager_t *manager, int ttlMs, int isProbed);
+
+/**
+ * @brief Set the maximum size of the thumbnails cache of the local directory
+ * @note The thumbnails are cached by remote path and media size, ARDATATRANSFER_MediasDownloader_GetThumbnail, the listings with thumbnails and ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsync read them from the cache instead of the Device.
+ * The cache is disabled by default, ARDATATRANSFER_MEDIAS_THUMBNAILS_DEFAULT_SIZE is a suggested size to enable it. The least recently used thumbnails are removed when it is full.
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param maxSize The maximum size in bytes of the cache, 0 to disable the cache and remove its files
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_GetThumbnail ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetThumbnailsCacheSize(ARDATATRANSFER_Manager_t *manager, uint64_t maxSize);
+
 /**
  * @brief Get the medias list available form the Device
  * @warning This function allocates memory
@@ -182,6 +438,21 @@ int ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync (ARDATATRANSFER_Manag
  */
 eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsync (ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t availableMediaCallback, void *availableMediaArg);
 
+/**
+ * @brief Get the thumbnails of the medias list available from the Device
+ * @warning This function allocates memory
+ * @note The thumbnails are fetched in parallel over the ftpListManager given to ARDATATRANSFER_MediasDownloader_New and the connections of ARDATATRANSFER_MediasDownloader_AddListWorker, one request in flight on each connection.
+ * The available media callback is called for each media whose thumbnail was fetched, from the last media of the list to the first one if isOrdered is 1, else as soon as each thumbnail is fetched.
+ * The fetches share the connections of the listing, so the callback must not start a listing.
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param availableMediaCallback The available media callback
+ * @param availableMediaArg The pointer of the user custom argument
+ * @param isOrdered 1 to notify the medias in the order of the list, 0 in the order the thumbnails are fetched
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsync ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsyncWithOrder (ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t availableMediaCallback, void *availableMediaArg, int isOrdered);
+
 /**
  * @brief Send a cancel to the get media list function
  * @param manager The pointer of the ARDataTransfer Manager
@@ -208,7 +479,7 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias(AR
 eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_DeleteMedia(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media, ARDATATRANSFER_MediasDownloader_DeleteMediaCallback_t deleteMediaCallBack, void *deleteMediaArg);
 
 /**
- * @brief Add a media to the download process queue
+ * @brief Add a media to the download process queue with the ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_NORMAL priority
  * @param manager The pointer of the ARDataTransfer Manager
  * @param media The media to add
  * @param progressCallback The progress callback for this media download
@@ -220,8 +491,118 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_DeleteMedia(ARDATATRANSFER
  */
 eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddMediaToQueue (ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media,  ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback, void *progressArg, ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback, void *completionArg);
 
+/**
+ * @brief Add a media to the download process queue with a given priority
+ * @note A media of higher priority is downloaded as soon as the media in progress is completed
+ * @note If the same remote media is already queued or downloading, no new transfer is scheduled: the callbacks are attached to the existing one and the queued media is raised to the given priority
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param media The media to add
+ * @param priority The download priority of the media
+ * @param progressCallback The progress callback for this media download
+ * @param progressArg The progress callback user argument for this media download
+ * @param completionCallback The completion callback for this media download
+ * @param completionArg The completion callback user argument for this media download
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_AddMediaToQueue (), ARDATATRANSFER_MediasDownloader_SetMediaPriority ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddMediaToQueueWithPriority (ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority, ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback, void *progressArg, ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback, void *completionArg);
+
+/**
+ * @brief Add several medias to the download process queue at once, in their order
+ * @note This is faster than adding the medias one by one, each media is queued as with ARDATATRANSFER_MediasDownloader_AddMediaToQueueWithPriority
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param medias The medias to add
+ * @param count The number of medias to add
+ * @param priority The download priority of the medias
+ * @param progressCallback The progress callback for each media download
+ * @param progressArg The progress callback user argument for each media download
+ * @param completionCallback The completion callback for each media download
+ * @param completionArg The completion callback user argument for each media download
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR and no media is added.
+ * @see ARDATATRANSFER_MediasDownloader_AddMediaToQueueWithPriority ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddMediasToQueue (ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t **medias, int count, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority, ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback, void *progressArg, ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback, void *completionArg);
+
+/**
+ * @brief Restore the medias left pending in the download process queue by a previous run, and journal the queue from now on
+ * @note The queue journal is written in the local directory. A media stays pending until it is downloaded or canceled with ARDATATRANSFER_MediasDownloader_CancelMediaDownload, its partial file is resumed.
+ * @warning This function must be called before adding medias to the queue for them to be journaled
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param progressCallback The progress callback for the restored medias download
+ * @param progressArg The progress callback user argument for the restored medias download
+ * @param completionCallback The completion callback for the restored medias download
+ * @param completionArg The completion callback user argument for the restored medias download
+ * @param [out] error The On success, set ARDATATRANSFER_OK. Otherwise, it set an error number of eARDATATRANSFER_ERROR
+ * @retval Returns the number of medias added back to the queue.
+ * @see ARDATATRANSFER_MediasDownloader_AddMediaToQueue ()
+ */
+int ARDATATRANSFER_MediasDownloader_RestoreQueue (ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback, void *progressArg, ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback, void *completionArg, eARDATATRANSFER_ERROR *error);
+
+/**
+ * @brief Set the scheduling policy of the download process queue
+ * @note The policy orders the queued medias of the same priority, it applies to the medias already queued
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param policy The scheduling policy
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_AddMediaToQueueWithPriority ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetQueuePolicy (ARDATATRANSFER_Manager_t *manager, eARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY policy);
+
+/**
+ * @brief Change the priority of a media waiting in the download process queue
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param media The queued media
+ * @param priority The new download priority of the media
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR, ARDATATRANSFER_ERROR_BAD_PARAMETER if the media is not waiting in the queue.
+ * @see ARDATATRANSFER_MediasDownloader_AddMediaToQueueWithPriority ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetMediaPriority (ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority);
+
+/**
+ * @brief Get a snapshot of the download process queue
+ * @note The counters are maintained by the queue operations, the call does not scan the queue
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param[out] stats The queue snapshot
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_QueueStats_t
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_GetQueueStats (ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_QueueStats_t *stats);
+
+/**
+ * @brief Add an FTP connection to download the queued medias in parallel
+ * @note Run one ARDATATRANSFER_MediasDownloader_QueueThreadRun thread for each FTP connection, including the ftpQueueManager given to ARDATATRANSFER_MediasDownloader_New
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param ftpQueueManager The FTP connection, it must not be shared with another downloader
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_QueueThreadRun ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddQueueWorker (ARDATATRANSFER_Manager_t *manager, ARUTILS_Manager_t *ftpQueueManager);
+
+/**
+ * @brief Add an FTP connection to list the medias directories in parallel
+ * @note ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync lists the DCIM subdirectories and the product subfolders over the ftpListManager given to ARDATATRANSFER_MediasDownloader_New and these connections, then merges them in the listing order.
+ * ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsync fetches the thumbnails over the same connections
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param ftpListManager The FTP connection, it must not be shared with another downloader
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddListWorker (ARDATATRANSFER_Manager_t *manager, ARUTILS_Manager_t *ftpListManager);
+
+/**
+ * @brief Set the recursive listing of the medias directories
+ * @note The medias listing then lists the remote directory tree with one command instead of one per directory. When the first recursive listing fails or has no subdirectory headers, the server is taken as not supporting it and the directories are listed one by one until the next call of this function
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param recursiveListCallback The recursive listing callback, NULL to list the directories one by one
+ * @param recursiveListArg The pointer of the user custom argument of the callback
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_RecursiveListCallback_t, ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetRecursiveList (ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_RecursiveListCallback_t recursiveListCallback, void *recursiveListArg);
+
 /**
  * @brief Process of the media download queue
+ * @note Each running thread downloads with its own FTP connection, see ARDATATRANSFER_MediasDownloader_AddQueueWorker
  * @param manager The pointer of the ARDataTransfer Manager
  * @retval returns NULL
  * @see ARDATATRANSFER_MediasDownloader_Init ()
@@ -229,7 +610,17 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddMediaToQueue (ARDATATRA
 void* ARDATATRANSFER_MediasDownloader_QueueThreadRun (void *managerArg);
 
 /**
- * @brief Send a cancel to the medias downloader process queue
+ * @brief Cancel the download of one media, the other queued medias keep downloading
+ * @note The media is removed from the queue if still waiting, otherwise its transfer in progress is aborted. Its completion callback is called with ARDATATRANSFER_ERROR_CANCELED.
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param media The media to cancel
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR, ARDATATRANSFER_ERROR_BAD_PARAMETER if the media is neither queued nor downloading.
+ * @see ARDATATRANSFER_MediasDownloader_AddMediaToQueue (), ARDATATRANSFER_MediasDownloader_CancelQueueThread ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_CancelMediaDownload (ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media);
+
+/**
+ * @brief Send a cancel to all the medias downloader process queue threads
  * @param manager The pointer of the ARDataTransfer Manager
  * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
  * @see ARDATATRANSFER_MediasDownloader_QueueThreadRun ()
@@ -237,7 +628,7 @@ void* ARDATATRANSFER_MediasDownloader_QueueThreadRun (void *managerArg);
 eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_CancelQueueThread (ARDATATRANSFER_Manager_t *manager);
 
 /**
- * @brief Get the media thumbnail from the device FTP server
+ * @brief Get the media thumbnail from the thumbnails cache, else from the device FTP server
  * @warning This function allocates memory
  * @param manager The address of the pointer on the ARDataTransfer Manager
  * @param media The media for which the thumbnail is requested
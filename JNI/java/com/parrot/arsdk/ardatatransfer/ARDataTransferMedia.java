@@ -59,6 +59,7 @@ public class ARDataTransferMedia implements Parcelable
     private String remotePath = null;
     private String remoteThumb = null;
     private float size = 0.f;
+    private long timestamp = Long.MIN_VALUE;
     private byte[] thumbnail = null;
 
     /*  Java Methods */
@@ -71,10 +72,11 @@ public class ARDataTransferMedia implements Parcelable
      * @param date String Media Date
      * @param uuid String Media UUID
      * @param size float Media Size
+     * @param timestamp long Media Date in seconds since the Epoch, Long.MIN_VALUE if unknown
      * @param thumbnail byte[] Media Thumbnail
      * @return void
      */
-    protected ARDataTransferMedia(int productValue, String name, String filePath, String date, String uuid, String remotePath, String remoteThumb, float size, byte[] thumbnail)
+    protected ARDataTransferMedia(int productValue, String name, String filePath, String date, String uuid, String remotePath, String remoteThumb, float size, long timestamp, byte[] thumbnail)
     {
         this.product = ARDISCOVERY_PRODUCT_ENUM.getFromValue(productValue);
         this.name = name;
@@ -84,6 +86,7 @@ public class ARDataTransferMedia implements Parcelable
         this.remotePath = remotePath;
         this.remoteThumb = remoteThumb;
         this.size = size;
+        this.timestamp = timestamp;
         this.thumbnail = thumbnail;
     }
 
@@ -97,6 +100,7 @@ public class ARDataTransferMedia implements Parcelable
         this.remotePath = readString(source);
         this.remoteThumb = readString(source);
         this.size = source.readFloat();
+        this.timestamp = source.readLong();
         int thumbnailSize = source.readInt();
         if (thumbnailSize > 0)
         {
@@ -116,6 +120,7 @@ public class ARDataTransferMedia implements Parcelable
         writeString(dest, this.remotePath);
         writeString(dest, this.remoteThumb);
         dest.writeFloat(this.size);
+        dest.writeLong(this.timestamp);
         int thumbnailSize = (this.thumbnail != null) ? this.thumbnail.length : 0;
         dest.writeInt(thumbnailSize);
         if (thumbnailSize > 0)
@@ -254,6 +259,16 @@ public class ARDataTransferMedia implements Parcelable
         return this.size;
     }
 
+    /**
+     * Gets the Media Timestamp
+     * @note get the Media Date in seconds since the Epoch
+     * @return long media Timestamp, Long.MIN_VALUE if unknown
+     */
+    public long getTimestamp()
+    {
+        return this.timestamp;
+    }
+
     /**
      * Gets the Media Thumbnail
      * @note get the Media Thumbnail
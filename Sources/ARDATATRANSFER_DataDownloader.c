@@ -53,6 +53,7 @@
 #include <libARSAL/ARSAL_Sem.h>
 #include <libARSAL/ARSAL_Mutex.h>
 #include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Thread.h>
 #include <libARSAL/ARSAL_Ftw.h>
 #include <libARUtils/ARUTILS_Error.h>
 #include <libARUtils/ARUTILS_Manager.h>
@@ -67,7 +68,10 @@
 #include "libARDataTransfer/ARDATATRANSFER_MediasDownloader.h"
 #include "ARDATATRANSFER_Downloader.h"
 #include "ARDATATRANSFER_Uploader.h"
+#include "ARDATATRANSFER_MediasIndex.h"
 #include "ARDATATRANSFER_MediasQueue.h"
+#include "ARDATATRANSFER_MediasJournal.h"
+#include "ARDATATRANSFER_MediasThumbnails.h"
 #include "ARDATATRANSFER_DataDownloader.h"
 #include "ARDATATRANSFER_MediasDownloader.h"
 #include "ARDATATRANSFER_Manager.h"
@@ -45,6 +45,7 @@
 #include <libARSAL/ARSAL_Sem.h>
 #include <libARSAL/ARSAL_Mutex.h>
 #include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Thread.h>
 #include <libARUtils/ARUTILS_Error.h>
 #include <libARUtils/ARUTILS_Manager.h>
 #include <libARUtils/ARUTILS_Ftp.h>
@@ -58,7 +59,10 @@
 #include "libARDataTransfer/ARDATATRANSFER_MediasDownloader.h"
 #include "ARDATATRANSFER_Downloader.h"
 #include "ARDATATRANSFER_Uploader.h"
+#include "ARDATATRANSFER_MediasIndex.h"
 #include "ARDATATRANSFER_MediasQueue.h"
+#include "ARDATATRANSFER_MediasJournal.h"
+#include "ARDATATRANSFER_MediasThumbnails.h"
 #include "ARDATATRANSFER_DataDownloader.h"
 #include "ARDATATRANSFER_MediasDownloader.h"
 #include "ARDATATRANSFER_Manager.h"
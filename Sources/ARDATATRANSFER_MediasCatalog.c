@@ -0,0 +1,408 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARDATATRANSFER_MediasCatalog.c
+ * @brief libARDataTransfer MediasCatalog c file.
+ * The catalog file is a header, the directories of the medias list then its media records, as laid out in memory.
+ * It is mapped copy on write, so the records are used in place and the thumbnails fetched later stay private to the process.
+ **/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <libARSAL/ARSAL_Sem.h>
+#include <libARSAL/ARSAL_Mutex.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Thread.h>
+#include <libARUtils/ARUTILS_Error.h>
+#include <libARUtils/ARUTILS_Manager.h>
+#include <libARUtils/ARUTILS_Ftp.h>
+#include <libARDiscovery/ARDISCOVERY_Discovery.h>
+
+#include "libARDataTransfer/ARDATATRANSFER_Error.h"
+#include "libARDataTransfer/ARDATATRANSFER_Manager.h"
+#include "libARDataTransfer/ARDATATRANSFER_DataDownloader.h"
+#include "libARDataTransfer/ARDATATRANSFER_MediasDownloader.h"
+#include "ARDATATRANSFER_MediasIndex.h"
+#include "ARDATATRANSFER_MediasQueue.h"
+#include "ARDATATRANSFER_MediasJournal.h"
+#include "ARDATATRANSFER_MediasThumbnails.h"
+#include "ARDATATRANSFER_MediasDownloader.h"
+#include "ARDATATRANSFER_MediasCatalog.h"
+
+#define ARDATATRANSFER_MEDIASCATALOG_TAG        "MediasCatalog"
+
+#define ARDATATRANSFER_MEDIASCATALOG_MAGIC      "ARMCATLG"
+#define ARDATATRANSFER_MEDIASCATALOG_TMP_EXT    ".tmp"
+
+/*****************************************
+ *
+ *             Private implementation:
+ *
+ *****************************************/
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasCatalog_Save(const char *localDirectory, const char *remoteDirectory, ARDATATRANSFER_MediaList_t *mediaList)
+{
+    char path[ARUTILS_FTP_MAX_PATH_SIZE];
+    char tmpPath[ARUTILS_FTP_MAX_PATH_SIZE];
+    char padding[ARDATATRANSFER_MEDIAS_CATALOG_ALIGN];
+    ARDATATRANSFER_MediasCatalog_Header_t header;
+    ARDATATRANSFER_MediaDirectory_t *directories = NULL;
+    ARDATATRANSFER_MediaDirectory_t *directory;
+    ARDATATRANSFER_MediaRecord_t record;
+    ARDATATRANSFER_Media_t *media;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    FILE *file = NULL;
+    size_t offset = 0;
+    int count = 0;
+    int i, j;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASCATALOG_TAG, "%s", localDirectory ? localDirectory : "null");
+
+    if ((localDirectory == NULL) || (remoteDirectory == NULL) || (mediaList == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (mediaList->directoriesCount > 0))
+    {
+        directories = (ARDATATRANSFER_MediaDirectory_t *)malloc(mediaList->directoriesCount * sizeof(ARDATATRANSFER_MediaDirectory_t));
+
+        if (directories == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_ALLOC;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        // The removed medias are not written, the ranges of the directories are computed again
+        for (i=0; i<mediaList->directoriesCount; i++)
+        {
+            directory = &directories[i];
+            memcpy(directory, &mediaList->directories[i], sizeof(ARDATATRANSFER_MediaDirectory_t));
+            directory->first = count;
+            directory->count = 0;
+            // The thumbnails are not written, they are fetched again by the next listing with thumbnails
+            directory->hasThumbnails = 0;
+
+            for (j=mediaList->directories[i].first; j<(mediaList->directories[i].first + mediaList->directories[i].count); j++)
+            {
+                if (mediaList->medias[j] != NULL)
+                {
+                    directory->count++;
+                }
+            }
+
+            count += directory->count;
+        }
+
+        memset(&header, 0, sizeof(ARDATATRANSFER_MediasCatalog_Header_t));
+        memcpy(header.magic, ARDATATRANSFER_MEDIASCATALOG_MAGIC, sizeof(header.magic));
+        header.version = ARDATATRANSFER_MEDIAS_CATALOG_VERSION;
+        header.mediaSize = sizeof(ARDATATRANSFER_MediaRecord_t);
+        header.directorySize = sizeof(ARDATATRANSFER_MediaDirectory_t);
+        header.count = count;
+        header.directoriesCount = mediaList->directoriesCount;
+        offset = sizeof(ARDATATRANSFER_MediasCatalog_Header_t) + (mediaList->directoriesCount * sizeof(ARDATATRANSFER_MediaDirectory_t));
+        header.recordsOffset = ((offset + ARDATATRANSFER_MEDIAS_CATALOG_ALIGN - 1) / ARDATATRANSFER_MEDIAS_CATALOG_ALIGN) * ARDATATRANSFER_MEDIAS_CATALOG_ALIGN;
+        strncpy(header.remoteDirectory, remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        header.remoteDirectory[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        memset(padding, 0, ARDATATRANSFER_MEDIAS_CATALOG_ALIGN);
+
+        strncpy(path, localDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        path[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(path, ARDATATRANSFER_MEDIAS_CATALOG_FILE_NAME, ARUTILS_FTP_MAX_PATH_SIZE - strlen(path) - 1);
+        strncpy(tmpPath, path, ARUTILS_FTP_MAX_PATH_SIZE);
+        tmpPath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(tmpPath, ARDATATRANSFER_MEDIASCATALOG_TMP_EXT, ARUTILS_FTP_MAX_PATH_SIZE - strlen(tmpPath) - 1);
+
+        // Written aside then renamed, a mapped catalog is never modified
+        file = fopen(tmpPath, "wb");
+
+        if (file == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_FILE;
+        }
+    }
+
+    if ((result == ARDATATRANSFER_OK)
+        && ((fwrite(&header, sizeof(ARDATATRANSFER_MediasCatalog_Header_t), 1, file) != 1)
+            || ((mediaList->directoriesCount > 0) && (fwrite(directories, sizeof(ARDATATRANSFER_MediaDirectory_t), mediaList->directoriesCount, file) != (size_t)mediaList->directoriesCount))
+            || ((header.recordsOffset > offset) && (fwrite(padding, header.recordsOffset - offset, 1, file) != 1))))
+    {
+        result = ARDATATRANSFER_ERROR_FILE;
+    }
+
+    for (i=0; (result == ARDATATRANSFER_OK) && (i < mediaList->directoriesCount); i++)
+    {
+        for (j=mediaList->directories[i].first; (result == ARDATATRANSFER_OK) && (j < (mediaList->directories[i].first + mediaList->directories[i].count)); j++)
+        {
+            media = mediaList->medias[j];
+
+            if (media != NULL)
+            {
+                memcpy(&record, ARDATATRANSFER_MediasDownloader_GetMediaRecord(media), sizeof(ARDATATRANSFER_MediaRecord_t));
+                record.media.thumbnail = NULL;
+                record.media.thumbnailSize = 0;
+
+                if (fwrite(&record, sizeof(ARDATATRANSFER_MediaRecord_t), 1, file) != 1)
+                {
+                    result = ARDATATRANSFER_ERROR_FILE;
+                }
+            }
+        }
+    }
+
+    if ((file != NULL) && (fclose(file) != 0))
+    {
+        result = ARDATATRANSFER_ERROR_FILE;
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (rename(tmpPath, path) != 0))
+    {
+        result = ARDATATRANSFER_ERROR_FILE;
+    }
+
+    if ((result != ARDATATRANSFER_OK) && (file != NULL))
+    {
+        remove(tmpPath);
+    }
+
+    if (directories != NULL)
+    {
+        free(directories);
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASCATALOG_TAG, "%d medias, return %d", count, result);
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasCatalog_Load(const char *localDirectory, const char *remoteDirectory, ARDATATRANSFER_MediaList_t *mediaList)
+{
+    char path[ARUTILS_FTP_MAX_PATH_SIZE];
+    ARDATATRANSFER_MediasCatalog_Header_t *header = NULL;
+    ARDATATRANSFER_MediaDirectory_t *directories = NULL;
+    ARDATATRANSFER_MediaDirectory_t *directory;
+    ARDATATRANSFER_MediaRecord_t *records = NULL;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    void *mapping = NULL;
+    struct stat fileStat;
+    int fd = -1;
+    int count = 0;
+    int i, j;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASCATALOG_TAG, "%s", localDirectory ? localDirectory : "null");
+
+    if ((localDirectory == NULL) || (remoteDirectory == NULL) || (mediaList == NULL) || (mediaList->count != 0) || (mediaList->mapping != NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        strncpy(path, localDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        path[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(path, ARDATATRANSFER_MEDIAS_CATALOG_FILE_NAME, ARUTILS_FTP_MAX_PATH_SIZE - strlen(path) - 1);
+
+        fd = open(path, O_RDONLY);
+
+        if ((fd < 0) || (fstat(fd, &fileStat) != 0) || (fileStat.st_size < (off_t)sizeof(ARDATATRANSFER_MediasCatalog_Header_t)))
+        {
+            result = ARDATATRANSFER_ERROR_FILE;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        mapping = mmap(NULL, fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+        if (mapping == MAP_FAILED)
+        {
+            mapping = NULL;
+            result = ARDATATRANSFER_ERROR_FILE;
+        }
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        header = (ARDATATRANSFER_MediasCatalog_Header_t *)mapping;
+
+        // A catalog of another format, of another build or of another remote directory is ignored
+        if ((memcmp(header->magic, ARDATATRANSFER_MEDIASCATALOG_MAGIC, sizeof(header->magic)) != 0)
+            || (header->version != ARDATATRANSFER_MEDIAS_CATALOG_VERSION)
+            || (header->mediaSize != sizeof(ARDATATRANSFER_MediaRecord_t))
+            || (header->directorySize != sizeof(ARDATATRANSFER_MediaDirectory_t))
+            || (strncmp(header->remoteDirectory, remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE) != 0)
+            || ((header->recordsOffset % ARDATATRANSFER_MEDIAS_CATALOG_ALIGN) != 0)
+            || ((uint64_t)header->recordsOffset < (sizeof(ARDATATRANSFER_MediasCatalog_Header_t) + ((uint64_t)header->directoriesCount * sizeof(ARDATATRANSFER_MediaDirectory_t))))
+            || ((uint64_t)fileStat.st_size != ((uint64_t)header->recordsOffset + ((uint64_t)header->count * sizeof(ARDATATRANSFER_MediaRecord_t)))))
+        {
+            result = ARDATATRANSFER_ERROR_FILE;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        directories = (ARDATATRANSFER_MediaDirectory_t *)((char *)mapping + sizeof(ARDATATRANSFER_MediasCatalog_Header_t));
+        records = (ARDATATRANSFER_MediaRecord_t *)((char *)mapping + header->recordsOffset);
+
+        for (i=0; (result == ARDATATRANSFER_OK) && (i < (int)header->directoriesCount); i++)
+        {
+            directory = &directories[i];
+
+            if ((directory->remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] != '\0')
+                || (directory->first != count)
+                || (directory->count < 0)
+                || (directory->count > ((int)header->count - count)))
+            {
+                result = ARDATATRANSFER_ERROR_FILE;
+            }
+            else
+            {
+                count += directory->count;
+            }
+        }
+
+        if (count != (int)header->count)
+        {
+            result = ARDATATRANSFER_ERROR_FILE;
+        }
+
+        for (i=0; (result == ARDATATRANSFER_OK) && (i < count); i++)
+        {
+            if (ARDATATRANSFER_MediasCatalog_IsValidMedia(&records[i].media) == 0)
+            {
+                result = ARDATATRANSFER_ERROR_FILE;
+            }
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        // The list owns the mapping from now on
+        mediaList->mapping = mapping;
+        mediaList->mappingSize = fileStat.st_size;
+
+        for (i=0; (result == ARDATATRANSFER_OK) && (i < (int)header->directoriesCount); i++)
+        {
+            directory = &directories[i];
+            result = ARDATATRANSFER_MediasDownloader_AddDirectoryToList(mediaList, directory->remotePath, directory->listHash, directory->listLen, directory->thumbHash, directory->hasThumbnails, &directory->filter);
+
+            for (j=directory->first; (result == ARDATATRANSFER_OK) && (j < (directory->first + directory->count)); j++)
+            {
+                result = ARDATATRANSFER_MediasDownloader_AddMediaToList(mediaList, &records[j].media);
+            }
+        }
+
+        if (result != ARDATATRANSFER_OK)
+        {
+            ARDATATRANSFER_MediasDownloader_FreeMediaList(mediaList);
+        }
+    }
+    else if (mapping != NULL)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_WARNING, ARDATATRANSFER_MEDIASCATALOG_TAG, "ignore %s", path);
+        munmap(mapping, fileStat.st_size);
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASCATALOG_TAG, "%d medias, return %d", count, result);
+
+    return result;
+}
+
+void ARDATATRANSFER_MediasCatalog_Unmap(ARDATATRANSFER_MediaList_t *mediaList)
+{
+    ARDATATRANSFER_MediasCatalog_Header_t *header;
+    ARDATATRANSFER_MediaRecord_t *records;
+    uint32_t i;
+
+    if ((mediaList != NULL) && (mediaList->mapping != NULL))
+    {
+        header = (ARDATATRANSFER_MediasCatalog_Header_t *)mediaList->mapping;
+        records = (ARDATATRANSFER_MediaRecord_t *)((char *)mediaList->mapping + header->recordsOffset);
+
+        // The thumbnails fetched since the load are held by the private pages of the mapping
+        for (i=0; i<header->count; i++)
+        {
+            if (records[i].media.thumbnail != NULL)
+            {
+                free(records[i].media.thumbnail);
+            }
+        }
+
+        munmap(mediaList->mapping, mediaList->mappingSize);
+        mediaList->mapping = NULL;
+        mediaList->mappingSize = 0;
+    }
+}
+
+void ARDATATRANSFER_MediasCatalog_Remove(const char *localDirectory)
+{
+    char path[ARUTILS_FTP_MAX_PATH_SIZE];
+
+    if (localDirectory != NULL)
+    {
+        strncpy(path, localDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        path[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(path, ARDATATRANSFER_MEDIAS_CATALOG_FILE_NAME, ARUTILS_FTP_MAX_PATH_SIZE - strlen(path) - 1);
+
+        if ((remove(path) != 0) && (errno != ENOENT))
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIASCATALOG_TAG, "remove %s failed: %d", path, errno);
+        }
+    }
+}
+
+int ARDATATRANSFER_MediasCatalog_IsValidMedia(const ARDATATRANSFER_Media_t *media)
+{
+    return ((media->name[ARDATATRANSFER_MEDIA_NAME_SIZE - 1] == '\0')
+            && (media->filePath[ARDATATRANSFER_MEDIA_PATH_SIZE - 1] == '\0')
+            && (media->date[ARDATATRANSFER_MEDIA_DATE_SIZE - 1] == '\0')
+            && (media->uuid[ARDATATRANSFER_MEDIA_UUID_SIZE - 1] == '\0')
+            && (media->remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] == '\0')
+            && (media->remoteThumb[ARUTILS_FTP_MAX_PATH_SIZE - 1] == '\0')
+            && (media->thumbnail == NULL)
+            && (media->thumbnailSize == 0)) ? 1 : 0;
+}
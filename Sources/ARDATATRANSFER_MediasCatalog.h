@@ -0,0 +1,126 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARDATATRANSFER_MediasCatalog.h
+ * @brief libARDataTransfer MediasCatalog header file, the persisted list of the available medias.
+ **/
+
+#ifndef _ARDATATRANSFER_MEDIASCATALOG_PRIVATE_H_
+#define _ARDATATRANSFER_MEDIASCATALOG_PRIVATE_H_
+
+/**
+ * @brief Defines the medias catalog file name, in the MediasDownloader local directory
+ * @see ARDATATRANSFER_MediasCatalog_Load ()
+ */
+#define ARDATATRANSFER_MEDIAS_CATALOG_FILE_NAME     ".medias_catalog"
+
+/**
+ * @brief Defines the medias catalog file format version, to increment when the layout of the file changes
+ * @see ARDATATRANSFER_MediasCatalog_Header_t
+ */
+#define ARDATATRANSFER_MEDIAS_CATALOG_VERSION       3
+
+/**
+ * @brief Defines the alignment of the media records in the catalog file
+ * @see ARDATATRANSFER_MediasCatalog_Header_t
+ */
+#define ARDATATRANSFER_MEDIAS_CATALOG_ALIGN         16
+
+/**
+ * @brief MediasCatalog file header, followed by the directories then by the media records
+ * @note The directories and the records are the in memory structures of the library build that wrote them, their sizes are checked with the version
+ * @param magic The file signature
+ * @param version The file format version
+ * @param mediaSize The size of a media record
+ * @param directorySize The size of a directory
+ * @param count The number of media records
+ * @param directoriesCount The number of directories
+ * @param recordsOffset The offset of the first media record, aligned on ARDATATRANSFER_MEDIAS_CATALOG_ALIGN
+ * @param remoteDirectory The FTP sub directory the medias were listed in
+ * @see ARDATATRANSFER_MediasCatalog_Save ()
+ */
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t mediaSize;
+    uint32_t directorySize;
+    uint32_t count;
+    uint32_t directoriesCount;
+    uint32_t recordsOffset;
+    char remoteDirectory[ARUTILS_FTP_MAX_PATH_SIZE];
+
+} ARDATATRANSFER_MediasCatalog_Header_t;
+
+/**
+ * @brief Write a medias list to the catalog file, the thumbnails are not written
+ * @param localDirectory The directory of the catalog file, ending with a '/'
+ * @param remoteDirectory The FTP sub directory the medias were listed in
+ * @param mediaList The list of medias
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasCatalog_Load ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasCatalog_Save(const char *localDirectory, const char *remoteDirectory, ARDATATRANSFER_MediaList_t *mediaList);
+
+/**
+ * @brief Map the catalog file and fill an empty medias list with its records, the records stay in the mapping
+ * @warning This function allocates memory
+ * @param localDirectory The directory of the catalog file, ending with a '/'
+ * @param remoteDirectory The FTP sub directory the medias must have been listed in
+ * @param mediaList The empty list of medias
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR, ARDATATRANSFER_ERROR_FILE if there is no valid catalog file.
+ * @see ARDATATRANSFER_MediasCatalog_Unmap ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasCatalog_Load(const char *localDirectory, const char *remoteDirectory, ARDATATRANSFER_MediaList_t *mediaList);
+
+/**
+ * @brief Free the thumbnails of the mapped records of a medias list and unmap the catalog file
+ * @param mediaList The list of medias
+ * @see ARDATATRANSFER_MediasCatalog_Load ()
+ */
+void ARDATATRANSFER_MediasCatalog_Unmap(ARDATATRANSFER_MediaList_t *mediaList);
+
+/**
+ * @brief Remove the catalog file
+ * @param localDirectory The directory of the catalog file, ending with a '/'
+ * @see ARDATATRANSFER_MediasCatalog_Save ()
+ */
+void ARDATATRANSFER_MediasCatalog_Remove(const char *localDirectory);
+
+/**
+ * @brief Check a mapped media record, its strings must be terminated and it must not hold a thumbnail
+ * @param media The media record
+ * @retval Returns 1 if the record is valid else 0
+ * @see ARDATATRANSFER_MediasCatalog_Load ()
+ */
+int ARDATATRANSFER_MediasCatalog_IsValidMedia(const ARDATATRANSFER_Media_t *media);
+
+#endif /* _ARDATATRANSFER_MEDIASCATALOG_PRIVATE_H_ */
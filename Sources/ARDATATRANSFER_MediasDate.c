@@ -0,0 +1,174 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARDATATRANSFER_MediasDate.c
+ * @brief libARDataTransfer MediasDate c file.
+ **/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "libARDataTransfer/ARDATATRANSFER_Error.h"
+#include "libARDataTransfer/ARDATATRANSFER_Manager.h"
+#include "libARDataTransfer/ARDATATRANSFER_MediasDownloader.h"
+#include "ARDATATRANSFER_MediasDate.h"
+
+static const char *ARDATATRANSFER_MediasDate_Months[12] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+/**
+ * @brief Get the number of days since the Epoch of a proleptic Gregorian date
+ * @param year The year
+ * @param month The month, from 1 to 12
+ * @param day The day of the month, from 1 to 31
+ * @retval Returns the number of days since the Epoch
+ */
+static int64_t ARDATATRANSFER_MediasDate_GetDays(int year, int month, int day)
+{
+    int era, yearOfEra, dayOfYear, dayOfEra, shiftedMonth;
+
+    year -= (month <= 2) ? 1 : 0;
+    era = ((year >= 0) ? year : (year - 399)) / 400;
+    yearOfEra = year - (era * 400);
+    shiftedMonth = (month > 2) ? (month - 3) : (month + 9);
+    dayOfYear = (((153 * shiftedMonth) + 2) / 5) + day - 1;
+    dayOfEra = (yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100) + dayOfYear;
+
+    return ((int64_t)era * 146097) + dayOfEra - 719468;
+}
+
+int64_t ARDATATRANSFER_MediasDate_Parse(const char *date)
+{
+    int64_t timestamp = INT64_MIN;
+    int year, month, day, hour, minute, second, tzHour, tzMinute;
+    char tzSign;
+
+    if ((date != NULL)
+        && (sscanf(date, "%4d-%2d-%2dT%2d%2d%2d%c%2d%2d", &year, &month, &day, &hour, &minute, &second, &tzSign, &tzHour, &tzMinute) == 9)
+        && ((tzSign == '+') || (tzSign == '-'))
+        && (month >= 1) && (month <= 12) && (day >= 1) && (day <= 31))
+    {
+        timestamp = (ARDATATRANSFER_MediasDate_GetDays(year, month, day) * 86400) + (hour * 3600) + (minute * 60) + second;
+        timestamp -= ((tzSign == '+') ? 1 : -1) * ((tzHour * 3600) + (tzMinute * 60));
+    }
+
+    return timestamp;
+}
+
+int64_t ARDATATRANSFER_MediasDate_ParseName(const char *name)
+{
+    char date[ARDATATRANSFER_MEDIA_DATE_SIZE];
+    const char *begin;
+    const char *end;
+    int64_t timestamp = INT64_MIN;
+    size_t len;
+
+    end = strrchr(name, '_');
+
+    for (begin = end; (begin != NULL) && (begin > name) && (*(begin - 1) != '_'); begin--);
+
+    if ((begin != NULL) && (begin > name))
+    {
+        len = end - begin;
+        len = (len < ARDATATRANSFER_MEDIA_DATE_SIZE) ? len : (ARDATATRANSFER_MEDIA_DATE_SIZE - 1);
+        memcpy(date, begin, len);
+        date[len] = '\0';
+        timestamp = ARDATATRANSFER_MediasDate_Parse(date);
+    }
+
+    return timestamp;
+}
+
+int64_t ARDATATRANSFER_MediasDate_ParseListItem(const char *line, int lineSize, int64_t now)
+{
+    char item[16];
+    char monthName[4];
+    const char *field = line;
+    const char *lineEnd = line + lineSize;
+    int64_t timestamp = INT64_MIN;
+    int64_t days;
+    time_t nowTime;
+    struct tm nowDate;
+    int year, month, day, hour, minute;
+    int len;
+    int i;
+
+    // The date follows the mode, links, owner, group and size fields
+    for (i=0; (i < 5) && (field < lineEnd); i++)
+    {
+        while ((field < lineEnd) && (*field != ' '))
+        {
+            field++;
+        }
+        while ((field < lineEnd) && (*field == ' '))
+        {
+            field++;
+        }
+    }
+
+    len = lineEnd - field;
+    len = (len < (int)sizeof(item)) ? len : ((int)sizeof(item) - 1);
+    memcpy(item, field, len);
+    item[len] = '\0';
+
+    month = 0;
+    if (sscanf(item, "%3s %d", monthName, &day) == 2)
+    {
+        for (i=0; (i < 12) && (month == 0); i++)
+        {
+            month = (strcmp(monthName, ARDATATRANSFER_MediasDate_Months[i]) == 0) ? (i + 1) : 0;
+        }
+    }
+
+    if ((month != 0) && (day >= 1) && (day <= 31) && (sscanf(item, "%*3s %*d %d:%d", &hour, &minute) == 2))
+    {
+        // Within the last six months, the year is the one of now unless the date would be ahead of now by more than a day
+        nowTime = (time_t)now;
+        gmtime_r(&nowTime, &nowDate);
+        year = nowDate.tm_year + 1900;
+
+        days = ARDATATRANSFER_MediasDate_GetDays(year, month, day);
+        if ((days * 86400) > (now + 86400))
+        {
+            days = ARDATATRANSFER_MediasDate_GetDays(year - 1, month, day);
+        }
+
+        timestamp = (days * 86400) + (hour * 3600) + (minute * 60);
+    }
+    else if ((month != 0) && (day >= 1) && (day <= 31) && (sscanf(item, "%*3s %*d %d", &year) == 1))
+    {
+        timestamp = ARDATATRANSFER_MediasDate_GetDays(year, month, day) * 86400;
+    }
+
+    return timestamp;
+}
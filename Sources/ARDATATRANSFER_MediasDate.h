@@ -0,0 +1,64 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARDATATRANSFER_MediasDate.h
+ * @brief libARDataTransfer MediasDate header file, the parsing of the media dates shared by the queue and the listing.
+ **/
+
+#ifndef _ARDATATRANSFER_MEDIASDATE_PRIVATE_H_
+#define _ARDATATRANSFER_MEDIASDATE_PRIVATE_H_
+
+/**
+ * @brief Parse a media date, as found in the media file names (e.g. 2014-12-15T102030+0100)
+ * @param date The media date
+ * @retval Returns the date in seconds since the Epoch, INT64_MIN if the date can not be parsed
+ */
+int64_t ARDATATRANSFER_MediasDate_Parse(const char *date);
+
+/**
+ * @brief Parse the date of a media file name, the date being between its last two underscores
+ * @param name The file name of the media or of its thumbnail
+ * @retval Returns the date in seconds since the Epoch, INT64_MIN if the name has no date
+ * @see ARDATATRANSFER_MediasDate_Parse ()
+ */
+int64_t ARDATATRANSFER_MediasDate_ParseName(const char *name);
+
+/**
+ * @brief Parse the modification date of a FTP LIST line (e.g. Dec 15 10:20, or Dec 15 2013 past six months)
+ * @note The date is in the time zone of the Device and at best to the minute
+ * @param line The LIST line
+ * @param lineSize The size of the line
+ * @param now The current date in seconds since the Epoch, giving the year of the dates without one
+ * @retval Returns the date in seconds since the Epoch, INT64_MIN if the line has no date
+ */
+int64_t ARDATATRANSFER_MediasDate_ParseListItem(const char *line, int lineSize, int64_t now);
+
+#endif /* _ARDATATRANSFER_MEDIASDATE_PRIVATE_H_ */
@@ -40,11 +40,14 @@
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 #include <sys/stat.h>
 
 #include <libARSAL/ARSAL_Sem.h>
 #include <libARSAL/ARSAL_Mutex.h>
 #include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Thread.h>
+#include <libARSAL/ARSAL_Time.h>
 #include <libARUtils/ARUTILS_Error.h>
 #include <libARUtils/ARUTILS_Manager.h>
 #include <libARUtils/ARUTILS_Ftp.h>
@@ -59,9 +62,14 @@
 #include "libARDataTransfer/ARDATATRANSFER_MediasDownloader.h"
 #include "ARDATATRANSFER_Downloader.h"
 #include "ARDATATRANSFER_Uploader.h"
+#include "ARDATATRANSFER_MediasIndex.h"
+#include "ARDATATRANSFER_MediasDate.h"
 #include "ARDATATRANSFER_MediasQueue.h"
+#include "ARDATATRANSFER_MediasJournal.h"
+#include "ARDATATRANSFER_MediasThumbnails.h"
 #include "ARDATATRANSFER_DataDownloader.h"
 #include "ARDATATRANSFER_MediasDownloader.h"
+#include "ARDATATRANSFER_MediasCatalog.h"
 #include "ARDATATRANSFER_Manager.h"
 
 #define ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG                "MediasDownloader"
@@ -78,6 +86,11 @@
 #define ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MP4_CAP        "MP4"
 #define ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MOV_CAP        "MOV"
 
+#define ARDATATRANSFER_MEDIAS_DOWNLOADER_DCIM_DIR_LEN       8
+#define ARDATATRANSFER_MEDIAS_DOWNLOADER_DCIM_PREFIX_LEN    21
+
+#define ARDATATRANSFER_MEDIAS_DOWNLOADER_THUMBNAILS_BATCH   64
+
 /*****************************************
  *
  *             Public implementation:
@@ -145,10 +158,40 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_New(ARDATATRANSFER_Manager
 
     if (result == ARDATATRANSFER_OK)
     {
-        manager->mediasDownloader->medias.medias = NULL;
-        manager->mediasDownloader->medias.count = 0;
+        resultSys = ARSAL_Mutex_Init(&manager->mediasDownloader->listLock);
+
+        if (resultSys != 0)
+        {
+            result = ARDATATRANSFER_ERROR_SYSTEM;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        resultSys = ARSAL_Mutex_Init(&manager->mediasDownloader->workersLock);
+
+        if (resultSys != 0)
+        {
+            result = ARDATATRANSFER_ERROR_SYSTEM;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        result = ARDATATRANSFER_MediasDownloader_NewListPool(&manager->mediasDownloader->listPool);
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        memset(&manager->mediasDownloader->medias, 0, sizeof(ARDATATRANSFER_MediaList_t));
         manager->mediasDownloader->ftpListManager = ftpListManager;
         manager->mediasDownloader->ftpQueueManager = ftpQueueManager;
+        manager->mediasDownloader->workers[0].ftpManager = ftpQueueManager;
+        manager->mediasDownloader->workers[0].isRunning = 0;
+        manager->mediasDownloader->workersCount = 1;
+        manager->mediasDownloader->listManagers[0] = ftpListManager;
+        manager->mediasDownloader->listManagersCount = 1;
+        manager->mediasDownloader->recursiveListSupport = -1;
     }
 
     if (result == ARDATATRANSFER_OK)
@@ -156,6 +199,16 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_New(ARDATATRANSFER_Manager
         ARDATATRANSFER_MediasQueue_New(&manager->mediasDownloader->queue);
     }
 
+    if (result == ARDATATRANSFER_OK)
+    {
+        result = ARDATATRANSFER_MediasJournal_New(&manager->mediasDownloader->journal);
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        result = ARDATATRANSFER_MediasThumbnails_New(&manager->mediasDownloader->thumbnails);
+    }
+
     if (result == ARDATATRANSFER_OK)
     {
         manager->mediasDownloader->isRunning = 0;
@@ -198,11 +251,17 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_Delete(ARDATATRANSFER_Mana
             {
                 ARDATATRANSFER_MediasDownloader_Clear(manager);
 
+                ARDATATRANSFER_MediasDownloader_DeleteListPool(&manager->mediasDownloader->listPool);
+
                 ARSAL_Sem_Destroy(&manager->mediasDownloader->queueSem);
                 ARSAL_Sem_Destroy(&manager->mediasDownloader->threadSem);
 
                 ARDATATRANSFER_MediasQueue_Delete(&manager->mediasDownloader->queue);
+                ARDATATRANSFER_MediasJournal_Delete(&manager->mediasDownloader->journal);
+                ARDATATRANSFER_MediasThumbnails_Delete(&manager->mediasDownloader->thumbnails);
 
+                ARSAL_Mutex_Destroy(&manager->mediasDownloader->workersLock);
+                ARSAL_Mutex_Destroy(&manager->mediasDownloader->listLock);
                 ARSAL_Mutex_Destroy(&manager->mediasDownloader->mediasLock);
                 ARDATATRANSFER_MediasDownloader_FreeMediaList(&manager->mediasDownloader->medias);
 
@@ -216,32 +275,54 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_Delete(ARDATATRANSFER_Mana
 }
 
 int ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(ARDATATRANSFER_Manager_t *manager, int withThumbnail, eARDATATRANSFER_ERROR *error)
+{
+    return ARDATATRANSFER_MediasDownloader_ListMedias(manager, withThumbnail, NULL, NULL, NULL, error);
+}
+
+int ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered(ARDATATRANSFER_Manager_t *manager, int withThumbnail, const ARDATATRANSFER_MediasDownloader_Filter_t *filter, eARDATATRANSFER_ERROR *error)
+{
+    return ARDATATRANSFER_MediasDownloader_ListMedias(manager, withThumbnail, NULL, NULL, filter, error);
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_GetAvailableMediasStream(ARDATATRANSFER_Manager_t *manager, int withThumbnail, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t availableMediaCallback, void *availableMediaArg, ARDATATRANSFER_MediasDownloader_ListingCompletionCallback_t completionCallback, void *completionArg)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int count = 0;
+
+    if (availableMediaCallback == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        count = ARDATATRANSFER_MediasDownloader_ListMedias(manager, withThumbnail, availableMediaCallback, availableMediaArg, NULL, &result);
+
+        if (completionCallback != NULL)
+        {
+            completionCallback(completionArg, count, result);
+        }
+    }
+
+    return result;
+}
+
+int ARDATATRANSFER_MediasDownloader_ListMedias(ARDATATRANSFER_Manager_t *manager, int withThumbnail, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t discoveredCallback, void *discoveredArg, const ARDATATRANSFER_MediasDownloader_Filter_t *filter, eARDATATRANSFER_ERROR *error)
 {
     char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
-    char thumbPath[ARUTILS_FTP_MAX_PATH_SIZE];
-    char remoteProduct[ARUTILS_FTP_MAX_PATH_SIZE];
-    char productPathName[ARUTILS_FTP_MAX_PATH_SIZE];
     char *productFtpList = NULL;
     uint32_t productFtpListLen = 0;
-    char *mediaFtpList = NULL;
-    uint32_t mediaFtpListLen = 0;
-    char *dcimFtpList = NULL;
-    uint32_t dcimFtpListLen = 0;
-    char *metaThumbList = NULL;
-    uint32_t metaThumbListLen = 0;
-    const char *nextDcim = NULL;
-    const char *nextProduct = NULL;
-    const char *nextMedia = NULL;
-    const char *lineItem;
-    int lineSize;
-    const char *dirName;
-    const char *fileName;
-    const char *thumbName;
-    int product;
+    ARDATATRANSFER_MediaList_t medias;
+    ARDATATRANSFER_MediaList_t *previousMedias;
+    ARDATATRANSFER_MediasDownloader_Listing_t listing;
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
     eARUTILS_ERROR resultUtils = ARUTILS_OK;
     int count = 0;
-    int hasDCIM = 0;
+    int i;
+
+    memset(&medias, 0, sizeof(ARDATATRANSFER_MediaList_t));
+    memset(&listing, 0, sizeof(ARDATATRANSFER_MediasDownloader_Listing_t));
+    listing.dcimMinute = INT64_MIN;
 
     if (manager == NULL)
     {
@@ -255,14 +336,59 @@ int ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(ARDATATRANSFER_Manage
 
     if (result == ARDATATRANSFER_OK)
     {
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->listLock);
+
+        if (filter != NULL)
+        {
+            listing.filter.products = filter->products;
+            listing.filter.types = filter->types;
+            listing.filter.minTimestamp = filter->minTimestamp;
+            listing.filter.maxTimestamp = filter->maxTimestamp;
+            listing.isFiltered = ((filter->products != 0) || (filter->types != 0) || (filter->minTimestamp != 0) || (filter->maxTimestamp != 0)) ? 1 : 0;
+        }
+
+        // A listing that streams its medias always lists the Device, a canceled one fails
+        if ((discoveredCallback == NULL) && (ARDATATRANSFER_MediasDownloader_IsListCanceled(manager) == 0)
+            && (ARDATATRANSFER_MediasDownloader_IsCatalogCached(manager, withThumbnail, &listing.filter) == 1))
+        {
+            ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
+            count = manager->mediasDownloader->medias.count;
+            ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
+            goto end_list_medias;
+        }
+
         ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
 
-        ARDATATRANSFER_MediasDownloader_FreeMediaList(&manager->mediasDownloader->medias);
+        // The new listing is built aside, the previous one stays readable and its unchanged directories and thumbnails are reused
+        previousMedias = &manager->mediasDownloader->medias;
+
+        listing.manager = manager;
+        listing.withThumbnail = withThumbnail;
+        listing.medias = &medias;
+        listing.previousMedias = previousMedias;
+        listing.discoveredCallback = discoveredCallback;
+        listing.discoveredArg = discoveredArg;
 
-        if ((result == ARDATATRANSFER_OK)
-            && ((manager->mediasDownloader->medias.medias != NULL) || (manager->mediasDownloader->medias.count != 0)))
+        // Indexed even without thumbnails, the thumbnails of the unchanged directories are shared too
+        if (previousMedias->count > 0)
         {
-            result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+            result = ARDATATRANSFER_MediasIndex_New(&listing.previousIndex, previousMedias->count);
+
+            for (i=0; (result == ARDATATRANSFER_OK) && (i < previousMedias->count); i++)
+            {
+                if (previousMedias->medias[i] != NULL)
+                {
+                    result = ARDATATRANSFER_MediasIndex_Add(&listing.previousIndex, previousMedias->medias[i]->remotePath, strlen(previousMedias->medias[i]->remotePath), previousMedias->medias[i]);
+                }
+            }
+        }
+
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
+
+        // With a recursive listing, the directories found in it are not listed again
+        if (result == ARDATATRANSFER_OK)
+        {
+            result = ARDATATRANSFER_MediasDownloader_ListRecursive(manager, &listing.sectionIndex, &listing.recursiveList);
         }
 
         if (result == ARDATATRANSFER_OK)
@@ -270,7 +396,10 @@ int ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(ARDATATRANSFER_Manage
             strncpy(remotePath, manager->mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
             remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
 
-            resultUtils = ARUTILS_Manager_Ftp_List(manager->mediasDownloader->ftpListManager, remotePath, &productFtpList, &productFtpListLen);
+            if (ARDATATRANSFER_MediasDownloader_TakeRecursiveList(&listing.sectionIndex, manager->mediasDownloader->remoteDirectory, remotePath, &productFtpList, &productFtpListLen) == 0)
+            {
+                resultUtils = ARUTILS_Manager_Ftp_List(manager->mediasDownloader->ftpListManager, remotePath, &productFtpList, &productFtpListLen);
+            }
 
             if (resultUtils != ARUTILS_OK)
             {
@@ -278,489 +407,44 @@ int ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(ARDATATRANSFER_Manage
             }
         }
 
-        /* Search for medias in DCIM, by looking at the .META/thumb/ entries */
         if (result == ARDATATRANSFER_OK)
         {
             resultUtils = ARUTILS_Manager_Ftp_Connection_IsCanceled(manager->mediasDownloader->ftpListManager);
             if (resultUtils != ARUTILS_OK)
             {
                 result = ARDATATRANSFER_ERROR_CANCELED;
-                goto end_search_dcim;
             }
+        }
 
-            char lineDataDcim[ARUTILS_FTP_MAX_PATH_SIZE];
-            // Find DCIM directory
-            nextProduct = NULL;
-            fileName = ARUTILS_Ftp_List_GetNextItem(productFtpList, &nextProduct, ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_DCIM, 1, NULL, NULL, lineDataDcim, ARUTILS_FTP_MAX_PATH_SIZE);
-            if ((fileName != NULL) && strcmp(fileName, ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_DCIM) == 0)
-            {
-                // We have it.
-                hasDCIM = 1;
-                //First, list the thumbnails, we will need them for every file
-                strncpy(thumbPath, manager->mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
-                thumbPath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-                strncat(thumbPath, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_META "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(thumbPath) - 1);
-                if (ARUTILS_Manager_Ftp_List(manager->mediasDownloader->ftpListManager, thumbPath, &metaThumbList, &metaThumbListLen) != ARUTILS_OK)
-                {
-                    result = ARDATATRANSFER_ERROR_FTP;
-                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "Unable to list thumbnails");
-                    goto end_search_dcim;
-                }
-
-                resultUtils = ARUTILS_Manager_Ftp_Connection_IsCanceled(manager->mediasDownloader->ftpListManager);
-                if (resultUtils != ARUTILS_OK)
-                {
-                    result = ARDATATRANSFER_ERROR_CANCELED;
-                    goto end_search_dcim;
-                }
-
-                // Then look for all DCIM subdirectories
-                strncpy(remotePath, manager->mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
-                remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-                strncat(remotePath, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_DCIM "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(remotePath) - 1);
-                if (ARUTILS_Manager_Ftp_List(manager->mediasDownloader->ftpListManager, remotePath, &dcimFtpList, &dcimFtpListLen) != ARUTILS_OK)
-                {
-                    result = ARDATATRANSFER_ERROR_FTP;
-                    ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "Unable to list DCIM");
-                    goto end_search_dcim;
-                }
+        /* List the directories of the medias: DCIM, by looking at the .META/thumb/ entries, and the product subfolders */
+        if (result == ARDATATRANSFER_OK)
+        {
+            result = ARDATATRANSFER_MediasDownloader_ListDcim(&listing, productFtpList);
+        }
 
-                resultUtils = ARUTILS_Manager_Ftp_Connection_IsCanceled(manager->mediasDownloader->ftpListManager);
-                if (resultUtils != ARUTILS_OK)
-                {
-                    result = ARDATATRANSFER_ERROR_CANCELED;
-                    goto end_search_dcim;
-                }
+        if (result == ARDATATRANSFER_OK)
+        {
+            result = ARDATATRANSFER_MediasDownloader_ListProducts(&listing, productFtpList);
+        }
 
-                // Iterate for each subdir
-                nextDcim = NULL;
-                while ((dirName = ARUTILS_Ftp_List_GetNextItem(dcimFtpList, &nextDcim, NULL, 1, NULL, NULL, lineDataDcim, ARUTILS_FTP_MAX_PATH_SIZE))!= NULL)
-                {
+        // Then list all DCIM subdirectories and the product subfolders together, each one is parsed in this order as soon as it is done
+        if (result == ARDATATRANSFER_OK)
+        {
+            ARDATATRANSFER_MediasDownloader_TakeRecursiveLists(&listing.sectionIndex, manager->mediasDownloader->remoteDirectory, listing.lists, listing.listsCount);
+            ARDATATRANSFER_MediasDownloader_StartListing(&manager->mediasDownloader->listPool, listing.lists, listing.listsCount);
+            listing.isListing = 1;
+        }
 
-                    resultUtils = ARUTILS_Manager_Ftp_Connection_IsCanceled(manager->mediasDownloader->ftpListManager);
-                    if (resultUtils != ARUTILS_OK)
-                    {
-                        result = ARDATATRANSFER_ERROR_CANCELED;
-                        goto end_search_dcim;
-                    }
-
-                    strncpy(remotePath, manager->mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
-                    remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-                    strncat(remotePath, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_DCIM "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(remotePath) - 1);
-                    strncat(remotePath, dirName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(remotePath) - 1);
-                    strncat(remotePath, "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(remotePath) - 1);
-
-                    if (ARUTILS_Manager_Ftp_List(manager->mediasDownloader->ftpListManager, remotePath, &mediaFtpList, &mediaFtpListLen) != ARUTILS_OK)
-                    {
-                        result = ARDATATRANSFER_ERROR_FTP;
-                        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "Unable to list DCIM/%s", fileName);
-                        goto end_search_dcim;
-                    }
-
-                    // And now iterate on each media
-                    char lineDataMedia[ARUTILS_FTP_MAX_PATH_SIZE];
-                    nextMedia = NULL;
-                    while ((fileName = ARUTILS_Ftp_List_GetNextItem(mediaFtpList, &nextMedia, NULL, 0, &lineItem, &lineSize, lineDataMedia, ARUTILS_FTP_MAX_PATH_SIZE)) != NULL)
-                    {
-
-                        resultUtils = ARUTILS_Manager_Ftp_Connection_IsCanceled(manager->mediasDownloader->ftpListManager);
-                        if (resultUtils != ARUTILS_OK)
-                        {
-                            result = ARDATATRANSFER_ERROR_CANCELED;
-                            goto end_search_dcim;
-                        }
-
-                        char *index;
-                        // Check that the file is a proper media file
-                        index = strrchr (fileName, '.');
-                        if (index == NULL)
-                        {
-                            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "No dot found in %s", fileName);
-                            continue;
-                        }
-
-                        index++;
-                        const char *ext;
-                        if (strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_JPG_CAP) == 0)
-                        {
-                            ext = ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_JPG;
-                        }
-                        else if(strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MP4_CAP) == 0)
-                        {
-                            ext = ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MP4;
-                        }
-                        else if(strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MOV_CAP) == 0)
-                        {
-                            ext = ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MOV;
-                        }
-                        else
-                        {
-                            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "File is not media file !");
-                            continue;
-                        }
-
-                        // Check that we have a proper thumbnail file for this media
-                        char lineDataThumb[ARUTILS_FTP_MAX_PATH_SIZE];
-                        const char *nextThumb = NULL;
-                        char thumbPrefix[ARUTILS_FTP_MAX_PATH_SIZE];
-                        strncpy(thumbPrefix, dirName, ARUTILS_FTP_MAX_PATH_SIZE);
-                        thumbPrefix[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-                        strncat(thumbPrefix, fileName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(thumbPrefix) - 1);
-                        strncat(thumbPrefix, ".", ARUTILS_FTP_MAX_PATH_SIZE - strlen(thumbPrefix) - 1);
-
-                        thumbName = ARUTILS_Ftp_List_GetNextItem(metaThumbList, &nextThumb, thumbPrefix, 0, NULL, NULL, lineDataThumb, ARUTILS_FTP_MAX_PATH_SIZE);
-                        if (thumbName == NULL)
-                        {
-                            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "No thumbnail for media %s/%s", dirName, fileName);
-                            continue;
-                        }
-
-                        // Yes we do, get all infos !
-
-                        // Start with size
-                        double fileSize;
-                        if (ARUTILS_Ftp_List_GetItemSize(lineItem, lineSize, &fileSize) == NULL)
-                        {
-                            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "Unable to get media size");
-                            continue;
-                        }
-
-                        ARDATATRANSFER_Media_t *media = calloc(1, sizeof *media);
-                        if (media == NULL)
-                        {
-                            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "Unable to allocate media");
-                            continue;
-                        }
-
-                        // Forge the media
-
-                        // The DCIM prefix for thumbnails is 21 chars long
-                        // 8 for the 100DRONE (folder name) +
-                        // 8 for the JUMP0001 (media name) +
-                        // 4 for the .MOV (media extension) +
-                        // 1 for the . (separator)
-                        // The len of thumbName is always good because we checked
-                        // this prefix in the GetNextItem function.
-                        const int dcimHeaderLen = 21;
-                        media->product = ARDISCOVERY_getProductFromPathName(&thumbName[dcimHeaderLen]);
-
-                        // Media name is:
-                        // thumbnailName without dcim prefix
-                        // the extension (last 3 chars) replaced by the lowercase media ext
-                        strncpy(media->name, &thumbName[dcimHeaderLen], ARDATATRANSFER_MEDIA_NAME_SIZE);
-                        media->name[ARDATATRANSFER_MEDIA_NAME_SIZE - 1] = '\0';
-                        strncpy(&media->name[strlen(media->name) - 3], ext, 3);
-
-                        // Media filePath is the local path + the name
-                        strncpy(media->filePath, manager->mediasDownloader->localDirectory, ARDATATRANSFER_MEDIA_PATH_SIZE);
-                        media->filePath[ARDATATRANSFER_MEDIA_PATH_SIZE - 1] = '\0';
-                        strncat(media->filePath, media->name, ARDATATRANSFER_MEDIA_PATH_SIZE - strlen(media->filePath) - 1);
-
-                        // Media UUID is after the last _ but before the last .
-                        char *begin = strrchr(media->name, '_');
-                        char *end = strrchr(media->name, '.');
-                        if (begin == NULL || end == NULL)
-                        {
-                            media->uuid[0] = '\0';
-                        }
-                        else
-                        {
-                            int len = end - begin - 1;
-                            int start = begin - media->name + 1;
-                            if (len >= ARDATATRANSFER_MEDIA_UUID_SIZE)
-                            {
-                                len = ARDATATRANSFER_MEDIA_UUID_SIZE - 1;
-                            }
-                            strncpy(media->uuid, &media->name[start], len);
-                            media->uuid[len] = '\0';
-                        }
-
-                        // Media date is between the last _ and the previous one
-                        end = begin;
-                        begin = end - 1;
-                        // Find previous "_", limiting at the beginning of the string
-                        for (begin = end - 1; begin >= media->name && *begin != '_'; begin--);
-                        if (*begin != '_')
-                        {
-                            media->date[0] = '\0';
-                        }
-                        else
-                        {
-                            int len = end - begin - 1;
-                            int start = begin - media->name + 1;
-                            if (len >= ARDATATRANSFER_MEDIA_UUID_SIZE)
-                            {
-                                len = ARDATATRANSFER_MEDIA_UUID_SIZE - 1;
-                            }
-                            strncpy(media->date, &media->name[start], len);
-                            media->date[len] = '\0';
-                        }
-
-                        // Media size is just fileSize ;)
-                        media->size = fileSize;
-
-                        // Remote path is the full path to the file on the FTP
-                        strncpy(media->remotePath, manager->mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
-                        media->remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-                        strncat(media->remotePath, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_DCIM "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
-                        strncat(media->remotePath, dirName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
-                        strncat(media->remotePath, "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
-                        strncat(media->remotePath, fileName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
-
-                        // Remote thumb is the full path of the thumbnail on the FTP
-                        strncpy(media->remoteThumb, manager->mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
-                        media->remoteThumb[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-                        strncat(media->remoteThumb, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_META "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) -1);
-                        strncat(media->remoteThumb, thumbName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) - 1);
-
-                        if (withThumbnail == 1)
-                        {
-                            ARDATATRANSFER_MediasDownloader_GetThumbnail(manager, media);
-                        }
-
-                        ARDATATRANSFER_Media_t **oldMedias = manager->mediasDownloader->medias.medias;
-                        manager->mediasDownloader->medias.medias = realloc(oldMedias, (manager->mediasDownloader->medias.count + 1) * sizeof(ARDATATRANSFER_Media_t *));
-                        if (manager->mediasDownloader->medias.medias == NULL)
-                        {
-                            manager->mediasDownloader->medias.medias = oldMedias;
-                            result = ARDATATRANSFER_ERROR_ALLOC;
-                            free(media);
-                            goto end_search_dcim;
-                        }
-                        manager->mediasDownloader->medias.medias[manager->mediasDownloader->medias.count++] = media;
-                    }
-                }
-            }
+        /* Search for medias in DCIM */
+        if (result == ARDATATRANSFER_OK)
+        {
+            result = ARDATATRANSFER_MediasDownloader_ParseDcim(&listing);
         }
-    end_search_dcim:
-        free (metaThumbList);
-        free (dcimFtpList);
-        free (mediaFtpList);
-        mediaFtpList = NULL;
-        mediaFtpListLen = 0;
 
         /* Search for medias in their product subfolders */
-        product = 0;
-        while ((result == ARDATATRANSFER_OK) && (product < ARDISCOVERY_PRODUCT_MAX))
+        if (result == ARDATATRANSFER_OK)
         {
-            resultUtils = ARUTILS_Manager_Ftp_Connection_IsCanceled(manager->mediasDownloader->ftpListManager);
-
-            if (resultUtils != ARUTILS_OK)
-            {
-                result = ARDATATRANSFER_ERROR_CANCELED;
-            }
-
-            if (result == ARDATATRANSFER_OK)
-            {
-                char lineDataProduct[ARUTILS_FTP_MAX_PATH_SIZE];
-                ARDISCOVERY_getProductPathName(product, productPathName, sizeof(productPathName));
-                nextProduct = NULL;
-                fileName = ARUTILS_Ftp_List_GetNextItem(productFtpList, &nextProduct, productPathName, 1, NULL, NULL, lineDataProduct,ARUTILS_FTP_MAX_PATH_SIZE);
-
-                if ((fileName != NULL) && strcmp(fileName, productPathName) == 0)
-                {
-                    strncpy(remoteProduct, manager->mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
-                    remoteProduct[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-                    strncat(remoteProduct, "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(remoteProduct) - 1);
-                    strncat(remoteProduct, productPathName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(remoteProduct) - 1);
-                    strncat(remoteProduct, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_MEDIA "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(remoteProduct) - 1);
-
-                    resultUtils = ARUTILS_Manager_Ftp_List(manager->mediasDownloader->ftpListManager, remoteProduct, &mediaFtpList, &mediaFtpListLen);
-                    if (resultUtils == ARUTILS_OK)
-                    {
-                        char lineDataMedia[ARUTILS_FTP_MAX_PATH_SIZE];
-                        int fileType;
-                        const char *index;
-
-                        nextMedia = NULL;
-                        while ((result == ARDATATRANSFER_OK)
-                               && (fileName = ARUTILS_Ftp_List_GetNextItem(mediaFtpList, &nextMedia, NULL, 0, &lineItem, &lineSize, lineDataMedia,ARUTILS_FTP_MAX_PATH_SIZE)) != NULL)
-                        {
-                            resultUtils = ARUTILS_Manager_Ftp_Connection_IsCanceled(manager->mediasDownloader->ftpListManager);
-
-                            if (resultUtils != ARUTILS_OK)
-                            {
-                                result = ARDATATRANSFER_ERROR_CANCELED;
-                            }
-
-                            //Check file type
-                            fileType = 0;
-                            index = fileName + strlen(fileName);
-                            while (index > fileName && *index != '.')
-                            {
-                                index--;
-                            }
-                            if (*index == '.')
-                            {
-                                index++;
-                                if (strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_JPG) == 0)
-                                {
-                                    fileType = 1;
-                                }
-                                else if (strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MP4) == 0)
-                                {
-                                    fileType = 1;
-                                }
-                                else if (strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MOV) == 0)
-                                {
-                                    fileType = 1;
-                                }
-                            }
-
-                            if (strncmp(fileName, productPathName, strlen(productPathName)) != 0)
-                            {
-                                fileType = 0;
-                            }
-
-                            if (result == ARDATATRANSFER_OK && (fileType == 1))
-                            {
-                                char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
-                                ARDATATRANSFER_Media_t **oldMedias;
-                                ARDATATRANSFER_Media_t *media = NULL;
-                                double fileSize;
-                                const char *begin = NULL;;
-                                const char *tag = NULL;
-                                const char *end = NULL;
-                                const char *index;
-
-                                strncpy(remotePath, remoteProduct, ARUTILS_FTP_MAX_PATH_SIZE);
-                                remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-                                strncat(remotePath, fileName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(remotePath) - 1);
-
-                                //do not pertorm ARUTILS_Ftp_Size that is too long, prefer decoding the FTP LIST
-                                if (ARUTILS_Ftp_List_GetItemSize(lineItem, lineSize, &fileSize) != NULL)
-                                {
-                                    resultUtils = ARUTILS_OK;
-                                }
-                                else
-                                {
-                                    resultUtils = ARUTILS_ERROR_FTP_CODE;
-                                }
-
-                                if ((result == ARDATATRANSFER_OK) && (resultUtils == ARUTILS_OK))
-                                {
-                                    media = (ARDATATRANSFER_Media_t *)calloc(1, sizeof(ARDATATRANSFER_Media_t));
-
-                                    if (media == NULL)
-                                    {
-                                        result = ARDATATRANSFER_ERROR_ALLOC;
-                                    }
-                                    else
-                                    {
-                                        media->product = product;
-                                        strncpy(media->name, fileName, ARDATATRANSFER_MEDIA_NAME_SIZE);
-                                        media->name[ARDATATRANSFER_MEDIA_NAME_SIZE - 1] = '\0';
-
-                                        strncpy(media->filePath, manager->mediasDownloader->localDirectory, ARDATATRANSFER_MEDIA_PATH_SIZE);
-                                        media->filePath[ARDATATRANSFER_MEDIA_PATH_SIZE - 1] = '\0';
-                                        strncat(media->filePath, fileName, ARDATATRANSFER_MEDIA_PATH_SIZE - strlen(media->filePath) - 1);
-
-                                        strncpy(media->date, "", ARDATATRANSFER_MEDIA_DATE_SIZE);
-                                        media->date[ARDATATRANSFER_MEDIA_DATE_SIZE - 1] = '\0';
-
-                                        strncpy(media->uuid, "", ARDATATRANSFER_MEDIA_UUID_SIZE);
-                                        media->uuid[ARDATATRANSFER_MEDIA_UUID_SIZE - 1] = '\0';
-                                        //Jumping_Sumo_1970-01-01T000317+0000_3902B87F947BE865A9D137CFA63492B8.mp4
-
-                                        index = media->name;
-                                        while ((index = strstr(index, "_")) != NULL)
-                                        {
-                                            begin = tag;
-                                            tag = ++index;
-                                        }
-
-                                        if ((begin != NULL) && (tag != NULL))
-                                        {
-                                            end = strstr(begin, ".");
-                                        }
-
-                                        if ((begin != NULL)  && (tag != NULL) && (end != NULL))
-                                        {
-                                            long len = tag - begin - 1;
-                                            len = (len < ARDATATRANSFER_MEDIA_DATE_SIZE) ? len : (ARDATATRANSFER_MEDIA_DATE_SIZE - 1);
-                                            strncpy(media->date, begin, len);
-                                            media->date[len] = '\0';
-
-                                            len = end - tag;
-                                            len = (len < ARDATATRANSFER_MEDIA_UUID_SIZE) ? len : (ARDATATRANSFER_MEDIA_UUID_SIZE - 1);
-                                            strncpy(media->uuid, tag, len);
-                                            media->uuid[len] = '\0';
-                                        }
-
-                                        media->size = fileSize;
-
-                                        // Remote path is the full path to the file on the FTP
-                                        strncpy(media->remotePath, manager->mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
-                                        media->remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-                                        strncat(media->remotePath, "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
-                                        strncat(media->remotePath, productPathName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
-                                        strncat(media->remotePath, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_MEDIA "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
-                                        strncat(media->remotePath, fileName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
-
-                                        // Remote thumb is the full path of the thumbnail on the FTP
-                                        strncpy(media->remoteThumb, manager->mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
-                                        media->remoteThumb[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-                                        strncat(media->remoteThumb, "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) -1);
-                                        strncat(media->remoteThumb, productPathName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) -1);
-                                        strncat(media->remoteThumb, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_THUMB "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) -1);
-                                        strncat(media->remoteThumb, fileName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) - 1);
-                                        // Append ".jpg" to remote thumb is fileName does not already end whith .jpg
-                                        if (fileName[strlen(fileName) - 4] != '.' ||
-                                            fileName[strlen(fileName) - 3] != 'j' ||
-                                            fileName[strlen(fileName) - 2] != 'p' ||
-                                            fileName[strlen(fileName) - 1] != 'g')
-                                        {
-                                            strncat(media->remoteThumb, "." ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_JPG, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) - 1);
-                                        }
-
-                                        if (withThumbnail == 1)
-                                        {
-                                            ARDATATRANSFER_MediasDownloader_GetThumbnail(manager, media);
-                                        }
-                                    }
-                                }
-
-                                if (result == ARDATATRANSFER_OK)
-                                {
-                                    oldMedias = manager->mediasDownloader->medias.medias;
-                                    manager->mediasDownloader->medias.medias = (ARDATATRANSFER_Media_t **)realloc(manager->mediasDownloader->medias.medias, (manager->mediasDownloader->medias.count + 1) * sizeof(ARDATATRANSFER_Media_t *));
-
-                                    if (manager->mediasDownloader->medias.medias == NULL)
-                                    {
-                                        manager->mediasDownloader->medias.medias = oldMedias;
-                                        result = ARDATATRANSFER_ERROR_ALLOC;
-                                        free(media);
-                                    }
-                                    else
-                                    {
-                                        manager->mediasDownloader->medias.medias[manager->mediasDownloader->medias.count] = media;
-                                        manager->mediasDownloader->medias.count++;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    else
-                    {
-                        ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "List of %s failed with error  = %i",
-                            remoteProduct, resultUtils);
-                        // only set the error if the product has no DCIM folder
-                        // if it has a DCIM folder, we assume that the pictures are in it.
-                        if (!hasDCIM)
-                        {
-                            result = ARDATATRANSFER_ERROR_FTP;
-                        }
-                    }
-
-                    if (mediaFtpList != NULL)
-                    {
-                        free(mediaFtpList);
-                        mediaFtpList = NULL;
-                        mediaFtpListLen = 0;
-                    }
-                }
-            }
-            product++;
+            result = ARDATATRANSFER_MediasDownloader_ParseProducts(&listing);
         }
 
         if (productFtpList != NULL)
@@ -768,16 +452,46 @@ int ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(ARDATATRANSFER_Manage
             free(productFtpList);
         }
 
+        if (listing.isListing == 1)
+        {
+            ARDATATRANSFER_MediasDownloader_StopListing(&manager->mediasDownloader->listPool);
+        }
+
+        for (i = 0; i < listing.listsCount; i++)
+        {
+            free(listing.lists[i].list);
+        }
+        free(listing.lists);
+
         if (result == ARDATATRANSFER_OK)
         {
-            count = manager->mediasDownloader->medias.count;
+            count = medias.count;
+
+            // The persistence only changes under listLock
+            if ((manager->mediasDownloader->isCatalogPersistent == 1)
+                && (ARDATATRANSFER_MediasCatalog_Save(manager->mediasDownloader->localDirectory, manager->mediasDownloader->remoteDirectory, &medias) != ARDATATRANSFER_OK))
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "catalog not saved");
+            }
         }
-        else
+
+        ARDATATRANSFER_MediasDownloader_PublishListing(&listing, (result == ARDATATRANSFER_OK) ? 1 : 0);
+
+        if (result == ARDATATRANSFER_OK)
         {
-            ARDATATRANSFER_MediasDownloader_FreeMediaList(&manager->mediasDownloader->medias);
+            ARDATATRANSFER_MediasDownloader_CacheCatalog(manager, withThumbnail, &listing.filter, ((listing.hasDCIM == 1) && (listing.listsCount == listing.dcimCount)) ? 1 : 0, listing.dcimHash, listing.dcimLen, listing.dcimMinute);
         }
 
-        ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
+        ARDATATRANSFER_MediasIndex_Delete(&listing.thumbIndex);
+        free(listing.thumbNames);
+        ARDATATRANSFER_MediasIndex_Delete(&listing.dcimIndex);
+        free(listing.dcimNames);
+        ARDATATRANSFER_MediasIndex_Delete(&listing.sectionIndex);
+        free(listing.recursiveList);
+        ARDATATRANSFER_MediasIndex_Delete(&listing.previousIndex);
+
+    end_list_medias:
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->listLock);
     }
 
     *error = result;
@@ -785,11 +499,18 @@ int ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(ARDATATRANSFER_Manage
 }
 
 eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsync(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t availableMediaCallback, void *availableMediaArg)
+{
+    return ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsyncWithOrder(manager, availableMediaCallback, availableMediaArg, 1);
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsyncWithOrder(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t availableMediaCallback, void *availableMediaArg, int isOrdered)
 {
     ARDATATRANSFER_Media_t *media;
-    ARDATATRANSFER_Media_t tmpMedia;
+    ARDATATRANSFER_MediasDownloader_List_t *lists = NULL;
+    int indexes[ARDATATRANSFER_MEDIAS_DOWNLOADER_THUMBNAILS_BATCH];
+    double mediaSizes[ARDATATRANSFER_MEDIAS_DOWNLOADER_THUMBNAILS_BATCH];
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
-    eARUTILS_ERROR resultUtils = ARUTILS_OK;
+    int batchCount;
     int i;
 
     if ((manager == NULL) || (availableMediaCallback == NULL))
@@ -812,58 +533,59 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsync(AR
 
     if (result == ARDATATRANSFER_OK)
     {
-        for (i=manager->mediasDownloader->medias.count-1; (resultUtils == ARUTILS_OK) && (i>=0); i--)
+        lists = (ARDATATRANSFER_MediasDownloader_List_t *)malloc(ARDATATRANSFER_MEDIAS_DOWNLOADER_THUMBNAILS_BATCH * sizeof(ARDATATRANSFER_MediasDownloader_List_t));
+
+        if (lists == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_ALLOC;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
+        i = manager->mediasDownloader->medias.count - 1;
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
+
+        // The fetches are batched to bound their memory, the connections stay busy within a batch
+        while ((result == ARDATATRANSFER_OK) && (i >= 0))
         {
-            eARDATATRANSFER_ERROR resultThumbnail;
-            resultUtils = ARUTILS_Manager_Ftp_Connection_IsCanceled(manager->mediasDownloader->ftpListManager);
+            batchCount = 0;
 
-            if (resultUtils != ARUTILS_OK)
-            {
-                result = ARDATATRANSFER_ERROR_CANCELED;
-            }
-            else
-            {
-                ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
+            // The listing connections are shared with the medias listing, a listing runs between two batches
+            ARSAL_Mutex_Lock(&manager->mediasDownloader->listLock);
+            ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
 
+            i = (i < manager->mediasDownloader->medias.count) ? i : (manager->mediasDownloader->medias.count - 1);
+            while ((i >= 0) && (batchCount < ARDATATRANSFER_MEDIAS_DOWNLOADER_THUMBNAILS_BATCH))
+            {
                 media = manager->mediasDownloader->medias.medias[i];
-                if (media != NULL)
-                {
-                    memcpy(&tmpMedia, media, sizeof(ARDATATRANSFER_Media_t));
-                }
-                else
+                if ((media != NULL) && (media->thumbnail == NULL))
                 {
-                    memset(&tmpMedia, 0, sizeof(ARDATATRANSFER_Media_t));
+                    memset(&lists[batchCount], 0, sizeof(ARDATATRANSFER_MediasDownloader_List_t));
+                    strncpy(lists[batchCount].remotePath, media->remoteThumb, ARUTILS_FTP_MAX_PATH_SIZE);
+                    lists[batchCount].remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+                    lists[batchCount].isFile = 1;
+                    indexes[batchCount] = i;
+                    mediaSizes[batchCount] = media->size;
+                    batchCount++;
                 }
+                i--;
+            }
 
-                ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
+            ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
 
-                if ((media != NULL) && (tmpMedia.thumbnail == NULL))
-                {
-                    resultThumbnail = ARDATATRANSFER_MediasDownloader_GetThumbnail(manager, &tmpMedia);
-                    if ((resultThumbnail == ARDATATRANSFER_OK) && (tmpMedia.thumbnail != NULL))
-                    {
-                        ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
-
-                        media = manager->mediasDownloader->medias.medias[i];
-                        if (media != NULL)
-                        {
-                            media->thumbnail = tmpMedia.thumbnail;
-                            media->thumbnailSize = tmpMedia.thumbnailSize;
-                        }
-                        else
-                        {
-                            free(tmpMedia.thumbnail);
-                            tmpMedia.thumbnail = NULL;
-                        }
-
-                        ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
-                        availableMediaCallback(availableMediaArg, &tmpMedia, i);
-                    }
-                }
+            if (batchCount > 0)
+            {
+                result = ARDATATRANSFER_MediasDownloader_FetchThumbnails(manager, lists, indexes, mediaSizes, batchCount, isOrdered, availableMediaCallback, availableMediaArg);
             }
+
+            ARSAL_Mutex_Unlock(&manager->mediasDownloader->listLock);
         }
     }
 
+    free(lists);
+
     return result;
 }
 
@@ -902,206 +624,288 @@ ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtInde
     return media;
 }
 
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_DeleteMedia(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media, ARDATATRANSFER_MediasDownloader_DeleteMediaCallback_t deleteMediaCallBack, void *deleteMediaArg)
+ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_GetAvailableMediaByUuid(ARDATATRANSFER_Manager_t *manager, const char *uuid, eARDATATRANSFER_ERROR *error)
+{
+    return ARDATATRANSFER_MediasDownloader_GetAvailableMediaByKey(manager, ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_UUID, uuid, error);
+}
+
+ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_GetAvailableMediaByName(ARDATATRANSFER_Manager_t *manager, const char *name, eARDATATRANSFER_ERROR *error)
+{
+    return ARDATATRANSFER_MediasDownloader_GetAvailableMediaByKey(manager, ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_NAME, name, error);
+}
+
+ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_GetAvailableMediaByFilePath(ARDATATRANSFER_Manager_t *manager, const char *filePath, eARDATATRANSFER_ERROR *error)
+{
+    return ARDATATRANSFER_MediasDownloader_GetAvailableMediaByKey(manager, ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_FILE_PATH, filePath, error);
+}
+
+int ARDATATRANSFER_MediasDownloader_GetAvailableMediasPage(ARDATATRANSFER_Manager_t *manager, int offset, int count, eARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER order, ARDATATRANSFER_Media_t **medias, eARDATATRANSFER_ERROR *error)
 {
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
-    eARUTILS_ERROR resultUtils = ARUTILS_OK;
+    eARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW view = ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_LISTING;
+    ARDATATRANSFER_MediaList_t *mediaList;
+    int isReversed = 0;
+    int pageCount = 0;
+    int position;
+    int i;
 
-    if ((manager == NULL) || (media == NULL))
+    if ((manager == NULL) || (offset < 0) || (count < 0) || ((medias == NULL) && (count > 0)))
     {
         result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
 
-    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    if ((result == ARDATATRANSFER_OK) && (manager->mediasDownloader == NULL))
     {
         result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
     }
 
     if (result == ARDATATRANSFER_OK)
     {
-        resultUtils = ARUTILS_Manager_Ftp_Delete(manager->mediasDownloader->ftpQueueManager, media->remotePath);
-
-        if (resultUtils != ARUTILS_OK)
+        switch (order)
         {
-            result = ARDATATRANSFER_ERROR_FTP;
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_LISTING:
+            view = ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_LISTING;
+            break;
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_NEWEST_FIRST:
+            view = ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_DATE;
+            isReversed = 1;
+            break;
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_OLDEST_FIRST:
+            view = ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_DATE;
+            break;
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_SMALLEST_FIRST:
+            view = ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_SIZE;
+            break;
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_LARGEST_FIRST:
+            view = ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_SIZE;
+            isReversed = 1;
+            break;
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_PRODUCT:
+            view = ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_PRODUCT;
+            break;
+        default:
+            result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+            break;
         }
+    }
 
-        ARUTILS_Manager_Ftp_Delete(manager->mediasDownloader->ftpQueueManager, media->remoteThumb);
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
 
-        if (deleteMediaCallBack != NULL)
+        mediaList = &manager->mediasDownloader->medias;
+
+        if (mediaList->views[view] == NULL)
         {
-            deleteMediaCallBack(deleteMediaArg, media, result);
+            result = ARDATATRANSFER_MediasDownloader_BuildView(mediaList, view);
         }
 
-        if (result == ARDATATRANSFER_OK)
+        for (i=offset; (result == ARDATATRANSFER_OK) && (i < mediaList->viewsCount[view]) && (pageCount < count); i++)
         {
-            result = ARDATATRANSFER_MediasDownloader_RemoveMediaFromMediaList(manager, media);
+            position = (isReversed == 1) ? mediaList->views[view][mediaList->viewsCount[view] - 1 - i] : mediaList->views[view][i];
+            medias[pageCount++] = mediaList->medias[position];
         }
+
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
     }
 
-    return result;
+    *error = result;
+    return pageCount;
 }
 
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddMediaToQueue(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media,  ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback, void *progressArg, ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback, void *completionArg)
+int64_t ARDATATRANSFER_MediasDownloader_GetMediaTimestamp(const ARDATATRANSFER_Media_t *media)
 {
-    ARDATATRANSFER_FtpMedia_t *newFtpMedia = NULL;
-    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int64_t timestamp = INT64_MIN;
 
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+    if (media != NULL)
+    {
+        timestamp = ARDATATRANSFER_MediasDate_Parse(media->date);
+    }
 
-    if ((manager == NULL) || (media == NULL))
+    return timestamp;
+}
+
+int ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(ARDATATRANSFER_Manager_t *manager, eARDATATRANSFER_ERROR *error)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int count = 0;
+
+    if (manager == NULL)
     {
         result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
 
-    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    if ((result == ARDATATRANSFER_OK) && (manager->mediasDownloader == NULL))
     {
         result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
     }
 
     if (result == ARDATATRANSFER_OK)
     {
-        newFtpMedia = calloc(1, sizeof(ARDATATRANSFER_FtpMedia_t));
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
+        count = manager->mediasDownloader->medias.count;
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
+    }
 
-        if (newFtpMedia == NULL)
-        {
-            result = ARDATATRANSFER_ERROR_ALLOC;
-        }
-        else
-        {
-            strncpy(newFtpMedia->media.name, media->name, ARDATATRANSFER_MEDIA_NAME_SIZE);
-            newFtpMedia->media.name[ARDATATRANSFER_MEDIA_NAME_SIZE - 1] = '\0';
-            strncpy(newFtpMedia->media.filePath, media->filePath, ARDATATRANSFER_MEDIA_PATH_SIZE);
-            newFtpMedia->media.filePath[ARDATATRANSFER_MEDIA_PATH_SIZE - 1] = '\0';
-            strncpy(newFtpMedia->media.date, media->date, ARDATATRANSFER_MEDIA_DATE_SIZE);
-            newFtpMedia->media.date[ARDATATRANSFER_MEDIA_DATE_SIZE - 1] = '\0';
-            strncpy(newFtpMedia->media.uuid, media->uuid, ARDATATRANSFER_MEDIA_UUID_SIZE);
-            newFtpMedia->media.uuid[ARDATATRANSFER_MEDIA_UUID_SIZE - 1] = '\0';
-            strncpy(newFtpMedia->media.remotePath, media->remotePath, ARUTILS_FTP_MAX_PATH_SIZE);
-            newFtpMedia->media.remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-            strncpy(newFtpMedia->media.remoteThumb, media->remoteThumb, ARUTILS_FTP_MAX_PATH_SIZE);
-            newFtpMedia->media.remoteThumb[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-            newFtpMedia->media.size = media->size;
-            newFtpMedia->media.product = media->product;
+    *error = result;
+    return count;
+}
 
-            newFtpMedia->progressCallback = progressCallback;
-            newFtpMedia->progressArg = progressArg;
-            newFtpMedia->completionCallback = completionCallback;
-            newFtpMedia->completionArg = completionArg;
-        }
-    }
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetCatalogPersistent(ARDATATRANSFER_Manager_t *manager, int isPersistent)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
 
-    if (result == ARDATATRANSFER_OK)
-    {
-        result = ARDATATRANSFER_MediasQueue_Add(&manager->mediasDownloader->queue, newFtpMedia);
-    }
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%d", isPersistent);
 
-    if (result == ARDATATRANSFER_OK)
+    if (manager == NULL)
     {
-        ARSAL_Sem_Post(&manager->mediasDownloader->queueSem);
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
 
-    if (result != ARDATATRANSFER_OK)
+    if ((result == ARDATATRANSFER_OK) && (manager->mediasDownloader == NULL))
     {
-        free(newFtpMedia);
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        // Waits for a running listing, its catalog is saved or removed as a whole
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->listLock);
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
+
+        manager->mediasDownloader->isCatalogPersistent = (isPersistent != 0) ? 1 : 0;
+
+        if (manager->mediasDownloader->isCatalogPersistent == 0)
+        {
+            ARDATATRANSFER_MediasCatalog_Remove(manager->mediasDownloader->localDirectory);
+        }
+        else if ((manager->mediasDownloader->medias.count == 0) && (manager->mediasDownloader->medias.directoriesCount == 0))
+        {
+            // Before the first listing, the catalog persisted by a previous run answers until the medias are listed
+            if (ARDATATRANSFER_MediasCatalog_Load(manager->mediasDownloader->localDirectory, manager->mediasDownloader->remoteDirectory, &manager->mediasDownloader->medias) != ARDATATRANSFER_OK)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "no catalog loaded");
+            }
+        }
+        else if (manager->mediasDownloader->medias.mapping == NULL)
+        {
+            // The medias already listed are written at once, a mapped list is the catalog itself
+            result = ARDATATRANSFER_MediasCatalog_Save(manager->mediasDownloader->localDirectory, manager->mediasDownloader->remoteDirectory, &manager->mediasDownloader->medias);
+        }
+
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->listLock);
     }
 
     return result;
 }
 
-void* ARDATATRANSFER_MediasDownloader_QueueThreadRun(void *managerArg)
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetCatalogTtl(ARDATATRANSFER_Manager_t *manager, int ttlMs, int isProbed)
 {
-    ARDATATRANSFER_Manager_t *manager = (ARDATATRANSFER_Manager_t *)managerArg;
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
 
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%d %d", ttlMs, isProbed);
 
-    if (manager == NULL)
+    if ((manager == NULL) || (ttlMs < 0))
     {
         result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
 
-    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    if ((result == ARDATATRANSFER_OK) && (manager->mediasDownloader == NULL))
     {
         result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
     }
 
-    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader->isCanceled != 0))
+    if (result == ARDATATRANSFER_OK)
     {
-        result = ARDATATRANSFER_ERROR_CANCELED;
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->listLock);
+        manager->mediasDownloader->catalogCache.ttlMs = ttlMs;
+        manager->mediasDownloader->catalogCache.isProbed = (isProbed != 0) ? 1 : 0;
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->listLock);
     }
 
-    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader->isRunning != 0))
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetThumbnailsCacheSize(ARDATATRANSFER_Manager_t *manager, uint64_t maxSize)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%" PRIu64, maxSize);
+
+    if (manager == NULL)
     {
-        result = ARDATATRANSFER_ERROR_THREAD_ALREADY_RUNNING;
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
 
-    if (result == ARDATATRANSFER_OK)
+    if ((result == ARDATATRANSFER_OK) && (manager->mediasDownloader == NULL))
     {
-        manager->mediasDownloader->isRunning = 1;
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
     }
 
     if (result == ARDATATRANSFER_OK)
     {
-        eARDATATRANSFER_ERROR error = ARDATATRANSFER_OK;
-        ARDATATRANSFER_FtpMedia_t *ftpMedia = NULL;
-        int resultSys;
+        result = ARDATATRANSFER_MediasThumbnails_Open(&manager->mediasDownloader->thumbnails, manager->mediasDownloader->localDirectory, maxSize);
+    }
 
-        do
-        {
-            resultSys = ARSAL_Sem_Wait(&manager->mediasDownloader->queueSem);
+    return result;
+}
 
-            if (resultSys != 0)
-            {
-                result = ARDATATRANSFER_ERROR_SYSTEM;
-            }
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_DeleteMedia(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media, ARDATATRANSFER_MediasDownloader_DeleteMediaCallback_t deleteMediaCallBack, void *deleteMediaArg)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    eARUTILS_ERROR resultUtils = ARUTILS_OK;
 
-            if (result == ARDATATRANSFER_OK)
-            {
-                ftpMedia = ARDATATRANSFER_MediasQueue_Pop(&manager->mediasDownloader->queue, &error);
-            }
+    if ((manager == NULL) || (media == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
 
-            if ((result == ARDATATRANSFER_OK)
-                && (error == ARDATATRANSFER_OK)
-                && (ftpMedia != NULL)
-                && (manager->mediasDownloader->isCanceled == 0))
-            {
-                error = ARDATATRANSFER_MediasDownloader_DownloadMedia(manager, ftpMedia);
-            }
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
 
-            if (ftpMedia != NULL)
-            {
-                if ((ftpMedia->completionCallback != NULL) && (manager->mediasDownloader->isCanceled == 0))
-                {
-                    ftpMedia->completionCallback(ftpMedia->completionArg, &ftpMedia->media, error);
-                }
+    if (result == ARDATATRANSFER_OK)
+    {
+        resultUtils = ARUTILS_Manager_Ftp_Delete(manager->mediasDownloader->ftpQueueManager, media->remotePath);
 
-                free(ftpMedia);
-                ftpMedia = NULL;
-            }
+        if (resultUtils != ARUTILS_OK)
+        {
+            result = ARDATATRANSFER_ERROR_FTP;
         }
-        while (manager->mediasDownloader->isCanceled == 0);
-    }
 
-    if (manager != NULL && manager->mediasDownloader != NULL)
-    {
-        manager->mediasDownloader->isRunning = 0;
+        ARUTILS_Manager_Ftp_Delete(manager->mediasDownloader->ftpQueueManager, media->remoteThumb);
+        ARDATATRANSFER_MediasThumbnails_Remove(&manager->mediasDownloader->thumbnails, media->remoteThumb, media->size);
+
+        if (deleteMediaCallBack != NULL)
+        {
+            deleteMediaCallBack(deleteMediaArg, media, result);
+        }
 
-        ARDATATRANSFER_MediasDownloader_ResetQueueThread(manager);
+        if (result == ARDATATRANSFER_OK)
+        {
+            result = ARDATATRANSFER_MediasDownloader_RemoveMediaFromMediaList(manager, media);
+        }
     }
 
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "exit");
+    return result;
+}
 
-    return NULL;
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddMediaToQueue(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media,  ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback, void *progressArg, ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback, void *completionArg)
+{
+    return ARDATATRANSFER_MediasDownloader_AddMediaToQueueWithPriority(manager, media, ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_NORMAL, progressCallback, progressArg, completionCallback, completionArg);
 }
 
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ResetQueueThread(ARDATATRANSFER_Manager_t *manager)
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddMediaToQueueWithPriority(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority, ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback, void *progressArg, ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback, void *completionArg)
 {
+    ARDATATRANSFER_FtpMedia_t *newFtpMedia = NULL;
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int isAttached = 0;
 
     ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
 
-    if (manager == NULL)
+    if ((manager == NULL) || (media == NULL) || (priority < 0) || (priority >= ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_MAX))
     {
         result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
@@ -1113,92 +917,135 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ResetQueueThread(ARDATATRA
 
     if (result == ARDATATRANSFER_OK)
     {
-        manager->mediasDownloader->isCanceled = 0;
+        newFtpMedia = ARDATATRANSFER_MediasQueue_NewMedia(media);
+
+        if (newFtpMedia == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_ALLOC;
+        }
+        else
+        {
+            ARDATATRANSFER_MediasDownloader_InitFtpMedia(newFtpMedia, priority, progressCallback, progressArg, completionCallback, completionArg);
+        }
     }
 
     if (result == ARDATATRANSFER_OK)
     {
-        while (ARSAL_Sem_Trywait(&manager->mediasDownloader->threadSem) == 0)
-        {
-            /* Do nothing*/
-        }
+        // Journal before queueing, a worker may complete the media as soon as it is queued
+        ARDATATRANSFER_MediasJournal_Append(&manager->mediasDownloader->journal, &newFtpMedia, 1);
 
-        while (ARSAL_Sem_Trywait(&manager->mediasDownloader->queueSem) == 0)
+        result = ARDATATRANSFER_MediasQueue_Add(&manager->mediasDownloader->queue, newFtpMedia, &isAttached);
+
+        // The done record would also close a pending entry already queued for this path
+        if ((result != ARDATATRANSFER_OK)
+            && (ARDATATRANSFER_MediasQueue_Contains(&manager->mediasDownloader->queue, newFtpMedia->remotePath) == 0))
         {
-            /* Do nothing*/
+            ARDATATRANSFER_MediasJournal_AppendDone(&manager->mediasDownloader->journal, newFtpMedia->remotePath);
         }
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (isAttached == 0))
+    {
+        ARSAL_Sem_Post(&manager->mediasDownloader->queueSem);
+    }
 
-        ARUTILS_Manager_Ftp_Connection_Reset(manager->mediasDownloader->ftpQueueManager);
+    if (result != ARDATATRANSFER_OK)
+    {
+        free(newFtpMedia);
     }
 
     return result;
 }
 
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_CancelQueueThread(ARDATATRANSFER_Manager_t *manager)
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddMediasToQueue(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t **medias, int count, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority, ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback, void *progressArg, ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback, void *completionArg)
 {
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
-    eARUTILS_ERROR resultUtils = ARUTILS_OK;
-    int resultSys = 0;
+    ARDATATRANSFER_FtpMediaBlock_t *block = NULL;
+    ARDATATRANSFER_FtpMedia_t **ftpMedias = NULL;
+    int queuedCount = 0;
+    int i;
 
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%d", count);
 
-    if (manager == NULL)
+    if ((manager == NULL) || (medias == NULL) || (count <= 0) || (priority < 0) || (priority >= ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_MAX))
     {
         result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
 
-    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    for (i=0; (result == ARDATATRANSFER_OK) && (i < count); i++)
     {
-        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+        if (medias[i] == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+        }
     }
 
-    if (result == ARDATATRANSFER_OK)
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
     {
-        manager->mediasDownloader->isCanceled = 1;
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
     }
 
     if (result == ARDATATRANSFER_OK)
     {
-        result = ARDATATRANSFER_MediasQueue_RemoveAll(&manager->mediasDownloader->queue);
-    }
+        ftpMedias = (ARDATATRANSFER_FtpMedia_t **)malloc(count * sizeof(ARDATATRANSFER_FtpMedia_t *));
 
-    if (result == ARDATATRANSFER_OK)
-    {
-        resultSys = ARSAL_Sem_Post(&manager->mediasDownloader->threadSem);
+        if (ftpMedias != NULL)
+        {
+            block = ARDATATRANSFER_MediasQueue_NewBlock(medias, count, ftpMedias);
+        }
 
-        if (resultSys != 0)
+        if ((block == NULL) || (ftpMedias == NULL))
         {
-            result = ARDATATRANSFER_ERROR_SYSTEM;
+            result = ARDATATRANSFER_ERROR_ALLOC;
         }
     }
 
     if (result == ARDATATRANSFER_OK)
     {
-        resultSys = ARSAL_Sem_Post(&manager->mediasDownloader->queueSem);
+        for (i=0; i<count; i++)
+        {
+            ARDATATRANSFER_MediasDownloader_InitFtpMedia(ftpMedias[i], priority, progressCallback, progressArg, completionCallback, completionArg);
+        }
 
-        if (resultSys != 0)
+        // Journal before queueing, a worker may complete a media as soon as it is queued
+        ARDATATRANSFER_MediasJournal_Append(&manager->mediasDownloader->journal, ftpMedias, count);
+
+        result = ARDATATRANSFER_MediasQueue_AddBatch(&manager->mediasDownloader->queue, ftpMedias, count, &queuedCount);
+
+        // A refused batch queued none of its medias, the entries already queued keep their pending record
+        for (i=0; (result != ARDATATRANSFER_OK) && (i < count); i++)
         {
-            result = ARDATATRANSFER_ERROR_SYSTEM;
+            if (ARDATATRANSFER_MediasQueue_Contains(&manager->mediasDownloader->queue, ftpMedias[i]->remotePath) == 0)
+            {
+                ARDATATRANSFER_MediasJournal_AppendDone(&manager->mediasDownloader->journal, ftpMedias[i]->remotePath);
+            }
         }
     }
 
-    if (result == ARDATATRANSFER_OK)
+    for (i=0; (result == ARDATATRANSFER_OK) && (i < queuedCount); i++)
     {
-        resultUtils = ARUTILS_Manager_Ftp_Connection_Cancel(manager->mediasDownloader->ftpQueueManager);
+        ARSAL_Sem_Post(&manager->mediasDownloader->queueSem);
+    }
 
-        if (resultUtils != ARUTILS_OK)
-        {
-            result = ARDATATRANSFER_ERROR_FTP;
-        }
+    if ((result != ARDATATRANSFER_OK) && (block != NULL))
+    {
+        ARSAL_Mutex_Destroy(&block->lock);
+        free(block);
     }
 
+    free(ftpMedias);
+
     return result;
 }
 
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias(ARDATATRANSFER_Manager_t *manager)
+int ARDATATRANSFER_MediasDownloader_RestoreQueue(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback, void *progressArg, ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback, void *completionArg, eARDATATRANSFER_ERROR *error)
 {
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
-    eARUTILS_ERROR resultUtils = ARUTILS_OK;
+    ARDATATRANSFER_FtpMedia_t **ftpMedias = NULL;
+    int queuedCount = 0;
+    int count = 0;
+    int restored = 0;
+    int i;
 
     ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
 
@@ -1214,24 +1061,57 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias(AR
 
     if (result == ARDATATRANSFER_OK)
     {
-        resultUtils = ARUTILS_Manager_Ftp_Connection_Reset(manager->mediasDownloader->ftpListManager);
-        if (resultUtils != ARUTILS_OK)
+        count = ARDATATRANSFER_MediasJournal_Restore(&manager->mediasDownloader->journal, manager->mediasDownloader->localDirectory, &ftpMedias, &result);
+    }
+
+    // The restored medias are already in the compacted journal
+    for (i=0; i<count; i++)
+    {
+        ftpMedias[i]->progressCallback = progressCallback;
+        ftpMedias[i]->progressArg = progressArg;
+        ftpMedias[i]->completionCallback = completionCallback;
+        ftpMedias[i]->completionArg = completionArg;
+    }
+
+    if (count > 0)
+    {
+        if (ARDATATRANSFER_MediasQueue_AddBatch(&manager->mediasDownloader->queue, ftpMedias, count, &queuedCount) == ARDATATRANSFER_OK)
         {
-            result = ARDATATRANSFER_ERROR_FTP;
+            restored = count;
+        }
+        else
+        {
+            for (i=0; i<count; i++)
+            {
+                free(ftpMedias[i]);
+            }
         }
     }
 
-    return result;
+    for (i=0; i<queuedCount; i++)
+    {
+        ARSAL_Sem_Post(&manager->mediasDownloader->queueSem);
+    }
+
+    free(ftpMedias);
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "restored %d medias", restored);
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+
+    return restored;
 }
 
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_CancelGetAvailableMedias(ARDATATRANSFER_Manager_t *manager)
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetQueuePolicy(ARDATATRANSFER_Manager_t *manager, eARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY policy)
 {
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
-    eARUTILS_ERROR resultUtils = ARUTILS_OK;
 
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%d", policy);
 
-    if (manager == NULL)
+    if ((manager == NULL) || (policy < 0) || (policy >= ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_MAX))
     {
         result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
@@ -1243,202 +1123,2902 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_CancelGetAvailableMedias(A
 
     if (result == ARDATATRANSFER_OK)
     {
-        resultUtils = ARUTILS_Manager_Ftp_Connection_Cancel(manager->mediasDownloader->ftpListManager);
-        if (resultUtils != ARUTILS_OK)
-        {
-            result = ARDATATRANSFER_ERROR_FTP;
-        }
+        result = ARDATATRANSFER_MediasQueue_SetPolicy(&manager->mediasDownloader->queue, policy);
     }
 
     return result;
 }
 
-/*****************************************
- *
- *             Private implementation:
- *
- *****************************************/
-
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_Initialize(ARDATATRANSFER_Manager_t *manager, ARUTILS_Manager_t *ftpListManager, ARUTILS_Manager_t *ftpQueueManager, const char *remoteDirectory, const char *localDirectory)
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_GetQueueStats(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_QueueStats_t *stats)
 {
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
-    //eARUTILS_ERROR error = ARUTILS_OK;
-    int resultSys = 0;
+    struct timespec now;
+    double remainingBytes;
 
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s, %s", localDirectory ? localDirectory : "null", remoteDirectory ? remoteDirectory : "null");
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
 
-    if ((manager == NULL) || (ftpListManager == NULL) || (ftpQueueManager == NULL) || (localDirectory == NULL))
+    if ((manager == NULL) || (stats == NULL))
     {
         result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
 
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
     if (result == ARDATATRANSFER_OK)
     {
-        strncpy(manager->mediasDownloader->remoteDirectory, remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
-        manager->mediasDownloader->remoteDirectory[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-        strncpy(manager->mediasDownloader->localDirectory, localDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
-        manager->mediasDownloader->localDirectory[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-        strncat(manager->mediasDownloader->localDirectory, "/" , ARUTILS_FTP_MAX_PATH_SIZE - strlen(manager->mediasDownloader->localDirectory) - 1);
+        ARSAL_Time_GetTime(&now);
 
-        resultSys = mkdir(manager->mediasDownloader->localDirectory, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+        // Under the workers lock a media is either queued or in flight, never counted twice
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->workersLock);
+        result = ARDATATRANSFER_MediasQueue_GetStats(&manager->mediasDownloader->queue, &stats->queuedCount, &stats->queuedBytes);
 
-        if ((resultSys != 0) && (errno != EEXIST))
+        ARDATATRANSFER_MediasDownloader_UpdateRate(manager, &now);
+        stats->inFlightCount = manager->mediasDownloader->stats.inFlightCount;
+        stats->inFlightBytes = manager->mediasDownloader->stats.inFlightBytes;
+        stats->downloadedBytes = manager->mediasDownloader->stats.downloadedBytes;
+        stats->bytesPerSecond = manager->mediasDownloader->stats.bytesPerSecond;
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->workersLock);
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        remainingBytes = stats->queuedBytes + stats->inFlightBytes - stats->downloadedBytes;
+
+        if (remainingBytes <= 0.f)
         {
-            result = ARDATATRANSFER_ERROR_SYSTEM;
+            stats->estimatedTime = 0.f;
+        }
+        else if (stats->bytesPerSecond > 0.f)
+        {
+            stats->estimatedTime = remainingBytes / stats->bytesPerSecond;
+        }
+        else
+        {
+            stats->estimatedTime = -1.f;
         }
     }
 
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "return %d", result);
-
     return result;
 }
 
-void ARDATATRANSFER_MediasDownloader_Clear(ARDATATRANSFER_Manager_t *manager)
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetMediaPriority(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority)
 {
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if ((manager == NULL) || (media == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        result = ARDATATRANSFER_MediasQueue_SetPriority(&manager->mediasDownloader->queue, media->remotePath, priority);
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddQueueWorker(ARDATATRANSFER_Manager_t *manager, ARUTILS_Manager_t *ftpQueueManager)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if ((manager == NULL) || (ftpQueueManager == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->workersLock);
+
+        for (i=0; (result == ARDATATRANSFER_OK) && (i < manager->mediasDownloader->workersCount); i++)
+        {
+            if (manager->mediasDownloader->workers[i].ftpManager == ftpQueueManager)
+            {
+                result = ARDATATRANSFER_ERROR_ALREADY_INITIALIZED;
+            }
+        }
+
+        if ((result == ARDATATRANSFER_OK) && (manager->mediasDownloader->workersCount >= ARDATATRANSFER_MEDIAS_DOWNLOADER_MAX_QUEUE_WORKERS))
+        {
+            result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+        }
+
+        if (result == ARDATATRANSFER_OK)
+        {
+            manager->mediasDownloader->workers[manager->mediasDownloader->workersCount].ftpManager = ftpQueueManager;
+            manager->mediasDownloader->workers[manager->mediasDownloader->workersCount].isRunning = 0;
+            manager->mediasDownloader->workersCount++;
+        }
+
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->workersLock);
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddListWorker(ARDATATRANSFER_Manager_t *manager, ARUTILS_Manager_t *ftpListManager)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if ((manager == NULL) || (ftpListManager == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->listLock);
+
+        for (i=0; (result == ARDATATRANSFER_OK) && (i < manager->mediasDownloader->listManagersCount); i++)
+        {
+            if (manager->mediasDownloader->listManagers[i] == ftpListManager)
+            {
+                result = ARDATATRANSFER_ERROR_ALREADY_INITIALIZED;
+            }
+        }
+
+        if ((result == ARDATATRANSFER_OK) && (manager->mediasDownloader->listManagersCount >= ARDATATRANSFER_MEDIAS_DOWNLOADER_MAX_LIST_WORKERS))
+        {
+            result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+        }
+
+        // The worker of the connection lives until the downloader is deleted
+        if (result == ARDATATRANSFER_OK)
+        {
+            result = ARDATATRANSFER_MediasDownloader_AddListThread(&manager->mediasDownloader->listPool, ftpListManager);
+        }
+
+        if (result == ARDATATRANSFER_OK)
+        {
+            // The cancel and the reset read the connections without the lock, held by the listing, the count is published once the connection is set
+            manager->mediasDownloader->listManagers[manager->mediasDownloader->listManagersCount] = ftpListManager;
+            __atomic_store_n(&manager->mediasDownloader->listManagersCount, manager->mediasDownloader->listManagersCount + 1, __ATOMIC_RELEASE);
+        }
+
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->listLock);
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetRecursiveList(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_RecursiveListCallback_t recursiveListCallback, void *recursiveListArg)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if (manager == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        // Waits for a running listing, the support is detected again by the next one
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->listLock);
+        manager->mediasDownloader->recursiveListCallback = recursiveListCallback;
+        manager->mediasDownloader->recursiveListArg = recursiveListArg;
+        __atomic_store_n(&manager->mediasDownloader->recursiveListSupport, -1, __ATOMIC_RELAXED);
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->listLock);
+    }
+
+    return result;
+}
+
+void* ARDATATRANSFER_MediasDownloader_QueueThreadRun(void *managerArg)
+{
+    ARDATATRANSFER_Manager_t *manager = (ARDATATRANSFER_Manager_t *)managerArg;
+    ARDATATRANSFER_MediasDownloader_Worker_t *worker = NULL;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if (manager == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader->isCanceled != 0))
+    {
+        result = ARDATATRANSFER_ERROR_CANCELED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        worker = ARDATATRANSFER_MediasDownloader_AcquireWorker(manager);
+
+        if (worker == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_THREAD_ALREADY_RUNNING;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        eARDATATRANSFER_ERROR error = ARDATATRANSFER_OK;
+        ARDATATRANSFER_FtpMedia_t *ftpMedia = NULL;
+        int resultSys;
+
+        int isMediaCanceled;
+        int isDownloaded;
+
+        do
+        {
+            resultSys = ARSAL_Sem_Wait(&manager->mediasDownloader->queueSem);
+
+            if (resultSys != 0)
+            {
+                result = ARDATATRANSFER_ERROR_SYSTEM;
+            }
+
+            if (result == ARDATATRANSFER_OK)
+            {
+                // Pop under the workers lock so that a media is always either queued or owned by a worker
+                ARSAL_Mutex_Lock(&manager->mediasDownloader->workersLock);
+                ftpMedia = ARDATATRANSFER_MediasQueue_Pop(&manager->mediasDownloader->queue, &error);
+                worker->ftpMedia = ftpMedia;
+
+                if (ftpMedia != NULL)
+                {
+                    ARDATATRANSFER_MediasDownloader_StartStats(manager, worker);
+                }
+                ARSAL_Mutex_Unlock(&manager->mediasDownloader->workersLock);
+            }
+
+            if (ftpMedia != NULL)
+            {
+                ARDATATRANSFER_MediasQueue_GetMedia(ftpMedia, &worker->media);
+            }
+
+            isDownloaded = 0;
+
+            if ((result == ARDATATRANSFER_OK)
+                && (error == ARDATATRANSFER_OK)
+                && (ftpMedia != NULL)
+                && (manager->mediasDownloader->isCanceled == 0))
+            {
+                error = ARDATATRANSFER_MediasDownloader_DownloadMedia(manager, worker);
+                isDownloaded = 1;
+            }
+
+            ARSAL_Mutex_Lock(&manager->mediasDownloader->workersLock);
+            if (worker->ftpMedia != NULL)
+            {
+                ARDATATRANSFER_MediasDownloader_StopStats(manager, worker);
+            }
+            worker->ftpMedia = NULL;
+            isMediaCanceled = worker->isMediaCanceled;
+            worker->isMediaCanceled = 0;
+            ARSAL_Mutex_Unlock(&manager->mediasDownloader->workersLock);
+
+            if (isMediaCanceled != 0)
+            {
+                ARUTILS_Manager_Ftp_Connection_Reset(worker->ftpManager);
+
+                if (error != ARDATATRANSFER_OK)
+                {
+                    error = ARDATATRANSFER_ERROR_CANCELED;
+                }
+            }
+
+            if (ftpMedia != NULL)
+            {
+                ARDATATRANSFER_MediasQueue_Release(&manager->mediasDownloader->queue, ftpMedia);
+
+                // A failed, interrupted or never started download stays pending in the journal to be resumed
+                if (((isDownloaded != 0) && (error == ARDATATRANSFER_OK)) || (isMediaCanceled != 0))
+                {
+                    ARDATATRANSFER_MediasJournal_AppendDone(&manager->mediasDownloader->journal, ftpMedia->remotePath);
+                }
+
+                if (manager->mediasDownloader->isCanceled == 0)
+                {
+                    ARDATATRANSFER_MediasDownloader_NotifyCompletion(ftpMedia, &worker->media, error);
+                }
+
+                ARDATATRANSFER_MediasQueue_FreeMedia(ftpMedia);
+                ftpMedia = NULL;
+            }
+        }
+        while (manager->mediasDownloader->isCanceled == 0);
+    }
+
+    if (worker != NULL)
+    {
+        // The last running thread resets the canceled queue for the next run
+        if (ARDATATRANSFER_MediasDownloader_ReleaseWorker(manager, worker) == 0)
+        {
+            ARDATATRANSFER_MediasDownloader_ResetQueueThread(manager);
+        }
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "exit");
+
+    return NULL;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ResetQueueThread(ARDATATRANSFER_Manager_t *manager)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if (manager == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        manager->mediasDownloader->isCanceled = 0;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        while (ARSAL_Sem_Trywait(&manager->mediasDownloader->threadSem) == 0)
+        {
+            /* Do nothing*/
+        }
+
+        while (ARSAL_Sem_Trywait(&manager->mediasDownloader->queueSem) == 0)
+        {
+            /* Do nothing*/
+        }
+
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->workersLock);
+
+        for (i=0; i<manager->mediasDownloader->workersCount; i++)
+        {
+            ARUTILS_Manager_Ftp_Connection_Reset(manager->mediasDownloader->workers[i].ftpManager);
+        }
+
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->workersLock);
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_CancelMediaDownload(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    ARDATATRANSFER_Media_t canceledMedia;
+    eARUTILS_ERROR resultUtils = ARUTILS_OK;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia = NULL;
+    ARDATATRANSFER_MediasDownloader_Worker_t *worker = NULL;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if ((manager == NULL) || (media == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->workersLock);
+
+        ftpMedia = ARDATATRANSFER_MediasQueue_Remove(&manager->mediasDownloader->queue, media->remotePath, &result);
+
+        if ((result == ARDATATRANSFER_OK) && (ftpMedia == NULL))
+        {
+            for (i=0; (worker == NULL) && (i < manager->mediasDownloader->workersCount); i++)
+            {
+                if ((manager->mediasDownloader->workers[i].ftpMedia != NULL)
+                    && (strcmp(manager->mediasDownloader->workers[i].ftpMedia->remotePath, media->remotePath) == 0))
+                {
+                    worker = &manager->mediasDownloader->workers[i];
+                }
+            }
+
+            if (worker == NULL)
+            {
+                result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+            }
+            else if (worker->isMediaCanceled == 0)
+            {
+                // The worker resets its connection and calls the completion callback once the transfer is aborted
+                worker->isMediaCanceled = 1;
+                resultUtils = ARUTILS_Manager_Ftp_Connection_Cancel(worker->ftpManager);
+
+                if (resultUtils != ARUTILS_OK)
+                {
+                    result = ARDATATRANSFER_ERROR_FTP;
+                }
+            }
+        }
+
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->workersLock);
+    }
+
+    if (ftpMedia != NULL)
+    {
+        // The queue semaphore stays posted for this media, the queue thread will pop nothing for it
+        ARDATATRANSFER_MediasJournal_AppendDone(&manager->mediasDownloader->journal, ftpMedia->remotePath);
+        ARDATATRANSFER_MediasQueue_GetMedia(ftpMedia, &canceledMedia);
+        ARDATATRANSFER_MediasDownloader_NotifyCompletion(ftpMedia, &canceledMedia, ARDATATRANSFER_ERROR_CANCELED);
+        ARDATATRANSFER_MediasQueue_FreeMedia(ftpMedia);
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_CancelQueueThread(ARDATATRANSFER_Manager_t *manager)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    eARUTILS_ERROR resultUtils = ARUTILS_OK;
+    int resultSys = 0;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if (manager == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        manager->mediasDownloader->isCanceled = 1;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        result = ARDATATRANSFER_MediasQueue_RemoveAll(&manager->mediasDownloader->queue);
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        resultSys = ARSAL_Sem_Post(&manager->mediasDownloader->threadSem);
+
+        if (resultSys != 0)
+        {
+            result = ARDATATRANSFER_ERROR_SYSTEM;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->workersLock);
+
+        // Wake up every queue thread, then abort their transfers in progress
+        for (i=0; (result == ARDATATRANSFER_OK) && (i < manager->mediasDownloader->workersCount); i++)
+        {
+            resultSys = ARSAL_Sem_Post(&manager->mediasDownloader->queueSem);
+
+            if (resultSys != 0)
+            {
+                result = ARDATATRANSFER_ERROR_SYSTEM;
+            }
+        }
+
+        for (i=0; (result == ARDATATRANSFER_OK) && (i < manager->mediasDownloader->workersCount); i++)
+        {
+            resultUtils = ARUTILS_Manager_Ftp_Connection_Cancel(manager->mediasDownloader->workers[i].ftpManager);
+
+            if (resultUtils != ARUTILS_OK)
+            {
+                result = ARDATATRANSFER_ERROR_FTP;
+            }
+        }
+
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->workersLock);
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias(ARDATATRANSFER_Manager_t *manager)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    eARUTILS_ERROR resultUtils = ARUTILS_OK;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if (manager == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        // The recursive listing is issued on ftpListManager, its support is detected again once the connection is reset
+        __atomic_store_n(&manager->mediasDownloader->recursiveListSupport, -1, __ATOMIC_RELAXED);
+        __atomic_store_n(&manager->mediasDownloader->isListCanceled, 0, __ATOMIC_RELAXED);
+    }
+
+    for (i=0; (result == ARDATATRANSFER_OK) && (i < __atomic_load_n(&manager->mediasDownloader->listManagersCount, __ATOMIC_ACQUIRE)); i++)
+    {
+        resultUtils = ARUTILS_Manager_Ftp_Connection_Reset(manager->mediasDownloader->listManagers[i]);
+        if (resultUtils != ARUTILS_OK)
+        {
+            result = ARDATATRANSFER_ERROR_FTP;
+        }
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_CancelGetAvailableMedias(ARDATATRANSFER_Manager_t *manager)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    eARUTILS_ERROR resultUtils = ARUTILS_OK;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if (manager == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        // Seen by the parse loops at their next line, the connections abort the FTP command in progress
+        __atomic_store_n(&manager->mediasDownloader->isListCanceled, 1, __ATOMIC_RELAXED);
+    }
+
+    for (i=0; (result == ARDATATRANSFER_OK) && (i < __atomic_load_n(&manager->mediasDownloader->listManagersCount, __ATOMIC_ACQUIRE)); i++)
+    {
+        resultUtils = ARUTILS_Manager_Ftp_Connection_Cancel(manager->mediasDownloader->listManagers[i]);
+        if (resultUtils != ARUTILS_OK)
+        {
+            result = ARDATATRANSFER_ERROR_FTP;
+        }
+    }
+
+    return result;
+}
+
+/*****************************************
+ *
+ *             Private implementation:
+ *
+ *****************************************/
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_Initialize(ARDATATRANSFER_Manager_t *manager, ARUTILS_Manager_t *ftpListManager, ARUTILS_Manager_t *ftpQueueManager, const char *remoteDirectory, const char *localDirectory)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    //eARUTILS_ERROR error = ARUTILS_OK;
+    int resultSys = 0;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s, %s", localDirectory ? localDirectory : "null", remoteDirectory ? remoteDirectory : "null");
+
+    if ((manager == NULL) || (ftpListManager == NULL) || (ftpQueueManager == NULL) || (localDirectory == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        strncpy(manager->mediasDownloader->remoteDirectory, remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        manager->mediasDownloader->remoteDirectory[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncpy(manager->mediasDownloader->localDirectory, localDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        manager->mediasDownloader->localDirectory[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(manager->mediasDownloader->localDirectory, "/" , ARUTILS_FTP_MAX_PATH_SIZE - strlen(manager->mediasDownloader->localDirectory) - 1);
+
+        resultSys = mkdir(manager->mediasDownloader->localDirectory, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+        if ((resultSys != 0) && (errno != EEXIST))
+        {
+            result = ARDATATRANSFER_ERROR_SYSTEM;
+        }
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "return %d", result);
+
+    return result;
+}
+
+void ARDATATRANSFER_MediasDownloader_Clear(ARDATATRANSFER_Manager_t *manager)
+{
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if ((manager != NULL) && (manager->mediasDownloader != NULL))
+    {
+        manager->mediasDownloader->isCanceled = 0;
+    }
+}
+
+ARDATATRANSFER_MediasDownloader_Worker_t * ARDATATRANSFER_MediasDownloader_AcquireWorker(ARDATATRANSFER_Manager_t *manager)
+{
+    ARDATATRANSFER_MediasDownloader_Worker_t *worker = NULL;
+    int i;
+
+    ARSAL_Mutex_Lock(&manager->mediasDownloader->workersLock);
+
+    for (i=0; (worker == NULL) && (i < manager->mediasDownloader->workersCount); i++)
+    {
+        if (manager->mediasDownloader->workers[i].isRunning == 0)
+        {
+            worker = &manager->mediasDownloader->workers[i];
+            worker->manager = manager;
+            worker->isRunning = 1;
+            manager->mediasDownloader->isRunning++;
+        }
+    }
+
+    ARSAL_Mutex_Unlock(&manager->mediasDownloader->workersLock);
+
+    return worker;
+}
+
+void ARDATATRANSFER_MediasDownloader_StartStats(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_Worker_t *worker)
+{
+    ARDATATRANSFER_MediasDownloader_Stats_t *stats = &manager->mediasDownloader->stats;
+
+    // The throughput is measured while downloading only, a new sample starts with the first download
+    if (stats->inFlightCount == 0)
+    {
+        ARSAL_Time_GetTime(&stats->rateTime);
+        stats->rateBytes = 0.f;
+    }
+
+    stats->inFlightCount++;
+    stats->inFlightBytes += worker->ftpMedia->size;
+    worker->downloadedBytes = 0.f;
+}
+
+void ARDATATRANSFER_MediasDownloader_StopStats(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_Worker_t *worker)
+{
+    ARDATATRANSFER_MediasDownloader_Stats_t *stats = &manager->mediasDownloader->stats;
+
+    stats->inFlightCount--;
+
+    if (stats->inFlightCount > 0)
+    {
+        stats->inFlightBytes -= worker->ftpMedia->size;
+        stats->downloadedBytes -= worker->downloadedBytes;
+    }
+    else
+    {
+        stats->inFlightBytes = 0.f;
+        stats->downloadedBytes = 0.f;
+    }
+
+    worker->downloadedBytes = 0.f;
+}
+
+void ARDATATRANSFER_MediasDownloader_UpdateRate(ARDATATRANSFER_Manager_t *manager, struct timespec *now)
+{
+    ARDATATRANSFER_MediasDownloader_Stats_t *stats = &manager->mediasDownloader->stats;
+    int32_t elapsed;
+    double sample;
+
+    elapsed = ARSAL_Time_ComputeTimespecMsTimeDiff(&stats->rateTime, now);
+
+    if ((stats->inFlightCount > 0) && (elapsed >= ARDATATRANSFER_MEDIAS_DOWNLOADER_RATE_PERIOD_MS))
+    {
+        sample = stats->rateBytes * 1000.f / elapsed;
+
+        if (stats->bytesPerSecond == 0.f)
+        {
+            stats->bytesPerSecond = sample;
+        }
+        else
+        {
+            stats->bytesPerSecond += (sample - stats->bytesPerSecond) * ARDATATRANSFER_MEDIAS_DOWNLOADER_RATE_WEIGHT;
+        }
+
+        stats->rateTime = *now;
+        stats->rateBytes = 0.f;
+    }
+}
+
+int ARDATATRANSFER_MediasDownloader_ReleaseWorker(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_Worker_t *worker)
+{
+    int isRunning;
+
+    ARSAL_Mutex_Lock(&manager->mediasDownloader->workersLock);
+
+    worker->isRunning = 0;
+    manager->mediasDownloader->isRunning--;
+    isRunning = manager->mediasDownloader->isRunning;
+
+    ARSAL_Mutex_Unlock(&manager->mediasDownloader->workersLock);
+
+    return isRunning;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_GetThumbnail(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    eARUTILS_ERROR error = ARUTILS_OK;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if ((manager == NULL) || (media == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    // The thumbnail of a remote path does not change while the size of its media does not
+    if ((result == ARDATATRANSFER_OK)
+        && (ARDATATRANSFER_MediasThumbnails_Load(&manager->mediasDownloader->thumbnails, media->remoteThumb, media->size, &media->thumbnail, &media->thumbnailSize) != ARDATATRANSFER_OK))
+    {
+        error = ARUTILS_Manager_Ftp_Get_WithBuffer(manager->mediasDownloader->ftpListManager, media->remoteThumb, &media->thumbnail, &media->thumbnailSize, NULL, NULL);
+
+        if (error != ARUTILS_OK)
+        {
+            result = ARDATATRANSFER_ERROR_FTP;
+        }
+        else
+        {
+            ARDATATRANSFER_MediasThumbnails_Save(&manager->mediasDownloader->thumbnails, media->remoteThumb, media->size, media->thumbnail, media->thumbnailSize);
+        }
+    }
+
+    return result;
+}
+
+void ARDATATRANSFER_MediasDownloader_FtpProgressCallback(void* arg, float percent)
+{
+    ARDATATRANSFER_MediasDownloader_Worker_t *worker = (ARDATATRANSFER_MediasDownloader_Worker_t *)arg;
+    ARDATATRANSFER_MediasDownloader_Stats_t *stats;
+    ARDATATRANSFER_FtpMedia_t *listener;
+    struct timespec now;
+    double downloadedBytes;
+
+    if ((worker != NULL) && (worker->manager != NULL) && (worker->ftpMedia != NULL))
+    {
+        stats = &worker->manager->mediasDownloader->stats;
+        downloadedBytes = worker->ftpMedia->size * percent / 100.f;
+        ARSAL_Time_GetTime(&now);
+
+        ARSAL_Mutex_Lock(&worker->manager->mediasDownloader->workersLock);
+        if (downloadedBytes > worker->downloadedBytes)
+        {
+            stats->downloadedBytes += downloadedBytes - worker->downloadedBytes;
+            stats->rateBytes += downloadedBytes - worker->downloadedBytes;
+            worker->downloadedBytes = downloadedBytes;
+        }
+        ARDATATRANSFER_MediasDownloader_UpdateRate(worker->manager, &now);
+        ARSAL_Mutex_Unlock(&worker->manager->mediasDownloader->workersLock);
+
+        // The listeners attached during the transfer are appended with a release store
+        for (listener = worker->ftpMedia; listener != NULL; listener = __atomic_load_n(&listener->nextListener, __ATOMIC_ACQUIRE))
+        {
+            if (listener->progressCallback != NULL)
+            {
+                listener->progressCallback(listener->progressArg, &worker->media, percent);
+            }
+        }
+    }
+}
+
+void ARDATATRANSFER_MediasDownloader_NotifyCompletion(ARDATATRANSFER_FtpMedia_t *ftpMedia, ARDATATRANSFER_Media_t *media, eARDATATRANSFER_ERROR error)
+{
+    ARDATATRANSFER_FtpMedia_t *listener;
+
+    for (listener = ftpMedia; listener != NULL; listener = listener->nextListener)
+    {
+        if (listener->completionCallback != NULL)
+        {
+            listener->completionCallback(listener->completionArg, media, error);
+        }
+    }
+}
+
+void ARDATATRANSFER_MediasDownloader_InitFtpMedia(ARDATATRANSFER_FtpMedia_t *ftpMedia, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority, ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback, void *progressArg, ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback, void *completionArg)
+{
+    ftpMedia->progressCallback = progressCallback;
+    ftpMedia->progressArg = progressArg;
+    ftpMedia->completionCallback = completionCallback;
+    ftpMedia->completionArg = completionArg;
+    ftpMedia->priority = priority;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_DownloadMedia(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_Worker_t *worker)
+{
+    char localPath[ARUTILS_FTP_MAX_PATH_SIZE];
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    eARUTILS_ERROR errorResume = ARUTILS_OK;
+    eARUTILS_ERROR error = ARUTILS_OK;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia = NULL;
+    int64_t localSize = 0;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+
+    if ((manager  == NULL) || (worker == NULL) || (worker->ftpManager == NULL) || (worker->ftpMedia == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+    else
+    {
+        ftpMedia = worker->ftpMedia;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        strncpy(localPath, manager->mediasDownloader->localDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        localPath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(localPath, ARDATATRANSFER_MANAGER_DOWNLOADER_DOWNLOADING_PREFIX, ARUTILS_FTP_MAX_PATH_SIZE - strlen(localPath) - 1);
+        strncat(localPath, ftpMedia->name, ARUTILS_FTP_MAX_PATH_SIZE - strlen(localPath) - 1);
+
+        errorResume = ARUTILS_FileSystem_GetFileSize(localPath, &localSize);
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (errorResume == ARUTILS_OK))
+    {
+        // The resumed part is already received, it does not count in the throughput
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->workersLock);
+        manager->mediasDownloader->stats.downloadedBytes += (double)localSize - worker->downloadedBytes;
+        worker->downloadedBytes = (double)localSize;
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->workersLock);
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        error = ARUTILS_Manager_Ftp_Get(worker->ftpManager, ftpMedia->remotePath, localPath, ARDATATRANSFER_MediasDownloader_FtpProgressCallback, worker, (errorResume == ARUTILS_OK) ? FTP_RESUME_TRUE : FTP_RESUME_FALSE);
+
+        if (error == ARUTILS_ERROR_FTP_CANCELED)
+        {
+            result = ARDATATRANSFER_ERROR_CANCELED;
+        }
+        else if (error != ARUTILS_OK)
+        {
+            result = ARDATATRANSFER_ERROR_FTP;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        error = ARUTILS_FileSystem_Rename(localPath, ftpMedia->filePath);
+
+        if (error != ARUTILS_OK)
+        {
+            result = ARDATATRANSFER_ERROR_FILE;
+        }
+    }
+    else
+    {
+        // Don't remove localPath, keep it for resume, and manage older file in App
+        //remove(localPath);
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_IndexThumbnails(ARDATATRANSFER_MediasIndex_t *thumbIndex, const char *metaThumbList, uint32_t metaThumbListLen, char **thumbNames)
+{
+    char lineDataThumb[ARUTILS_FTP_MAX_PATH_SIZE];
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    const char *nextThumb = NULL;
+    const char *thumbName;
+    char *names = NULL;
+    char *name;
+    size_t nameLen;
+    size_t i;
+
+    // A name is never longer than its list line, all the names fit in a buffer of the list size
+    names = malloc(metaThumbListLen + 1);
+
+    if (names == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_ALLOC;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        result = ARDATATRANSFER_MediasIndex_New(thumbIndex, metaThumbListLen / ARDATATRANSFER_MEDIAS_DOWNLOADER_THUMB_LINE_SIZE);
+    }
+
+    name = names;
+    while ((result == ARDATATRANSFER_OK)
+           && ((thumbName = ARUTILS_Ftp_List_GetNextItem(metaThumbList, &nextThumb, NULL, 0, NULL, NULL, lineDataThumb, ARUTILS_FTP_MAX_PATH_SIZE)) != NULL))
+    {
+        nameLen = strlen(thumbName);
+        memcpy(name, thumbName, nameLen + 1);
+
+        // A media looks its thumbnail up by a prefix ending with a dot, index the thumbnail under each of them
+        for (i=0; (result == ARDATATRANSFER_OK) && (i < nameLen); i++)
+        {
+            if (name[i] == '.')
+            {
+                result = ARDATATRANSFER_MediasIndex_Add(thumbIndex, name, (int)(i + 1), name);
+            }
+        }
+
+        name += nameLen + 1;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        *thumbNames = names;
+    }
+    else
+    {
+        ARDATATRANSFER_MediasIndex_Delete(thumbIndex);
+        free(names);
+    }
+
+    return result;
+}
+
+int ARDATATRANSFER_MediasDownloader_IsProductSelected(const ARDATATRANSFER_MediasDownloader_Filter_t *filter, eARDISCOVERY_PRODUCT product)
+{
+    return ((filter->products == 0) || ((filter->products & ((uint64_t)1 << product)) != 0)) ? 1 : 0;
+}
+
+int ARDATATRANSFER_MediasDownloader_IsMediaSelected(const ARDATATRANSFER_MediasDownloader_Filter_t *filter, eARDISCOVERY_PRODUCT product, eARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE type, int64_t timestamp)
+{
+    int isSelected = ARDATATRANSFER_MediasDownloader_IsProductSelected(filter, product);
+
+    if ((filter->types != 0) && ((filter->types & (1 << type)) == 0))
+    {
+        isSelected = 0;
+    }
+
+    if (((filter->minTimestamp != 0) || (filter->maxTimestamp != 0)) && (timestamp == INT64_MIN))
+    {
+        isSelected = 0;
+    }
+
+    if (((filter->minTimestamp != 0) && (timestamp < filter->minTimestamp))
+        || ((filter->maxTimestamp != 0) && (timestamp > filter->maxTimestamp)))
+    {
+        isSelected = 0;
+    }
+
+    return isSelected;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SelectDcimDirectories(ARDATATRANSFER_MediasIndex_t *dirIndex, const ARDATATRANSFER_MediasDownloader_Filter_t *filter, const char *metaThumbList, uint32_t metaThumbListLen, char **dirNames)
+{
+    char lineDataThumb[ARUTILS_FTP_MAX_PATH_SIZE];
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    eARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE type;
+    const char *nextThumb = NULL;
+    const char *thumbName;
+    const char *ext;
+    char *names = NULL;
+    char *name;
+
+    // A directory name is shorter than the thumbnail line it is found in
+    names = malloc(metaThumbListLen + 1);
+
+    if (names == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_ALLOC;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        result = ARDATATRANSFER_MediasIndex_New(dirIndex, ARDATATRANSFER_MEDIA_LIST_SIZE);
+    }
+
+    name = names;
+    while ((result == ARDATATRANSFER_OK)
+           && ((thumbName = ARUTILS_Ftp_List_GetNextItem(metaThumbList, &nextThumb, NULL, 0, NULL, NULL, lineDataThumb, ARUTILS_FTP_MAX_PATH_SIZE)) != NULL))
+    {
+        // 100DRONEJUMP0001.MOV.<media name>, see the DCIM prefix of the thumbnails
+        if (strlen(thumbName) > ARDATATRANSFER_MEDIAS_DOWNLOADER_DCIM_PREFIX_LEN)
+        {
+            ext = &thumbName[ARDATATRANSFER_MEDIAS_DOWNLOADER_DCIM_PREFIX_LEN - 4];
+            type = (strncmp(ext, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_JPG_CAP, 3) == 0) ? ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_PHOTO : ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_VIDEO;
+
+            if ((ARDATATRANSFER_MediasDownloader_IsMediaSelected(filter, ARDISCOVERY_getProductFromPathName(&thumbName[ARDATATRANSFER_MEDIAS_DOWNLOADER_DCIM_PREFIX_LEN]), type, ARDATATRANSFER_MediasDate_ParseName(thumbName)) == 1)
+                && (ARDATATRANSFER_MediasIndex_Find(dirIndex, thumbName, ARDATATRANSFER_MEDIAS_DOWNLOADER_DCIM_DIR_LEN) == NULL))
+            {
+                memcpy(name, thumbName, ARDATATRANSFER_MEDIAS_DOWNLOADER_DCIM_DIR_LEN);
+                result = ARDATATRANSFER_MediasIndex_Add(dirIndex, name, ARDATATRANSFER_MEDIAS_DOWNLOADER_DCIM_DIR_LEN, name);
+                name += ARDATATRANSFER_MEDIAS_DOWNLOADER_DCIM_DIR_LEN;
+            }
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        *dirNames = names;
+    }
+    else
+    {
+        ARDATATRANSFER_MediasIndex_Delete(dirIndex);
+        free(names);
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_NewListPool(ARDATATRANSFER_MediasDownloader_ListPool_t *pool)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    memset(pool, 0, sizeof(ARDATATRANSFER_MediasDownloader_ListPool_t));
+
+    if (ARSAL_Mutex_Init(&pool->lock) != 0)
+    {
+        result = ARDATATRANSFER_ERROR_SYSTEM;
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (ARSAL_Cond_Init(&pool->doneCond) != 0))
+    {
+        result = ARDATATRANSFER_ERROR_SYSTEM;
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (ARSAL_Sem_Init(&pool->workSem, 0, 0) != 0))
+    {
+        result = ARDATATRANSFER_ERROR_SYSTEM;
+    }
+
+    return result;
+}
+
+void ARDATATRANSFER_MediasDownloader_DeleteListPool(ARDATATRANSFER_MediasDownloader_ListPool_t *pool)
+{
+    int i;
+
+    // Without worker the pool may be partially initialized, there is nobody to stop
+    if (pool->workersCount > 0)
+    {
+        ARSAL_Mutex_Lock(&pool->lock);
+        pool->isStopped = 1;
+        ARSAL_Mutex_Unlock(&pool->lock);
+
+        for (i=0; i<pool->workersCount; i++)
+        {
+            ARSAL_Sem_Post(&pool->workSem);
+        }
+
+        for (i=0; i<pool->workersCount; i++)
+        {
+            ARSAL_Thread_Join(pool->workers[i].thread, NULL);
+            ARSAL_Thread_Destroy(&pool->workers[i].thread);
+        }
+        pool->workersCount = 0;
+    }
+
+    ARSAL_Sem_Destroy(&pool->workSem);
+    ARSAL_Cond_Destroy(&pool->doneCond);
+    ARSAL_Mutex_Destroy(&pool->lock);
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddListThread(ARDATATRANSFER_MediasDownloader_ListPool_t *pool, ARUTILS_Manager_t *ftpManager)
+{
+    ARDATATRANSFER_MediasDownloader_ListWorker_t *worker;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    // The workers are only added under the lock of the downloader, the slot is not read before the count is incremented
+    worker = &pool->workers[pool->workersCount];
+    worker->pool = pool;
+    worker->ftpManager = ftpManager;
+
+    if (ARSAL_Thread_Create(&worker->thread, ARDATATRANSFER_MediasDownloader_ListThreadRun, worker) != 0)
+    {
+        result = ARDATATRANSFER_ERROR_SYSTEM;
+    }
+    else
+    {
+        ARSAL_Mutex_Lock(&pool->lock);
+        pool->workersCount++;
+        ARSAL_Mutex_Unlock(&pool->lock);
+    }
+
+    return result;
+}
+
+int ARDATATRANSFER_MediasDownloader_IsCatalogCached(ARDATATRANSFER_Manager_t *manager, int withThumbnail, const ARDATATRANSFER_MediasDownloader_Filter_t *filter)
+{
+    ARDATATRANSFER_MediasDownloader_CatalogCache_t *cache = &manager->mediasDownloader->catalogCache;
+    char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
+    char *dcimFtpList = NULL;
+    uint32_t dcimFtpListLen = 0;
+    struct timespec now;
+    eARUTILS_ERROR resultUtils = ARUTILS_OK;
+    int isCached = 0;
+
+    if ((cache->ttlMs > 0) && (cache->isValid == 1) && (withThumbnail <= cache->withThumbnail)
+        && (memcmp(&cache->filter, filter, sizeof(ARDATATRANSFER_MediasDownloader_Filter_t)) == 0))
+    {
+        ARSAL_Time_GetTime(&now);
+        isCached = (ARSAL_Time_ComputeTimespecMsTimeDiff(&cache->listTime, &now) < cache->ttlMs) ? 1 : 0;
+
+        if ((isCached == 0) && (cache->isProbed == 1) && (cache->isProbeable == 1))
+        {
+            // The dates of the DCIM subdirectories change with their medias
+            strncpy(remotePath, manager->mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+            remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+            strncat(remotePath, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_DCIM "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(remotePath) - 1);
+
+            resultUtils = ARUTILS_Manager_Ftp_List(manager->mediasDownloader->ftpListManager, remotePath, &dcimFtpList, &dcimFtpListLen);
+
+            // The dates are to the minute, a change within the minute of the newest one only shows in a listing done after it
+            if ((resultUtils == ARUTILS_OK) && (dcimFtpListLen == cache->probeLen) && (ARDATATRANSFER_MediasIndex_Hash(dcimFtpList, dcimFtpListLen) == cache->probeHash)
+                && (cache->isProbeSettled == 1))
+            {
+                cache->listTime = now;
+                isCached = 1;
+            }
+
+            free(dcimFtpList);
+        }
+
+        ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "cached %d", isCached);
+    }
+
+    return isCached;
+}
+
+void ARDATATRANSFER_MediasDownloader_CacheCatalog(ARDATATRANSFER_Manager_t *manager, int withThumbnail, const ARDATATRANSFER_MediasDownloader_Filter_t *filter, int isProbeable, uint32_t probeHash, uint32_t probeLen, int64_t probeMinute)
+{
+    ARDATATRANSFER_MediasDownloader_CatalogCache_t *cache = &manager->mediasDownloader->catalogCache;
+
+    ARSAL_Time_GetTime(&cache->listTime);
+    memcpy(&cache->filter, filter, sizeof(ARDATATRANSFER_MediasDownloader_Filter_t));
+    cache->withThumbnail = withThumbnail;
+    cache->isProbeable = isProbeable;
+    cache->probeHash = probeHash;
+    cache->probeLen = probeLen;
+
+    if ((cache->isValid == 0) || (probeMinute != cache->probeMinute))
+    {
+        cache->probeMinute = probeMinute;
+        cache->probeMinuteTime = cache->listTime;
+    }
+
+    // The minute is over once a minute passed since it was first found, whatever the clock of the Device.
+    // Otherwise it is compared to the local clock, a day covering the time zone of the Device.
+    cache->isProbeSettled = ((probeMinute == INT64_MIN)
+                             || (ARSAL_Time_ComputeTimespecMsTimeDiff(&cache->probeMinuteTime, &cache->listTime) >= 60000)
+                             || ((probeMinute + 60 + 86400) <= (int64_t)time(NULL))) ? 1 : 0;
+    cache->isValid = 1;
+}
+
+int ARDATATRANSFER_MediasDownloader_IsListCanceled(ARDATATRANSFER_Manager_t *manager)
+{
+    // No ordering needed, the flag guards no data and a late load only costs a few lines
+    return (__atomic_load_n(&manager->mediasDownloader->isListCanceled, __ATOMIC_RELAXED) != 0) ? 1 : 0;
+}
+
+void ARDATATRANSFER_MediasDownloader_NotifyDiscovered(ARDATATRANSFER_MediaList_t *mediaList, int *notifiedCount, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t discoveredCallback, void *discoveredArg)
+{
+    if (discoveredCallback != NULL)
+    {
+        while (*notifiedCount < mediaList->count)
+        {
+            discoveredCallback(discoveredArg, mediaList->medias[*notifiedCount], *notifiedCount);
+            (*notifiedCount)++;
+        }
+    }
+}
+
+void ARDATATRANSFER_MediasDownloader_StartListing(ARDATATRANSFER_MediasDownloader_ListPool_t *pool, ARDATATRANSFER_MediasDownloader_List_t *lists, int count)
+{
+    int pendingCount = 0;
+    int wakeCount;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%d directories", count);
+
+    for (i=0; i<count; i++)
+    {
+        pendingCount += (lists[i].isDone == 0) ? 1 : 0;
+    }
+
+    ARSAL_Mutex_Lock(&pool->lock);
+    pool->lists = lists;
+    pool->count = count;
+    pool->next = 0;
+    // The caller takes a listing too, no more workers are woken than there are listings left
+    wakeCount = (pool->workersCount < (pendingCount - 1)) ? pool->workersCount : (pendingCount - 1);
+    ARSAL_Mutex_Unlock(&pool->lock);
+
+    for (i=0; i<wakeCount; i++)
+    {
+        ARSAL_Sem_Post(&pool->workSem);
+    }
+}
+
+void ARDATATRANSFER_MediasDownloader_WaitListing(ARDATATRANSFER_MediasDownloader_ListPool_t *pool, int index, ARUTILS_Manager_t *ftpManager)
+{
+    ARSAL_Mutex_Lock(&pool->lock);
+
+    while (pool->lists[index].isDone == 0)
+    {
+        if (pool->next < pool->count)
+        {
+            // Rather than waiting idle, list the next pending directory
+            ARSAL_Mutex_Unlock(&pool->lock);
+            ARDATATRANSFER_MediasDownloader_RunListing(pool, ftpManager);
+            ARSAL_Mutex_Lock(&pool->lock);
+        }
+        else
+        {
+            ARSAL_Cond_Wait(&pool->doneCond, &pool->lock);
+        }
+    }
+
+    ARSAL_Mutex_Unlock(&pool->lock);
+}
+
+int ARDATATRANSFER_MediasDownloader_WaitAnyListing(ARDATATRANSFER_MediasDownloader_ListPool_t *pool, ARUTILS_Manager_t *ftpManager)
+{
+    int index = -1;
+    int isPending = 1;
+    int i;
+
+    ARSAL_Mutex_Lock(&pool->lock);
+
+    while ((index < 0) && (isPending == 1))
+    {
+        isPending = 0;
+
+        for (i=0; (index < 0) && (i < pool->count); i++)
+        {
+            if (pool->lists[i].isTaken == 0)
+            {
+                isPending = 1;
+                index = (pool->lists[i].isDone == 1) ? i : -1;
+            }
+        }
+
+        if ((index < 0) && (isPending == 1))
+        {
+            if (pool->next < pool->count)
+            {
+                ARSAL_Mutex_Unlock(&pool->lock);
+                ARDATATRANSFER_MediasDownloader_RunListing(pool, ftpManager);
+                ARSAL_Mutex_Lock(&pool->lock);
+            }
+            else
+            {
+                ARSAL_Cond_Wait(&pool->doneCond, &pool->lock);
+            }
+        }
+    }
+
+    if (index >= 0)
+    {
+        pool->lists[index].isTaken = 1;
+    }
+
+    ARSAL_Mutex_Unlock(&pool->lock);
+
+    return index;
+}
+
+void ARDATATRANSFER_MediasDownloader_StopListing(ARDATATRANSFER_MediasDownloader_ListPool_t *pool)
+{
+    ARSAL_Mutex_Lock(&pool->lock);
+    pool->next = pool->count;
+
+    // A woken worker may still be listing, the lists are only released once every worker is done
+    while (pool->activeCount > 0)
+    {
+        ARSAL_Cond_Wait(&pool->doneCond, &pool->lock);
+    }
+
+    pool->lists = NULL;
+    pool->count = 0;
+    pool->next = 0;
+    ARSAL_Mutex_Unlock(&pool->lock);
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ListDirectories(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_List_t *lists, int count)
+{
+    int i;
+
+    ARDATATRANSFER_MediasDownloader_StartListing(&manager->mediasDownloader->listPool, lists, count);
+
+    for (i=0; i<count; i++)
+    {
+        ARDATATRANSFER_MediasDownloader_WaitListing(&manager->mediasDownloader->listPool, i, manager->mediasDownloader->ftpListManager);
+    }
+
+    ARDATATRANSFER_MediasDownloader_StopListing(&manager->mediasDownloader->listPool);
+
+    return ARDATATRANSFER_OK;
+}
+
+int ARDATATRANSFER_MediasDownloader_RunListing(ARDATATRANSFER_MediasDownloader_ListPool_t *pool, ARUTILS_Manager_t *ftpManager)
+{
+    ARDATATRANSFER_MediasDownloader_List_t *list = NULL;
+
+    ARSAL_Mutex_Lock(&pool->lock);
+    while ((pool->next < pool->count) && (pool->lists[pool->next].isDone == 1))
+    {
+        // Already taken from the recursive listing
+        pool->next++;
+    }
+
+    if (pool->next < pool->count)
+    {
+        list = &pool->lists[pool->next];
+        pool->next++;
+    }
+    ARSAL_Mutex_Unlock(&pool->lock);
+
+    if (list != NULL)
+    {
+        list->result = ARUTILS_Manager_Ftp_Connection_IsCanceled(ftpManager);
+
+        if ((list->result == ARUTILS_OK) && (list->isFile == 1))
+        {
+            list->result = ARUTILS_Manager_Ftp_Get_WithBuffer(ftpManager, list->remotePath, (uint8_t **)&list->list, &list->listLen, NULL, NULL);
+        }
+        else if (list->result == ARUTILS_OK)
+        {
+            list->result = ARUTILS_Manager_Ftp_List(ftpManager, list->remotePath, &list->list, &list->listLen);
+        }
+
+        ARSAL_Mutex_Lock(&pool->lock);
+        list->isDone = 1;
+        ARSAL_Cond_Broadcast(&pool->doneCond);
+        ARSAL_Mutex_Unlock(&pool->lock);
+    }
+
+    return (list != NULL) ? 1 : 0;
+}
+
+void* ARDATATRANSFER_MediasDownloader_ListThreadRun(void *workerArg)
+{
+    ARDATATRANSFER_MediasDownloader_ListWorker_t *worker = (ARDATATRANSFER_MediasDownloader_ListWorker_t *)workerArg;
+    ARDATATRANSFER_MediasDownloader_ListPool_t *pool = worker->pool;
+    int isStopped = 0;
+
+    while (isStopped == 0)
+    {
+        ARSAL_Sem_Wait(&pool->workSem);
+
+        ARSAL_Mutex_Lock(&pool->lock);
+        isStopped = pool->isStopped;
+        if (isStopped == 0)
+        {
+            pool->activeCount++;
+        }
+        ARSAL_Mutex_Unlock(&pool->lock);
+
+        if (isStopped == 0)
+        {
+            while (ARDATATRANSFER_MediasDownloader_RunListing(pool, worker->ftpManager) == 1);
+
+            ARSAL_Mutex_Lock(&pool->lock);
+            pool->activeCount--;
+            ARSAL_Cond_Broadcast(&pool->doneCond);
+            ARSAL_Mutex_Unlock(&pool->lock);
+        }
+    }
+
+    return NULL;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_FetchThumbnails(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_List_t *lists, int *indexes, double *mediaSizes, int count, int isOrdered, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t availableMediaCallback, void *availableMediaArg)
+{
+    ARDATATRANSFER_MediasDownloader_ListPool_t *pool = &manager->mediasDownloader->listPool;
+    ARDATATRANSFER_MediasDownloader_List_t *list;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int listIndex;
+    int i;
+
+    // The cached thumbnails are done before the fetches start, only the others are fetched
+    for (i=0; i<count; i++)
+    {
+        if (ARDATATRANSFER_MediasThumbnails_Load(&manager->mediasDownloader->thumbnails, lists[i].remotePath, mediaSizes[i], (uint8_t **)&lists[i].list, &lists[i].listLen) == ARDATATRANSFER_OK)
+        {
+            lists[i].result = ARUTILS_OK;
+            lists[i].isDone = 1;
+            lists[i].isCached = 1;
+        }
+    }
+
+    ARDATATRANSFER_MediasDownloader_StartListing(pool, lists, count);
+
+    for (i=0; (result == ARDATATRANSFER_OK) && (i < count); i++)
+    {
+        if (isOrdered == 1)
+        {
+            listIndex = i;
+            ARDATATRANSFER_MediasDownloader_WaitListing(pool, listIndex, manager->mediasDownloader->ftpListManager);
+        }
+        else
+        {
+            listIndex = ARDATATRANSFER_MediasDownloader_WaitAnyListing(pool, manager->mediasDownloader->ftpListManager);
+        }
+
+        list = &lists[listIndex];
+        if ((list->isCached == 0) && (list->result == ARUTILS_OK) && (list->list != NULL))
+        {
+            ARDATATRANSFER_MediasThumbnails_Save(&manager->mediasDownloader->thumbnails, list->remotePath, mediaSizes[listIndex], (uint8_t *)list->list, list->listLen);
+        }
+
+        result = ARDATATRANSFER_MediasDownloader_SetFetchedThumbnail(manager, list, indexes[listIndex], availableMediaCallback, availableMediaArg);
+    }
+
+    // On cancel, the fetches in flight are aborted and the pending ones are not done
+    ARDATATRANSFER_MediasDownloader_StopListing(pool);
+
+    for (i=0; i<count; i++)
+    {
+        free(lists[i].list);
+        lists[i].list = NULL;
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetFetchedThumbnail(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_List_t *list, int index, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t availableMediaCallback, void *availableMediaArg)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    ARDATATRANSFER_Media_t *media;
+    ARDATATRANSFER_Media_t tmpMedia;
+
+    if ((list->result == ARUTILS_ERROR_FTP_CANCELED) || (ARDATATRANSFER_MediasDownloader_IsListCanceled(manager) == 1)
+        || (ARUTILS_Manager_Ftp_Connection_IsCanceled(manager->mediasDownloader->ftpListManager) != ARUTILS_OK))
+    {
+        result = ARDATATRANSFER_ERROR_CANCELED;
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (list->result == ARUTILS_OK) && (list->list != NULL))
+    {
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
+
+        // A new listing may have been published meanwhile, the thumbnail is only set to the same media
+        media = (index < manager->mediasDownloader->medias.count) ? manager->mediasDownloader->medias.medias[index] : NULL;
+        if ((media != NULL) && (media->thumbnail == NULL) && (strcmp(media->remoteThumb, list->remotePath) == 0))
+        {
+            media->thumbnail = (uint8_t *)list->list;
+            media->thumbnailSize = list->listLen;
+            memcpy(&tmpMedia, media, sizeof(ARDATATRANSFER_Media_t));
+            list->list = NULL;
+        }
+        else
+        {
+            memset(&tmpMedia, 0, sizeof(ARDATATRANSFER_Media_t));
+        }
+
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
+
+        if (tmpMedia.thumbnail != NULL)
+        {
+            availableMediaCallback(availableMediaArg, &tmpMedia, index);
+        }
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ListRecursive(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasIndex_t *sectionIndex, char **recursiveList)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    eARUTILS_ERROR resultUtils = ARUTILS_OK;
+    char *list = NULL;
+    uint32_t listLen = 0;
+    char *line;
+    char *lineEnd;
+    char *listEnd;
+    char *blankLine = NULL;
+    const char *sectionPath = "";
+    int sectionPathLen = 0;
+    char *section;
+    int lineLen;
+    int hasHeaders = 0;
+    int support;
+
+    memset(sectionIndex, 0, sizeof(ARDATATRANSFER_MediasIndex_t));
+    *recursiveList = NULL;
+
+    // Reset with the connection without listLock, see ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias
+    support = __atomic_load_n(&manager->mediasDownloader->recursiveListSupport, __ATOMIC_RELAXED);
+
+    if ((manager->mediasDownloader->recursiveListCallback != NULL) && (support != 0))
+    {
+        resultUtils = manager->mediasDownloader->recursiveListCallback(manager->mediasDownloader->recursiveListArg, manager->mediasDownloader->ftpListManager, manager->mediasDownloader->remoteDirectory, &list, &listLen);
+
+        if (resultUtils == ARUTILS_ERROR_FTP_CANCELED)
+        {
+            result = ARDATATRANSFER_ERROR_CANCELED;
+        }
+        else if ((resultUtils != ARUTILS_OK) || (list == NULL))
+        {
+            // The directories are listed one by one until the connection is reset
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "recursive listing not supported: %d", resultUtils);
+            support = 0;
+        }
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (list != NULL) && (support != 0))
+    {
+        result = ARDATATRANSFER_MediasIndex_New(sectionIndex, 0);
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (sectionIndex->entries != NULL))
+    {
+        // One pass: a "path:" line at the start or after a blank line ends the previous directory listing and names the next one
+        listEnd = list + strnlen(list, listLen);
+        section = list;
+        line = list;
+
+        while ((result == ARDATATRANSFER_OK) && (line < listEnd))
+        {
+            lineEnd = memchr(line, '\n', listEnd - line);
+            lineEnd = (lineEnd != NULL) ? lineEnd : listEnd;
+            lineLen = lineEnd - line;
+            if ((lineLen > 0) && (line[lineLen - 1] == '\r'))
+            {
+                lineLen--;
+            }
+
+            if (((line == list) || (blankLine != NULL)) && (lineLen > 1) && (line[lineLen - 1] == ':'))
+            {
+                if (line != list)
+                {
+                    *blankLine = '\0';
+                    result = ARDATATRANSFER_MediasIndex_Add(sectionIndex, sectionPath, sectionPathLen, section);
+                }
+
+                line[lineLen - 1] = '\0';
+                sectionPath = ARDATATRANSFER_MediasDownloader_GetRelativePath(manager->mediasDownloader->remoteDirectory, line, &sectionPathLen);
+                section = (lineEnd < listEnd) ? (lineEnd + 1) : lineEnd;
+                hasHeaders = 1;
+            }
+
+            blankLine = (lineLen == 0) ? line : NULL;
+            line = (lineEnd < listEnd) ? (lineEnd + 1) : lineEnd;
+        }
+
+        if (result == ARDATATRANSFER_OK)
+        {
+            result = ARDATATRANSFER_MediasIndex_Add(sectionIndex, sectionPath, sectionPathLen, section);
+        }
+
+        if ((result == ARDATATRANSFER_OK) && (hasHeaders == 0))
+        {
+            // A flat listing of the remote directory, the subdirectories are listed one by one until the connection is reset
+            ARSAL_PRINT(ARSAL_PRINT_WARNING, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "recursive listing not supported");
+            support = 0;
+        }
+        else if (result == ARDATATRANSFER_OK)
+        {
+            support = 1;
+        }
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (manager->mediasDownloader->recursiveListCallback != NULL))
+    {
+        __atomic_store_n(&manager->mediasDownloader->recursiveListSupport, support, __ATOMIC_RELAXED);
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        *recursiveList = list;
+    }
+    else
+    {
+        ARDATATRANSFER_MediasIndex_Delete(sectionIndex);
+        free(list);
+    }
+
+    return result;
+}
+
+const char * ARDATATRANSFER_MediasDownloader_GetRelativePath(const char *remoteDirectory, const char *path, int *pathLen)
+{
+    const char *relativePath = path;
+    int directoryLen;
+    int len;
+
+    while (*remoteDirectory == '/')
+    {
+        remoteDirectory++;
+    }
+
+    directoryLen = strlen(remoteDirectory);
+    while ((directoryLen > 0) && (remoteDirectory[directoryLen - 1] == '/'))
+    {
+        directoryLen--;
+    }
+
+    if ((relativePath[0] == '.') && ((relativePath[1] == '/') || (relativePath[1] == '\0')))
+    {
+        relativePath++;
+    }
+
+    while (*relativePath == '/')
+    {
+        relativePath++;
+    }
+
+    if ((directoryLen > 0) && (strncmp(relativePath, remoteDirectory, directoryLen) == 0) && ((relativePath[directoryLen] == '/') || (relativePath[directoryLen] == '\0')))
+    {
+        relativePath += directoryLen;
+    }
+
+    while (*relativePath == '/')
+    {
+        relativePath++;
+    }
+
+    len = strlen(relativePath);
+    while ((len > 0) && (relativePath[len - 1] == '/'))
+    {
+        len--;
+    }
+
+    *pathLen = len;
+    return relativePath;
+}
+
+int ARDATATRANSFER_MediasDownloader_TakeRecursiveList(ARDATATRANSFER_MediasIndex_t *sectionIndex, const char *remoteDirectory, const char *remotePath, char **list, uint32_t *listLen)
+{
+    const char *relativePath;
+    const char *section;
+    int relativePathLen;
+    int isTaken = 0;
+
+    relativePath = ARDATATRANSFER_MediasDownloader_GetRelativePath(remoteDirectory, remotePath, &relativePathLen);
+    section = ARDATATRANSFER_MediasIndex_Find(sectionIndex, relativePath, relativePathLen);
+
+    if (section != NULL)
+    {
+        *list = strdup(section);
+
+        if (*list != NULL)
+        {
+            *listLen = strlen(*list);
+            isTaken = 1;
+        }
+    }
+
+    return isTaken;
+}
+
+void ARDATATRANSFER_MediasDownloader_TakeRecursiveLists(ARDATATRANSFER_MediasIndex_t *sectionIndex, const char *remoteDirectory, ARDATATRANSFER_MediasDownloader_List_t *lists, int count)
+{
+    int i;
+
+    for (i=0; i<count; i++)
+    {
+        if (ARDATATRANSFER_MediasDownloader_TakeRecursiveList(sectionIndex, remoteDirectory, lists[i].remotePath, &lists[i].list, &lists[i].listLen) == 1)
+        {
+            lists[i].result = ARUTILS_OK;
+            lists[i].isDone = 1;
+        }
+    }
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ListDcim(ARDATATRANSFER_MediasDownloader_Listing_t *listing, const char *productFtpList)
+{
+    ARDATATRANSFER_MediasDownloader_t *mediasDownloader = listing->manager->mediasDownloader;
+    ARDATATRANSFER_MediasDownloader_List_t dcimLists[2];
+    ARDATATRANSFER_MediasDownloader_List_t *list;
+    char lineData[ARUTILS_FTP_MAX_PATH_SIZE];
+    const char *nextProduct = NULL;
+    const char *nextDcim = NULL;
+    const char *fileName;
+    const char *dirName;
+    const char *lineItem;
+    int lineSize;
+    int64_t lineMinute;
+    int64_t now = 0;
+    int dcimCount = 0;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    memset(dcimLists, 0, sizeof(dcimLists));
+
+    // Find DCIM directory
+    fileName = ARUTILS_Ftp_List_GetNextItem(productFtpList, &nextProduct, ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_DCIM, 1, NULL, NULL, lineData, ARUTILS_FTP_MAX_PATH_SIZE);
+    if ((fileName != NULL) && strcmp(fileName, ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_DCIM) == 0)
+    {
+        // We have it.
+        listing->hasDCIM = 1;
+        // List the thumbnails, we will need them for every file, and the DCIM subdirectories
+        strncpy(dcimLists[0].remotePath, mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        dcimLists[0].remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(dcimLists[0].remotePath, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_META "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(dcimLists[0].remotePath) - 1);
+        strncpy(dcimLists[1].remotePath, mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        dcimLists[1].remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(dcimLists[1].remotePath, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_DCIM "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(dcimLists[1].remotePath) - 1);
+
+        ARDATATRANSFER_MediasDownloader_TakeRecursiveLists(&listing->sectionIndex, mediasDownloader->remoteDirectory, dcimLists, 2);
+        result = ARDATATRANSFER_MediasDownloader_ListDirectories(listing->manager, dcimLists, 2);
+
+        if ((result == ARDATATRANSFER_OK) && (dcimLists[0].result != ARUTILS_OK))
+        {
+            result = ARDATATRANSFER_ERROR_FTP;
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "Unable to list thumbnails");
+        }
+
+        if ((result == ARDATATRANSFER_OK) && (dcimLists[1].result != ARUTILS_OK))
+        {
+            result = ARDATATRANSFER_ERROR_FTP;
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "Unable to list DCIM");
+        }
+
+        // Parse the thumbnails once, each media then finds its thumbnail in constant time
+        if (result == ARDATATRANSFER_OK)
+        {
+            result = ARDATATRANSFER_MediasDownloader_IndexThumbnails(&listing->thumbIndex, dcimLists[0].list, dcimLists[0].listLen, &listing->thumbNames);
+            listing->thumbHash = ARDATATRANSFER_MediasIndex_Hash(dcimLists[0].list, dcimLists[0].listLen);
+        }
+
+        // The thumbnail names tell the product, type and date of the medias of each subdirectory before it is listed
+        if ((result == ARDATATRANSFER_OK) && (listing->isFiltered == 1))
+        {
+            result = ARDATATRANSFER_MediasDownloader_SelectDcimDirectories(&listing->dcimIndex, &listing->filter, dcimLists[0].list, dcimLists[0].listLen, &listing->dcimNames);
+        }
+
+        // The listing of the DCIM folder is the one probed once the medias list is out of date
+        if (result == ARDATATRANSFER_OK)
+        {
+            listing->dcimHash = ARDATATRANSFER_MediasIndex_Hash(dcimLists[1].list, dcimLists[1].listLen);
+            listing->dcimLen = dcimLists[1].listLen;
+            now = (int64_t)time(NULL);
+        }
+
+        while ((result == ARDATATRANSFER_OK) && (ARUTILS_Ftp_List_GetNextItem(dcimLists[1].list, &nextDcim, NULL, 1, &lineItem, &lineSize, lineData, ARUTILS_FTP_MAX_PATH_SIZE) != NULL))
+        {
+            lineMinute = ARDATATRANSFER_MediasDate_ParseListItem(lineItem, lineSize, now);
+            listing->dcimMinute = (lineMinute > listing->dcimMinute) ? lineMinute : listing->dcimMinute;
+            dcimCount++;
+        }
+    }
+
+    // The DCIM subdirectories are listed with the product subfolders, that follow them
+    if (result == ARDATATRANSFER_OK)
+    {
+        listing->lists = (ARDATATRANSFER_MediasDownloader_List_t *)calloc(dcimCount + ARDISCOVERY_PRODUCT_MAX, sizeof(ARDATATRANSFER_MediasDownloader_List_t));
+
+        if (listing->lists == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_ALLOC;
+        }
+    }
+
+    nextDcim = NULL;
+    while ((result == ARDATATRANSFER_OK) && (listing->listsCount < dcimCount)
+           && ((dirName = ARUTILS_Ftp_List_GetNextItem(dcimLists[1].list, &nextDcim, NULL, 1, NULL, NULL, lineData, ARUTILS_FTP_MAX_PATH_SIZE)) != NULL))
+    {
+        if ((listing->isFiltered == 1) && (ARDATATRANSFER_MediasIndex_Find(&listing->dcimIndex, dirName, strlen(dirName)) == NULL))
+        {
+            continue;
+        }
+
+        list = &listing->lists[listing->listsCount];
+        strncpy(list->name, dirName, ARUTILS_FTP_MAX_PATH_SIZE);
+        list->name[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncpy(list->remotePath, mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        list->remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(list->remotePath, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_DCIM "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(list->remotePath) - 1);
+        strncat(list->remotePath, dirName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(list->remotePath) - 1);
+        strncat(list->remotePath, "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(list->remotePath) - 1);
+        listing->listsCount++;
+    }
+    listing->dcimCount = listing->listsCount;
+
+    free(dcimLists[0].list);
+    free(dcimLists[1].list);
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ParseDcim(ARDATATRANSFER_MediasDownloader_Listing_t *listing)
+{
+    ARDATATRANSFER_MediasDownloader_t *mediasDownloader = listing->manager->mediasDownloader;
+    ARDATATRANSFER_MediasDownloader_List_t *list;
+    int listIndex;
+    int isReused = 0;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    // Iterate for each subdir, in the DCIM listing order
+    for (listIndex = 0; (result == ARDATATRANSFER_OK) && (listIndex < listing->dcimCount); listIndex++)
+    {
+        list = &listing->lists[listIndex];
+        ARDATATRANSFER_MediasDownloader_WaitListing(&mediasDownloader->listPool, listIndex, mediasDownloader->ftpListManager);
+
+        if (ARUTILS_Manager_Ftp_Connection_IsCanceled(mediasDownloader->ftpListManager) != ARUTILS_OK)
+        {
+            result = ARDATATRANSFER_ERROR_CANCELED;
+        }
+
+        if ((result == ARDATATRANSFER_OK) && (list->result != ARUTILS_OK))
+        {
+            result = ARDATATRANSFER_ERROR_FTP;
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "Unable to list DCIM/%s", list->name);
+        }
+
+        if (result == ARDATATRANSFER_OK)
+        {
+            result = ARDATATRANSFER_MediasDownloader_ReuseDirectory(listing, list->remotePath, list->list, list->listLen, listing->thumbHash, &isReused);
+        }
+
+        if ((result == ARDATATRANSFER_OK) && (isReused == 0))
+        {
+            result = ARDATATRANSFER_MediasDownloader_ParseDcimDirectory(listing, list->name, list->list);
+        }
+
+        if (result == ARDATATRANSFER_OK)
+        {
+            ARDATATRANSFER_MediasDownloader_NotifyDiscovered(listing->medias, &listing->notifiedCount, listing->discoveredCallback, listing->discoveredArg);
+        }
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ParseDcimDirectory(ARDATATRANSFER_MediasDownloader_Listing_t *listing, const char *dirName, const char *mediaFtpList)
+{
+    ARDATATRANSFER_MediasDownloader_t *mediasDownloader = listing->manager->mediasDownloader;
+    char lineDataMedia[ARUTILS_FTP_MAX_PATH_SIZE];
+    char thumbPrefix[ARUTILS_FTP_MAX_PATH_SIZE];
+    ARDATATRANSFER_Media_t *media;
+    eARDISCOVERY_PRODUCT mediaProduct;
+    eARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE mediaType;
+    int64_t timestamp;
+    const char *nextMedia = NULL;
+    const char *lineItem;
+    int lineSize;
+    const char *fileName;
+    const char *thumbName;
+    const char *ext;
+    char *index;
+    char *begin;
+    char *end;
+    double fileSize;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    // Iterate on each media
+    while ((result == ARDATATRANSFER_OK) && ((fileName = ARUTILS_Ftp_List_GetNextItem(mediaFtpList, &nextMedia, NULL, 0, &lineItem, &lineSize, lineDataMedia, ARUTILS_FTP_MAX_PATH_SIZE)) != NULL))
+    {
+        if (ARDATATRANSFER_MediasDownloader_IsListCanceled(listing->manager) == 1)
+        {
+            result = ARDATATRANSFER_ERROR_CANCELED;
+            break;
+        }
+
+        // Check that the file is a proper media file
+        index = strrchr (fileName, '.');
+        if (index == NULL)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "No dot found in %s", fileName);
+            continue;
+        }
+
+        index++;
+        if (strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_JPG_CAP) == 0)
+        {
+            ext = ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_JPG;
+            mediaType = ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_PHOTO;
+        }
+        else if(strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MP4_CAP) == 0)
+        {
+            ext = ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MP4;
+            mediaType = ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_VIDEO;
+        }
+        else if(strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MOV_CAP) == 0)
+        {
+            ext = ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MOV;
+            mediaType = ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_VIDEO;
+        }
+        else
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "File is not media file !");
+            continue;
+        }
+
+        // Check that we have a proper thumbnail file for this media
+        strncpy(thumbPrefix, dirName, ARUTILS_FTP_MAX_PATH_SIZE);
+        thumbPrefix[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(thumbPrefix, fileName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(thumbPrefix) - 1);
+        strncat(thumbPrefix, ".", ARUTILS_FTP_MAX_PATH_SIZE - strlen(thumbPrefix) - 1);
+
+        thumbName = ARDATATRANSFER_MediasIndex_Find(&listing->thumbIndex, thumbPrefix, strlen(thumbPrefix));
+        if (thumbName == NULL)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "No thumbnail for media %s/%s", dirName, fileName);
+            continue;
+        }
+
+        // The thumbnail name is the media name prefixed by its DCIM path, the date being between its last two _
+        mediaProduct = ARDISCOVERY_getProductFromPathName(&thumbName[ARDATATRANSFER_MEDIAS_DOWNLOADER_DCIM_PREFIX_LEN]);
+        timestamp = ARDATATRANSFER_MediasDate_ParseName(thumbName);
+        if ((listing->isFiltered == 1) && (ARDATATRANSFER_MediasDownloader_IsMediaSelected(&listing->filter, mediaProduct, mediaType, timestamp) == 0))
+        {
+            continue;
+        }
+
+        // Yes we do, get all infos !
+
+        // Start with size
+        if (ARUTILS_Ftp_List_GetItemSize(lineItem, lineSize, &fileSize) == NULL)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "Unable to get media size");
+            continue;
+        }
+
+        media = ARDATATRANSFER_MediasDownloader_NewMediaInList(listing->medias);
+        if (media == NULL)
+        {
+            ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "Unable to allocate media");
+            continue;
+        }
+
+        // Forge the media
+
+        // The DCIM prefix for thumbnails is 21 chars long
+        // 8 for the 100DRONE (folder name) +
+        // 8 for the JUMP0001 (media name) +
+        // 4 for the .MOV (media extension) +
+        // 1 for the . (separator)
+        // The len of thumbName is always good because it was
+        // indexed under this prefix.
+        const int dcimHeaderLen = ARDATATRANSFER_MEDIAS_DOWNLOADER_DCIM_PREFIX_LEN;
+        media->product = mediaProduct;
+
+        // Media name is:
+        // thumbnailName without dcim prefix
+        // the extension (last 3 chars) replaced by the lowercase media ext
+        strncpy(media->name, &thumbName[dcimHeaderLen], ARDATATRANSFER_MEDIA_NAME_SIZE);
+        media->name[ARDATATRANSFER_MEDIA_NAME_SIZE - 1] = '\0';
+        strncpy(&media->name[strlen(media->name) - 3], ext, 3);
+
+        // Media filePath is the local path + the name
+        strncpy(media->filePath, mediasDownloader->localDirectory, ARDATATRANSFER_MEDIA_PATH_SIZE);
+        media->filePath[ARDATATRANSFER_MEDIA_PATH_SIZE - 1] = '\0';
+        strncat(media->filePath, media->name, ARDATATRANSFER_MEDIA_PATH_SIZE - strlen(media->filePath) - 1);
+
+        // Media UUID is after the last _ but before the last .
+        begin = strrchr(media->name, '_');
+        end = strrchr(media->name, '.');
+        if (begin == NULL || end == NULL)
+        {
+            media->uuid[0] = '\0';
+        }
+        else
+        {
+            int len = end - begin - 1;
+            int start = begin - media->name + 1;
+            if (len >= ARDATATRANSFER_MEDIA_UUID_SIZE)
+            {
+                len = ARDATATRANSFER_MEDIA_UUID_SIZE - 1;
+            }
+            strncpy(media->uuid, &media->name[start], len);
+            media->uuid[len] = '\0';
+        }
+
+        // Media date is between the last _ and the previous one
+        end = begin;
+        begin = end - 1;
+        // Find previous "_", limiting at the beginning of the string
+        for (begin = end - 1; begin >= media->name && *begin != '_'; begin--);
+        if (*begin != '_')
+        {
+            media->date[0] = '\0';
+        }
+        else
+        {
+            int len = end - begin - 1;
+            int start = begin - media->name + 1;
+            if (len >= ARDATATRANSFER_MEDIA_UUID_SIZE)
+            {
+                len = ARDATATRANSFER_MEDIA_UUID_SIZE - 1;
+            }
+            strncpy(media->date, &media->name[start], len);
+            media->date[len] = '\0';
+        }
+        ARDATATRANSFER_MediasDownloader_GetMediaRecord(media)->timestamp = timestamp;
+
+        // Media size is just fileSize ;)
+        media->size = fileSize;
+
+        // Remote path is the full path to the file on the FTP
+        strncpy(media->remotePath, mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        media->remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(media->remotePath, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_DCIM "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
+        strncat(media->remotePath, dirName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
+        strncat(media->remotePath, "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
+        strncat(media->remotePath, fileName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
+
+        // Remote thumb is the full path of the thumbnail on the FTP
+        strncpy(media->remoteThumb, mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        media->remoteThumb[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(media->remoteThumb, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_META "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) -1);
+        strncat(media->remoteThumb, thumbName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) - 1);
+
+        if (listing->withThumbnail == 1)
+        {
+            ARDATATRANSFER_MediasDownloader_RefreshThumbnail(listing->manager, &listing->previousIndex, media);
+        }
+
+        result = ARDATATRANSFER_MediasDownloader_AddMediaToList(listing->medias, media);
+
+        if (result == ARDATATRANSFER_OK)
+        {
+            // Each media is streamed as soon as it is parsed, a cancel from the callback stops at the next line
+            ARDATATRANSFER_MediasDownloader_NotifyDiscovered(listing->medias, &listing->notifiedCount, listing->discoveredCallback, listing->discoveredArg);
+        }
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ListProducts(ARDATATRANSFER_MediasDownloader_Listing_t *listing, const char *productFtpList)
+{
+    ARDATATRANSFER_MediasDownloader_t *mediasDownloader = listing->manager->mediasDownloader;
+    ARDATATRANSFER_MediasDownloader_List_t *list;
+    char productPathName[ARUTILS_FTP_MAX_PATH_SIZE];
+    char lineDataProduct[ARUTILS_FTP_MAX_PATH_SIZE];
+    const char *nextProduct;
+    const char *fileName;
+    int product;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    for (product = 0; (result == ARDATATRANSFER_OK) && (product < ARDISCOVERY_PRODUCT_MAX); product++)
+    {
+        ARDISCOVERY_getProductPathName(product, productPathName, sizeof(productPathName));
+        nextProduct = NULL;
+        fileName = ARUTILS_Ftp_List_GetNextItem(productFtpList, &nextProduct, productPathName, 1, NULL, NULL, lineDataProduct, ARUTILS_FTP_MAX_PATH_SIZE);
+
+        if ((fileName != NULL) && (strcmp(fileName, productPathName) == 0) && (ARDATATRANSFER_MediasDownloader_IsProductSelected(&listing->filter, product) == 1))
+        {
+            list = &listing->lists[listing->listsCount];
+            strncpy(list->name, productPathName, ARUTILS_FTP_MAX_PATH_SIZE);
+            list->name[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+
+            // The product subfolders are parsed in this order, one that can not be listed fails the listing rather than being skipped
+            if (snprintf(list->remotePath, ARUTILS_FTP_MAX_PATH_SIZE, "%s/%s/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_MEDIA "/", mediasDownloader->remoteDirectory, productPathName) >= ARUTILS_FTP_MAX_PATH_SIZE)
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "path too long for %s", productPathName);
+                result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+            }
+            listing->listsCount++;
+        }
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ParseProducts(ARDATATRANSFER_MediasDownloader_Listing_t *listing)
+{
+    ARDATATRANSFER_MediasDownloader_t *mediasDownloader = listing->manager->mediasDownloader;
+    ARDATATRANSFER_MediasDownloader_List_t *list;
+    char productPathName[ARUTILS_FTP_MAX_PATH_SIZE];
+    int listIndex = listing->dcimCount;
+    int product;
+    int isReused = 0;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    for (product = 0; (result == ARDATATRANSFER_OK) && (product < ARDISCOVERY_PRODUCT_MAX) && (listIndex < listing->listsCount); product++)
+    {
+        if (ARUTILS_Manager_Ftp_Connection_IsCanceled(mediasDownloader->ftpListManager) != ARUTILS_OK)
+        {
+            result = ARDATATRANSFER_ERROR_CANCELED;
+        }
+
+        ARDISCOVERY_getProductPathName(product, productPathName, sizeof(productPathName));
+
+        // The product subfolders are listed in this order, after the DCIM subdirectories
+        if ((result == ARDATATRANSFER_OK) && (strcmp(listing->lists[listIndex].name, productPathName) == 0))
+        {
+            list = &listing->lists[listIndex];
+            ARDATATRANSFER_MediasDownloader_WaitListing(&mediasDownloader->listPool, listIndex, mediasDownloader->ftpListManager);
+            listIndex++;
+
+            if (list->result == ARUTILS_OK)
+            {
+                result = ARDATATRANSFER_MediasDownloader_ReuseDirectory(listing, list->remotePath, list->list, list->listLen, 0, &isReused);
+
+                if ((result == ARDATATRANSFER_OK) && (isReused == 0))
+                {
+                    result = ARDATATRANSFER_MediasDownloader_ParseProductDirectory(listing, product, productPathName, list->list);
+                }
+
+                if (result == ARDATATRANSFER_OK)
+                {
+                    ARDATATRANSFER_MediasDownloader_NotifyDiscovered(listing->medias, &listing->notifiedCount, listing->discoveredCallback, listing->discoveredArg);
+                }
+            }
+            else
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "List of %s failed with error  = %i",
+                    list->remotePath, list->result);
+                // only set the error if the product has no DCIM folder
+                // if it has a DCIM folder, we assume that the pictures are in it.
+                if (!listing->hasDCIM)
+                {
+                    result = ARDATATRANSFER_ERROR_FTP;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ParseProductDirectory(ARDATATRANSFER_MediasDownloader_Listing_t *listing, int product, const char *productPathName, const char *mediaFtpList)
+{
+    ARDATATRANSFER_MediasDownloader_t *mediasDownloader = listing->manager->mediasDownloader;
+    char lineDataMedia[ARUTILS_FTP_MAX_PATH_SIZE];
+    ARDATATRANSFER_Media_t *media;
+    eARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE mediaType = ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_PHOTO;
+    int64_t timestamp;
+    const char *nextMedia = NULL;
+    const char *lineItem;
+    int lineSize;
+    const char *fileName;
+    const char *begin;
+    const char *tag;
+    const char *end;
+    const char *index;
+    double fileSize;
+    int fileType;
+    long len;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    while ((result == ARDATATRANSFER_OK)
+           && (fileName = ARUTILS_Ftp_List_GetNextItem(mediaFtpList, &nextMedia, NULL, 0, &lineItem, &lineSize, lineDataMedia,ARUTILS_FTP_MAX_PATH_SIZE)) != NULL)
+    {
+        if (ARDATATRANSFER_MediasDownloader_IsListCanceled(listing->manager) == 1)
+        {
+            result = ARDATATRANSFER_ERROR_CANCELED;
+        }
+
+        //Check file type
+        fileType = 0;
+        index = fileName + strlen(fileName);
+        while (index > fileName && *index != '.')
+        {
+            index--;
+        }
+        if (*index == '.')
+        {
+            index++;
+            if (strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_JPG) == 0)
+            {
+                fileType = 1;
+                mediaType = ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_PHOTO;
+            }
+            else if (strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MP4) == 0)
+            {
+                fileType = 1;
+                mediaType = ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_VIDEO;
+            }
+            else if (strcmp(index, ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_MOV) == 0)
+            {
+                fileType = 1;
+                mediaType = ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_VIDEO;
+            }
+        }
+
+        if (strncmp(fileName, productPathName, strlen(productPathName)) != 0)
+        {
+            fileType = 0;
+        }
+
+        // The medias not selected are not allocated
+        timestamp = INT64_MIN;
+        if (fileType == 1)
+        {
+            timestamp = ARDATATRANSFER_MediasDate_ParseName(fileName);
+        }
+
+        if ((fileType == 1) && (listing->isFiltered == 1) && (ARDATATRANSFER_MediasDownloader_IsMediaSelected(&listing->filter, product, mediaType, timestamp) == 0))
+        {
+            fileType = 0;
+        }
+
+        //do not pertorm ARUTILS_Ftp_Size that is too long, prefer decoding the FTP LIST
+        if ((result != ARDATATRANSFER_OK) || (fileType == 0) || (ARUTILS_Ftp_List_GetItemSize(lineItem, lineSize, &fileSize) == NULL))
+        {
+            continue;
+        }
+
+        media = ARDATATRANSFER_MediasDownloader_NewMediaInList(listing->medias);
+
+        if (media == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_ALLOC;
+            continue;
+        }
+
+        media->product = product;
+        strncpy(media->name, fileName, ARDATATRANSFER_MEDIA_NAME_SIZE);
+        media->name[ARDATATRANSFER_MEDIA_NAME_SIZE - 1] = '\0';
+
+        strncpy(media->filePath, mediasDownloader->localDirectory, ARDATATRANSFER_MEDIA_PATH_SIZE);
+        media->filePath[ARDATATRANSFER_MEDIA_PATH_SIZE - 1] = '\0';
+        strncat(media->filePath, fileName, ARDATATRANSFER_MEDIA_PATH_SIZE - strlen(media->filePath) - 1);
+
+        strncpy(media->date, "", ARDATATRANSFER_MEDIA_DATE_SIZE);
+        media->date[ARDATATRANSFER_MEDIA_DATE_SIZE - 1] = '\0';
+
+        strncpy(media->uuid, "", ARDATATRANSFER_MEDIA_UUID_SIZE);
+        media->uuid[ARDATATRANSFER_MEDIA_UUID_SIZE - 1] = '\0';
+        //Jumping_Sumo_1970-01-01T000317+0000_3902B87F947BE865A9D137CFA63492B8.mp4
+
+        begin = NULL;
+        tag = NULL;
+        end = NULL;
+        index = media->name;
+        while ((index = strstr(index, "_")) != NULL)
+        {
+            begin = tag;
+            tag = ++index;
+        }
+
+        if ((begin != NULL) && (tag != NULL))
+        {
+            end = strstr(begin, ".");
+        }
+
+        if ((begin != NULL)  && (tag != NULL) && (end != NULL))
+        {
+            len = tag - begin - 1;
+            len = (len < ARDATATRANSFER_MEDIA_DATE_SIZE) ? len : (ARDATATRANSFER_MEDIA_DATE_SIZE - 1);
+            strncpy(media->date, begin, len);
+            media->date[len] = '\0';
+
+            len = end - tag;
+            len = (len < ARDATATRANSFER_MEDIA_UUID_SIZE) ? len : (ARDATATRANSFER_MEDIA_UUID_SIZE - 1);
+            strncpy(media->uuid, tag, len);
+            media->uuid[len] = '\0';
+        }
+        ARDATATRANSFER_MediasDownloader_GetMediaRecord(media)->timestamp = timestamp;
+
+        media->size = fileSize;
+
+        // Remote path is the full path to the file on the FTP
+        strncpy(media->remotePath, mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        media->remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(media->remotePath, "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
+        strncat(media->remotePath, productPathName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
+        strncat(media->remotePath, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_MEDIA "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
+        strncat(media->remotePath, fileName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remotePath) -1);
+
+        // Remote thumb is the full path of the thumbnail on the FTP
+        strncpy(media->remoteThumb, mediasDownloader->remoteDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        media->remoteThumb[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(media->remoteThumb, "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) -1);
+        strncat(media->remoteThumb, productPathName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) -1);
+        strncat(media->remoteThumb, "/" ARDATATRANSFER_MEDIAS_DOWNLOADER_FTP_THUMB "/", ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) -1);
+        strncat(media->remoteThumb, fileName, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) - 1);
+        // Append ".jpg" to remote thumb is fileName does not already end whith .jpg
+        if (fileName[strlen(fileName) - 4] != '.' ||
+            fileName[strlen(fileName) - 3] != 'j' ||
+            fileName[strlen(fileName) - 2] != 'p' ||
+            fileName[strlen(fileName) - 1] != 'g')
+        {
+            strncat(media->remoteThumb, "." ARDATATRANSFER_MEDIAS_DOWNLOADER_EXT_JPG, ARUTILS_FTP_MAX_PATH_SIZE - strlen(media->remoteThumb) - 1);
+        }
+
+        if (listing->withThumbnail == 1)
+        {
+            ARDATATRANSFER_MediasDownloader_RefreshThumbnail(listing->manager, &listing->previousIndex, media);
+        }
+
+        result = ARDATATRANSFER_MediasDownloader_AddMediaToList(listing->medias, media);
+
+        if (result == ARDATATRANSFER_OK)
+        {
+            // Streamed as in the DCIM directories
+            ARDATATRANSFER_MediasDownloader_NotifyDiscovered(listing->medias, &listing->notifiedCount, listing->discoveredCallback, listing->discoveredArg);
+        }
+    }
+
+    return result;
+}
+
+void ARDATATRANSFER_MediasDownloader_PublishListing(ARDATATRANSFER_MediasDownloader_Listing_t *listing, int isPublished)
+{
+    ARDATATRANSFER_MediasDownloader_t *mediasDownloader = listing->manager->mediasDownloader;
+    ARDATATRANSFER_MediaList_t retiredMedias;
+
+    ARSAL_Mutex_Lock(&mediasDownloader->mediasLock);
+
+    ARDATATRANSFER_MediasDownloader_SettleThumbnails(listing->medias, &listing->previousIndex, isPublished);
+
+    if (isPublished == 1)
+    {
+        // Publish the new listing at once, the readers never see a partial one
+        retiredMedias = mediasDownloader->medias;
+        mediasDownloader->medias = *listing->medias;
+    }
+    else
+    {
+        // The previous listing stays published, its thumbnails are no longer shared
+        retiredMedias = *listing->medias;
+        mediasDownloader->medias.isShared = 0;
+    }
+    memset(listing->medias, 0, sizeof(ARDATATRANSFER_MediaList_t));
+
+    ARSAL_Mutex_Unlock(&mediasDownloader->mediasLock);
+
+    ARDATATRANSFER_MediasDownloader_FreeMediaList(&retiredMedias);
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ReuseDirectory(ARDATATRANSFER_MediasDownloader_Listing_t *listing, const char *remotePath, const char *list, uint32_t listLen, uint32_t thumbHash, int *isReused)
+{
+    ARDATATRANSFER_MediaDirectory_t *directory;
+    uint32_t listHash;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+
+    // A directory whose listing and thumbnails did not change keeps its medias
+    listHash = ARDATATRANSFER_MediasIndex_Hash(list, listLen);
+    directory = ARDATATRANSFER_MediasDownloader_FindUnchangedDirectory(listing->previousMedias, remotePath, listHash, listLen, thumbHash, listing->withThumbnail, &listing->filter);
+
+    if (directory != NULL)
+    {
+        ARSAL_Mutex_Lock(&listing->manager->mediasDownloader->mediasLock);
+        result = ARDATATRANSFER_MediasDownloader_CopyDirectory(listing->medias, listing->previousMedias, directory);
+        ARSAL_Mutex_Unlock(&listing->manager->mediasDownloader->mediasLock);
+        *isReused = 1;
+    }
+    else
+    {
+        result = ARDATATRANSFER_MediasDownloader_AddDirectoryToList(listing->medias, remotePath, listHash, listLen, thumbHash, listing->withThumbnail, &listing->filter);
+        *isReused = 0;
+    }
+
+    return result;
+}
+
+ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_GetAvailableMediaByKey(ARDATATRANSFER_Manager_t *manager, eARDATATRANSFER_MEDIAS_DOWNLOADER_KEY key, const char *value, eARDATATRANSFER_ERROR *error)
+{
+    ARDATATRANSFER_Media_t *media = NULL;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int index;
 
-    if ((manager != NULL) && (manager->mediasDownloader != NULL))
+    if ((manager == NULL) || (value == NULL))
     {
-        manager->mediasDownloader->isCanceled = 0;
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (manager->mediasDownloader == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_NOT_INITIALIZED;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
+
+        index = ARDATATRANSFER_MediasDownloader_FindMediaInList(&manager->mediasDownloader->medias, key, value);
+        if (index != -1)
+        {
+            media = manager->mediasDownloader->medias.medias[index];
+        }
+        else
+        {
+            result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+        }
+
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
+    }
+
+    if (error != NULL)
+    {
+        *error = result;
     }
+
+    return media;
 }
 
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_GetThumbnail(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media)
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_RemoveMediaFromMediaList(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media)
 {
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
-    eARUTILS_ERROR error = ARUTILS_OK;
-
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+    ARDATATRANSFER_Media_t *removed;
+    int foundIndex = -1;
 
-    if ((manager == NULL) || (media == NULL))
+    if ((manager == NULL) || (manager->mediasDownloader == NULL) || (manager->mediasDownloader->medias.medias == NULL) || (manager->mediasDownloader->medias.count == 0))
     {
         result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
 
     if (result == ARDATATRANSFER_OK)
     {
-        error = ARUTILS_Manager_Ftp_Get_WithBuffer(manager->mediasDownloader->ftpListManager, media->remoteThumb, &media->thumbnail, &media->thumbnailSize, NULL, NULL);
+        ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
 
-        if (error != ARUTILS_OK)
+        foundIndex = ARDATATRANSFER_MediasDownloader_FindMediaInList(&manager->mediasDownloader->medias, ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_FILE_PATH, media->filePath);
+
+        if (foundIndex != -1)
         {
-            result = ARDATATRANSFER_ERROR_FTP;
+            removed = manager->mediasDownloader->medias.medias[foundIndex];
+            manager->mediasDownloader->medias.medias[foundIndex] = NULL;
+            ARDATATRANSFER_MediasDownloader_FreeViews(&manager->mediasDownloader->medias);
+
+            // The record stays in its slab until the list is freed, its thumbnail too while a listing in progress may share it
+            if ((manager->mediasDownloader->medias.isShared == 0) && (removed->thumbnail != NULL))
+            {
+                free(removed->thumbnail);
+                removed->thumbnail = NULL;
+                removed->thumbnailSize = 0;
+            }
         }
+
+        ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
     }
 
     return result;
 }
 
-void ARDATATRANSFER_MediasDownloader_FtpProgressCallback(void* arg, float percent)
+ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_NewMediaInList(ARDATATRANSFER_MediaList_t *mediaList)
 {
-    ARDATATRANSFER_FtpMedia_t *ftpMedia = (ARDATATRANSFER_FtpMedia_t *)arg;
+    ARDATATRANSFER_MediaSlab_t *slab = mediaList->slabs;
+    ARDATATRANSFER_MediaRecord_t *record;
+    ARDATATRANSFER_Media_t *media = NULL;
+    int capacity;
 
-    if (ftpMedia != NULL)
+    if ((slab == NULL) || (slab->count == slab->capacity))
     {
-        if (ftpMedia->progressCallback != NULL)
+        capacity = (slab == NULL) ? ARDATATRANSFER_MEDIA_LIST_SIZE : (slab->capacity * 2);
+        capacity = (capacity < ARDATATRANSFER_MEDIA_LIST_SLAB_MAX_SIZE) ? capacity : ARDATATRANSFER_MEDIA_LIST_SLAB_MAX_SIZE;
+
+        slab = malloc(sizeof(ARDATATRANSFER_MediaSlab_t) + (capacity * sizeof(ARDATATRANSFER_MediaRecord_t)));
+
+        if (slab != NULL)
         {
-            ftpMedia->progressCallback(ftpMedia->progressArg, &ftpMedia->media, percent);
+            slab->next = mediaList->slabs;
+            slab->capacity = capacity;
+            slab->count = 0;
+            mediaList->slabs = slab;
         }
     }
+
+    if (slab != NULL)
+    {
+        record = &slab->records[slab->count++];
+        memset(record, 0, sizeof(ARDATATRANSFER_MediaRecord_t));
+        record->timestamp = INT64_MIN;
+        media = &record->media;
+    }
+
+    return media;
 }
 
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_DownloadMedia(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_FtpMedia_t *ftpMedia)
+ARDATATRANSFER_MediaRecord_t * ARDATATRANSFER_MediasDownloader_GetMediaRecord(ARDATATRANSFER_Media_t *media)
+{
+    return (ARDATATRANSFER_MediaRecord_t *)media;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddMediaToList(ARDATATRANSFER_MediaList_t *mediaList, ARDATATRANSFER_Media_t *media)
 {
-    char localPath[ARUTILS_FTP_MAX_PATH_SIZE];
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
-    eARUTILS_ERROR errorResume = ARUTILS_OK;
-    eARUTILS_ERROR error = ARUTILS_OK;
-    int64_t localSize = 0;
+    ARDATATRANSFER_Media_t **medias;
+    const char *value;
+    int capacity;
+    int key;
 
-    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
+    if (mediaList->count == mediaList->capacity)
+    {
+        capacity = (mediaList->capacity == 0) ? ARDATATRANSFER_MEDIA_LIST_SIZE : (mediaList->capacity * 2);
+        medias = (ARDATATRANSFER_Media_t **)realloc(mediaList->medias, capacity * sizeof(ARDATATRANSFER_Media_t *));
+
+        if (medias == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_ALLOC;
+        }
+        else
+        {
+            mediaList->medias = medias;
+            mediaList->capacity = capacity;
+        }
+    }
 
-    if ((manager  == NULL) || (ftpMedia == NULL))
+    // The indexes hold the position of the media plus one, NULL meaning not indexed
+    for (key = 0; (result == ARDATATRANSFER_OK) && (key < ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_MAX); key++)
     {
-        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+        value = ARDATATRANSFER_MediasDownloader_GetMediaKey(media, key);
+
+        if ((value[0] != '\0') && (mediaList->indexes[key].entries == NULL))
+        {
+            result = ARDATATRANSFER_MediasIndex_New(&mediaList->indexes[key], ARDATATRANSFER_MEDIA_LIST_SIZE);
+        }
+
+        if ((result == ARDATATRANSFER_OK) && (value[0] != '\0'))
+        {
+            result = ARDATATRANSFER_MediasIndex_Add(&mediaList->indexes[key], value, strlen(value), (void *)(intptr_t)(mediaList->count + 1));
+        }
     }
 
     if (result == ARDATATRANSFER_OK)
     {
-        strncpy(localPath, manager->mediasDownloader->localDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
-        localPath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
-        strncat(localPath, ARDATATRANSFER_MANAGER_DOWNLOADER_DOWNLOADING_PREFIX, ARUTILS_FTP_MAX_PATH_SIZE - strlen(localPath) - 1);
-        strncat(localPath, ftpMedia->media.name, ARUTILS_FTP_MAX_PATH_SIZE - strlen(localPath) - 1);
+        mediaList->medias[mediaList->count++] = media;
 
-        errorResume = ARUTILS_FileSystem_GetFileSize(localPath, &localSize);
+        if (mediaList->directoriesCount > 0)
+        {
+            mediaList->directories[mediaList->directoriesCount - 1].count++;
+        }
     }
 
-    if (result == ARDATATRANSFER_OK)
+    return result;
+}
+
+const char * ARDATATRANSFER_MediasDownloader_GetMediaKey(ARDATATRANSFER_Media_t *media, eARDATATRANSFER_MEDIAS_DOWNLOADER_KEY key)
+{
+    const char *value;
+
+    switch (key)
     {
-        error = ARUTILS_Manager_Ftp_Get(manager->mediasDownloader->ftpQueueManager, ftpMedia->media.remotePath, localPath, ARDATATRANSFER_MediasDownloader_FtpProgressCallback, ftpMedia, (errorResume == ARUTILS_OK) ? FTP_RESUME_TRUE : FTP_RESUME_FALSE);
+    case ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_UUID:
+        value = media->uuid;
+        break;
+    case ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_NAME:
+        value = media->name;
+        break;
+    case ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_FILE_PATH:
+        value = media->filePath;
+        break;
+    default:
+        value = "";
+        break;
+    }
 
-        if (error == ARUTILS_ERROR_FTP_CANCELED)
+    return value;
+}
+
+int ARDATATRANSFER_MediasDownloader_FindMediaInList(ARDATATRANSFER_MediaList_t *mediaList, eARDATATRANSFER_MEDIAS_DOWNLOADER_KEY key, const char *value)
+{
+    int index = -1;
+
+    if ((key >= 0) && (key < ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_MAX) && (value != NULL))
+    {
+        index = (int)(intptr_t)ARDATATRANSFER_MediasIndex_Find(&mediaList->indexes[key], value, strlen(value)) - 1;
+    }
+
+    if ((index != -1) && (mediaList->medias[index] == NULL))
+    {
+        index = -1;
+    }
+
+    return index;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddDirectoryToList(ARDATATRANSFER_MediaList_t *mediaList, const char *remotePath, uint32_t listHash, uint32_t listLen, uint32_t thumbHash, int hasThumbnails, const ARDATATRANSFER_MediasDownloader_Filter_t *filter)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    ARDATATRANSFER_MediaDirectory_t *directories;
+    ARDATATRANSFER_MediaDirectory_t *directory;
+    int capacity;
+
+    if (mediaList->directoriesCount == mediaList->directoriesCapacity)
+    {
+        capacity = (mediaList->directoriesCapacity == 0) ? ARDATATRANSFER_MEDIA_LIST_SIZE : (mediaList->directoriesCapacity * 2);
+        directories = (ARDATATRANSFER_MediaDirectory_t *)realloc(mediaList->directories, capacity * sizeof(ARDATATRANSFER_MediaDirectory_t));
+
+        if (directories == NULL)
         {
-            result = ARDATATRANSFER_ERROR_CANCELED;
+            result = ARDATATRANSFER_ERROR_ALLOC;
         }
-        else if (error != ARUTILS_OK)
+        else
         {
-            result = ARDATATRANSFER_ERROR_FTP;
+            mediaList->directories = directories;
+            mediaList->directoriesCapacity = capacity;
         }
     }
 
     if (result == ARDATATRANSFER_OK)
     {
-        error = ARUTILS_FileSystem_Rename(localPath, ftpMedia->media.filePath);
+        directory = &mediaList->directories[mediaList->directoriesCount++];
+        strncpy(directory->remotePath, remotePath, ARUTILS_FTP_MAX_PATH_SIZE);
+        directory->remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        directory->listHash = listHash;
+        directory->listLen = listLen;
+        directory->thumbHash = thumbHash;
+        directory->hasThumbnails = hasThumbnails;
+        memcpy(&directory->filter, filter, sizeof(ARDATATRANSFER_MediasDownloader_Filter_t));
+        directory->first = mediaList->count;
+        directory->count = 0;
+    }
 
-        if (error != ARUTILS_OK)
+    return result;
+}
+
+ARDATATRANSFER_MediaDirectory_t * ARDATATRANSFER_MediasDownloader_FindUnchangedDirectory(ARDATATRANSFER_MediaList_t *mediaList, const char *remotePath, uint32_t listHash, uint32_t listLen, uint32_t thumbHash, int withThumbnail, const ARDATATRANSFER_MediasDownloader_Filter_t *filter)
+{
+    ARDATATRANSFER_MediaDirectory_t *directory = NULL;
+    int i;
+
+    for (i=0; (directory == NULL) && (i < mediaList->directoriesCount); i++)
+    {
+        if (strcmp(mediaList->directories[i].remotePath, remotePath) == 0)
         {
-            result = ARDATATRANSFER_ERROR_FILE;
+            directory = &mediaList->directories[i];
         }
     }
-    else
+
+    if ((directory != NULL)
+        && ((directory->listHash != listHash)
+            || (directory->listLen != listLen)
+            || (directory->thumbHash != thumbHash)
+            || ((withThumbnail == 1) && (directory->hasThumbnails == 0))
+            || (memcmp(&directory->filter, filter, sizeof(ARDATATRANSFER_MediasDownloader_Filter_t)) != 0)))
     {
-        // Don't remove localPath, keep it for resume, and manage older file in App
-        //remove(localPath);
+        directory = NULL;
+    }
+
+    return directory;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_CopyDirectory(ARDATATRANSFER_MediaList_t *mediaList, ARDATATRANSFER_MediaList_t *previousList, ARDATATRANSFER_MediaDirectory_t *directory)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    ARDATATRANSFER_Media_t *previous;
+    ARDATATRANSFER_Media_t *media;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s unchanged, %d medias", directory->remotePath, directory->count);
+
+    result = ARDATATRANSFER_MediasDownloader_AddDirectoryToList(mediaList, directory->remotePath, directory->listHash, directory->listLen, directory->thumbHash, directory->hasThumbnails, &directory->filter);
+
+    for (i=directory->first; (result == ARDATATRANSFER_OK) && (i < (directory->first + directory->count)); i++)
+    {
+        previous = previousList->medias[i];
+
+        if (previous != NULL)
+        {
+            media = ARDATATRANSFER_MediasDownloader_NewMediaInList(mediaList);
+
+            if (media == NULL)
+            {
+                result = ARDATATRANSFER_ERROR_ALLOC;
+            }
+            else
+            {
+                // The thumbnail is shared with the new record until the new listing is published
+                memcpy(ARDATATRANSFER_MediasDownloader_GetMediaRecord(media), ARDATATRANSFER_MediasDownloader_GetMediaRecord(previous), sizeof(ARDATATRANSFER_MediaRecord_t));
+                previousList->isShared = 1;
+
+                result = ARDATATRANSFER_MediasDownloader_AddMediaToList(mediaList, media);
+            }
+        }
     }
 
     return result;
 }
 
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_RemoveMediaFromMediaList(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_Media_t *media)
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_RefreshThumbnail(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasIndex_t *previousIndex, ARDATATRANSFER_Media_t *media)
 {
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
-    ARDATATRANSFER_Media_t *curMedia;
-    int foundIndex = -1;
+    ARDATATRANSFER_Media_t *previous;
+
+    ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
+
+    previous = ARDATATRANSFER_MediasIndex_Find(previousIndex, media->remotePath, strlen(media->remotePath));
+
+    if ((previous != NULL)
+        && (previous->thumbnail != NULL)
+        && (previous->size == media->size)
+        && (strcmp(previous->remoteThumb, media->remoteThumb) == 0))
+    {
+        // Shared until the new listing is published
+        media->thumbnail = previous->thumbnail;
+        media->thumbnailSize = previous->thumbnailSize;
+        manager->mediasDownloader->medias.isShared = 1;
+    }
+
+    ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
+
+    if (media->thumbnail == NULL)
+    {
+        result = ARDATATRANSFER_MediasDownloader_GetThumbnail(manager, media);
+    }
+
+    return result;
+}
+
+void ARDATATRANSFER_MediasDownloader_SettleThumbnails(ARDATATRANSFER_MediaList_t *mediaList, ARDATATRANSFER_MediasIndex_t *previousIndex, int isPublished)
+{
+    ARDATATRANSFER_Media_t *previous;
+    ARDATATRANSFER_Media_t *media;
     int i;
 
-    if ((manager == NULL) || (manager->mediasDownloader == NULL) || (manager->mediasDownloader->medias.medias == NULL) || (manager->mediasDownloader->medias.count == 0))
+    for (i=0; (previousIndex->count > 0) && (i < mediaList->count); i++)
     {
-        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+        media = mediaList->medias[i];
+
+        if ((media != NULL) && (media->thumbnail != NULL))
+        {
+            previous = ARDATATRANSFER_MediasIndex_Find(previousIndex, media->remotePath, strlen(media->remotePath));
+
+            if ((previous != NULL) && (previous->thumbnail == media->thumbnail))
+            {
+                if (isPublished == 1)
+                {
+                    previous->thumbnail = NULL;
+                    previous->thumbnailSize = 0;
+                }
+                else
+                {
+                    media->thumbnail = NULL;
+                    media->thumbnailSize = 0;
+                }
+            }
+        }
     }
+}
 
-    if (result == ARDATATRANSFER_OK)
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_BuildView(ARDATATRANSFER_MediaList_t *mediaList, eARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW view)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    ARDATATRANSFER_MediasDownloader_SortEntry_t *entries = NULL;
+    ARDATATRANSFER_Media_t *media;
+    int64_t timestamp;
+    int *positions = NULL;
+    int count = 0;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%d", view);
+
+    // One slot more, malloc of an empty list may return NULL
+    positions = malloc((mediaList->count + 1) * sizeof(int));
+    entries = malloc((mediaList->count + 1) * sizeof(ARDATATRANSFER_MediasDownloader_SortEntry_t));
+
+    if ((positions == NULL) || (entries == NULL))
     {
-        ARSAL_Mutex_Lock(&manager->mediasDownloader->mediasLock);
+        result = ARDATATRANSFER_ERROR_ALLOC;
+    }
 
-        for (i = 0; (foundIndex == -1) && (i < manager->mediasDownloader->medias.count); i++)
+    for (i=0; (result == ARDATATRANSFER_OK) && (i < mediaList->count); i++)
+    {
+        media = mediaList->medias[i];
+
+        if (media != NULL)
         {
-            curMedia = manager->mediasDownloader->medias.medias[i];
+            entries[count].position = i;
+            entries[count].subKey = 0;
 
-            if ((curMedia != NULL) && (strcmp(curMedia->filePath, media->filePath) == 0))
+            switch (view)
             {
-                foundIndex = i;
+            case ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_DATE:
+                entries[count].key = ARDATATRANSFER_MediasDownloader_GetMediaRecord(media)->timestamp;
+                break;
+            case ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_SIZE:
+                entries[count].key = (int64_t)media->size;
+                break;
+            case ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_PRODUCT:
+                // Most recent first, medias without date last
+                entries[count].key = media->product;
+                timestamp = ARDATATRANSFER_MediasDownloader_GetMediaRecord(media)->timestamp;
+                entries[count].subKey = (timestamp == INT64_MIN) ? INT64_MAX : -timestamp;
+                break;
+            default:
+                entries[count].key = 0;
+                break;
             }
+
+            count++;
         }
+    }
 
-        if (foundIndex != -1)
+    if (result == ARDATATRANSFER_OK)
+    {
+        if (view != ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_LISTING)
         {
-            curMedia = manager->mediasDownloader->medias.medias[foundIndex];
-            manager->mediasDownloader->medias.medias[foundIndex] = NULL;
-            free(curMedia);
+            qsort(entries, count, sizeof(ARDATATRANSFER_MediasDownloader_SortEntry_t), ARDATATRANSFER_MediasDownloader_CompareSortEntries);
         }
 
-        ARSAL_Mutex_Unlock(&manager->mediasDownloader->mediasLock);
+        for (i=0; i<count; i++)
+        {
+            positions[i] = entries[i].position;
+        }
+
+        mediaList->views[view] = positions;
+        mediaList->viewsCount[view] = count;
+        positions = NULL;
+    }
+
+    if (positions != NULL)
+    {
+        free(positions);
+    }
+
+    if (entries != NULL)
+    {
+        free(entries);
     }
 
     return result;
 }
 
+int ARDATATRANSFER_MediasDownloader_CompareSortEntries(const void *first, const void *second)
+{
+    const ARDATATRANSFER_MediasDownloader_SortEntry_t *firstEntry = first;
+    const ARDATATRANSFER_MediasDownloader_SortEntry_t *secondEntry = second;
+    int compare;
+
+    if (firstEntry->key != secondEntry->key)
+    {
+        compare = (firstEntry->key < secondEntry->key) ? -1 : 1;
+    }
+    else if (firstEntry->subKey != secondEntry->subKey)
+    {
+        compare = (firstEntry->subKey < secondEntry->subKey) ? -1 : 1;
+    }
+    else
+    {
+        compare = (firstEntry->position < secondEntry->position) ? -1 : 1;
+    }
+
+    return compare;
+}
+
+void ARDATATRANSFER_MediasDownloader_FreeViews(ARDATATRANSFER_MediaList_t *mediaList)
+{
+    int i;
+
+    for (i=0; i<ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_MAX; i++)
+    {
+        if (mediaList->views[i] != NULL)
+        {
+            free(mediaList->views[i]);
+            mediaList->views[i] = NULL;
+        }
+
+        mediaList->viewsCount[i] = 0;
+    }
+}
+
 void ARDATATRANSFER_MediasDownloader_FreeMediaList(ARDATATRANSFER_MediaList_t *mediaList)
 {
+    ARDATATRANSFER_MediaSlab_t *slab;
     int i = 0;
 
     ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIAS_DOWNLOADER_TAG, "%s", "");
@@ -1447,23 +4027,44 @@ void ARDATATRANSFER_MediasDownloader_FreeMediaList(ARDATATRANSFER_MediaList_t *m
     {
         if (mediaList->medias != NULL)
         {
-            for (i=0; i<mediaList->count; i++)
-            {
-                ARDATATRANSFER_Media_t *media = mediaList->medias[i];
+            free(mediaList->medias);
+            mediaList->medias = NULL;
+        }
 
-                if (media != NULL)
-                {
-                    if (media->thumbnail != NULL)
-                    {
-                        free(media->thumbnail);
-                    }
+        if (mediaList->directories != NULL)
+        {
+            free(mediaList->directories);
+            mediaList->directories = NULL;
+        }
+
+        // The slabs hold every record allocated, even those removed from the medias array
+        while (mediaList->slabs != NULL)
+        {
+            slab = mediaList->slabs;
+            mediaList->slabs = slab->next;
 
-                    free(media);
+            for (i=0; i<slab->count; i++)
+            {
+                if (slab->records[i].media.thumbnail != NULL)
+                {
+                    free(slab->records[i].media.thumbnail);
                 }
             }
-            mediaList->medias = NULL;
+
+            free(slab);
+        }
+
+        ARDATATRANSFER_MediasCatalog_Unmap(mediaList);
+        ARDATATRANSFER_MediasDownloader_FreeViews(mediaList);
+
+        for (i=0; i<ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_MAX; i++)
+        {
+            ARDATATRANSFER_MediasIndex_Delete(&mediaList->indexes[i]);
         }
 
         mediaList->count = 0;
+        mediaList->capacity = 0;
+        mediaList->directoriesCount = 0;
+        mediaList->directoriesCapacity = 0;
     }
 }
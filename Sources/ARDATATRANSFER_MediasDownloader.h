@@ -38,24 +38,391 @@
 #ifndef _ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIVATE_H_
 #define _ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIVATE_H_
 
+/**
+ * @brief Defines the maximum number of FTP connections downloading the medias queue in parallel
+ * @see ARDATATRANSFER_MediasDownloader_AddQueueWorker ()
+ */
+#define ARDATATRANSFER_MEDIAS_DOWNLOADER_MAX_QUEUE_WORKERS      8
+
+/**
+ * @brief Defines the maximum number of FTP connections listing the medias directories in parallel
+ * @see ARDATATRANSFER_MediasDownloader_AddListWorker ()
+ */
+#define ARDATATRANSFER_MEDIAS_DOWNLOADER_MAX_LIST_WORKERS       4
+
+/**
+ * @brief Defines the expected length of a .META/thumb listing line, to size the thumbnails index
+ * @see ARDATATRANSFER_MediasDownloader_IndexThumbnails ()
+ */
+#define ARDATATRANSFER_MEDIAS_DOWNLOADER_THUMB_LINE_SIZE        100
+
+/**
+ * @brief Defines the number of records of the first slab and of the first medias array of a media list
+ * @see ARDATATRANSFER_MediasDownloader_NewMediaInList (), ARDATATRANSFER_MediasDownloader_AddMediaToList ()
+ */
+#define ARDATATRANSFER_MEDIA_LIST_SIZE                          16
+
+/**
+ * @brief Defines the maximum number of records of a slab, the slabs double up to it
+ * @see ARDATATRANSFER_MediasDownloader_NewMediaInList ()
+ */
+#define ARDATATRANSFER_MEDIA_LIST_SLAB_MAX_SIZE                 256
+
+/**
+ * @brief Defines the minimum duration in ms of a download throughput sample
+ * @see ARDATATRANSFER_MediasDownloader_UpdateRate ()
+ */
+#define ARDATATRANSFER_MEDIAS_DOWNLOADER_RATE_PERIOD_MS         1000
+
+/**
+ * @brief Defines the weight of the last sample in the smoothed download throughput
+ * @see ARDATATRANSFER_MediasDownloader_UpdateRate ()
+ */
+#define ARDATATRANSFER_MEDIAS_DOWNLOADER_RATE_WEIGHT            0.25
+
+/**
+ * @brief Keys of the medias of a media list indexed for the lookups
+ * @see ARDATATRANSFER_MediasDownloader_FindMediaInList ()
+ */
+typedef enum
+{
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_UUID = 0, /**< The uuid of the media, not indexed if empty */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_NAME, /**< The name of the media */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_FILE_PATH, /**< The local file path of the media */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_MAX, /**< Max of the enum, do not use */
+
+} eARDATATRANSFER_MEDIAS_DOWNLOADER_KEY;
+
+/**
+ * @brief Sorted views of the medias of a media list, the descending orders read a view backwards
+ * @see ARDATATRANSFER_MediasDownloader_BuildView ()
+ */
+typedef enum
+{
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_LISTING = 0, /**< The medias not removed, in the listing order */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_DATE, /**< By timestamp, medias without date first */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_SIZE, /**< By size */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_PRODUCT, /**< By product, most recent timestamp first in a product */
+    ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_MAX, /**< Max of the enum, do not use */
+
+} eARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW;
+
+/**
+ * @brief Sort entry of a media while a view is built
+ * @param key The first sort key
+ * @param subKey The second sort key, for the medias of the same key
+ * @param position The position of the media in the medias array, for the medias of the same keys
+ * @see ARDATATRANSFER_MediasDownloader_CompareSortEntries ()
+ */
+typedef struct
+{
+    int64_t key;
+    int64_t subKey;
+    int position;
+
+} ARDATATRANSFER_MediasDownloader_SortEntry_t;
+
+/**
+ * @brief MediasDownloader queue worker structure
+ * @param manager The ARDataTransfer Manager of the worker, set while a Queue Thread is running on it
+ * @param ftpManager The FTP connection of the worker
+ * @param isRunning Is set to 1 if a Queue Thread is running on this worker else 0
+ * @param ftpMedia The media being downloaded by the worker, NULL if none
+ * @param isMediaCanceled Is set to 1 if the download of ftpMedia is canceled else 0
+ * @param media The media of ftpMedia, expanded for the callbacks
+ * @param downloadedBytes The number of bytes of ftpMedia already received
+ * @see ARDATATRANSFER_MediasDownloader_QueueThreadRun ()
+ */
+typedef struct
+{
+    ARDATATRANSFER_Manager_t *manager;
+    ARUTILS_Manager_t *ftpManager;
+    int isRunning;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia;
+    int isMediaCanceled;
+    ARDATATRANSFER_Media_t media;
+    double downloadedBytes;
+
+} ARDATATRANSFER_MediasDownloader_Worker_t;
+
+/**
+ * @brief MediasDownloader in flight statistics, maintained by the queue workers
+ * @param inFlightCount The number of medias being downloaded
+ * @param inFlightBytes The sum of the sizes of the medias being downloaded
+ * @param downloadedBytes The number of bytes of the medias being downloaded already received
+ * @param rateTime The start time of the current throughput sample
+ * @param rateBytes The number of bytes received since rateTime
+ * @param bytesPerSecond The smoothed download throughput, 0 until the first sample
+ */
+typedef struct
+{
+    int inFlightCount;
+    double inFlightBytes;
+    double downloadedBytes;
+    struct timespec rateTime;
+    double rateBytes;
+    double bytesPerSecond;
+
+} ARDATATRANSFER_MediasDownloader_Stats_t;
+
+/**
+ * @brief State of the medias list reuse between listings, protected by listLock
+ * @param ttlMs The time to live of the medias list in milliseconds, 0 if the medias list is not reused
+ * @param isProbed Is set to 1 if the DCIM folder is probed once the TTL is over else 0
+ * @param isValid Is set to 1 once a listing was published else 0
+ * @param listTime The time the medias list was listed or probed
+ * @param filter The filter of the listing
+ * @param withThumbnail The thumbnails option of the listing
+ * @param isProbeable Is set to 1 if the listing found a DCIM folder and no product subfolder else 0
+ * @param probeHash The hash of the DCIM folder listing
+ * @param probeLen The length of the DCIM folder listing
+ * @param probeMinute The newest date of the DCIM subdirectories, to the minute as FTP LIST dates
+ * @param probeMinuteTime The time of the first listing that found probeMinute
+ * @param isProbeSettled Is set to 1 if the last listing was done once the minute of probeMinute was over else 0, only then a probe is trusted
+ * @see ARDATATRANSFER_MediasDownloader_SetCatalogTtl ()
+ */
+typedef struct
+{
+    int ttlMs;
+    int isProbed;
+    int isValid;
+    struct timespec listTime;
+    ARDATATRANSFER_MediasDownloader_Filter_t filter;
+    int withThumbnail;
+    int isProbeable;
+    uint32_t probeHash;
+    uint32_t probeLen;
+    int64_t probeMinute;
+    struct timespec probeMinuteTime;
+    int isProbeSettled;
+
+} ARDATATRANSFER_MediasDownloader_CatalogCache_t;
+
+/**
+ * @brief FTP listing of a medias directory, or fetch of a small file, done by the listing connections
+ * @param remotePath The remote path of the directory or of the file
+ * @param name The name of the directory in the listing of its parent
+ * @param isFile Is set to 1 to fetch the file at remotePath else 0 to list the directory
+ * @param list The listing or the file content, NULL until done
+ * @param listLen The length of the listing or of the file content
+ * @param result The FTP listing result
+ * @param isDone Is set to 1 once the listing is done else 0
+ * @param isTaken Is set to 1 once the listing is returned by ARDATATRANSFER_MediasDownloader_WaitAnyListing else 0
+ * @param isCached Is set to 1 if the file content was read from the thumbnails cache instead of fetched else 0
+ * @see ARDATATRANSFER_MediasDownloader_StartListing ()
+ */
+typedef struct
+{
+    char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
+    char name[ARUTILS_FTP_MAX_PATH_SIZE];
+    int isFile;
+    char *list;
+    uint32_t listLen;
+    eARUTILS_ERROR result;
+    int isDone;
+    int isTaken;
+    int isCached;
+
+} ARDATATRANSFER_MediasDownloader_List_t;
+
+/**
+ * @brief Listing connection of a ListPool, run by its own thread for the downloader lifetime
+ * @param pool The pool of the listings to do
+ * @param ftpManager The FTP connection
+ * @param thread The thread listing on the connection
+ * @see ARDATATRANSFER_MediasDownloader_ListThreadRun ()
+ */
+typedef struct
+{
+    struct _ARDATATRANSFER_MediasDownloader_ListPool_t_ *pool;
+    ARUTILS_Manager_t *ftpManager;
+    ARSAL_Thread_t thread;
+
+} ARDATATRANSFER_MediasDownloader_ListWorker_t;
+
+/**
+ * @brief Listings shared by the listing connections, each connection takes the next listing to do
+ * @param lists The listings, NULL between two waves
+ * @param count The number of listings
+ * @param next The index of the next listing to do
+ * @param activeCount The number of workers going through the listings
+ * @param isStopped Is set to 1 when the workers are to exit else 0
+ * @param lock The mutex to protect the pool
+ * @param doneCond The condition signaled when a listing is done or a worker is done with the listings
+ * @param workSem The semaphore posted to wake the idle workers
+ * @param workers The workers, one for each listing connection but ftpListManager
+ * @param workersCount The number of workers
+ * @see ARDATATRANSFER_MediasDownloader_StartListing ()
+ */
+typedef struct _ARDATATRANSFER_MediasDownloader_ListPool_t_
+{
+    ARDATATRANSFER_MediasDownloader_List_t *lists;
+    int count;
+    int next;
+    int activeCount;
+    int isStopped;
+    ARSAL_Mutex_t lock;
+    ARSAL_Cond_t doneCond;
+    ARSAL_Sem_t workSem;
+    ARDATATRANSFER_MediasDownloader_ListWorker_t workers[ARDATATRANSFER_MEDIAS_DOWNLOADER_MAX_LIST_WORKERS];
+    int workersCount;
+
+} ARDATATRANSFER_MediasDownloader_ListPool_t;
+
+/**
+ * @brief Media record of a media list, the media handed to the application followed by the fields private to the library
+ * @param media The media, first so that the address of the media is the one of its record
+ * @param timestamp The date of the media in seconds since the Epoch, INT64_MIN if the date is unknown
+ * @see ARDATATRANSFER_MediasDownloader_GetMediaRecord ()
+ */
+typedef struct
+{
+    ARDATATRANSFER_Media_t media;
+    int64_t timestamp;
+
+} ARDATATRANSFER_MediaRecord_t;
+
+/**
+ * @brief Slab of media records, the records of a media list are allocated in a chain of slabs
+ * @param next The previously filled slab
+ * @param capacity The number of records of the slab
+ * @param count The number of records used
+ * @param records The records
+ * @see ARDATATRANSFER_MediasDownloader_NewMediaInList ()
+ */
+typedef struct _ARDATATRANSFER_MediaSlab_t_
+{
+    struct _ARDATATRANSFER_MediaSlab_t_ *next;
+    int capacity;
+    int count;
+    ARDATATRANSFER_MediaRecord_t records[];
+
+} ARDATATRANSFER_MediaSlab_t;
+
+/**
+ * @brief Remote directory listed in a media list, to refresh only the directories whose listing changed
+ * @param remotePath The remote path of the directory
+ * @param listHash The hash of the directory listing
+ * @param listLen The length of the directory listing
+ * @param thumbHash The hash of the .META/thumb listing the medias were matched with, 0 if none
+ * @param hasThumbnails Is set to 1 if the thumbnails of the medias were requested else 0
+ * @param filter The filter the medias were selected with, zeroed if none
+ * @param first The index in the media list of the first media of the directory
+ * @param count The number of medias of the directory
+ * @see ARDATATRANSFER_MediasDownloader_AddDirectoryToList ()
+ */
+typedef struct
+{
+    char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
+    uint32_t listHash;
+    uint32_t listLen;
+    uint32_t thumbHash;
+    int hasThumbnails;
+    ARDATATRANSFER_MediasDownloader_Filter_t filter;
+    int first;
+    int count;
+
+} ARDATATRANSFER_MediaDirectory_t;
+
 /**
  * @brief Initialize the MediasDownloader
  * @param medias The pointer address of the media list
  * @param count The number of medias in the media list
+ * @param capacity The number of slots of the medias array, grown geometrically
+ * @param slabs The slabs holding the media records, the current one first
+ * @param directories The directories listed, in the order of their medias
+ * @param directoriesCount The number of directories
+ * @param directoriesCapacity The number of slots of the directories array, grown geometrically
+ * @param mapping The mapping of the catalog file holding the records loaded from it, NULL if none
+ * @param mappingSize The size of the mapping
+ * @param indexes The positions in the medias array by key of eARDATATRANSFER_MEDIAS_DOWNLOADER_KEY, a removed media stays indexed to its NULL slot
+ * @param views The positions in the medias array of the medias not removed by view of eARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW, NULL until built, freed when a media is removed
+ * @param viewsCount The number of positions of each built view
+ * @param isShared Is set to 1 once a listing in progress shares thumbnails of the list, until the listing ends, protected by mediasLock
  * @see ARDATATRANSFER_MediasDownloader_GetAvailableMedias (), ARDATATRANSFER_Media_t
  */
 typedef struct
 {
     ARDATATRANSFER_Media_t **medias;
     int count;
-    
+    int capacity;
+    ARDATATRANSFER_MediaSlab_t *slabs;
+    ARDATATRANSFER_MediaDirectory_t *directories;
+    int directoriesCount;
+    int directoriesCapacity;
+    void *mapping;
+    size_t mappingSize;
+    ARDATATRANSFER_MediasIndex_t indexes[ARDATATRANSFER_MEDIAS_DOWNLOADER_KEY_MAX];
+    int *views[ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_MAX];
+    int viewsCount[ARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW_MAX];
+    int isShared;
+
 } ARDATATRANSFER_MediaList_t;
 
+/**
+ * @brief Listing of the medias in progress, shared by its phases
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param withThumbnail Is set to 1 if the thumbnails of the medias are requested else 0
+ * @param medias The list of medias being built, without mediasLock
+ * @param previousMedias The published list of medias, whose unchanged directories and thumbnails are shared until the listing ends
+ * @param previousIndex The index of the previous medias by remote path
+ * @param thumbIndex The index of the .META/thumb names, see ARDATATRANSFER_MediasDownloader_IndexThumbnails
+ * @param thumbNames The buffer holding the thumbnail names of thumbIndex
+ * @param thumbHash The hash of the .META/thumb listing, 0 if none
+ * @param filter The filter of the medias, zeroed with its padding as the directories compare it as bytes
+ * @param isFiltered Is set to 1 if the filter selects some medias only else 0
+ * @param dcimIndex The index of the DCIM subdirectories holding a media selected by the filter, only if isFiltered
+ * @param dcimNames The buffer holding the names of dcimIndex
+ * @param sectionIndex The index of the recursive listing, empty if none, see ARDATATRANSFER_MediasDownloader_ListRecursive
+ * @param recursiveList The recursive listing holding the keys and values of sectionIndex, NULL if none
+ * @param hasDCIM Is set to 1 if the Device has a DCIM directory else 0
+ * @param dcimHash The hash of the DCIM folder listing
+ * @param dcimLen The length of the DCIM folder listing
+ * @param dcimMinute The newest date of the DCIM subdirectories, INT64_MIN if none, see ARDATATRANSFER_MediasDate_ParseListItem
+ * @param lists The listings of the DCIM subdirectories followed by the ones of the product subfolders
+ * @param listsCount The number of listings
+ * @param dcimCount The number of listings of DCIM subdirectories
+ * @param isListing Is set to 1 while the listings are handed to the listing connections else 0
+ * @param discoveredCallback The media discovered callback, NULL if none
+ * @param discoveredArg The media discovered callback user argument
+ * @param notifiedCount The number of medias already notified
+ * @see ARDATATRANSFER_MediasDownloader_ListMedias ()
+ */
+typedef struct
+{
+    ARDATATRANSFER_Manager_t *manager;
+    int withThumbnail;
+    ARDATATRANSFER_MediaList_t *medias;
+    ARDATATRANSFER_MediaList_t *previousMedias;
+    ARDATATRANSFER_MediasIndex_t previousIndex;
+    ARDATATRANSFER_MediasIndex_t thumbIndex;
+    char *thumbNames;
+    uint32_t thumbHash;
+    ARDATATRANSFER_MediasDownloader_Filter_t filter;
+    int isFiltered;
+    ARDATATRANSFER_MediasIndex_t dcimIndex;
+    char *dcimNames;
+    ARDATATRANSFER_MediasIndex_t sectionIndex;
+    char *recursiveList;
+    int hasDCIM;
+    uint32_t dcimHash;
+    uint32_t dcimLen;
+    int64_t dcimMinute;
+    ARDATATRANSFER_MediasDownloader_List_t *lists;
+    int listsCount;
+    int dcimCount;
+    int isListing;
+    ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t discoveredCallback;
+    void *discoveredArg;
+    int notifiedCount;
+
+} ARDATATRANSFER_MediasDownloader_Listing_t;
+
 /**
  * @brief MediasDownloader structure
  * @param isInitialized Is set to 1 if MediasDownloader initilized else 0
- * @param isRunning Is set to 1 if MediasDownloader Queue Thread is running else 0
- * @param isCanceled Is set to 1 if MediasDownloader Queue Thread is canceled else 0
+ * @param isRunning The number of MediasDownloader Queue Threads running
+ * @param isCanceled Is set to 1 if MediasDownloader Queue Threads are canceled else 0
  * @param isCancelQueued Is set to 1 if MediasDownloader Queue is cancelling all medias else 0
  * @param listFtp The FTP List medias MediasDownloader connection
  * @param ftp The FTP medias body MediasDownloader connection
@@ -64,6 +431,21 @@ typedef struct
  * @param queueSem The semaphore to cancel the DataDownloader Queue
  * @param threadSem The semaphore to cancel the DataDownloader Thread and its FTP connection
  * @param queue The medias queue
+ * @param workers The queue workers, the first one uses the ftpQueueManager connection
+ * @param workersCount The number of queue workers
+ * @param workersLock The mutex to protect the workers access, to take before the queue lock
+ * @param journal The queue journal, enabled by ARDATATRANSFER_MediasDownloader_RestoreQueue
+ * @param stats The in flight statistics, protected by workersLock
+ * @param isCatalogPersistent Is set to 1 if the medias list is written to the catalog file after each listing else 0
+ * @param listManagers The FTP connections listing the medias directories, the first one is ftpListManager
+ * @param listManagersCount The number of listing connections, written under listLock and published with a release store for the readers without it
+ * @param listPool The listings shared by the listing connections
+ * @param listLock The mutex to run one listing at a time, the medias list is built without mediasLock and published at the end, to take before mediasLock
+ * @param recursiveListCallback The recursive listing callback, NULL to list the medias directories one by one, protected by listLock
+ * @param recursiveListArg The recursive listing callback user argument
+ * @param recursiveListSupport Is set to 1 if ftpListManager, the connection of the recursive listings, supports them, 0 if not, -1 until the next recursive listing, reset with the connection
+ * @param isListCanceled Is set to 1 by ARDATATRANSFER_MediasDownloader_CancelGetAvailableMedias until ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias else 0, accessed with relaxed atomics
+ * @param thumbnails The disk cache of the thumbnails, read before the thumbnails are fetched
  * @see ARDATATRANSFER_MediasDownloader_New ()
  */
 typedef struct
@@ -79,6 +461,22 @@ typedef struct
     ARSAL_Mutex_t mediasLock;
     ARDATATRANSFER_MediaList_t medias;
     ARDATATRANSFER_MediasQueue_t queue;
+    ARDATATRANSFER_MediasDownloader_Worker_t workers[ARDATATRANSFER_MEDIAS_DOWNLOADER_MAX_QUEUE_WORKERS];
+    int workersCount;
+    ARSAL_Mutex_t workersLock;
+    ARDATATRANSFER_MediasJournal_t journal;
+    ARDATATRANSFER_MediasDownloader_Stats_t stats;
+    int isCatalogPersistent;
+    ARUTILS_Manager_t *listManagers[ARDATATRANSFER_MEDIAS_DOWNLOADER_MAX_LIST_WORKERS];
+    int listManagersCount;
+    ARDATATRANSFER_MediasDownloader_ListPool_t listPool;
+    ARSAL_Mutex_t listLock;
+    ARDATATRANSFER_MediasDownloader_RecursiveListCallback_t recursiveListCallback;
+    void *recursiveListArg;
+    int recursiveListSupport;
+    ARDATATRANSFER_MediasDownloader_CatalogCache_t catalogCache;
+    int isListCanceled;
+    ARDATATRANSFER_MediasThumbnails_t thumbnails;
 
 } ARDATATRANSFER_MediasDownloader_t;
 
@@ -105,22 +503,347 @@ void ARDATATRANSFER_MediasDownloader_Clear(ARDATATRANSFER_Manager_t *manager);
 
 /**
  * @brief Progress callback of the FtpMedia download
- * @param manager The address of the pointer on the ARDataTransfer Manager
- * @param arg The progress arg (ftpMedia)
+ * @param arg The progress arg (worker)
  * @param percent The percent size of the media file already downloaded
  * @see ARDATATRANSFER_MediasDownloader_DownloadMedia ()
  */
 void ARDATATRANSFER_MediasDownloader_FtpProgressCallback(void* arg, float percent);
 
 /**
- * @brief Download an FTP Media
+ * @brief Call the completion callbacks of an FtpMedia and of the listeners attached to it
+ * @param ftpMedia The FtpMedia, released from the queue
+ * @param media The media of ftpMedia, expanded for the callbacks
+ * @param error The download result
+ * @see ARDATATRANSFER_MediasQueue_Add ()
+ */
+void ARDATATRANSFER_MediasDownloader_NotifyCompletion(ARDATATRANSFER_FtpMedia_t *ftpMedia, ARDATATRANSFER_Media_t *media, eARDATATRANSFER_ERROR error);
+
+/**
+ * @brief Set the download parameters of a new FtpMedia
+ * @param ftpMedia The FtpMedia
+ * @param priority The download priority of the media
+ * @param progressCallback The progress callback for this media download
+ * @param progressArg The progress callback user argument for this media download
+ * @param completionCallback The completion callback for this media download
+ * @param completionArg The completion callback user argument for this media download
+ * @see ARDATATRANSFER_MediasDownloader_AddMediaToQueueWithPriority (), ARDATATRANSFER_MediasDownloader_AddMediasToQueue ()
+ */
+void ARDATATRANSFER_MediasDownloader_InitFtpMedia(ARDATATRANSFER_FtpMedia_t *ftpMedia, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority, ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback, void *progressArg, ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback, void *completionArg);
+
+/**
+ * @brief Download the FTP Media of a queue worker
  * @param manager The address of the pointer on the ARDataTransfer Manager
- * @param ftpMedia The media to be downloaded
- * @param percent The percent size of the media file already downloaded
+ * @param worker The queue worker, with its FtpMedia to be downloaded
  * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
  * @see ARDATATRANSFER_MediasDownloader_FtpProgressCallback ()
  */
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_DownloadMedia(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_FtpMedia_t *ftpMedia);
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_DownloadMedia(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_Worker_t *worker);
+
+/**
+ * @brief Reserve a queue worker not already used by a Queue Thread
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @retval On success, returns the reserved worker. Otherwise, it returns NULL.
+ * @see ARDATATRANSFER_MediasDownloader_QueueThreadRun ()
+ */
+ARDATATRANSFER_MediasDownloader_Worker_t * ARDATATRANSFER_MediasDownloader_AcquireWorker(ARDATATRANSFER_Manager_t *manager);
+
+/**
+ * @brief Release a queue worker reserved by a Queue Thread
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param worker The worker to release
+ * @retval Returns the number of Queue Threads still running
+ * @see ARDATATRANSFER_MediasDownloader_AcquireWorker ()
+ */
+int ARDATATRANSFER_MediasDownloader_ReleaseWorker(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_Worker_t *worker);
+
+/**
+ * @brief Account the start of a worker download in the in flight statistics, called under the workers lock
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param worker The worker, with its popped FtpMedia
+ * @see ARDATATRANSFER_MediasDownloader_GetQueueStats ()
+ */
+void ARDATATRANSFER_MediasDownloader_StartStats(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_Worker_t *worker);
+
+/**
+ * @brief Account the end of a worker download in the in flight statistics, called under the workers lock
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param worker The worker, with its FtpMedia not cleared yet
+ * @see ARDATATRANSFER_MediasDownloader_StartStats ()
+ */
+void ARDATATRANSFER_MediasDownloader_StopStats(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_Worker_t *worker);
+
+/**
+ * @brief Close the current throughput sample if it lasted long enough, called under the workers lock
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param now The current time
+ * @see ARDATATRANSFER_MEDIAS_DOWNLOADER_RATE_PERIOD_MS, ARDATATRANSFER_MEDIAS_DOWNLOADER_RATE_WEIGHT
+ */
+void ARDATATRANSFER_MediasDownloader_UpdateRate(ARDATATRANSFER_Manager_t *manager, struct timespec *now);
+
+/**
+ * @brief Parse the .META/thumb listing once into a hash index of the thumbnail names
+ * @note Each thumbnail is indexed under each of its prefixes ending with a dot, the first listed thumbnail of a prefix is kept, as a prefix search of the listing would find
+ * @warning This function allocates memory
+ * @param thumbIndex The index to create, its values are the thumbnail names
+ * @param metaThumbList The .META/thumb listing
+ * @param metaThumbListLen The length of the listing
+ * @param[out] thumbNames The buffer holding the thumbnail names, to free after the index
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_IndexThumbnails(ARDATATRANSFER_MediasIndex_t *thumbIndex, const char *metaThumbList, uint32_t metaThumbListLen, char **thumbNames);
+
+/**
+ * @brief Initialize the pool of the listing connections, without worker
+ * @param pool The pool
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_AddListThread ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_NewListPool(ARDATATRANSFER_MediasDownloader_ListPool_t *pool);
+
+/**
+ * @brief Stop and join the workers of the pool of the listing connections, then delete the pool
+ * @param pool The pool
+ * @see ARDATATRANSFER_MediasDownloader_NewListPool ()
+ */
+void ARDATATRANSFER_MediasDownloader_DeleteListPool(ARDATATRANSFER_MediasDownloader_ListPool_t *pool);
+
+/**
+ * @brief Start the worker of a listing connection, it waits for the listings of the pool
+ * @param pool The pool
+ * @param ftpManager The listing connection
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_ListThreadRun ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddListThread(ARDATATRANSFER_MediasDownloader_ListPool_t *pool, ARUTILS_Manager_t *ftpManager);
+
+/**
+ * @brief Get the medias list available from the Device, each media being notified as soon as its directory is parsed
+ * @warning This function allocates memory
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param withThumbnail The flag to return thumbnail, 0 no thumbnail is returned, 1 thumbnails are returned
+ * @param discoveredCallback The media discovered callback, NULL if none, called while the new medias list is built
+ * @param discoveredArg The media discovered callback user argument
+ * @param filter The filter of the medias, NULL to select all the medias
+ * @param[out] error The pointer of the error code: if success ARDATATRANSFER_OK, otherwise an error number of eARDATATRANSFER_ERROR
+ * @retval On success, the number of media found else 0.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync (), ARDATATRANSFER_MediasDownloader_GetAvailableMediasStream ()
+ */
+int ARDATATRANSFER_MediasDownloader_ListMedias(ARDATATRANSFER_Manager_t *manager, int withThumbnail, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t discoveredCallback, void *discoveredArg, const ARDATATRANSFER_MediasDownloader_Filter_t *filter, eARDATATRANSFER_ERROR *error);
+
+/**
+ * @brief Check if the medias of a product may match a filter
+ * @param filter The filter
+ * @param product The product
+ * @retval Returns 1 if the product is selected by the filter else 0
+ * @see ARDATATRANSFER_MediasDownloader_IsMediaSelected ()
+ */
+int ARDATATRANSFER_MediasDownloader_IsProductSelected(const ARDATATRANSFER_MediasDownloader_Filter_t *filter, eARDISCOVERY_PRODUCT product);
+
+/**
+ * @brief Check if a media matches a filter
+ * @param filter The filter
+ * @param product The product of the media
+ * @param type The type of the media
+ * @param timestamp The timestamp of the media, INT64_MIN if unknown
+ * @retval Returns 1 if the media is selected by the filter else 0
+ * @see ARDATATRANSFER_MediasDownloader_Filter_t
+ */
+int ARDATATRANSFER_MediasDownloader_IsMediaSelected(const ARDATATRANSFER_MediasDownloader_Filter_t *filter, eARDISCOVERY_PRODUCT product, eARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE type, int64_t timestamp);
+
+/**
+ * @brief Index the DCIM subdirectories holding at least a media selected by a filter, from the .META/thumb listing
+ * @warning This function allocates memory
+ * @param dirIndex The index to create, its keys are the DCIM subdirectory names
+ * @param filter The filter
+ * @param metaThumbList The .META/thumb listing
+ * @param metaThumbListLen The length of the listing
+ * @param[out] dirNames The buffer holding the directory names, to free after the index
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_IndexThumbnails ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SelectDcimDirectories(ARDATATRANSFER_MediasIndex_t *dirIndex, const ARDATATRANSFER_MediasDownloader_Filter_t *filter, const char *metaThumbList, uint32_t metaThumbListLen, char **dirNames);
+
+/**
+ * @brief Check whether the published medias list can be returned instead of listing the Device, probing the DCIM folder once the TTL is over
+ * @note Called under listLock. An unchanged probe is only trusted once the medias list was listed after the minute of the newest DCIM subdirectory date, else the Device is listed.
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param withThumbnail The thumbnails option of the listing
+ * @param filter The filter of the listing, zeroed with its padding
+ * @retval Returns 1 if the medias list is up to date else 0
+ * @see ARDATATRANSFER_MediasDownloader_SetCatalogTtl ()
+ */
+int ARDATATRANSFER_MediasDownloader_IsCatalogCached(ARDATATRANSFER_Manager_t *manager, int withThumbnail, const ARDATATRANSFER_MediasDownloader_Filter_t *filter);
+
+/**
+ * @brief Record the published listing for its reuse
+ * @note Called under listLock
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param withThumbnail The thumbnails option of the listing
+ * @param filter The filter of the listing, zeroed with its padding
+ * @param isProbeable 1 if the listing found a DCIM folder and no product subfolder else 0
+ * @param probeHash The hash of the DCIM folder listing
+ * @param probeLen The length of the DCIM folder listing
+ * @param probeMinute The newest date of the DCIM subdirectories, INT64_MIN if none
+ * @see ARDATATRANSFER_MediasDownloader_IsCatalogCached ()
+ */
+void ARDATATRANSFER_MediasDownloader_CacheCatalog(ARDATATRANSFER_Manager_t *manager, int withThumbnail, const ARDATATRANSFER_MediasDownloader_Filter_t *filter, int isProbeable, uint32_t probeHash, uint32_t probeLen, int64_t probeMinute);
+
+/**
+ * @brief Check whether the medias listing is canceled, without going through the FTP connection
+ * @note Cheap enough for the listing parse loops, the FTP connections are checked between FTP commands
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @retval Returns 1 if the listing is canceled else 0
+ * @see ARDATATRANSFER_MediasDownloader_CancelGetAvailableMedias ()
+ */
+int ARDATATRANSFER_MediasDownloader_IsListCanceled(ARDATATRANSFER_Manager_t *manager);
+
+/**
+ * @brief Notify the medias appended to a medias list since the last notification
+ * @param mediaList The list of medias
+ * @param[in,out] notifiedCount The number of medias of the list already notified
+ * @param discoveredCallback The media discovered callback, NULL if none
+ * @param discoveredArg The media discovered callback user argument
+ * @see ARDATATRANSFER_MediasDownloader_ListMedias ()
+ */
+void ARDATATRANSFER_MediasDownloader_NotifyDiscovered(ARDATATRANSFER_MediaList_t *mediaList, int *notifiedCount, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t discoveredCallback, void *discoveredArg);
+
+/**
+ * @brief Hand medias directories to list to the workers of the pool, waking one for each listing but the first
+ * @note The caller lists on ftpListManager while it waits for a listing
+ * @param pool The pool of the listing connections
+ * @param lists The listings to do, zeroed but their paths and names, or already done
+ * @param count The number of listings
+ * @see ARDATATRANSFER_MediasDownloader_WaitListing (), ARDATATRANSFER_MediasDownloader_StopListing ()
+ */
+void ARDATATRANSFER_MediasDownloader_StartListing(ARDATATRANSFER_MediasDownloader_ListPool_t *pool, ARDATATRANSFER_MediasDownloader_List_t *lists, int count);
+
+/**
+ * @brief Wait for a listing of a started pool to be done, doing the pending listings meanwhile
+ * @param pool The started pool
+ * @param index The index of the listing
+ * @param ftpManager The FTP connection of the caller
+ * @see ARDATATRANSFER_MediasDownloader_StartListing ()
+ */
+void ARDATATRANSFER_MediasDownloader_WaitListing(ARDATATRANSFER_MediasDownloader_ListPool_t *pool, int index, ARUTILS_Manager_t *ftpManager);
+
+/**
+ * @brief Wait for any listing of a started pool not returned yet to be done, doing the pending listings meanwhile
+ * @param pool The started pool
+ * @param ftpManager The FTP connection of the caller
+ * @retval Returns the index of the listing, set as taken, -1 if all listings were returned
+ * @see ARDATATRANSFER_MediasDownloader_WaitListing ()
+ */
+int ARDATATRANSFER_MediasDownloader_WaitAnyListing(ARDATATRANSFER_MediasDownloader_ListPool_t *pool, ARUTILS_Manager_t *ftpManager);
+
+/**
+ * @brief Stop a started pool, the pending listings are not done and the listings are released once the workers are idle
+ * @param pool The started pool
+ * @see ARDATATRANSFER_MediasDownloader_StartListing ()
+ */
+void ARDATATRANSFER_MediasDownloader_StopListing(ARDATATRANSFER_MediasDownloader_ListPool_t *pool);
+
+/**
+ * @brief List medias directories in parallel over the listing connections
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param lists The listings to do, the listing result of each one is set
+ * @param count The number of listings
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_StartListing ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ListDirectories(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_List_t *lists, int count);
+
+/**
+ * @brief Do the next pending listing of a pool, the listings already done are skipped
+ * @param pool The started pool
+ * @param ftpManager The FTP connection to list on
+ * @retval Returns 1 if a listing was done, 0 if none is pending
+ * @see ARDATATRANSFER_MediasDownloader_ListThreadRun ()
+ */
+int ARDATATRANSFER_MediasDownloader_RunListing(ARDATATRANSFER_MediasDownloader_ListPool_t *pool, ARUTILS_Manager_t *ftpManager);
+
+/**
+ * @brief Worker of a listing connection, on each wake up it does the listings of its ListPool until there is none left
+ * @param workerArg The ListWorker
+ * @retval Returns NULL
+ * @see ARDATATRANSFER_MediasDownloader_StartListing ()
+ */
+void* ARDATATRANSFER_MediasDownloader_ListThreadRun(void *workerArg);
+
+/**
+ * @brief List the medias directory tree with the recursive listing callback and index the listing of each directory
+ * @warning This function allocates memory
+ * @note Nothing is indexed if the recursive listing is not set or not supported. The first recursive listing that fails or has no subdirectory header marks it as not supported until ftpListManager is reset, its flat output is still indexed as the listing of the remote directory
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param sectionIndex The index to create, its keys are the directory paths relative to the remote directory, its values the directory listings
+ * @param[out] recursiveList The recursive listing holding the keys and the directory listings, to free after the index
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_TakeRecursiveList ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ListRecursive(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasIndex_t *sectionIndex, char **recursiveList);
+
+/**
+ * @brief Get the path of a directory relative to the remote directory
+ * @param remoteDirectory The remote directory
+ * @param path The path, absolute, relative to the remote directory, or starting with it or with "./"
+ * @param[out] pathLen The length of the relative path, without its trailing slashes
+ * @retval Returns the relative path, in path
+ * @see ARDATATRANSFER_MediasDownloader_ListRecursive ()
+ */
+const char * ARDATATRANSFER_MediasDownloader_GetRelativePath(const char *remoteDirectory, const char *path, int *pathLen);
+
+/**
+ * @brief Copy the listing of a directory from an indexed recursive listing
+ * @warning This function allocates memory
+ * @param sectionIndex The index of the recursive listing
+ * @param remoteDirectory The remote directory
+ * @param remotePath The remote path of the directory
+ * @param[out] list The allocated listing
+ * @param[out] listLen The length of the listing
+ * @retval Returns 1 if the directory listing was copied, else 0 and it is to be listed
+ * @see ARDATATRANSFER_MediasDownloader_ListRecursive ()
+ */
+int ARDATATRANSFER_MediasDownloader_TakeRecursiveList(ARDATATRANSFER_MediasIndex_t *sectionIndex, const char *remoteDirectory, const char *remotePath, char **list, uint32_t *listLen);
+
+/**
+ * @brief Set the listings found in an indexed recursive listing as done, ListPool skips them
+ * @param sectionIndex The index of the recursive listing
+ * @param remoteDirectory The remote directory
+ * @param lists The listings, zeroed but their paths and names
+ * @param count The number of listings
+ * @see ARDATATRANSFER_MediasDownloader_TakeRecursiveList (), ARDATATRANSFER_MediasDownloader_RunListing ()
+ */
+void ARDATATRANSFER_MediasDownloader_TakeRecursiveLists(ARDATATRANSFER_MediasIndex_t *sectionIndex, const char *remoteDirectory, ARDATATRANSFER_MediasDownloader_List_t *lists, int count);
+
+/**
+ * @brief Fetch the thumbnails of medias in parallel over the listing connections and notify each one as it is set
+ * @note The cached thumbnails are read first, the fetched ones are written to the cache
+ * @warning This function allocates memory
+ * @note Called under listLock, the pool of the listing connections being the one of the medias listing
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param lists The thumbnail fetches, remotePath set to the remote thumbnail of the media
+ * @param indexes The index of the media of each fetch in the medias list
+ * @param mediaSizes The size of the media of each fetch
+ * @param count The number of fetches
+ * @param isOrdered 1 to notify in the order of the fetches, 0 as soon as each one is done
+ * @param availableMediaCallback The available media callback
+ * @param availableMediaArg The pointer of the user custom argument
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsyncWithOrder ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_FetchThumbnails(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_List_t *lists, int *indexes, double *mediaSizes, int count, int isOrdered, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t availableMediaCallback, void *availableMediaArg);
+
+/**
+ * @brief Set a fetched thumbnail to its media of the medias list and notify it
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param list The done thumbnail fetch, its content is taken
+ * @param index The index of the media in the medias list
+ * @param availableMediaCallback The available media callback
+ * @param availableMediaArg The pointer of the user custom argument
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_FetchThumbnails ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_SetFetchedThumbnail(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasDownloader_List_t *list, int index, ARDATATRANSFER_MediasDownloader_AvailableMediaCallback_t availableMediaCallback, void *availableMediaArg);
 
 /**
  * @brief Remove a media from the medias list
@@ -139,7 +862,229 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_RemoveMediaFromMediaList(A
 eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ResetQueueThread(ARDATATRANSFER_Manager_t *manager);
 
 /**
- * @brief Free a medias list
+ * @brief Allocate a zeroed media record in the slabs of a medias list
+ * @warning This function allocates memory
+ * @param mediaList The list of medias
+ * @retval On success, returns the media record, freed with the list. Otherwise, it returns NULL.
+ * @see ARDATATRANSFER_MediasDownloader_AddMediaToList ()
+ */
+ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_NewMediaInList(ARDATATRANSFER_MediaList_t *mediaList);
+
+/**
+ * @brief Get the record of a media of a medias list
+ * @warning The media must be one of a medias list, allocated by ARDATATRANSFER_MediasDownloader_NewMediaInList or loaded from the catalog
+ * @param media The media
+ * @retval Returns the record of the media
+ * @see ARDATATRANSFER_MediaRecord_t
+ */
+ARDATATRANSFER_MediaRecord_t * ARDATATRANSFER_MediasDownloader_GetMediaRecord(ARDATATRANSFER_Media_t *media);
+
+/**
+ * @brief Append a directory to a medias list, the medias appended next belong to it
+ * @warning This function allocates memory
+ * @param mediaList The list of medias
+ * @param remotePath The remote path of the directory
+ * @param listHash The hash of the directory listing
+ * @param listLen The length of the directory listing
+ * @param thumbHash The hash of the .META/thumb listing the medias are matched with, 0 if none
+ * @param hasThumbnails Is set to 1 if the thumbnails of the medias are requested else 0
+ * @param filter The filter the medias are selected with, zeroed if none
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediaDirectory_t
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddDirectoryToList(ARDATATRANSFER_MediaList_t *mediaList, const char *remotePath, uint32_t listHash, uint32_t listLen, uint32_t thumbHash, int hasThumbnails, const ARDATATRANSFER_MediasDownloader_Filter_t *filter);
+
+/**
+ * @brief Find a directory of a previous medias list whose listing did not change
+ * @param mediaList The previous list of medias
+ * @param remotePath The remote path of the directory
+ * @param listHash The hash of the new directory listing
+ * @param listLen The length of the new directory listing
+ * @param thumbHash The hash of the new .META/thumb listing the medias are matched with, 0 if none
+ * @param withThumbnail Is set to 1 if the thumbnails of the medias are requested else 0
+ * @param filter The filter the medias are selected with, zeroed if none, the directory must have been listed with the same one
+ * @retval Returns the unchanged directory, NULL if the directory is not listed or changed
+ * @see ARDATATRANSFER_MediasDownloader_CopyDirectory ()
+ */
+ARDATATRANSFER_MediaDirectory_t * ARDATATRANSFER_MediasDownloader_FindUnchangedDirectory(ARDATATRANSFER_MediaList_t *mediaList, const char *remotePath, uint32_t listHash, uint32_t listLen, uint32_t thumbHash, int withThumbnail, const ARDATATRANSFER_MediasDownloader_Filter_t *filter);
+
+/**
+ * @brief Append an unchanged directory of a previous medias list and its medias to a medias list, the thumbnails are shared
+ * @warning This function allocates memory
+ * @warning The previous list must be locked
+ * @param mediaList The list of medias
+ * @param previousList The previous list of medias
+ * @param directory The unchanged directory of the previous list
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_FindUnchangedDirectory ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_CopyDirectory(ARDATATRANSFER_MediaList_t *mediaList, ARDATATRANSFER_MediaList_t *previousList, ARDATATRANSFER_MediaDirectory_t *directory);
+
+/**
+ * @brief Get the thumbnail of a listed media, shared with the previous listing if it is the same media, else read from the cache or downloaded
+ * @note The previous listing is locked while its thumbnail is looked up, not while a thumbnail is downloaded
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param previousIndex The index of the previous medias by remote path
+ * @param media The listed media
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_GetThumbnail ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_RefreshThumbnail(ARDATATRANSFER_Manager_t *manager, ARDATATRANSFER_MediasIndex_t *previousIndex, ARDATATRANSFER_Media_t *media);
+
+/**
+ * @brief List .META/thumb and DCIM/ together, index the thumbnails and add the listings of the DCIM subdirectories to do
+ * @warning This function allocates memory
+ * @param listing The listing in progress
+ * @param productFtpList The listing of the remote directory
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_ParseDcim ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ListDcim(ARDATATRANSFER_MediasDownloader_Listing_t *listing, const char *productFtpList);
+
+/**
+ * @brief Parse the listed DCIM subdirectories that changed, in the DCIM listing order
+ * @param listing The listing in progress
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_ParseDcimDirectory ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ParseDcim(ARDATATRANSFER_MediasDownloader_Listing_t *listing);
+
+/**
+ * @brief Append the medias of a DCIM subdirectory listing to the medias being listed
+ * @param listing The listing in progress
+ * @param dirName The name of the DCIM subdirectory
+ * @param mediaFtpList The listing of the subdirectory
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_ParseDcim ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ParseDcimDirectory(ARDATATRANSFER_MediasDownloader_Listing_t *listing, const char *dirName, const char *mediaFtpList);
+
+/**
+ * @brief Add the listings of the product subfolders to do, after the DCIM subdirectories
+ * @param listing The listing in progress
+ * @param productFtpList The listing of the remote directory
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_ParseProducts ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ListProducts(ARDATATRANSFER_MediasDownloader_Listing_t *listing, const char *productFtpList);
+
+/**
+ * @brief Parse the listed product subfolders that changed, in the product order
+ * @param listing The listing in progress
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_ParseProductDirectory ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ParseProducts(ARDATATRANSFER_MediasDownloader_Listing_t *listing);
+
+/**
+ * @brief Append the medias of a product subfolder listing to the medias being listed
+ * @param listing The listing in progress
+ * @param product The product of the subfolder
+ * @param productPathName The name of the product subfolder
+ * @param mediaFtpList The listing of the subfolder
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_ParseProducts ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ParseProductDirectory(ARDATATRANSFER_MediasDownloader_Listing_t *listing, int product, const char *productPathName, const char *mediaFtpList);
+
+/**
+ * @brief End a listing, its medias list replaces the published one at once or is dropped, then the list that is not published is freed
+ * @param listing The listing in progress, its medias list is emptied
+ * @param isPublished Is set to 1 if the listing succeeded and its medias list is to publish, else 0
+ * @see ARDATATRANSFER_MediasDownloader_SettleThumbnails ()
+ */
+void ARDATATRANSFER_MediasDownloader_PublishListing(ARDATATRANSFER_MediasDownloader_Listing_t *listing, int isPublished);
+
+/**
+ * @brief Append a listed directory to the medias being listed, with its previous medias if its listing did not change
+ * @param listing The listing in progress
+ * @param remotePath The remote path of the directory
+ * @param list The listing of the directory
+ * @param listLen The length of the listing
+ * @param thumbHash The hash of the .META/thumb listing the medias are matched with, 0 if none
+ * @param[out] isReused Is set to 1 if the previous medias were copied, else 0 and the listing is to parse
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_FindUnchangedDirectory (), ARDATATRANSFER_MediasDownloader_CopyDirectory ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_ReuseDirectory(ARDATATRANSFER_MediasDownloader_Listing_t *listing, const char *remotePath, const char *list, uint32_t listLen, uint32_t thumbHash, int *isReused);
+
+/**
+ * @brief Give each thumbnail shared by a new medias list and the previous one to a single list, before the other list is freed
+ * @param mediaList The new list of medias
+ * @param previousIndex The index of the previous medias by remote path
+ * @param isPublished Is set to 1 if the new list replaces the previous one, which drops the shared thumbnails, else 0 and the new list drops them
+ * @see ARDATATRANSFER_MediasDownloader_CopyDirectory (), ARDATATRANSFER_MediasDownloader_RefreshThumbnail ()
+ */
+void ARDATATRANSFER_MediasDownloader_SettleThumbnails(ARDATATRANSFER_MediaList_t *mediaList, ARDATATRANSFER_MediasIndex_t *previousIndex, int isPublished);
+
+/**
+ * @brief Append a media record to a medias list, the medias array grows geometrically
+ * @warning This function allocates memory
+ * @param mediaList The list of medias
+ * @param media The media record, allocated by ARDATATRANSFER_MediasDownloader_NewMediaInList
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_NewMediaInList ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_AddMediaToList(ARDATATRANSFER_MediaList_t *mediaList, ARDATATRANSFER_Media_t *media);
+
+/**
+ * @brief Get a key of a media record
+ * @param media The media record
+ * @param key The key
+ * @retval Returns the key string of the media
+ * @see ARDATATRANSFER_MediasDownloader_FindMediaInList ()
+ */
+const char * ARDATATRANSFER_MediasDownloader_GetMediaKey(ARDATATRANSFER_Media_t *media, eARDATATRANSFER_MEDIAS_DOWNLOADER_KEY key);
+
+/**
+ * @brief Find the position of a media in a medias list by one of its keys
+ * @param mediaList The list of medias
+ * @param key The key to look up
+ * @param value The value of the key
+ * @retval Returns the position of the media in the medias array, -1 if it is not listed or removed
+ * @see ARDATATRANSFER_MediasDownloader_AddMediaToList ()
+ */
+int ARDATATRANSFER_MediasDownloader_FindMediaInList(ARDATATRANSFER_MediaList_t *mediaList, eARDATATRANSFER_MEDIAS_DOWNLOADER_KEY key, const char *value);
+
+/**
+ * @brief Get a media of the medias list by one of its keys
+ * @param manager The pointer of the ARDataTransfer Manager
+ * @param key The key to look up
+ * @param value The value of the key
+ * @param[out] error The pointer of the error code: if success ARDATATRANSFER_OK, otherwise an error number of eARDATATRANSFER_ERROR
+ * @retval On success, the adresse of the media found else null.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediaByUuid ()
+ */
+ARDATATRANSFER_Media_t * ARDATATRANSFER_MediasDownloader_GetAvailableMediaByKey(ARDATATRANSFER_Manager_t *manager, eARDATATRANSFER_MEDIAS_DOWNLOADER_KEY key, const char *value, eARDATATRANSFER_ERROR *error);
+
+/**
+ * @brief Build a sorted view of a medias list, sorting the medias not removed
+ * @warning This function allocates memory
+ * @param mediaList The list of medias
+ * @param view The view to build
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasPage ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasDownloader_BuildView(ARDATATRANSFER_MediaList_t *mediaList, eARDATATRANSFER_MEDIAS_DOWNLOADER_VIEW view);
+
+/**
+ * @brief Compare two sort entries by key, sub key and position, qsort compare function
+ * @param first The first ARDATATRANSFER_MediasDownloader_SortEntry_t
+ * @param second The second ARDATATRANSFER_MediasDownloader_SortEntry_t
+ * @retval Returns a negative value if first is sorted before second, else a positive value
+ * @see ARDATATRANSFER_MediasDownloader_BuildView ()
+ */
+int ARDATATRANSFER_MediasDownloader_CompareSortEntries(const void *first, const void *second);
+
+/**
+ * @brief Free the sorted views of a medias list, to build them again after a media is removed
+ * @param mediaList The list of medias
+ * @see ARDATATRANSFER_MediasDownloader_BuildView ()
+ */
+void ARDATATRANSFER_MediasDownloader_FreeViews(ARDATATRANSFER_MediaList_t *mediaList);
+
+/**
+ * @brief Free a medias list, its thumbnails, its slabs, its directories, its indexes and its views
  * @param mediaList The list of medias
  * @see ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync ()
  */
@@ -0,0 +1,228 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARDATATRANSFER_MediasIndex.c
+ * @brief libARDataTransfer MediasIndex c file.
+ **/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libARSAL/ARSAL_Print.h>
+
+#include "libARDataTransfer/ARDATATRANSFER_Error.h"
+#include "ARDATATRANSFER_MediasIndex.h"
+
+#define ARDATATRANSFER_MEDIASINDEX_TAG          "MediasIndex"
+
+/*****************************************
+ *
+ *             Private implementation:
+ *
+ *****************************************/
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasIndex_New(ARDATATRANSFER_MediasIndex_t *index, int count)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int capacity = ARDATATRANSFER_MEDIAS_INDEX_SIZE;
+
+    if ((index == NULL) || (count < 0))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        memset(index, 0, sizeof(ARDATATRANSFER_MediasIndex_t));
+
+        while (capacity < (2 * count))
+        {
+            capacity *= 2;
+        }
+
+        index->entries = (ARDATATRANSFER_MediasIndexEntry_t *)calloc(capacity, sizeof(ARDATATRANSFER_MediasIndexEntry_t));
+
+        if (index->entries == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_ALLOC;
+        }
+        else
+        {
+            index->capacity = capacity;
+        }
+    }
+
+    return result;
+}
+
+void ARDATATRANSFER_MediasIndex_Delete(ARDATATRANSFER_MediasIndex_t *index)
+{
+    if (index != NULL)
+    {
+        free(index->entries);
+        index->entries = NULL;
+        index->capacity = 0;
+        index->count = 0;
+    }
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasIndex_Add(ARDATATRANSFER_MediasIndex_t *index, const char *key, int keyLen, void *value)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    ARDATATRANSFER_MediasIndexEntry_t *entry = NULL;
+    uint32_t hash = 0;
+    uint32_t mask;
+
+    if ((index == NULL) || (index->entries == NULL) || (key == NULL) || (keyLen < 0))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if ((result == ARDATATRANSFER_OK) && ((2 * (index->count + 1)) > index->capacity))
+    {
+        result = ARDATATRANSFER_MediasIndex_Grow(index);
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        hash = ARDATATRANSFER_MediasIndex_Hash(key, keyLen);
+        mask = (uint32_t)index->capacity - 1;
+        entry = &index->entries[hash & mask];
+
+        // Linear probing up to a free slot or to the same key
+        while ((entry->key != NULL)
+               && ((entry->hash != hash) || (entry->keyLen != keyLen) || (memcmp(entry->key, key, keyLen) != 0)))
+        {
+            entry = &index->entries[(entry - index->entries + 1) & mask];
+        }
+
+        if (entry->key == NULL)
+        {
+            entry->key = key;
+            entry->keyLen = keyLen;
+            entry->hash = hash;
+            entry->value = value;
+            index->count++;
+        }
+    }
+
+    return result;
+}
+
+void * ARDATATRANSFER_MediasIndex_Find(ARDATATRANSFER_MediasIndex_t *index, const char *key, int keyLen)
+{
+    ARDATATRANSFER_MediasIndexEntry_t *entry = NULL;
+    void *value = NULL;
+    uint32_t hash;
+    uint32_t mask;
+
+    if ((index != NULL) && (index->entries != NULL) && (key != NULL) && (keyLen >= 0))
+    {
+        hash = ARDATATRANSFER_MediasIndex_Hash(key, keyLen);
+        mask = (uint32_t)index->capacity - 1;
+        entry = &index->entries[hash & mask];
+
+        while ((entry->key != NULL) && (value == NULL))
+        {
+            if ((entry->hash == hash) && (entry->keyLen == keyLen) && (memcmp(entry->key, key, keyLen) == 0))
+            {
+                value = entry->value;
+            }
+            else
+            {
+                entry = &index->entries[(entry - index->entries + 1) & mask];
+            }
+        }
+    }
+
+    return value;
+}
+
+uint32_t ARDATATRANSFER_MediasIndex_Hash(const char *key, int keyLen)
+{
+    uint32_t hash = 2166136261u;
+    int i;
+
+    for (i=0; i<keyLen; i++)
+    {
+        hash ^= (uint8_t)key[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasIndex_Grow(ARDATATRANSFER_MediasIndex_t *index)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    ARDATATRANSFER_MediasIndexEntry_t *entries;
+    ARDATATRANSFER_MediasIndexEntry_t *entry;
+    uint32_t mask;
+    int capacity;
+    int i;
+
+    capacity = index->capacity * 2;
+    entries = (ARDATATRANSFER_MediasIndexEntry_t *)calloc(capacity, sizeof(ARDATATRANSFER_MediasIndexEntry_t));
+
+    if (entries == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_ALLOC;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASINDEX_TAG, "%d", capacity);
+
+        mask = (uint32_t)capacity - 1;
+
+        for (i=0; i<index->capacity; i++)
+        {
+            if (index->entries[i].key != NULL)
+            {
+                entry = &entries[index->entries[i].hash & mask];
+
+                while (entry->key != NULL)
+                {
+                    entry = &entries[(entry - entries + 1) & mask];
+                }
+
+                *entry = index->entries[i];
+            }
+        }
+
+        free(index->entries);
+        index->entries = entries;
+        index->capacity = capacity;
+    }
+
+    return result;
+}
@@ -0,0 +1,134 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARDATATRANSFER_MediasIndex.h
+ * @brief libARDataTransfer MediasIndex header file, a hash index of strings used to match the listed medias.
+ **/
+
+#ifndef _ARDATATRANSFER_MEDIASINDEX_PRIVATE_H_
+#define _ARDATATRANSFER_MEDIASINDEX_PRIVATE_H_
+
+/**
+ * @brief Defines the minimum number of slots of a MediasIndex
+ * @see ARDATATRANSFER_MediasIndex_New ()
+ */
+#define ARDATATRANSFER_MEDIAS_INDEX_SIZE            64
+
+/**
+ * @brief MediasIndex entry structure
+ * @param key The indexed string, not owned by the index, NULL if the slot is free
+ * @param keyLen The length of the key, the key needs not to be null terminated
+ * @param hash The hash of the key
+ * @param value The value indexed by the key
+ * @see ARDATATRANSFER_MediasIndex_t
+ */
+typedef struct
+{
+    const char *key;
+    int keyLen;
+    uint32_t hash;
+    void *value;
+
+} ARDATATRANSFER_MediasIndexEntry_t;
+
+/**
+ * @brief MediasIndex structure, an open addressing hash table of strings, grown to stay at most half full
+ * @param entries The slots of the index
+ * @param capacity The number of slots, a power of 2
+ * @param count The number of keys indexed
+ * @see ARDATATRANSFER_MediasIndex_New ()
+ */
+typedef struct _ARDATATRANSFER_MediasIndex_t_
+{
+    ARDATATRANSFER_MediasIndexEntry_t *entries;
+    int capacity;
+    int count;
+
+} ARDATATRANSFER_MediasIndex_t;
+
+/**
+ * @brief Create a new ARDataTransfer MediasIndex
+ * @warning This function allocates memory
+ * @param index The address of the pointer on the ARDataTransfer MediasIndex
+ * @param count The number of keys expected, the index grows beyond it
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasIndex_Delete ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasIndex_New(ARDATATRANSFER_MediasIndex_t *index, int count);
+
+/**
+ * @brief Delete an ARDataTransfer MediasIndex, the keys and values are not freed
+ * @warning This function frees memory
+ * @param index The address of the pointer on the ARDataTransfer MediasIndex
+ * @see ARDATATRANSFER_MediasIndex_New ()
+ */
+void ARDATATRANSFER_MediasIndex_Delete(ARDATATRANSFER_MediasIndex_t *index);
+
+/**
+ * @brief Add a key to the ARDataTransfer MediasIndex, if the key is already indexed its first value is kept
+ * @warning This function allocates memory
+ * @param index The address of the pointer on the ARDataTransfer MediasIndex
+ * @param key The key, it must stay valid while indexed
+ * @param keyLen The length of the key
+ * @param value The value indexed by the key
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasIndex_Find ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasIndex_Add(ARDATATRANSFER_MediasIndex_t *index, const char *key, int keyLen, void *value);
+
+/**
+ * @brief Find the value of a key in the ARDataTransfer MediasIndex
+ * @param index The address of the pointer on the ARDataTransfer MediasIndex
+ * @param key The key
+ * @param keyLen The length of the key
+ * @retval Returns the value indexed by the key, NULL if the key is not indexed
+ * @see ARDATATRANSFER_MediasIndex_Add ()
+ */
+void * ARDATATRANSFER_MediasIndex_Find(ARDATATRANSFER_MediasIndex_t *index, const char *key, int keyLen);
+
+/**
+ * @brief Hash a key of the ARDataTransfer MediasIndex (FNV-1a)
+ * @param key The key
+ * @param keyLen The length of the key
+ * @retval Returns the hash of the key
+ */
+uint32_t ARDATATRANSFER_MediasIndex_Hash(const char *key, int keyLen);
+
+/**
+ * @brief Double the number of slots of the ARDataTransfer MediasIndex and reinsert its keys
+ * @warning This function allocates memory
+ * @param index The address of the pointer on the ARDataTransfer MediasIndex
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasIndex_Add ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasIndex_Grow(ARDATATRANSFER_MediasIndex_t *index);
+
+#endif /* _ARDATATRANSFER_MEDIASINDEX_PRIVATE_H_ */
@@ -0,0 +1,425 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARDATATRANSFER_MediasJournal.c
+ * @brief libARDataTransfer MediasJournal c file.
+ * The journal is a text file of tab separated records, one per line:
+ * "A <priority> <product> <size> <name> <filePath> <date> <uuid> <remotePath> <remoteThumb>" when a media is queued,
+ * "D <remotePath>" when it is downloaded or canceled.
+ **/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <libARSAL/ARSAL_Mutex.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARUtils/ARUTILS_Error.h>
+#include <libARUtils/ARUTILS_Manager.h>
+#include <libARUtils/ARUTILS_Ftp.h>
+#include <libARDiscovery/ARDISCOVERY_Discovery.h>
+
+#include "libARDataTransfer/ARDATATRANSFER_Error.h"
+#include "libARDataTransfer/ARDATATRANSFER_Manager.h"
+#include "libARDataTransfer/ARDATATRANSFER_DataDownloader.h"
+#include "libARDataTransfer/ARDATATRANSFER_MediasDownloader.h"
+#include "ARDATATRANSFER_MediasQueue.h"
+#include "ARDATATRANSFER_MediasJournal.h"
+
+#define ARDATATRANSFER_MEDIASJOURNAL_TAG        "MediasJournal"
+
+#define ARDATATRANSFER_MEDIASJOURNAL_ADD        'A'
+#define ARDATATRANSFER_MEDIASJOURNAL_DONE       'D'
+#define ARDATATRANSFER_MEDIASJOURNAL_FIELDS     10
+#define ARDATATRANSFER_MEDIASJOURNAL_TMP_EXT    ".tmp"
+
+/*****************************************
+ *
+ *             Private implementation:
+ *
+ *****************************************/
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasJournal_New(ARDATATRANSFER_MediasJournal_t *journal)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int resultSys = 0;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASJOURNAL_TAG, "%s", "");
+
+    if (journal == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        memset(journal, 0, sizeof(ARDATATRANSFER_MediasJournal_t));
+
+        resultSys = ARSAL_Mutex_Init(&journal->lock);
+
+        if (resultSys != 0)
+        {
+            result = ARDATATRANSFER_ERROR_SYSTEM;
+        }
+    }
+
+    return result;
+}
+
+void ARDATATRANSFER_MediasJournal_Delete(ARDATATRANSFER_MediasJournal_t *journal)
+{
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASJOURNAL_TAG, "%s", "");
+
+    if (journal != NULL)
+    {
+        if (journal->file != NULL)
+        {
+            fclose(journal->file);
+            journal->file = NULL;
+        }
+
+        ARSAL_Mutex_Destroy(&journal->lock);
+    }
+}
+
+int ARDATATRANSFER_MediasJournal_Restore(ARDATATRANSFER_MediasJournal_t *journal, const char *localDirectory, ARDATATRANSFER_FtpMedia_t ***ftpMedias, eARDATATRANSFER_ERROR *error)
+{
+    char line[ARDATATRANSFER_MEDIAS_JOURNAL_LINE_SIZE];
+    char tmpPath[ARUTILS_FTP_MAX_PATH_SIZE];
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    eARDATATRANSFER_ERROR resultQueue = ARDATATRANSFER_OK;
+    ARDATATRANSFER_MediasQueue_t pending;
+    ARDATATRANSFER_Media_t media;
+    eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority;
+    ARDATATRANSFER_FtpMedia_t **medias = NULL;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia = NULL;
+    FILE *file = NULL;
+    char *remotePath;
+    int isAttached = 0;
+    int isPendingNew = 0;
+    int count = 0;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASJOURNAL_TAG, "%s", localDirectory ? localDirectory : "null");
+
+    if ((journal == NULL) || (localDirectory == NULL) || (ftpMedias == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        result = ARDATATRANSFER_MediasQueue_New(&pending);
+        isPendingNew = (result == ARDATATRANSFER_OK) ? 1 : 0;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&journal->lock);
+
+        if (journal->file != NULL)
+        {
+            fclose(journal->file);
+            journal->file = NULL;
+        }
+
+        strncpy(journal->path, localDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        journal->path[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(journal->path, ARDATATRANSFER_MEDIAS_JOURNAL_FILE_NAME, ARUTILS_FTP_MAX_PATH_SIZE - strlen(journal->path) - 1);
+
+        // Replay the records, the pending queue coalesces the medias queued twice
+        file = fopen(journal->path, "r");
+
+        while ((result == ARDATATRANSFER_OK) && (file != NULL) && (fgets(line, ARDATATRANSFER_MEDIAS_JOURNAL_LINE_SIZE, file) != NULL))
+        {
+            line[strcspn(line, "\n")] = '\0';
+
+            if ((line[0] == ARDATATRANSFER_MEDIASJOURNAL_ADD) && (line[1] == '\t'))
+            {
+                if (ARDATATRANSFER_MediasJournal_ParseRecord(&line[2], &media, &priority) != 0)
+                {
+                    ARSAL_PRINT(ARSAL_PRINT_WARNING, ARDATATRANSFER_MEDIASJOURNAL_TAG, "skip record %s", line);
+                }
+                else
+                {
+                    ftpMedia = ARDATATRANSFER_MediasQueue_NewMedia(&media);
+
+                    if (ftpMedia == NULL)
+                    {
+                        result = ARDATATRANSFER_ERROR_ALLOC;
+                    }
+                    else
+                    {
+                        ftpMedia->priority = priority;
+                        result = ARDATATRANSFER_MediasQueue_Add(&pending, ftpMedia, &isAttached);
+
+                        if (result != ARDATATRANSFER_OK)
+                        {
+                            free(ftpMedia);
+                        }
+                    }
+                }
+                ftpMedia = NULL;
+            }
+            else if ((line[0] == ARDATATRANSFER_MEDIASJOURNAL_DONE) && (line[1] == '\t'))
+            {
+                remotePath = &line[2];
+                ftpMedia = ARDATATRANSFER_MediasQueue_Remove(&pending, remotePath, &resultQueue);
+                ARDATATRANSFER_MediasQueue_FreeMedia(ftpMedia);
+                ftpMedia = NULL;
+            }
+        }
+
+        if (file != NULL)
+        {
+            fclose(file);
+            file = NULL;
+        }
+
+        if ((result == ARDATATRANSFER_OK) && (pending.count > 0))
+        {
+            medias = (ARDATATRANSFER_FtpMedia_t **)calloc(pending.count, sizeof(ARDATATRANSFER_FtpMedia_t *));
+
+            if (medias == NULL)
+            {
+                result = ARDATATRANSFER_ERROR_ALLOC;
+            }
+        }
+
+        while ((result == ARDATATRANSFER_OK) && ((ftpMedia = ARDATATRANSFER_MediasQueue_Pop(&pending, &resultQueue)) != NULL))
+        {
+            ARDATATRANSFER_MediasQueue_Release(&pending, ftpMedia);
+
+            // The listeners of a coalesced record carry no callbacks
+            ARDATATRANSFER_MediasQueue_FreeMedia(ftpMedia->nextListener);
+            ftpMedia->nextListener = NULL;
+
+            medias[count++] = ftpMedia;
+        }
+
+        // Compact the journal to the pending records, then keep appending to it
+        if (result == ARDATATRANSFER_OK)
+        {
+            strncpy(tmpPath, journal->path, ARUTILS_FTP_MAX_PATH_SIZE);
+            tmpPath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+            strncat(tmpPath, ARDATATRANSFER_MEDIASJOURNAL_TMP_EXT, ARUTILS_FTP_MAX_PATH_SIZE - strlen(tmpPath) - 1);
+
+            file = fopen(tmpPath, "w");
+
+            if (file == NULL)
+            {
+                result = ARDATATRANSFER_ERROR_FILE;
+            }
+
+            for (i=0; (result == ARDATATRANSFER_OK) && (i < count); i++)
+            {
+                if (ARDATATRANSFER_MediasJournal_WriteRecord(file, medias[i]) != 0)
+                {
+                    result = ARDATATRANSFER_ERROR_FILE;
+                }
+            }
+
+            if ((file != NULL) && (fclose(file) != 0))
+            {
+                result = ARDATATRANSFER_ERROR_FILE;
+            }
+
+            if ((result == ARDATATRANSFER_OK) && (rename(tmpPath, journal->path) != 0))
+            {
+                result = ARDATATRANSFER_ERROR_FILE;
+            }
+
+            if (result != ARDATATRANSFER_OK)
+            {
+                remove(tmpPath);
+            }
+        }
+
+        if (result == ARDATATRANSFER_OK)
+        {
+            journal->file = fopen(journal->path, "a");
+
+            if (journal->file == NULL)
+            {
+                result = ARDATATRANSFER_ERROR_FILE;
+            }
+        }
+
+        ARSAL_Mutex_Unlock(&journal->lock);
+    }
+
+    if (isPendingNew != 0)
+    {
+        ARDATATRANSFER_MediasQueue_Delete(&pending);
+    }
+
+    if (result != ARDATATRANSFER_OK)
+    {
+        for (i=0; i<count; i++)
+        {
+            free(medias[i]);
+        }
+        free(medias);
+        medias = NULL;
+        count = 0;
+    }
+
+    if (ftpMedias != NULL)
+    {
+        *ftpMedias = medias;
+    }
+
+    if (error != NULL)
+    {
+        *error = result;
+    }
+
+    return count;
+}
+
+void ARDATATRANSFER_MediasJournal_Append(ARDATATRANSFER_MediasJournal_t *journal, ARDATATRANSFER_FtpMedia_t **ftpMedias, int count)
+{
+    int resultSys = 0;
+    int i;
+
+    if ((journal != NULL) && (ftpMedias != NULL))
+    {
+        ARSAL_Mutex_Lock(&journal->lock);
+
+        if (journal->file != NULL)
+        {
+            for (i=0; (resultSys == 0) && (i < count); i++)
+            {
+                resultSys = ARDATATRANSFER_MediasJournal_WriteRecord(journal->file, ftpMedias[i]);
+            }
+
+            if ((resultSys != 0) || (fflush(journal->file) != 0))
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIASJOURNAL_TAG, "write failed %d", errno);
+            }
+        }
+
+        ARSAL_Mutex_Unlock(&journal->lock);
+    }
+}
+
+void ARDATATRANSFER_MediasJournal_AppendDone(ARDATATRANSFER_MediasJournal_t *journal, const char *remotePath)
+{
+    if ((journal != NULL) && (remotePath != NULL))
+    {
+        ARSAL_Mutex_Lock(&journal->lock);
+
+        if (journal->file != NULL)
+        {
+            if ((fprintf(journal->file, "%c\t%s\n", ARDATATRANSFER_MEDIASJOURNAL_DONE, remotePath) < 0) || (fflush(journal->file) != 0))
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIASJOURNAL_TAG, "write failed %d", errno);
+            }
+        }
+
+        ARSAL_Mutex_Unlock(&journal->lock);
+    }
+}
+
+int ARDATATRANSFER_MediasJournal_WriteRecord(FILE *file, ARDATATRANSFER_FtpMedia_t *ftpMedia)
+{
+    int resultSys;
+
+    resultSys = fprintf(file, "%c\t%d\t%d\t%.0f\t%s\t%s\t%s\t%s\t%s\t%s\n",
+                        ARDATATRANSFER_MEDIASJOURNAL_ADD,
+                        (int)ftpMedia->priority,
+                        (int)ftpMedia->product,
+                        ftpMedia->size,
+                        ftpMedia->name,
+                        ftpMedia->filePath,
+                        ftpMedia->date,
+                        ftpMedia->uuid,
+                        ftpMedia->remotePath,
+                        ftpMedia->remoteThumb);
+
+    return (resultSys < 0) ? -1 : 0;
+}
+
+int ARDATATRANSFER_MediasJournal_ParseRecord(char *line, ARDATATRANSFER_Media_t *media, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY *priority)
+{
+    char *fields[ARDATATRANSFER_MEDIASJOURNAL_FIELDS - 1];
+    char *index = line;
+    int value;
+    int count = 0;
+    int result = 0;
+
+    while ((index != NULL) && (count < (ARDATATRANSFER_MEDIASJOURNAL_FIELDS - 1)))
+    {
+        fields[count++] = index;
+        index = strchr(index, '\t');
+
+        if (index != NULL)
+        {
+            *index++ = '\0';
+        }
+    }
+
+    if ((count != (ARDATATRANSFER_MEDIASJOURNAL_FIELDS - 1)) || (index != NULL) || (fields[7][0] == '\0'))
+    {
+        result = -1;
+    }
+
+    if (result == 0)
+    {
+        value = atoi(fields[0]);
+
+        if ((value < 0) || (value >= ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_MAX))
+        {
+            value = ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_NORMAL;
+        }
+
+        memset(media, 0, sizeof(ARDATATRANSFER_Media_t));
+        *priority = (eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY)value;
+        media->product = (eARDISCOVERY_PRODUCT)atoi(fields[1]);
+        media->size = strtod(fields[2], NULL);
+        strncpy(media->name, fields[3], ARDATATRANSFER_MEDIA_NAME_SIZE);
+        media->name[ARDATATRANSFER_MEDIA_NAME_SIZE - 1] = '\0';
+        strncpy(media->filePath, fields[4], ARDATATRANSFER_MEDIA_PATH_SIZE);
+        media->filePath[ARDATATRANSFER_MEDIA_PATH_SIZE - 1] = '\0';
+        strncpy(media->date, fields[5], ARDATATRANSFER_MEDIA_DATE_SIZE);
+        media->date[ARDATATRANSFER_MEDIA_DATE_SIZE - 1] = '\0';
+        strncpy(media->uuid, fields[6], ARDATATRANSFER_MEDIA_UUID_SIZE);
+        media->uuid[ARDATATRANSFER_MEDIA_UUID_SIZE - 1] = '\0';
+        strncpy(media->remotePath, fields[7], ARUTILS_FTP_MAX_PATH_SIZE);
+        media->remotePath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncpy(media->remoteThumb, fields[8], ARUTILS_FTP_MAX_PATH_SIZE);
+        media->remoteThumb[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+    }
+
+    return result;
+}
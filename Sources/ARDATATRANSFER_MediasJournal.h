@@ -0,0 +1,129 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARDATATRANSFER_MediasJournal.h
+ * @brief libARDataTransfer MediasJournal header file, the append-only journal of the medias queue.
+ **/
+
+#ifndef _ARDATATRANSFER_MEDIASJOURNAL_PRIVATE_H_
+#define _ARDATATRANSFER_MEDIASJOURNAL_PRIVATE_H_
+
+/**
+ * @brief Defines the medias queue journal file name, in the MediasDownloader local directory
+ * @see ARDATATRANSFER_MediasJournal_Restore ()
+ */
+#define ARDATATRANSFER_MEDIAS_JOURNAL_FILE_NAME     ".medias_queue_journal"
+
+/**
+ * @brief Defines the maximum size of a journal record line
+ * @see ARDATATRANSFER_MediasJournal_Restore ()
+ */
+#define ARDATATRANSFER_MEDIAS_JOURNAL_LINE_SIZE     4096
+
+/**
+ * @brief MediasJournal structure
+ * @param file The journal file opened for append, NULL while the journal is disabled
+ * @param path The path of the journal file
+ * @param lock The mutex to protect the file access
+ * @see ARDATATRANSFER_MediasJournal_New ()
+ */
+typedef struct _ARDATATRANSFER_MediasJournal_t_
+{
+    FILE *file;
+    char path[ARUTILS_FTP_MAX_PATH_SIZE];
+    ARSAL_Mutex_t lock;
+
+} ARDATATRANSFER_MediasJournal_t;
+
+/**
+ * @brief Create a new ARDataTransfer MediasJournal, disabled until restored
+ * @param journal The address of the pointer on the ARDataTransfer MediasJournal
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasJournal_Delete ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasJournal_New(ARDATATRANSFER_MediasJournal_t *journal);
+
+/**
+ * @brief Delete an ARDataTransfer MediasJournal, the journal file is kept
+ * @param journal The address of the pointer on the ARDataTransfer MediasJournal
+ * @see ARDATATRANSFER_MediasJournal_New ()
+ */
+void ARDATATRANSFER_MediasJournal_Delete(ARDATATRANSFER_MediasJournal_t *journal);
+
+/**
+ * @brief Read the pending medias of the journal file, rewrite the file with them only and enable the journal
+ * @warning This function allocates memory
+ * @param journal The address of the pointer on the ARDataTransfer MediasJournal
+ * @param localDirectory The directory of the journal file, ending with a '/'
+ * @param[out] ftpMedias The pending FtpMedia in download order, to free by the caller
+ * @param[out] error The pointer of the error code: if success ARDATATRANSFER_OK, otherwise an error number of eARDATATRANSFER_ERROR
+ * @retval Returns the number of pending FtpMedia
+ * @see ARDATATRANSFER_MediasJournal_Append ()
+ */
+int ARDATATRANSFER_MediasJournal_Restore(ARDATATRANSFER_MediasJournal_t *journal, const char *localDirectory, ARDATATRANSFER_FtpMedia_t ***ftpMedias, eARDATATRANSFER_ERROR *error);
+
+/**
+ * @brief Append the queued media records, before the medias are added to the queue
+ * @param journal The address of the pointer on the ARDataTransfer MediasJournal
+ * @param ftpMedias The FtpMedia being queued
+ * @param count The number of FtpMedia
+ * @see ARDATATRANSFER_MediasJournal_AppendDone ()
+ */
+void ARDATATRANSFER_MediasJournal_Append(ARDATATRANSFER_MediasJournal_t *journal, ARDATATRANSFER_FtpMedia_t **ftpMedias, int count);
+
+/**
+ * @brief Append a done record, the media is not pending anymore
+ * @param journal The address of the pointer on the ARDataTransfer MediasJournal
+ * @param remotePath The remote path of the downloaded or canceled media
+ * @see ARDATATRANSFER_MediasJournal_Append ()
+ */
+void ARDATATRANSFER_MediasJournal_AppendDone(ARDATATRANSFER_MediasJournal_t *journal, const char *remotePath);
+
+/**
+ * @brief Write a queued media record
+ * @param file The file to write to
+ * @param ftpMedia The FtpMedia
+ * @retval Returns 0 on success, else a negative value
+ * @see ARDATATRANSFER_MediasJournal_ParseRecord ()
+ */
+int ARDATATRANSFER_MediasJournal_WriteRecord(FILE *file, ARDATATRANSFER_FtpMedia_t *ftpMedia);
+
+/**
+ * @brief Parse a queued media record
+ * @param line The record line, modified by the parsing
+ * @param[out] media The media of the record
+ * @param[out] priority The download priority of the media
+ * @retval Returns 0 on success, else a negative value if the record is malformed
+ * @see ARDATATRANSFER_MediasJournal_WriteRecord ()
+ */
+int ARDATATRANSFER_MediasJournal_ParseRecord(char *line, ARDATATRANSFER_Media_t *media, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY *priority);
+
+#endif /* _ARDATATRANSFER_MEDIASJOURNAL_PRIVATE_H_ */
@@ -37,6 +37,7 @@
 
 #include <inttypes.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <errno.h>
 
@@ -48,6 +49,7 @@
 #include "libARDataTransfer/ARDATATRANSFER_DataDownloader.h"
 #include "libARDataTransfer/ARDATATRANSFER_MediasDownloader.h"
 #include "ARDATATRANSFER_MediasQueue.h"
+#include "ARDATATRANSFER_MediasDate.h"
 
 #define ARDATATRANSFER_MEDIASQUEUE_TAG          "MediasQueue"
 
@@ -72,6 +74,7 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_New(ARDATATRANSFER_MediasQueue_
     if (result == ARDATATRANSFER_OK)
     {
         memset(queue, 0, sizeof(ARDATATRANSFER_MediasQueue_t));
+        queue->policy = ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_FIFO;
     }
 
     if (result == ARDATATRANSFER_OK)
@@ -94,7 +97,21 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_New(ARDATATRANSFER_MediasQueue_
         }
         else
         {
-            queue->count = ARDATATRANSFER_MEDIA_QUEUE_SIZE;
+            queue->capacity = ARDATATRANSFER_MEDIA_QUEUE_SIZE;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        queue->buckets = (ARDATATRANSFER_FtpMedia_t **)calloc(ARDATATRANSFER_MEDIA_QUEUE_SIZE, sizeof(ARDATATRANSFER_FtpMedia_t *));
+
+        if (queue->buckets == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_ALLOC;
+        }
+        else
+        {
+            queue->bucketsCount = ARDATATRANSFER_MEDIA_QUEUE_SIZE;
         }
     }
 
@@ -124,9 +141,11 @@ void ARDATATRANSFER_MediasQueue_Delete(ARDATATRANSFER_MediasQueue_t *queue)
                 if (media != NULL)
                 {
                     queue->medias[i] = NULL;
-                    free(media);
+                    ARDATATRANSFER_MediasQueue_FreeMedia(media);
                 }
             }
+            queue->count = 0;
+            queue->bytes = 0.f;
         }
         ARSAL_Mutex_Unlock(&queue->lock);
 
@@ -137,38 +156,222 @@ void ARDATATRANSFER_MediasQueue_Delete(ARDATATRANSFER_MediasQueue_t *queue)
             free(queue->medias);
             queue->medias = NULL;
         }
+
+        if (queue->buckets != NULL)
+        {
+            free(queue->buckets);
+            queue->buckets = NULL;
+        }
     }
 }
 
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_Add(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia)
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_Add(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia, int *isAttached)
 {
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
-    int index = -1;
 
     ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASQUEUE_TAG, "%s", "");
 
-    if ((queue == NULL) || (ftpMedia == NULL))
+    if ((queue == NULL) || (ftpMedia == NULL) || (isAttached == NULL))
     {
         result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
 
     if (result == ARDATATRANSFER_OK)
     {
+        *isAttached = 0;
+        ftpMedia->hash = ARDATATRANSFER_MediasQueue_Hash(ftpMedia->remotePath);
+        ftpMedia->timestamp = ARDATATRANSFER_MediasDate_Parse(ftpMedia->date);
+
         ARSAL_Mutex_Lock(&queue->lock);
 
-        result = ARDATATRANSFER_MediasQueue_GetFreeIndex(queue, &index);
+        if (queue->count == queue->capacity)
+        {
+            result = ARDATATRANSFER_MediasQueue_Grow(queue);
+        }
 
         if (result == ARDATATRANSFER_OK)
         {
-            queue->medias[index] = ftpMedia;
+            *isAttached = ARDATATRANSFER_MediasQueue_Insert(queue, ftpMedia);
+        }
+
+        ARSAL_Mutex_Unlock(&queue->lock);
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_AddBatch(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t **ftpMedias, int count, int *queuedCount)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int queued = 0;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASQUEUE_TAG, "%d", count);
+
+    if ((queue == NULL) || ((ftpMedias == NULL) && (count > 0)) || (count < 0) || (queuedCount == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        // Compute the keys outside of the lock
+        for (i=0; i<count; i++)
+        {
+            ftpMedias[i]->hash = ARDATATRANSFER_MediasQueue_Hash(ftpMedias[i]->remotePath);
+            ftpMedias[i]->timestamp = ARDATATRANSFER_MediasDate_Parse(ftpMedias[i]->date);
+        }
+
+        ARSAL_Mutex_Lock(&queue->lock);
+
+        while ((result == ARDATATRANSFER_OK) && ((queue->capacity - queue->count) < count))
+        {
+            result = ARDATATRANSFER_MediasQueue_Grow(queue);
+        }
+
+        for (i=0; (result == ARDATATRANSFER_OK) && (i < count); i++)
+        {
+            if (ARDATATRANSFER_MediasQueue_Insert(queue, ftpMedias[i]) == 0)
+            {
+                queued++;
+            }
         }
 
         ARSAL_Mutex_Unlock(&queue->lock);
     }
 
+    if (queuedCount != NULL)
+    {
+        *queuedCount = queued;
+    }
+
     return result;
 }
 
+ARDATATRANSFER_FtpMedia_t * ARDATATRANSFER_MediasQueue_NewMedia(ARDATATRANSFER_Media_t *media)
+{
+    ARDATATRANSFER_FtpMedia_t *ftpMedia = NULL;
+
+    if (media != NULL)
+    {
+        ftpMedia = (ARDATATRANSFER_FtpMedia_t *)calloc(1, ARDATATRANSFER_MediasQueue_GetRecordSize(media));
+    }
+
+    if (ftpMedia != NULL)
+    {
+        ARDATATRANSFER_MediasQueue_PackMedia(ftpMedia, media);
+    }
+
+    return ftpMedia;
+}
+
+ARDATATRANSFER_FtpMediaBlock_t * ARDATATRANSFER_MediasQueue_NewBlock(ARDATATRANSFER_Media_t **medias, int count, ARDATATRANSFER_FtpMedia_t **ftpMedias)
+{
+    ARDATATRANSFER_FtpMediaBlock_t *block = NULL;
+    size_t headerSize;
+    size_t size;
+    uint8_t *record;
+    int i;
+
+    if ((medias != NULL) && (ftpMedias != NULL) && (count > 0))
+    {
+        headerSize = (sizeof(ARDATATRANSFER_FtpMediaBlock_t) + ARDATATRANSFER_FTP_MEDIA_ALIGN - 1) & ~((size_t)ARDATATRANSFER_FTP_MEDIA_ALIGN - 1);
+        size = headerSize;
+
+        for (i=0; i<count; i++)
+        {
+            size += ARDATATRANSFER_MediasQueue_GetRecordSize(medias[i]);
+        }
+
+        block = (ARDATATRANSFER_FtpMediaBlock_t *)calloc(1, size);
+
+        if ((block != NULL) && (ARSAL_Mutex_Init(&block->lock) != 0))
+        {
+            free(block);
+            block = NULL;
+        }
+
+        if (block != NULL)
+        {
+            block->refCount = count;
+            record = (uint8_t *)block + headerSize;
+
+            for (i=0; i<count; i++)
+            {
+                ftpMedias[i] = (ARDATATRANSFER_FtpMedia_t *)record;
+                ARDATATRANSFER_MediasQueue_PackMedia(ftpMedias[i], medias[i]);
+                ftpMedias[i]->block = block;
+                record += ARDATATRANSFER_MediasQueue_GetRecordSize(medias[i]);
+            }
+        }
+    }
+
+    return block;
+}
+
+static size_t ARDATATRANSFER_MediasQueue_StringSize(const char *string, size_t size)
+{
+    const char *end = memchr(string, '\0', size - 1);
+
+    return ((end != NULL) ? (size_t)(end - string) : (size - 1)) + 1;
+}
+
+static const char * ARDATATRANSFER_MediasQueue_PackString(char **strings, const char *string, size_t size)
+{
+    char *packed = *strings;
+    size_t len = ARDATATRANSFER_MediasQueue_StringSize(string, size) - 1;
+
+    memcpy(packed, string, len);
+    packed[len] = '\0';
+    *strings += len + 1;
+
+    return packed;
+}
+
+size_t ARDATATRANSFER_MediasQueue_GetRecordSize(ARDATATRANSFER_Media_t *media)
+{
+    size_t size = sizeof(ARDATATRANSFER_FtpMedia_t);
+
+    size += ARDATATRANSFER_MediasQueue_StringSize(media->name, ARDATATRANSFER_MEDIA_NAME_SIZE);
+    size += ARDATATRANSFER_MediasQueue_StringSize(media->filePath, ARDATATRANSFER_MEDIA_PATH_SIZE);
+    size += ARDATATRANSFER_MediasQueue_StringSize(media->date, ARDATATRANSFER_MEDIA_DATE_SIZE);
+    size += ARDATATRANSFER_MediasQueue_StringSize(media->uuid, ARDATATRANSFER_MEDIA_UUID_SIZE);
+    size += ARDATATRANSFER_MediasQueue_StringSize(media->remotePath, ARUTILS_FTP_MAX_PATH_SIZE);
+    size += ARDATATRANSFER_MediasQueue_StringSize(media->remoteThumb, ARUTILS_FTP_MAX_PATH_SIZE);
+
+    return (size + ARDATATRANSFER_FTP_MEDIA_ALIGN - 1) & ~((size_t)ARDATATRANSFER_FTP_MEDIA_ALIGN - 1);
+}
+
+void ARDATATRANSFER_MediasQueue_PackMedia(ARDATATRANSFER_FtpMedia_t *ftpMedia, ARDATATRANSFER_Media_t *media)
+{
+    char *strings = ftpMedia->strings;
+
+    ftpMedia->name = ARDATATRANSFER_MediasQueue_PackString(&strings, media->name, ARDATATRANSFER_MEDIA_NAME_SIZE);
+    ftpMedia->filePath = ARDATATRANSFER_MediasQueue_PackString(&strings, media->filePath, ARDATATRANSFER_MEDIA_PATH_SIZE);
+    ftpMedia->date = ARDATATRANSFER_MediasQueue_PackString(&strings, media->date, ARDATATRANSFER_MEDIA_DATE_SIZE);
+    ftpMedia->uuid = ARDATATRANSFER_MediasQueue_PackString(&strings, media->uuid, ARDATATRANSFER_MEDIA_UUID_SIZE);
+    ftpMedia->remotePath = ARDATATRANSFER_MediasQueue_PackString(&strings, media->remotePath, ARUTILS_FTP_MAX_PATH_SIZE);
+    ftpMedia->remoteThumb = ARDATATRANSFER_MediasQueue_PackString(&strings, media->remoteThumb, ARUTILS_FTP_MAX_PATH_SIZE);
+    ftpMedia->size = media->size;
+    ftpMedia->product = media->product;
+    ftpMedia->heapIndex = -1;
+}
+
+void ARDATATRANSFER_MediasQueue_GetMedia(ARDATATRANSFER_FtpMedia_t *ftpMedia, ARDATATRANSFER_Media_t *media)
+{
+    // The packed strings are shorter than the media fields
+    strcpy(media->name, ftpMedia->name);
+    strcpy(media->filePath, ftpMedia->filePath);
+    strcpy(media->date, ftpMedia->date);
+    strcpy(media->uuid, ftpMedia->uuid);
+    strcpy(media->remotePath, ftpMedia->remotePath);
+    strcpy(media->remoteThumb, ftpMedia->remoteThumb);
+    media->size = ftpMedia->size;
+    media->product = ftpMedia->product;
+    media->thumbnail = NULL;
+    media->thumbnailSize = 0;
+}
+
 eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_RemoveAll(ARDATATRANSFER_MediasQueue_t *queue)
 {
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
@@ -192,11 +395,15 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_RemoveAll(ARDATATRANSFER_Medias
 
             if (ftpMedia)
             {
-                free(ftpMedia);
+                ARDATATRANSFER_MediasQueue_Unindex(queue, ftpMedia);
+                ARDATATRANSFER_MediasQueue_FreeMedia(ftpMedia);
                 queue->medias[i] = NULL;
             }
         }
 
+        queue->count = 0;
+        queue->bytes = 0.f;
+
         ARSAL_Mutex_Unlock(&queue->lock);
     }
 
@@ -207,7 +414,6 @@ ARDATATRANSFER_FtpMedia_t * ARDATATRANSFER_MediasQueue_Pop(ARDATATRANSFER_Medias
 {
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
     ARDATATRANSFER_FtpMedia_t *ftpMedia = NULL;
-    int i;
 
     ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASQUEUE_TAG, "%s", "");
 
@@ -220,13 +426,21 @@ ARDATATRANSFER_FtpMedia_t * ARDATATRANSFER_MediasQueue_Pop(ARDATATRANSFER_Medias
     {
         ARSAL_Mutex_Lock(&queue->lock);
 
-        for (i=0; (i < queue->count) && (ftpMedia == NULL); i++)
+        if (queue->count > 0)
         {
-            if (queue->medias[i] != NULL)
+            ftpMedia = queue->medias[0];
+            ftpMedia->heapIndex = -1;
+            queue->count--;
+            queue->bytes = (queue->count > 0) ? (queue->bytes - ftpMedia->size) : 0.f;
+
+            if (queue->count > 0)
             {
-                ftpMedia = queue->medias[i];
-                queue->medias[i] = NULL;
+                queue->medias[0] = queue->medias[queue->count];
+                queue->medias[0]->heapIndex = 0;
+                ARDATATRANSFER_MediasQueue_SiftDown(queue, 0);
             }
+
+            queue->medias[queue->count] = NULL;
         }
 
         ARSAL_Mutex_Unlock(&queue->lock);
@@ -238,55 +452,442 @@ ARDATATRANSFER_FtpMedia_t * ARDATATRANSFER_MediasQueue_Pop(ARDATATRANSFER_Medias
     return ftpMedia;
 }
 
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_GetFreeIndex(ARDATATRANSFER_MediasQueue_t *queue, int *freeIndex)
+void ARDATATRANSFER_MediasQueue_Release(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia)
+{
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASQUEUE_TAG, "%s", "");
+
+    if ((queue != NULL) && (ftpMedia != NULL))
+    {
+        ARSAL_Mutex_Lock(&queue->lock);
+        ARDATATRANSFER_MediasQueue_Unindex(queue, ftpMedia);
+        ARSAL_Mutex_Unlock(&queue->lock);
+    }
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_GetStats(ARDATATRANSFER_MediasQueue_t *queue, int *count, double *bytes)
 {
     eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
-    ARDATATRANSFER_FtpMedia_t **old;
-    int index = -1;
-    int i;
 
-    *freeIndex = -1;
+    if ((queue == NULL) || (count == NULL) || (bytes == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&queue->lock);
+        *count = queue->count;
+        *bytes = queue->bytes;
+        ARSAL_Mutex_Unlock(&queue->lock);
+    }
+
+    return result;
+}
+
+void ARDATATRANSFER_MediasQueue_FreeMedia(ARDATATRANSFER_FtpMedia_t *ftpMedia)
+{
+    ARDATATRANSFER_FtpMedia_t *listener;
+    ARDATATRANSFER_FtpMediaBlock_t *block;
+    int refCount;
 
-    for (i=0; (i < queue->count) && (index == -1); i++)
+    while (ftpMedia != NULL)
     {
-        if (queue->medias[i] == NULL)
+        listener = ftpMedia->nextListener;
+        block = ftpMedia->block;
+
+        if (block == NULL)
         {
-            index = i;
+            free(ftpMedia);
         }
+        else
+        {
+            ARSAL_Mutex_Lock(&block->lock);
+            refCount = --block->refCount;
+            ARSAL_Mutex_Unlock(&block->lock);
+
+            if (refCount == 0)
+            {
+                ARSAL_Mutex_Destroy(&block->lock);
+                free(block);
+            }
+        }
+
+        ftpMedia = listener;
+    }
+}
+
+ARDATATRANSFER_FtpMedia_t * ARDATATRANSFER_MediasQueue_Remove(ARDATATRANSFER_MediasQueue_t *queue, const char *remotePath, eARDATATRANSFER_ERROR *error)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia = NULL;
+    ARDATATRANSFER_FtpMedia_t *last;
+    int index;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASQUEUE_TAG, "%s", "");
+
+    if ((queue == NULL) || (remotePath == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
     }
 
-    if (index == -1)
+    if (result == ARDATATRANSFER_OK)
     {
-        old = queue->medias;
-        index = queue->count;
+        ARSAL_Mutex_Lock(&queue->lock);
 
-        queue->medias = (ARDATATRANSFER_FtpMedia_t **)realloc(queue->medias, (queue->count + ARDATATRANSFER_MEDIA_QUEUE_SIZE) * sizeof(ARDATATRANSFER_FtpMedia_t *));
+        ftpMedia = ARDATATRANSFER_MediasQueue_Find(queue, remotePath, ARDATATRANSFER_MediasQueue_Hash(remotePath));
 
-        if (queue->medias == NULL)
+        if ((ftpMedia != NULL) && (ftpMedia->heapIndex < 0))
         {
-            queue->medias = old;
-            result = ARDATATRANSFER_ERROR_ALLOC;
+            // Being downloaded, not queued anymore
+            ftpMedia = NULL;
         }
-        else
+
+        if (ftpMedia != NULL)
         {
-            queue->count += ARDATATRANSFER_MEDIA_QUEUE_SIZE;
+            ARDATATRANSFER_MediasQueue_Unindex(queue, ftpMedia);
+            index = ftpMedia->heapIndex;
+            ftpMedia->heapIndex = -1;
+            queue->count--;
+            queue->bytes = (queue->count > 0) ? (queue->bytes - ftpMedia->size) : 0.f;
+            last = queue->medias[queue->count];
+            queue->medias[queue->count] = NULL;
+
+            // Fill the hole with the last FtpMedia of the heap and restore the heap order around it
+            if (last != ftpMedia)
+            {
+                queue->medias[index] = last;
+                last->heapIndex = index;
+
+                if ((index > 0) && ARDATATRANSFER_MediasQueue_IsBefore(queue, last, queue->medias[(index - 1) / 2]))
+                {
+                    ARDATATRANSFER_MediasQueue_SiftUp(queue, index);
+                }
+                else
+                {
+                    ARDATATRANSFER_MediasQueue_SiftDown(queue, index);
+                }
+            }
         }
 
-        if (result == ARDATATRANSFER_OK)
+        ARSAL_Mutex_Unlock(&queue->lock);
+    }
+
+    *error = result;
+    return ftpMedia;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_SetPriority(ARDATATRANSFER_MediasQueue_t *queue, const char *remotePath, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia = NULL;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASQUEUE_TAG, "%s", "");
+
+    if ((queue == NULL) || (remotePath == NULL) || (priority < 0) || (priority >= ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_MAX))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&queue->lock);
+
+        ftpMedia = ARDATATRANSFER_MediasQueue_Find(queue, remotePath, ARDATATRANSFER_MediasQueue_Hash(remotePath));
+
+        if ((ftpMedia == NULL) || (ftpMedia->heapIndex < 0))
+        {
+            result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+        }
+        else if (priority > ftpMedia->priority)
+        {
+            ftpMedia->priority = priority;
+            ARDATATRANSFER_MediasQueue_SiftUp(queue, ftpMedia->heapIndex);
+        }
+        else if (priority < ftpMedia->priority)
+        {
+            ftpMedia->priority = priority;
+            ARDATATRANSFER_MediasQueue_SiftDown(queue, ftpMedia->heapIndex);
+        }
+
+        ARSAL_Mutex_Unlock(&queue->lock);
+    }
+
+    return result;
+}
+
+int ARDATATRANSFER_MediasQueue_Contains(ARDATATRANSFER_MediasQueue_t *queue, const char *remotePath)
+{
+    int contains = 0;
+
+    if ((queue != NULL) && (remotePath != NULL))
+    {
+        ARSAL_Mutex_Lock(&queue->lock);
+        contains = (ARDATATRANSFER_MediasQueue_Find(queue, remotePath, ARDATATRANSFER_MediasQueue_Hash(remotePath)) != NULL) ? 1 : 0;
+        ARSAL_Mutex_Unlock(&queue->lock);
+    }
+
+    return contains;
+}
+
+ARDATATRANSFER_FtpMedia_t * ARDATATRANSFER_MediasQueue_Find(ARDATATRANSFER_MediasQueue_t *queue, const char *remotePath, uint32_t hash)
+{
+    ARDATATRANSFER_FtpMedia_t *ftpMedia = NULL;
+
+    ftpMedia = queue->buckets[hash & (queue->bucketsCount - 1)];
+
+    while ((ftpMedia != NULL) && ((ftpMedia->hash != hash) || (strcmp(ftpMedia->remotePath, remotePath) != 0)))
+    {
+        ftpMedia = ftpMedia->hashNext;
+    }
+
+    return ftpMedia;
+}
+
+int ARDATATRANSFER_MediasQueue_Insert(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia)
+{
+    ARDATATRANSFER_FtpMedia_t *existing = NULL;
+    ARDATATRANSFER_FtpMedia_t *listener = NULL;
+    int isAttached = 0;
+
+    ftpMedia->hashNext = NULL;
+    ftpMedia->nextListener = NULL;
+
+    existing = ARDATATRANSFER_MediasQueue_Find(queue, ftpMedia->remotePath, ftpMedia->hash);
+
+    if (existing != NULL)
+    {
+        ftpMedia->heapIndex = -1;
+
+        listener = existing;
+        while (listener->nextListener != NULL)
+        {
+            listener = listener->nextListener;
+        }
+
+        // Published once complete, a transfer in progress walks the listeners without the queue lock
+        __atomic_store_n(&listener->nextListener, ftpMedia, __ATOMIC_RELEASE);
+
+        if ((existing->heapIndex >= 0) && (ftpMedia->priority > existing->priority))
+        {
+            existing->priority = ftpMedia->priority;
+            ARDATATRANSFER_MediasQueue_SiftUp(queue, existing->heapIndex);
+        }
+
+        isAttached = 1;
+    }
+    else
+    {
+        ftpMedia->sequence = queue->sequence++;
+        ftpMedia->heapIndex = queue->count;
+        queue->medias[queue->count] = ftpMedia;
+        queue->count++;
+        queue->bytes += ftpMedia->size;
+
+        ARDATATRANSFER_MediasQueue_SiftUp(queue, ftpMedia->heapIndex);
+        ARDATATRANSFER_MediasQueue_Index(queue, ftpMedia);
+    }
+
+    return isAttached;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_SetPolicy(ARDATATRANSFER_MediasQueue_t *queue, eARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY policy)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASQUEUE_TAG, "%d", policy);
+
+    if ((queue == NULL) || (policy < 0) || (policy >= ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_MAX))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&queue->lock);
+
+        if (queue->policy != policy)
         {
-            for (i=index; i<queue->count; i++)
+            queue->policy = policy;
+
+            // Rebuild the heap bottom-up with the new order
+            for (i=(queue->count / 2) - 1; i>=0; i--)
             {
-                queue->medias[i] = NULL;
+                ARDATATRANSFER_MediasQueue_SiftDown(queue, i);
             }
         }
+
+        ARSAL_Mutex_Unlock(&queue->lock);
+    }
+
+    return result;
+}
+
+int ARDATATRANSFER_MediasQueue_IsBefore(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *first, ARDATATRANSFER_FtpMedia_t *second)
+{
+    int isBefore;
+
+    if (first->priority != second->priority)
+    {
+        isBefore = (first->priority > second->priority) ? 1 : 0;
+    }
+    else if ((queue->policy == ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_SMALLEST_FIRST) && (first->size != second->size))
+    {
+        isBefore = (first->size < second->size) ? 1 : 0;
+    }
+    else if ((queue->policy == ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_NEWEST_FIRST) && (first->timestamp != second->timestamp))
+    {
+        isBefore = (first->timestamp > second->timestamp) ? 1 : 0;
+    }
+    else
+    {
+        isBefore = (first->sequence < second->sequence) ? 1 : 0;
+    }
+
+    return isBefore;
+}
+
+void ARDATATRANSFER_MediasQueue_SiftUp(ARDATATRANSFER_MediasQueue_t *queue, int index)
+{
+    ARDATATRANSFER_FtpMedia_t *ftpMedia = queue->medias[index];
+    int parent;
+
+    while (index > 0)
+    {
+        parent = (index - 1) / 2;
+
+        if (!ARDATATRANSFER_MediasQueue_IsBefore(queue, ftpMedia, queue->medias[parent]))
+        {
+            break;
+        }
+
+        queue->medias[index] = queue->medias[parent];
+        queue->medias[index]->heapIndex = index;
+        index = parent;
+    }
+
+    queue->medias[index] = ftpMedia;
+    ftpMedia->heapIndex = index;
+}
+
+void ARDATATRANSFER_MediasQueue_SiftDown(ARDATATRANSFER_MediasQueue_t *queue, int index)
+{
+    ARDATATRANSFER_FtpMedia_t *ftpMedia = queue->medias[index];
+    int child;
+
+    while ((child = (2 * index) + 1) < queue->count)
+    {
+        if (((child + 1) < queue->count) && ARDATATRANSFER_MediasQueue_IsBefore(queue, queue->medias[child + 1], queue->medias[child]))
+        {
+            child++;
+        }
+
+        if (!ARDATATRANSFER_MediasQueue_IsBefore(queue, queue->medias[child], ftpMedia))
+        {
+            break;
+        }
+
+        queue->medias[index] = queue->medias[child];
+        queue->medias[index]->heapIndex = index;
+        index = child;
+    }
+
+    queue->medias[index] = ftpMedia;
+    ftpMedia->heapIndex = index;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_Grow(ARDATATRANSFER_MediasQueue_t *queue)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    ARDATATRANSFER_FtpMedia_t **medias;
+    int capacity;
+    int i;
+
+    capacity = (queue->capacity > 0) ? (queue->capacity * 2) : ARDATATRANSFER_MEDIA_QUEUE_SIZE;
+    medias = (ARDATATRANSFER_FtpMedia_t **)realloc(queue->medias, capacity * sizeof(ARDATATRANSFER_FtpMedia_t *));
+
+    if (medias == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_ALLOC;
     }
 
     if (result == ARDATATRANSFER_OK)
     {
-        *freeIndex = index;
+        for (i=queue->capacity; i<capacity; i++)
+        {
+            medias[i] = NULL;
+        }
+
+        queue->medias = medias;
+        queue->capacity = capacity;
     }
 
     return result;
 }
 
+uint32_t ARDATATRANSFER_MediasQueue_Hash(const char *remotePath)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*remotePath != '\0')
+    {
+        hash ^= (uint8_t)*remotePath++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+void ARDATATRANSFER_MediasQueue_Index(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia)
+{
+    ARDATATRANSFER_FtpMedia_t **buckets;
+    ARDATATRANSFER_FtpMedia_t *next;
+    int bucketsCount;
+    int i;
+
+    if (queue->indexedCount >= queue->bucketsCount)
+    {
+        // Keep the chains short; on allocation failure the index stays valid with longer chains
+        bucketsCount = queue->bucketsCount * 2;
+        buckets = (ARDATATRANSFER_FtpMedia_t **)calloc(bucketsCount, sizeof(ARDATATRANSFER_FtpMedia_t *));
+
+        if (buckets != NULL)
+        {
+            for (i=0; i<queue->bucketsCount; i++)
+            {
+                while (queue->buckets[i] != NULL)
+                {
+                    next = queue->buckets[i]->hashNext;
+                    queue->buckets[i]->hashNext = buckets[queue->buckets[i]->hash & (bucketsCount - 1)];
+                    buckets[queue->buckets[i]->hash & (bucketsCount - 1)] = queue->buckets[i];
+                    queue->buckets[i] = next;
+                }
+            }
+
+            free(queue->buckets);
+            queue->buckets = buckets;
+            queue->bucketsCount = bucketsCount;
+        }
+    }
+
+    ftpMedia->hashNext = queue->buckets[ftpMedia->hash & (queue->bucketsCount - 1)];
+    queue->buckets[ftpMedia->hash & (queue->bucketsCount - 1)] = ftpMedia;
+    queue->indexedCount++;
+}
+
+void ARDATATRANSFER_MediasQueue_Unindex(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia)
+{
+    ARDATATRANSFER_FtpMedia_t **link = &queue->buckets[ftpMedia->hash & (queue->bucketsCount - 1)];
+
+    while ((*link != NULL) && (*link != ftpMedia))
+    {
+        link = &(*link)->hashNext;
+    }
 
+    if (*link != NULL)
+    {
+        *link = ftpMedia->hashNext;
+        ftpMedia->hashNext = NULL;
+        queue->indexedCount--;
+    }
+}
@@ -45,35 +45,100 @@
 #define ARDATATRANSFER_MEDIA_QUEUE_SIZE             16
 
 /**
- * @brief FtpMedia structure
- * @param media The media
+ * @brief Defines the alignment of the FtpMedia records packed in a block
+ * @see ARDATATRANSFER_MediasQueue_GetRecordSize ()
+ */
+#define ARDATATRANSFER_FTP_MEDIA_ALIGN              8
+
+/**
+ * @brief FtpMedia structure, a variable size record holding the media strings after the structure
+ * @param name The media name
+ * @param filePath The local file path of the media
+ * @param date The media date
+ * @param uuid The media uuid
+ * @param remotePath The remote path of the media
+ * @param remoteThumb The remote path of the media thumbnail
+ * @param size The media size
+ * @param product The product that the media belong to
  * @param progressCallback The media progress callback
- * @param progressArg The media
- * @param completionCallback
- * @param completionArg
- * @see ARDATATRANSFER_MediasQueue_Add ()
+ * @param progressArg The media progress callback user argument
+ * @param completionCallback The media completion callback
+ * @param completionArg The media completion callback user argument
+ * @param priority The download priority of the media
+ * @param sequence The insertion sequence number, to keep FIFO order between medias of the same priority
+ * @param timestamp The media date in seconds since the Epoch, INT64_MIN if unknown
+ * @param heapIndex The index of the FtpMedia in the queue heap, -1 if not queued
+ * @param hash The hash of the media remote path
+ * @param hashNext The next FtpMedia of the same remotePath index bucket
+ * @param nextListener The next FtpMedia added for the same remote path, whose callbacks are called with this one, appended under the queue lock with a release store
+ * @param block The block the FtpMedia is allocated in, NULL if allocated alone
+ * @param strings The media strings, pointed by the string fields
+ * @see ARDATATRANSFER_MediasQueue_NewMedia (), ARDATATRANSFER_MediasQueue_GetMedia ()
  */
 typedef struct _ARDATATRANSFER_FtpMedia_t_
 {
-    ARDATATRANSFER_Media_t media;
+    const char *name;
+    const char *filePath;
+    const char *date;
+    const char *uuid;
+    const char *remotePath;
+    const char *remoteThumb;
+    double size;
+    eARDISCOVERY_PRODUCT product;
     ARDATATRANSFER_MediasDownloader_MediaDownloadProgressCallback_t progressCallback;
     void *progressArg;
     ARDATATRANSFER_MediasDownloader_MediaDownloadCompletionCallback_t completionCallback;
     void *completionArg;
+    eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority;
+    uint64_t sequence;
+    int64_t timestamp;
+    int heapIndex;
+    uint32_t hash;
+    struct _ARDATATRANSFER_FtpMedia_t_ *hashNext;
+    struct _ARDATATRANSFER_FtpMedia_t_ *nextListener;
+    struct _ARDATATRANSFER_FtpMediaBlock_t_ *block;
+    char strings[];
 
 } ARDATATRANSFER_FtpMedia_t;
 
 /**
- * @brief MediasQueue structure
- * @param medias The medias queue list
+ * @brief FtpMediaBlock structure, FtpMedia records allocated together after the block by a batch, freed with the last of them
+ * @param lock The mutex to protect the reference count
+ * @param refCount The number of FtpMedia of the block not freed yet
+ * @see ARDATATRANSFER_MediasQueue_NewBlock ()
+ */
+typedef struct _ARDATATRANSFER_FtpMediaBlock_t_
+{
+    ARSAL_Mutex_t lock;
+    int refCount;
+
+} ARDATATRANSFER_FtpMediaBlock_t;
+
+/**
+ * @brief MediasQueue structure, a growable binary heap of FtpMedia ordered by priority, then by the scheduling policy, then by insertion order
+ * @param medias The medias heap
+ * @param capacity The number of slots of the heap
+ * @param count The number of FtpMedia in the heap
+ * @param bytes The sum of the sizes of the FtpMedia in the heap
+ * @param sequence The next insertion sequence number
+ * @param policy The scheduling policy of the medias of the same priority
+ * @param buckets The remotePath index buckets, holding the FtpMedia queued or being downloaded
+ * @param bucketsCount The number of buckets, a power of 2
+ * @param indexedCount The number of FtpMedia in the remotePath index
  * @param lock The mutex to protect the list access
- * @param sem The semaphore to signal new medias in the list
  * @see ARDATATRANSFER_MediasQueue_New ()
  */
 typedef struct _ARDATATRANSFER_MediasQueue_t_
 {
     ARDATATRANSFER_FtpMedia_t **medias;
+    int capacity;
     int count;
+    double bytes;
+    uint64_t sequence;
+    eARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY policy;
+    ARDATATRANSFER_FtpMedia_t **buckets;
+    int bucketsCount;
+    int indexedCount;
     ARSAL_Mutex_t lock;
 
 } ARDATATRANSFER_MediasQueue_t;
@@ -96,13 +161,72 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_New(ARDATATRANSFER_MediasQueue_
 void ARDATATRANSFER_MediasQueue_Delete(ARDATATRANSFER_MediasQueue_t *queue);
 
 /**
- * @brief Add a new FtpMedia to the ARDataTransfer MediasQueue
+ * @brief Add a new FtpMedia to the ARDataTransfer MediasQueue, behind the FtpMedia of same or higher priority
+ * @note If an FtpMedia of the same remote path is already queued or being downloaded, ftpMedia is attached to it as a listener instead of being queued, and the queued one is raised to its priority
  * @warning This function allocates memory
  * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param ftpMedia The FtpMedia to add, its priority must be set, owned by the queue on success
+ * @param[out] isAttached Is set to 1 if ftpMedia is attached to an existing FtpMedia, else 0
  * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
- * @see ARDATATRANSFER_FtpMedia_t, ARDATATRANSFER_MediasQueue_Pop
+ * @see ARDATATRANSFER_FtpMedia_t, ARDATATRANSFER_MediasQueue_Pop, ARDATATRANSFER_MediasQueue_Release
  */
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_Add(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia);
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_Add(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia, int *isAttached);
+
+/**
+ * @brief Add several FtpMedia to the ARDataTransfer MediasQueue at once, in their order, as ARDATATRANSFER_MediasQueue_Add would
+ * @warning This function allocates memory
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param ftpMedias The FtpMedia to add, their priority must be set, owned by the queue on success
+ * @param count The number of FtpMedia to add
+ * @param[out] queuedCount The number of FtpMedia queued, the others are attached to an existing FtpMedia
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR and no FtpMedia is added.
+ * @see ARDATATRANSFER_MediasQueue_Add ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_AddBatch(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t **ftpMedias, int count, int *queuedCount);
+
+/**
+ * @brief Allocate a new FtpMedia record of a media
+ * @warning This function allocates memory
+ * @param media The media
+ * @retval On success, returns the FtpMedia, without callbacks. Otherwise, it returns NULL.
+ * @see ARDATATRANSFER_MediasQueue_FreeMedia (), ARDATATRANSFER_MediasQueue_GetMedia ()
+ */
+ARDATATRANSFER_FtpMedia_t * ARDATATRANSFER_MediasQueue_NewMedia(ARDATATRANSFER_Media_t *media);
+
+/**
+ * @brief Allocate the FtpMedia records of several medias in one block
+ * @warning This function allocates memory
+ * @param medias The medias
+ * @param count The number of medias
+ * @param[out] ftpMedias The FtpMedia of each media, without callbacks
+ * @retval On success, returns the block. Otherwise, it returns NULL.
+ * @see ARDATATRANSFER_MediasQueue_FreeMedia ()
+ */
+ARDATATRANSFER_FtpMediaBlock_t * ARDATATRANSFER_MediasQueue_NewBlock(ARDATATRANSFER_Media_t **medias, int count, ARDATATRANSFER_FtpMedia_t **ftpMedias);
+
+/**
+ * @brief Get the size of the FtpMedia record of a media, aligned to pack records in a block
+ * @param media The media
+ * @retval Returns the record size in bytes
+ * @see ARDATATRANSFER_MediasQueue_PackMedia ()
+ */
+size_t ARDATATRANSFER_MediasQueue_GetRecordSize(ARDATATRANSFER_Media_t *media);
+
+/**
+ * @brief Write a media in an FtpMedia record
+ * @param ftpMedia The FtpMedia record, of ARDATATRANSFER_MediasQueue_GetRecordSize bytes
+ * @param media The media
+ * @see ARDATATRANSFER_MediasQueue_GetRecordSize ()
+ */
+void ARDATATRANSFER_MediasQueue_PackMedia(ARDATATRANSFER_FtpMedia_t *ftpMedia, ARDATATRANSFER_Media_t *media);
+
+/**
+ * @brief Expand an FtpMedia record into a media, as given to the callbacks
+ * @param ftpMedia The FtpMedia
+ * @param[out] media The media, without thumbnail
+ * @see ARDATATRANSFER_MediasQueue_PackMedia ()
+ */
+void ARDATATRANSFER_MediasQueue_GetMedia(ARDATATRANSFER_FtpMedia_t *ftpMedia, ARDATATRANSFER_Media_t *media);
 
 /**
  * @brief Remove all FtpMedia from the ARDataTransfer MediasQueue
@@ -114,22 +238,161 @@ eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_Add(ARDATATRANSFER_MediasQueue_
 eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_RemoveAll(ARDATATRANSFER_MediasQueue_t *queue);
 
 /**
- * @brief Pop an FtpMedia from ARDATATRANSFER_MediasQueue_Pop if any else wait new FtpMedia
+ * @brief Pop the oldest FtpMedia of the highest priority from the ARDataTransfer MediasQueue if any
+ * @note The FtpMedia stays in the remotePath index until released, so that duplicates attach to the download in progress
  * @param queue The address of the pointer on the ARDataTransfer MediasQueue
  * @param[out] error The pointer of the error code: if success ARDATATRANSFER_OK, otherwise an error number of eARDATATRANSFER_ERROR
  * @retval On success, returns an new FtpMedia. Otherwise, it returns null.
- * @see ARDATATRANSFER_FtpMedia_t, ARDATATRANSFER_MediasQueue_Add
+ * @see ARDATATRANSFER_FtpMedia_t, ARDATATRANSFER_MediasQueue_Add, ARDATATRANSFER_MediasQueue_Release
  */
 ARDATATRANSFER_FtpMedia_t * ARDATATRANSFER_MediasQueue_Pop(ARDATATRANSFER_MediasQueue_t *queue, eARDATATRANSFER_ERROR *error);
 
 /**
- * @brief Get a new ARDataTransfer MediasQueue free index in the list, if not allocate new index
+ * @brief Release a popped FtpMedia from the remotePath index, no more listener can be attached to it afterwards
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param ftpMedia The popped FtpMedia
+ * @see ARDATATRANSFER_MediasQueue_Pop ()
+ */
+void ARDATATRANSFER_MediasQueue_Release(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia);
+
+/**
+ * @brief Get the number of FtpMedia queued and the sum of their sizes, maintained by the queue operations
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param[out] count The number of FtpMedia queued, the attached listeners are not counted
+ * @param[out] bytes The sum of the sizes of the FtpMedia queued
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_GetStats(ARDATATRANSFER_MediasQueue_t *queue, int *count, double *bytes);
+
+/**
+ * @brief Free an FtpMedia and its attached listeners, a block is freed with its last FtpMedia
+ * @warning This function frees memory
+ * @param ftpMedia The FtpMedia, not queued nor indexed
+ * @see ARDATATRANSFER_MediasQueue_Add ()
+ */
+void ARDATATRANSFER_MediasQueue_FreeMedia(ARDATATRANSFER_FtpMedia_t *ftpMedia);
+
+/**
+ * @brief Remove a queued FtpMedia from the ARDataTransfer MediasQueue
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param remotePath The remote path of the queued media
+ * @param[out] error The pointer of the error code: if success ARDATATRANSFER_OK, otherwise an error number of eARDATATRANSFER_ERROR
+ * @retval Returns the removed FtpMedia, owned by the caller, or NULL if the media is not queued.
+ * @see ARDATATRANSFER_MediasQueue_Add ()
+ */
+ARDATATRANSFER_FtpMedia_t * ARDATATRANSFER_MediasQueue_Remove(ARDATATRANSFER_MediasQueue_t *queue, const char *remotePath, eARDATATRANSFER_ERROR *error);
+
+/**
+ * @brief Change the priority of a queued FtpMedia
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param remotePath The remote path of the queued media
+ * @param priority The new priority of the media
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasQueue_Add ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_SetPriority(ARDATATRANSFER_MediasQueue_t *queue, const char *remotePath, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority);
+
+/**
+ * @brief Check whether a media is queued or being downloaded
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param remotePath The remote path of the media
+ * @retval Returns 1 if the media is queued or being downloaded, otherwise 0
+ * @see ARDATATRANSFER_MediasQueue_Find ()
+ */
+int ARDATATRANSFER_MediasQueue_Contains(ARDATATRANSFER_MediasQueue_t *queue, const char *remotePath);
+
+/**
+ * @brief Find an FtpMedia queued or being downloaded by its remote path
+ * @warning The queue lock must be held by the caller
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param remotePath The remote path of the media
+ * @param hash The hash of remotePath
+ * @retval Returns the FtpMedia, with a heapIndex of -1 if it is being downloaded, or NULL if not found
+ * @see ARDATATRANSFER_MediasQueue_Remove (), ARDATATRANSFER_MediasQueue_SetPriority (), ARDATATRANSFER_MediasQueue_Hash ()
+ */
+ARDATATRANSFER_FtpMedia_t * ARDATATRANSFER_MediasQueue_Find(ARDATATRANSFER_MediasQueue_t *queue, const char *remotePath, uint32_t hash);
+
+/**
+ * @brief Add an FtpMedia to the heap, or attach it to the FtpMedia of the same remote path
+ * @warning The queue lock must be held by the caller and the heap must have a free slot
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param ftpMedia The FtpMedia to add
+ * @retval Returns 1 if ftpMedia is attached to an existing FtpMedia, else 0
+ * @see ARDATATRANSFER_MediasQueue_Add (), ARDATATRANSFER_MediasQueue_AddBatch ()
+ */
+int ARDATATRANSFER_MediasQueue_Insert(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia);
+
+/**
+ * @brief Set the scheduling policy and reorder the queued FtpMedia
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param policy The scheduling policy
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasQueue_IsBefore ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_SetPolicy(ARDATATRANSFER_MediasQueue_t *queue, eARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY policy);
+
+/**
+ * @brief Compare two FtpMedia of the ARDataTransfer MediasQueue heap
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param first The first FtpMedia
+ * @param second The second FtpMedia
+ * @retval Returns 1 if first must be popped before second, otherwise 0
+ * @see ARDATATRANSFER_MediasQueue_SiftUp (), ARDATATRANSFER_MediasQueue_SiftDown ()
+ */
+int ARDATATRANSFER_MediasQueue_IsBefore(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *first, ARDATATRANSFER_FtpMedia_t *second);
+
+/**
+ * @brief Move up an FtpMedia of the ARDataTransfer MediasQueue heap until its parent is popped before it
+ * @warning The queue lock must be held by the caller
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param index The heap index of the FtpMedia to move
+ * @see ARDATATRANSFER_MediasQueue_Add ()
+ */
+void ARDATATRANSFER_MediasQueue_SiftUp(ARDATATRANSFER_MediasQueue_t *queue, int index);
+
+/**
+ * @brief Move down an FtpMedia of the ARDataTransfer MediasQueue heap until it is popped before its children
+ * @warning The queue lock must be held by the caller
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param index The heap index of the FtpMedia to move
+ * @see ARDATATRANSFER_MediasQueue_Pop ()
+ */
+void ARDATATRANSFER_MediasQueue_SiftDown(ARDATATRANSFER_MediasQueue_t *queue, int index);
+
+/**
+ * @brief Double the capacity of the ARDataTransfer MediasQueue heap
  * @warning This function allocates memory
+ * @warning The queue lock must be held by the caller
  * @param queue The address of the pointer on the ARDataTransfer MediasQueue
- * @param[out] freeIndex A free index in the list
  * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
- * @see ARDATATRANSFER_MediasQueue_Delete ()
+ * @see ARDATATRANSFER_MediasQueue_Add ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_Grow(ARDATATRANSFER_MediasQueue_t *queue);
+
+/**
+ * @brief Compute the remotePath index hash of a remote path (FNV-1a)
+ * @param remotePath The remote path
+ * @retval Returns the hash
+ * @see ARDATATRANSFER_MediasQueue_Find ()
+ */
+uint32_t ARDATATRANSFER_MediasQueue_Hash(const char *remotePath);
+
+/**
+ * @brief Insert an FtpMedia in the remotePath index, growing the buckets if needed
+ * @warning The queue lock must be held by the caller
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param ftpMedia The FtpMedia, its hash must be set
+ * @see ARDATATRANSFER_MediasQueue_Unindex ()
+ */
+void ARDATATRANSFER_MediasQueue_Index(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia);
+
+/**
+ * @brief Remove an FtpMedia from the remotePath index
+ * @warning The queue lock must be held by the caller
+ * @param queue The address of the pointer on the ARDataTransfer MediasQueue
+ * @param ftpMedia The indexed FtpMedia
+ * @see ARDATATRANSFER_MediasQueue_Index ()
  */
-eARDATATRANSFER_ERROR ARDATATRANSFER_MediasQueue_GetFreeIndex(ARDATATRANSFER_MediasQueue_t *queue, int *freeIndex);
+void ARDATATRANSFER_MediasQueue_Unindex(ARDATATRANSFER_MediasQueue_t *queue, ARDATATRANSFER_FtpMedia_t *ftpMedia);
 
 #endif /* _ARDATATRANSFER_MEDIASQUEUE_PRIVATE_H_ */
@@ -0,0 +1,463 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARDATATRANSFER_MediasThumbnails.c
+ * @brief libARDataTransfer MediasThumbnails c file.
+ * Each cached thumbnail is a file of the cache directory, a header then the thumbnail, named after its remote path and the size of its media.
+ * The modification time of a file is set again when it is read, the eviction removes the files least recently modified.
+ **/
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+
+#include <libARSAL/ARSAL_Mutex.h>
+#include <libARSAL/ARSAL_Print.h>
+#include <libARUtils/ARUTILS_Error.h>
+#include <libARUtils/ARUTILS_Manager.h>
+#include <libARUtils/ARUTILS_Ftp.h>
+#include <libARDiscovery/ARDISCOVERY_Discovery.h>
+
+#include "libARDataTransfer/ARDATATRANSFER_Error.h"
+#include "libARDataTransfer/ARDATATRANSFER_Manager.h"
+#include "libARDataTransfer/ARDATATRANSFER_DataDownloader.h"
+#include "libARDataTransfer/ARDATATRANSFER_MediasDownloader.h"
+#include "ARDATATRANSFER_MediasIndex.h"
+#include "ARDATATRANSFER_MediasThumbnails.h"
+
+#define ARDATATRANSFER_MEDIASTHUMBNAILS_TAG         "MediasThumbnails"
+
+#define ARDATATRANSFER_MEDIASTHUMBNAILS_MAGIC       "ARMTHUMB"
+#define ARDATATRANSFER_MEDIASTHUMBNAILS_EXT         ".thumb"
+#define ARDATATRANSFER_MEDIASTHUMBNAILS_TMP_EXT     ".tmp"
+
+/*****************************************
+ *
+ *             Private implementation:
+ *
+ *****************************************/
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasThumbnails_New(ARDATATRANSFER_MediasThumbnails_t *thumbnails)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int resultSys = 0;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASTHUMBNAILS_TAG, "%s", "");
+
+    if (thumbnails == NULL)
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        memset(thumbnails, 0, sizeof(ARDATATRANSFER_MediasThumbnails_t));
+
+        resultSys = ARSAL_Mutex_Init(&thumbnails->lock);
+
+        if (resultSys != 0)
+        {
+            result = ARDATATRANSFER_ERROR_SYSTEM;
+        }
+    }
+
+    return result;
+}
+
+void ARDATATRANSFER_MediasThumbnails_Delete(ARDATATRANSFER_MediasThumbnails_t *thumbnails)
+{
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASTHUMBNAILS_TAG, "%s", "");
+
+    if (thumbnails != NULL)
+    {
+        ARSAL_Mutex_Destroy(&thumbnails->lock);
+    }
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasThumbnails_Open(ARDATATRANSFER_MediasThumbnails_t *thumbnails, const char *localDirectory, uint64_t maxSize)
+{
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int resultSys = 0;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASTHUMBNAILS_TAG, "%s, %" PRIu64, localDirectory ? localDirectory : "null", maxSize);
+
+    if ((thumbnails == NULL) || (localDirectory == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&thumbnails->lock);
+
+        strncpy(thumbnails->directory, localDirectory, ARUTILS_FTP_MAX_PATH_SIZE);
+        thumbnails->directory[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(thumbnails->directory, ARDATATRANSFER_MEDIAS_THUMBNAILS_DIRECTORY_NAME, ARUTILS_FTP_MAX_PATH_SIZE - strlen(thumbnails->directory) - 1);
+        thumbnails->maxSize = 0;
+
+        if (maxSize == 0)
+        {
+            ARDATATRANSFER_MediasThumbnails_Evict(thumbnails, 0);
+
+            if ((rmdir(thumbnails->directory) != 0) && (errno != ENOENT))
+            {
+                ARSAL_PRINT(ARSAL_PRINT_ERROR, ARDATATRANSFER_MEDIASTHUMBNAILS_TAG, "rmdir %s failed: %d", thumbnails->directory, errno);
+            }
+        }
+        else
+        {
+            resultSys = mkdir(thumbnails->directory, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+
+            if ((resultSys != 0) && (errno != EEXIST))
+            {
+                result = ARDATATRANSFER_ERROR_SYSTEM;
+            }
+            else
+            {
+                ARDATATRANSFER_MediasThumbnails_Evict(thumbnails, maxSize);
+                thumbnails->maxSize = maxSize;
+            }
+        }
+
+        ARSAL_Mutex_Unlock(&thumbnails->lock);
+    }
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasThumbnails_Load(ARDATATRANSFER_MediasThumbnails_t *thumbnails, const char *remoteThumb, double mediaSize, uint8_t **thumbnail, uint32_t *thumbnailSize)
+{
+    char path[ARUTILS_FTP_MAX_PATH_SIZE];
+    ARDATATRANSFER_MediasThumbnails_Header_t header;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    struct stat fileStat;
+    uint8_t *data = NULL;
+    FILE *file = NULL;
+    int isLocked = 0;
+
+    if ((thumbnails == NULL) || (remoteThumb == NULL) || (thumbnail == NULL) || (thumbnailSize == NULL))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&thumbnails->lock);
+        isLocked = 1;
+
+        if (thumbnails->maxSize == 0)
+        {
+            result = ARDATATRANSFER_ERROR_FILE;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARDATATRANSFER_MediasThumbnails_GetPath(thumbnails, remoteThumb, mediaSize, path);
+        file = fopen(path, "rb");
+
+        if (file == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_FILE;
+        }
+    }
+
+    // Another thumbnail of the same name hash, or a file of another version, is a miss
+    if ((result == ARDATATRANSFER_OK)
+        && ((fstat(fileno(file), &fileStat) != 0)
+            || (fread(&header, sizeof(ARDATATRANSFER_MediasThumbnails_Header_t), 1, file) != 1)
+            || (memcmp(header.magic, ARDATATRANSFER_MEDIASTHUMBNAILS_MAGIC, sizeof(header.magic)) != 0)
+            || (header.version != ARDATATRANSFER_MEDIAS_THUMBNAILS_VERSION)
+            || (header.thumbnailSize == 0)
+            || ((uint64_t)fileStat.st_size != (sizeof(ARDATATRANSFER_MediasThumbnails_Header_t) + header.thumbnailSize))
+            || (header.mediaSize != mediaSize)
+            || (header.remoteThumb[ARUTILS_FTP_MAX_PATH_SIZE - 1] != '\0')
+            || (strcmp(header.remoteThumb, remoteThumb) != 0)))
+    {
+        result = ARDATATRANSFER_ERROR_FILE;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        data = (uint8_t *)malloc(header.thumbnailSize);
+
+        if (data == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_ALLOC;
+        }
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (fread(data, header.thumbnailSize, 1, file) != 1))
+    {
+        result = ARDATATRANSFER_ERROR_FILE;
+    }
+
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        // Least recently used first at the next eviction
+        utime(path, NULL);
+
+        *thumbnail = data;
+        *thumbnailSize = header.thumbnailSize;
+        data = NULL;
+    }
+
+    if (isLocked == 1)
+    {
+        ARSAL_Mutex_Unlock(&thumbnails->lock);
+    }
+
+    free(data);
+
+    return result;
+}
+
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasThumbnails_Save(ARDATATRANSFER_MediasThumbnails_t *thumbnails, const char *remoteThumb, double mediaSize, const uint8_t *thumbnail, uint32_t thumbnailSize)
+{
+    char path[ARUTILS_FTP_MAX_PATH_SIZE];
+    char tmpPath[ARUTILS_FTP_MAX_PATH_SIZE];
+    ARDATATRANSFER_MediasThumbnails_Header_t header;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    uint64_t fileSize = sizeof(ARDATATRANSFER_MediasThumbnails_Header_t) + (uint64_t)thumbnailSize;
+    FILE *file = NULL;
+    int isLocked = 0;
+
+    if ((thumbnails == NULL) || (remoteThumb == NULL) || (thumbnail == NULL) || (thumbnailSize == 0))
+    {
+        result = ARDATATRANSFER_ERROR_BAD_PARAMETER;
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        ARSAL_Mutex_Lock(&thumbnails->lock);
+        isLocked = 1;
+
+        if (fileSize > thumbnails->maxSize)
+        {
+            // Disabled, or a thumbnail larger than the whole cache
+            result = ARDATATRANSFER_ERROR_FILE;
+        }
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        memset(&header, 0, sizeof(ARDATATRANSFER_MediasThumbnails_Header_t));
+        memcpy(header.magic, ARDATATRANSFER_MEDIASTHUMBNAILS_MAGIC, sizeof(header.magic));
+        header.version = ARDATATRANSFER_MEDIAS_THUMBNAILS_VERSION;
+        header.thumbnailSize = thumbnailSize;
+        header.mediaSize = mediaSize;
+        strncpy(header.remoteThumb, remoteThumb, ARUTILS_FTP_MAX_PATH_SIZE);
+        header.remoteThumb[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+
+        ARDATATRANSFER_MediasThumbnails_GetPath(thumbnails, remoteThumb, mediaSize, path);
+        strncpy(tmpPath, path, ARUTILS_FTP_MAX_PATH_SIZE);
+        tmpPath[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(tmpPath, ARDATATRANSFER_MEDIASTHUMBNAILS_TMP_EXT, ARUTILS_FTP_MAX_PATH_SIZE - strlen(tmpPath) - 1);
+
+        // Written aside then renamed, a reader never sees a partial thumbnail
+        file = fopen(tmpPath, "wb");
+
+        if (file == NULL)
+        {
+            result = ARDATATRANSFER_ERROR_FILE;
+        }
+    }
+
+    if ((result == ARDATATRANSFER_OK)
+        && ((fwrite(&header, sizeof(ARDATATRANSFER_MediasThumbnails_Header_t), 1, file) != 1)
+            || (fwrite(thumbnail, thumbnailSize, 1, file) != 1)))
+    {
+        result = ARDATATRANSFER_ERROR_FILE;
+    }
+
+    if ((file != NULL) && (fclose(file) != 0))
+    {
+        result = ARDATATRANSFER_ERROR_FILE;
+    }
+
+    if ((result == ARDATATRANSFER_OK) && (rename(tmpPath, path) != 0))
+    {
+        result = ARDATATRANSFER_ERROR_FILE;
+    }
+
+    if ((result != ARDATATRANSFER_OK) && (file != NULL))
+    {
+        remove(tmpPath);
+    }
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        // A replaced file is counted twice until the eviction counts the files again
+        thumbnails->size += fileSize;
+
+        if (thumbnails->size > thumbnails->maxSize)
+        {
+            // Down to three quarters, not to scan the directory at each new thumbnail
+            ARDATATRANSFER_MediasThumbnails_Evict(thumbnails, thumbnails->maxSize - (thumbnails->maxSize / 4));
+        }
+    }
+
+    if (isLocked == 1)
+    {
+        ARSAL_Mutex_Unlock(&thumbnails->lock);
+    }
+
+    return result;
+}
+
+void ARDATATRANSFER_MediasThumbnails_Remove(ARDATATRANSFER_MediasThumbnails_t *thumbnails, const char *remoteThumb, double mediaSize)
+{
+    char path[ARUTILS_FTP_MAX_PATH_SIZE];
+    struct stat fileStat;
+
+    if ((thumbnails != NULL) && (remoteThumb != NULL))
+    {
+        ARSAL_Mutex_Lock(&thumbnails->lock);
+
+        if (thumbnails->maxSize > 0)
+        {
+            ARDATATRANSFER_MediasThumbnails_GetPath(thumbnails, remoteThumb, mediaSize, path);
+
+            if ((stat(path, &fileStat) == 0) && (remove(path) == 0))
+            {
+                thumbnails->size -= ((uint64_t)fileStat.st_size < thumbnails->size) ? (uint64_t)fileStat.st_size : thumbnails->size;
+            }
+        }
+
+        ARSAL_Mutex_Unlock(&thumbnails->lock);
+    }
+}
+
+void ARDATATRANSFER_MediasThumbnails_GetPath(ARDATATRANSFER_MediasThumbnails_t *thumbnails, const char *remoteThumb, double mediaSize, char *path)
+{
+    char name[ARDATATRANSFER_MEDIAS_THUMBNAILS_NAME_SIZE];
+
+    snprintf(name, ARDATATRANSFER_MEDIAS_THUMBNAILS_NAME_SIZE, "%08" PRIx32 "_%" PRIx64 ARDATATRANSFER_MEDIASTHUMBNAILS_EXT, ARDATATRANSFER_MediasIndex_Hash(remoteThumb, strlen(remoteThumb)), (uint64_t)mediaSize);
+    strncpy(path, thumbnails->directory, ARUTILS_FTP_MAX_PATH_SIZE);
+    path[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+    strncat(path, name, ARUTILS_FTP_MAX_PATH_SIZE - strlen(path) - 1);
+}
+
+void ARDATATRANSFER_MediasThumbnails_Evict(ARDATATRANSFER_MediasThumbnails_t *thumbnails, uint64_t targetSize)
+{
+    char path[ARUTILS_FTP_MAX_PATH_SIZE];
+    ARDATATRANSFER_MediasThumbnails_Entry_t *entries = NULL;
+    ARDATATRANSFER_MediasThumbnails_Entry_t *newEntries;
+    struct dirent *dirEntry;
+    struct stat fileStat;
+    DIR *dir;
+    uint64_t size = 0;
+    int capacity = 0;
+    int count = 0;
+    int removedCount = 0;
+    int i;
+
+    dir = opendir(thumbnails->directory);
+
+    while ((dir != NULL) && ((dirEntry = readdir(dir)) != NULL))
+    {
+        strncpy(path, thumbnails->directory, ARUTILS_FTP_MAX_PATH_SIZE);
+        path[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+        strncat(path, dirEntry->d_name, ARUTILS_FTP_MAX_PATH_SIZE - strlen(path) - 1);
+
+        if ((strlen(dirEntry->d_name) < ARDATATRANSFER_MEDIAS_THUMBNAILS_NAME_SIZE) && (stat(path, &fileStat) == 0) && S_ISREG(fileStat.st_mode))
+        {
+            if (count == capacity)
+            {
+                capacity = (capacity == 0) ? 64 : (capacity * 2);
+                newEntries = (ARDATATRANSFER_MediasThumbnails_Entry_t *)realloc(entries, capacity * sizeof(ARDATATRANSFER_MediasThumbnails_Entry_t));
+
+                if (newEntries == NULL)
+                {
+                    break;
+                }
+
+                entries = newEntries;
+            }
+
+            strncpy(entries[count].name, dirEntry->d_name, ARDATATRANSFER_MEDIAS_THUMBNAILS_NAME_SIZE);
+            entries[count].name[ARDATATRANSFER_MEDIAS_THUMBNAILS_NAME_SIZE - 1] = '\0';
+            entries[count].accessTime = fileStat.st_mtime;
+            entries[count].size = fileStat.st_size;
+            size += entries[count].size;
+            count++;
+        }
+    }
+
+    if (dir != NULL)
+    {
+        closedir(dir);
+    }
+
+    if (size > targetSize)
+    {
+        qsort(entries, count, sizeof(ARDATATRANSFER_MediasThumbnails_Entry_t), ARDATATRANSFER_MediasThumbnails_CompareEntries);
+
+        for (i=0; (size > targetSize) && (i < count); i++)
+        {
+            strncpy(path, thumbnails->directory, ARUTILS_FTP_MAX_PATH_SIZE);
+            path[ARUTILS_FTP_MAX_PATH_SIZE - 1] = '\0';
+            strncat(path, entries[i].name, ARUTILS_FTP_MAX_PATH_SIZE - strlen(path) - 1);
+
+            if (remove(path) == 0)
+            {
+                size -= entries[i].size;
+                removedCount++;
+            }
+        }
+    }
+
+    thumbnails->size = size;
+
+    ARSAL_PRINT(ARSAL_PRINT_DEBUG, ARDATATRANSFER_MEDIASTHUMBNAILS_TAG, "%d files, %d removed, %" PRIu64 " bytes", count, removedCount, size);
+
+    free(entries);
+}
+
+int ARDATATRANSFER_MediasThumbnails_CompareEntries(const void *a, const void *b)
+{
+    const ARDATATRANSFER_MediasThumbnails_Entry_t *entryA = (const ARDATATRANSFER_MediasThumbnails_Entry_t *)a;
+    const ARDATATRANSFER_MediasThumbnails_Entry_t *entryB = (const ARDATATRANSFER_MediasThumbnails_Entry_t *)b;
+
+    return (entryA->accessTime > entryB->accessTime) - (entryA->accessTime < entryB->accessTime);
+}
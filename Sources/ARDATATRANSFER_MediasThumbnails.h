@@ -0,0 +1,194 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file ARDATATRANSFER_MediasThumbnails.h
+ * @brief libARDataTransfer MediasThumbnails header file, the disk cache of the medias thumbnails.
+ **/
+
+#ifndef _ARDATATRANSFER_MEDIASTHUMBNAILS_PRIVATE_H_
+#define _ARDATATRANSFER_MEDIASTHUMBNAILS_PRIVATE_H_
+
+/**
+ * @brief Defines the thumbnails cache directory name, in the MediasDownloader local directory
+ * @see ARDATATRANSFER_MediasThumbnails_Open ()
+ */
+#define ARDATATRANSFER_MEDIAS_THUMBNAILS_DIRECTORY_NAME     ".medias_thumbnails/"
+
+/**
+ * @brief Defines the thumbnail file format version, to increment when the layout of the file changes
+ * @see ARDATATRANSFER_MediasThumbnails_Header_t
+ */
+#define ARDATATRANSFER_MEDIAS_THUMBNAILS_VERSION            1
+
+/**
+ * @brief Defines the size of a thumbnail file name
+ * @see ARDATATRANSFER_MediasThumbnails_GetPath ()
+ */
+#define ARDATATRANSFER_MEDIAS_THUMBNAILS_NAME_SIZE          64
+
+/**
+ * @brief Thumbnail file header, followed by the thumbnail
+ * @param magic The file signature
+ * @param version The file format version
+ * @param thumbnailSize The size of the thumbnail
+ * @param mediaSize The size of the media of the thumbnail
+ * @param remoteThumb The remote path of the thumbnail
+ * @see ARDATATRANSFER_MediasThumbnails_Save ()
+ */
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t thumbnailSize;
+    double mediaSize;
+    char remoteThumb[ARUTILS_FTP_MAX_PATH_SIZE];
+
+} ARDATATRANSFER_MediasThumbnails_Header_t;
+
+/**
+ * @brief Thumbnail file found by the scan of the cache directory
+ * @param name The file name
+ * @param accessTime The modification time of the file, set again when the thumbnail is read
+ * @param size The file size
+ * @see ARDATATRANSFER_MediasThumbnails_Evict ()
+ */
+typedef struct
+{
+    char name[ARDATATRANSFER_MEDIAS_THUMBNAILS_NAME_SIZE];
+    time_t accessTime;
+    uint64_t size;
+
+} ARDATATRANSFER_MediasThumbnails_Entry_t;
+
+/**
+ * @brief MediasThumbnails structure
+ * @param directory The cache directory, ending with a '/'
+ * @param maxSize The maximum size in bytes of the cache files, 0 while the cache is disabled
+ * @param size The size in bytes of the cache files, counted again by each eviction
+ * @param lock The mutex to protect the cache access
+ * @see ARDATATRANSFER_MediasThumbnails_New ()
+ */
+typedef struct _ARDATATRANSFER_MediasThumbnails_t_
+{
+    char directory[ARUTILS_FTP_MAX_PATH_SIZE];
+    uint64_t maxSize;
+    uint64_t size;
+    ARSAL_Mutex_t lock;
+
+} ARDATATRANSFER_MediasThumbnails_t;
+
+/**
+ * @brief Create a new ARDataTransfer MediasThumbnails, disabled until opened
+ * @param thumbnails The address of the pointer on the ARDataTransfer MediasThumbnails
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasThumbnails_Delete ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasThumbnails_New(ARDATATRANSFER_MediasThumbnails_t *thumbnails);
+
+/**
+ * @brief Delete an ARDataTransfer MediasThumbnails, the cache files are kept
+ * @param thumbnails The address of the pointer on the ARDataTransfer MediasThumbnails
+ * @see ARDATATRANSFER_MediasThumbnails_New ()
+ */
+void ARDATATRANSFER_MediasThumbnails_Delete(ARDATATRANSFER_MediasThumbnails_t *thumbnails);
+
+/**
+ * @brief Enable the cache in a local directory and evict the least recently used thumbnails above its maximum size
+ * @param thumbnails The address of the pointer on the ARDataTransfer MediasThumbnails
+ * @param localDirectory The directory of the cache directory, ending with a '/'
+ * @param maxSize The maximum size in bytes of the cache files, 0 to disable the cache and remove its files
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasThumbnails_Load ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasThumbnails_Open(ARDATATRANSFER_MediasThumbnails_t *thumbnails, const char *localDirectory, uint64_t maxSize);
+
+/**
+ * @brief Read the cached thumbnail of a media
+ * @warning This function allocates memory
+ * @param thumbnails The address of the pointer on the ARDataTransfer MediasThumbnails
+ * @param remoteThumb The remote path of the thumbnail
+ * @param mediaSize The size of the media, a media written again under the same name has another thumbnail
+ * @param[out] thumbnail The thumbnail, to free by the caller
+ * @param[out] thumbnailSize The size of the thumbnail
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR, ARDATATRANSFER_ERROR_FILE if the thumbnail is not cached.
+ * @see ARDATATRANSFER_MediasThumbnails_Save ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasThumbnails_Load(ARDATATRANSFER_MediasThumbnails_t *thumbnails, const char *remoteThumb, double mediaSize, uint8_t **thumbnail, uint32_t *thumbnailSize);
+
+/**
+ * @brief Write the thumbnail of a media to the cache, then evict the least recently used thumbnails if the cache is full
+ * @param thumbnails The address of the pointer on the ARDataTransfer MediasThumbnails
+ * @param remoteThumb The remote path of the thumbnail
+ * @param mediaSize The size of the media
+ * @param thumbnail The thumbnail
+ * @param thumbnailSize The size of the thumbnail
+ * @retval On success, returns ARDATATRANSFER_OK. Otherwise, it returns an error number of eARDATATRANSFER_ERROR.
+ * @see ARDATATRANSFER_MediasThumbnails_Load ()
+ */
+eARDATATRANSFER_ERROR ARDATATRANSFER_MediasThumbnails_Save(ARDATATRANSFER_MediasThumbnails_t *thumbnails, const char *remoteThumb, double mediaSize, const uint8_t *thumbnail, uint32_t thumbnailSize);
+
+/**
+ * @brief Remove the cached thumbnail of a media
+ * @param thumbnails The address of the pointer on the ARDataTransfer MediasThumbnails
+ * @param remoteThumb The remote path of the thumbnail
+ * @param mediaSize The size of the media
+ * @see ARDATATRANSFER_MediasThumbnails_Save ()
+ */
+void ARDATATRANSFER_MediasThumbnails_Remove(ARDATATRANSFER_MediasThumbnails_t *thumbnails, const char *remoteThumb, double mediaSize);
+
+/**
+ * @brief Get the path of the cache file of a thumbnail, named after the hash of its remote path and the size of its media
+ * @param thumbnails The address of the pointer on the ARDataTransfer MediasThumbnails
+ * @param remoteThumb The remote path of the thumbnail
+ * @param mediaSize The size of the media
+ * @param[out] path The path of the cache file, of ARUTILS_FTP_MAX_PATH_SIZE bytes
+ * @see ARDATATRANSFER_MediasThumbnails_Load ()
+ */
+void ARDATATRANSFER_MediasThumbnails_GetPath(ARDATATRANSFER_MediasThumbnails_t *thumbnails, const char *remoteThumb, double mediaSize, char *path);
+
+/**
+ * @brief Count the cache files and remove the least recently used ones until their size is at most a target size, with the lock taken
+ * @param thumbnails The address of the pointer on the ARDataTransfer MediasThumbnails
+ * @param targetSize The size in bytes to bring the cache files down to
+ * @see ARDATATRANSFER_MediasThumbnails_Save ()
+ */
+void ARDATATRANSFER_MediasThumbnails_Evict(ARDATATRANSFER_MediasThumbnails_t *thumbnails, uint64_t targetSize);
+
+/**
+ * @brief Compare two cache files by access time, the least recently used first
+ * @param a The first ARDATATRANSFER_MediasThumbnails_Entry_t
+ * @param b The second ARDATATRANSFER_MediasThumbnails_Entry_t
+ * @retval Returns a negative value if a was used before b, 0 if at the same time, else a positive value
+ * @see ARDATATRANSFER_MediasThumbnails_Evict ()
+ */
+int ARDATATRANSFER_MediasThumbnails_CompareEntries(const void *a, const void *b);
+
+#endif /* _ARDATATRANSFER_MEDIASTHUMBNAILS_PRIVATE_H_ */
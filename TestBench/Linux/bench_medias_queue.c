@@ -0,0 +1,323 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file bench_medias_queue.c
+ * @brief libARDataTransfer MediasQueue micro benchmark c file.
+ * Build it against the library sources, e.g.:
+ * gcc -O2 -I../../Includes -I../../Sources bench_medias_queue.c ../../Sources/ARDATATRANSFER_MediasQueue.c ../../Sources/ARDATATRANSFER_MediasDate.c -larsal
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Mutex.h>
+#include <libARUtils/ARUtils.h>
+
+#include <libARDataTransfer/ARDataTransfer.h>
+#include "ARDATATRANSFER_MediasQueue.h"
+
+#define TAG             "bench_medias_queue"
+
+static double bench_medias_queue_elapsed_ns(struct timespec *start, struct timespec *end)
+{
+    return ((double)(end->tv_sec - start->tv_sec) * 1e9) + (double)(end->tv_nsec - start->tv_nsec);
+}
+
+static ARDATATRANSFER_FtpMedia_t * bench_medias_queue_new_sized_media(int i, double size)
+{
+    ARDATATRANSFER_Media_t media;
+
+    memset(&media, 0, sizeof(ARDATATRANSFER_Media_t));
+    snprintf(media.name, ARDATATRANSFER_MEDIA_NAME_SIZE, "Bebop_Drone_%08d.mp4", i);
+    snprintf(media.date, ARDATATRANSFER_MEDIA_DATE_SIZE, "2014-12-15T102030+0100");
+    snprintf(media.remotePath, ARUTILS_FTP_MAX_PATH_SIZE, "/internal_000/Bebop_Drone/media/Bebop_Drone_%08d.mp4", i);
+    media.size = size;
+
+    return ARDATATRANSFER_MediasQueue_NewMedia(&media);
+}
+
+static ARDATATRANSFER_FtpMedia_t * bench_medias_queue_new_media(int i)
+{
+    return bench_medias_queue_new_sized_media(i, (double)i);
+}
+
+static int bench_medias_queue_run(int count)
+{
+    ARDATATRANSFER_MediasQueue_t queue;
+    ARDATATRANSFER_FtpMedia_t **medias;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia;
+    eARDATATRANSFER_ERROR error = ARDATATRANSFER_OK;
+    struct timespec start, end;
+    double addNs, popNs;
+    int inOrder = 1;
+    int isAttached = 0;
+    int i;
+
+    medias = calloc(count, sizeof(ARDATATRANSFER_FtpMedia_t *));
+    for (i=0; i<count; i++)
+    {
+        medias[i] = bench_medias_queue_new_media(i);
+    }
+
+    ARDATATRANSFER_MediasQueue_New(&queue);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i=0; i<count; i++)
+    {
+        ARDATATRANSFER_MediasQueue_Add(&queue, medias[i], &isAttached);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    addNs = bench_medias_queue_elapsed_ns(&start, &end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i=0; i<count; i++)
+    {
+        ftpMedia = ARDATATRANSFER_MediasQueue_Pop(&queue, &error);
+        ARDATATRANSFER_MediasQueue_Release(&queue, ftpMedia);
+        if (ftpMedia != medias[i])
+        {
+            inOrder = 0;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    popNs = bench_medias_queue_elapsed_ns(&start, &end);
+
+    printf("%8d medias: add %8.1f ns/op, pop %8.1f ns/op, fifo %s\n", count, addNs / count, popNs / count, inOrder ? "yes" : "NO");
+
+    ARDATATRANSFER_MediasQueue_Delete(&queue);
+
+    for (i=0; i<count; i++)
+    {
+        free(medias[i]);
+    }
+    free(medias);
+
+    return inOrder;
+}
+
+static int bench_medias_queue_run_equal_priority(int count)
+{
+    ARDATATRANSFER_MediasQueue_t queue;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia;
+    eARDATATRANSFER_ERROR error = ARDATATRANSFER_OK;
+    int isAttached = 0;
+    int inOrder = 1;
+    int i;
+
+    ARDATATRANSFER_MediasQueue_New(&queue);
+
+    // The default policy keeps the insertion order among medias of the same priority, whatever their size
+    for (i=0; i<count; i++)
+    {
+        ftpMedia = bench_medias_queue_new_sized_media(i, (double)(count - i));
+        ftpMedia->priority = ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_BULK;
+        ARDATATRANSFER_MediasQueue_Add(&queue, ftpMedia, &isAttached);
+    }
+
+    for (i=0; i<count; i++)
+    {
+        ftpMedia = ARDATATRANSFER_MediasQueue_Pop(&queue, &error);
+        ARDATATRANSFER_MediasQueue_Release(&queue, ftpMedia);
+        if ((ftpMedia == NULL) || (ftpMedia->size != (double)(count - i)))
+        {
+            inOrder = 0;
+        }
+        free(ftpMedia);
+    }
+
+    printf("%8d medias: equal priority fifo %s\n", count, inOrder ? "yes" : "NO");
+
+    ARDATATRANSFER_MediasQueue_Delete(&queue);
+
+    return inOrder;
+}
+
+static int bench_medias_queue_run_priority(int count)
+{
+    ARDATATRANSFER_MediasQueue_t queue;
+    ARDATATRANSFER_FtpMedia_t **medias;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia;
+    eARDATATRANSFER_ERROR error = ARDATATRANSFER_OK;
+    struct timespec start, end;
+    int inOrder = 1;
+    int isAttached = 0;
+    int i;
+
+    medias = calloc(count + 1, sizeof(ARDATATRANSFER_FtpMedia_t *));
+    ARDATATRANSFER_MediasQueue_New(&queue);
+
+    for (i=0; i<=count; i++)
+    {
+        medias[i] = bench_medias_queue_new_media(i);
+        medias[i]->priority = ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_NORMAL;
+        ARDATATRANSFER_MediasQueue_Add(&queue, medias[i], &isAttached);
+    }
+
+    // The last media moves up to the top of the heap, the first one down to its bottom
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    ARDATATRANSFER_MediasQueue_SetPriority(&queue, medias[count]->remotePath, ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_INTERACTIVE);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ARDATATRANSFER_MediasQueue_SetPriority(&queue, medias[0]->remotePath, ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_BULK);
+
+    for (i=0; i<=count; i++)
+    {
+        ftpMedia = ARDATATRANSFER_MediasQueue_Pop(&queue, &error);
+        ARDATATRANSFER_MediasQueue_Release(&queue, ftpMedia);
+        if (ftpMedia != medias[(i == 0) ? count : ((i == count) ? 0 : i)])
+        {
+            inOrder = 0;
+        }
+    }
+
+    printf("%8d medias: reprioritize %8.1f ns, priority order %s\n", count, bench_medias_queue_elapsed_ns(&start, &end), inOrder ? "yes" : "NO");
+
+    ARDATATRANSFER_MediasQueue_Delete(&queue);
+
+    for (i=0; i<=count; i++)
+    {
+        free(medias[i]);
+    }
+    free(medias);
+
+    return inOrder;
+}
+
+static void bench_medias_queue_run_duplicates(int count)
+{
+    ARDATATRANSFER_MediasQueue_t queue;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia;
+    struct timespec start, end;
+    int isAttached = 0;
+    int attached = 0;
+    int i;
+
+    ARDATATRANSFER_MediasQueue_New(&queue);
+
+    for (i=0; i<count; i++)
+    {
+        ARDATATRANSFER_MediasQueue_Add(&queue, bench_medias_queue_new_media(i), &isAttached);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i=0; i<count; i++)
+    {
+        ftpMedia = bench_medias_queue_new_media(i);
+        ARDATATRANSFER_MediasQueue_Add(&queue, ftpMedia, &isAttached);
+        attached += isAttached;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("%8d medias: duplicate add %8.1f ns/op, coalesced %s\n", count, bench_medias_queue_elapsed_ns(&start, &end) / count, ((attached == count) && (queue.count == count)) ? "yes" : "NO");
+
+    ARDATATRANSFER_MediasQueue_Delete(&queue);
+}
+
+static void bench_medias_queue_run_policy(eARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY policy, const char *name)
+{
+    ARDATATRANSFER_MediasQueue_t queue;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia;
+    eARDATATRANSFER_ERROR error = ARDATATRANSFER_OK;
+    double elapsed = 0.f;
+    double totalElapsed = 0.f;
+    int isAttached = 0;
+    int count = 0;
+    int i;
+
+    ARDATATRANSFER_MediasQueue_New(&queue);
+    ARDATATRANSFER_MediasQueue_SetPolicy(&queue, policy);
+
+    // A user selection of two 4 GB videos among 20 photos of 5 MB
+    for (i=0; i<22; i++)
+    {
+        ftpMedia = bench_medias_queue_new_sized_media(i, ((i % 11) == 0) ? 4e9 : 5e6);
+        ARDATATRANSFER_MediasQueue_Add(&queue, ftpMedia, &isAttached);
+    }
+
+    // Time to available of each media at 10 MB/s
+    while ((ftpMedia = ARDATATRANSFER_MediasQueue_Pop(&queue, &error)) != NULL)
+    {
+        ARDATATRANSFER_MediasQueue_Release(&queue, ftpMedia);
+        elapsed += ftpMedia->size / 10e6;
+        totalElapsed += elapsed;
+        count++;
+        free(ftpMedia);
+    }
+
+    printf("%14s policy: mean time to available %8.1f s\n", name, totalElapsed / count);
+
+    ARDATATRANSFER_MediasQueue_Delete(&queue);
+}
+
+static void bench_medias_queue_run_footprint(void)
+{
+    ARDATATRANSFER_Media_t media;
+
+    memset(&media, 0, sizeof(ARDATATRANSFER_Media_t));
+    snprintf(media.name, ARDATATRANSFER_MEDIA_NAME_SIZE, "Bebop_Drone_2014-12-15T102030+0100_1A2B3C.mp4");
+    snprintf(media.date, ARDATATRANSFER_MEDIA_DATE_SIZE, "2014-12-15T102030+0100");
+    snprintf(media.uuid, ARDATATRANSFER_MEDIA_UUID_SIZE, "0123456789abcdef0123456789abcdef");
+    snprintf(media.remotePath, ARUTILS_FTP_MAX_PATH_SIZE, "/internal_000/Bebop_Drone/media/%s", media.name);
+    snprintf(media.remoteThumb, ARUTILS_FTP_MAX_PATH_SIZE, "/internal_000/Bebop_Drone/thumb/%s.jpg", media.name);
+
+    printf("queue entry: %zu bytes, embedded media copy: %zu bytes\n", ARDATATRANSFER_MediasQueue_GetRecordSize(&media), sizeof(ARDATATRANSFER_Media_t));
+}
+
+int main(void)
+{
+    int count;
+    int failed = 0;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "bench Starting");
+
+    bench_medias_queue_run_footprint();
+
+    for (count = 1000; count <= 100000; count *= 10)
+    {
+        failed |= !bench_medias_queue_run(count);
+        failed |= !bench_medias_queue_run_equal_priority(count);
+        failed |= !bench_medias_queue_run_priority(count);
+        bench_medias_queue_run_duplicates(count);
+    }
+
+    bench_medias_queue_run_policy(ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_FIFO, "fifo");
+    bench_medias_queue_run_policy(ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_SMALLEST_FIRST, "smallest first");
+
+    if (failed)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "%s", "bench Failed, the queue lost the insertion or the priority order");
+    }
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "bench Completed");
+    return failed;
+}
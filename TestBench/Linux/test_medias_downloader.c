@@ -0,0 +1,2710 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file test_medias_downloader.c
+ * @brief libARDataTransfer medias downloader behaviour tests c file.
+ * Build it against the library sources and the mftpd stand-in, which replaces the FTP manager of libARUtils, e.g.:
+ * gcc -I../../Includes -I../../Sources test_medias_downloader.c test_medias_ftp.c ../../Sources/ARDATATRANSFER_*.c ../../gen/Sources/ARDATATRANSFER_Error.c -lardiscovery -larutils -larsal -lpthread
+ * It runs every test, or the ones named as arguments, and exits nonzero when one fails.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Sem.h>
+#include <libARSAL/ARSAL_Mutex.h>
+#include <libARSAL/ARSAL_Thread.h>
+#include <libARUtils/ARUtils.h>
+
+#include <libARDataTransfer/ARDataTransfer.h>
+#include <libARDataTransfer/ARDATATRANSFER_Downloader.h>
+#include <libARDataTransfer/ARDATATRANSFER_Uploader.h>
+#include "ARDATATRANSFER_Downloader.h"
+#include "ARDATATRANSFER_Uploader.h"
+#include "ARDATATRANSFER_MediasIndex.h"
+#include "ARDATATRANSFER_MediasQueue.h"
+#include "ARDATATRANSFER_MediasJournal.h"
+#include "ARDATATRANSFER_MediasThumbnails.h"
+#include "ARDATATRANSFER_DataDownloader.h"
+#include "ARDATATRANSFER_MediasDownloader.h"
+#include "ARDATATRANSFER_MediasCatalog.h"
+#include "ARDATATRANSFER_Manager.h"
+
+#include "test_medias_ftp.h"
+
+#define TAG                                         "test_medias_downloader"
+#define TEST_MEDIAS_DOWNLOADER_MAX_WORKERS          8
+#define TEST_MEDIAS_DOWNLOADER_MAX_MEDIAS           64
+#define TEST_MEDIAS_DOWNLOADER_TIMEOUT_MS           10000
+#define TEST_MEDIAS_DOWNLOADER_DIRECTORY_SIZE       96
+#define TEST_MEDIAS_DOWNLOADER_REMOTE_MEDIA         "/internal_000/Bebop_Drone/media/"
+#define TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM          "/DCIM/"
+#define TEST_MEDIAS_DOWNLOADER_REMOTE_THUMB         "/.META/thumb/"
+#define TEST_MEDIAS_DOWNLOADER_PAGES_MEDIAS_COUNT   11
+#define TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT     70
+
+typedef struct
+{
+    int completions;
+    int progresses;
+    int order;
+    eARDATATRANSFER_ERROR error;
+
+} test_medias_downloader_record_t;
+
+typedef struct
+{
+    char localDirectory[TEST_MEDIAS_DOWNLOADER_DIRECTORY_SIZE];
+    ARDATATRANSFER_Manager_t *manager;
+    ARUTILS_Manager_t *listConnection;
+    ARUTILS_Manager_t *listConnections[TEST_MEDIAS_DOWNLOADER_MAX_WORKERS];
+    int listConnectionsCount;
+    ARUTILS_Manager_t *queueConnections[TEST_MEDIAS_DOWNLOADER_MAX_WORKERS];
+    ARSAL_Thread_t threads[TEST_MEDIAS_DOWNLOADER_MAX_WORKERS];
+    int workersCount;
+    int threadsCount;
+    ARDATATRANSFER_Media_t medias[TEST_MEDIAS_DOWNLOADER_MAX_MEDIAS];
+    test_medias_downloader_record_t records[TEST_MEDIAS_DOWNLOADER_MAX_MEDIAS];
+    int order[TEST_MEDIAS_DOWNLOADER_MAX_MEDIAS * 2];
+    int orderCount;
+
+} test_medias_downloader_fixture_t;
+
+typedef int (*test_medias_downloader_test_t)(const char *baseDirectory);
+
+static int test_medias_downloader_completions = 0;
+
+static int test_medias_downloader_expect(int condition, const char *test, const char *what)
+{
+    if (!condition)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "%s: expected %s", test, what);
+    }
+
+    return condition ? 0 : 1;
+}
+
+static void test_medias_downloader_progress(void *arg, ARDATATRANSFER_Media_t *media, float percent)
+{
+    test_medias_downloader_record_t *record = (test_medias_downloader_record_t *)arg;
+
+    __sync_fetch_and_add(&record->progresses, 1);
+}
+
+static void test_medias_downloader_completion(void *arg, ARDATATRANSFER_Media_t *media, eARDATATRANSFER_ERROR error)
+{
+    test_medias_downloader_record_t *record = (test_medias_downloader_record_t *)arg;
+
+    record->error = error;
+    __sync_fetch_and_add(&record->completions, 1);
+    record->order = __sync_fetch_and_add(&test_medias_downloader_completions, 1);
+}
+
+static void test_medias_downloader_fixture_completion(void *arg, ARDATATRANSFER_Media_t *media, eARDATATRANSFER_ERROR error)
+{
+    test_medias_downloader_fixture_t *fixture = (test_medias_downloader_fixture_t *)arg;
+    int index = (int)strtol(media->uuid, NULL, 16);
+    int position = __sync_fetch_and_add(&fixture->orderCount, 1);
+
+    // The medias sharing the fixture as argument are told apart by their uuid
+    if (position < (TEST_MEDIAS_DOWNLOADER_MAX_MEDIAS * 2))
+    {
+        fixture->order[position] = index;
+    }
+    test_medias_downloader_completion(&fixture->records[index], media, error);
+}
+
+static int test_medias_downloader_wait_value(int *value, int expected)
+{
+    int elapsedMs;
+
+    for (elapsedMs = 0; (__atomic_load_n(value, __ATOMIC_ACQUIRE) < expected) && (elapsedMs < TEST_MEDIAS_DOWNLOADER_TIMEOUT_MS); elapsedMs++)
+    {
+        usleep(1000);
+    }
+
+    return (__atomic_load_n(value, __ATOMIC_ACQUIRE) >= expected) ? 1 : 0;
+}
+
+static int test_medias_downloader_wait_completions(int count)
+{
+    return test_medias_downloader_wait_value(&test_medias_downloader_completions, count);
+}
+
+static test_medias_downloader_fixture_t * test_medias_downloader_fixture_new(const char *baseDirectory, const char *name, int workersCount)
+{
+    test_medias_downloader_fixture_t *fixture;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int i;
+
+    test_medias_ftp_reset();
+    test_medias_downloader_completions = 0;
+
+    fixture = calloc(1, sizeof(test_medias_downloader_fixture_t));
+    if (fixture == NULL)
+    {
+        return NULL;
+    }
+
+    snprintf(fixture->localDirectory, sizeof(fixture->localDirectory), "%s/%s", baseDirectory, name);
+    fixture->workersCount = workersCount;
+    fixture->listConnection = test_medias_ftp_connection_new();
+    for (i=0; i<workersCount; i++)
+    {
+        fixture->queueConnections[i] = test_medias_ftp_connection_new();
+    }
+
+    fixture->manager = ARDATATRANSFER_Manager_New(&result);
+
+    if (result == ARDATATRANSFER_OK)
+    {
+        result = ARDATATRANSFER_MediasDownloader_New(fixture->manager, fixture->listConnection, fixture->queueConnections[0], "", fixture->localDirectory);
+    }
+
+    for (i=1; (result == ARDATATRANSFER_OK) && (i < workersCount); i++)
+    {
+        result = ARDATATRANSFER_MediasDownloader_AddQueueWorker(fixture->manager, fixture->queueConnections[i]);
+    }
+
+    if (result != ARDATATRANSFER_OK)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "%s: setup failed: %s", name, ARDATATRANSFER_Error_ToString(result));
+        ARDATATRANSFER_Manager_Delete(&fixture->manager);
+        test_medias_ftp_connection_delete(&fixture->listConnection);
+        for (i=0; i<workersCount; i++)
+        {
+            test_medias_ftp_connection_delete(&fixture->queueConnections[i]);
+        }
+        free(fixture);
+        fixture = NULL;
+    }
+
+    return fixture;
+}
+
+static void test_medias_downloader_fixture_start(test_medias_downloader_fixture_t *fixture)
+{
+    for (fixture->threadsCount = 0; fixture->threadsCount < fixture->workersCount; fixture->threadsCount++)
+    {
+        ARSAL_Thread_Create(&fixture->threads[fixture->threadsCount], ARDATATRANSFER_MediasDownloader_QueueThreadRun, fixture->manager);
+    }
+}
+
+static void test_medias_downloader_fixture_join(test_medias_downloader_fixture_t *fixture)
+{
+    int i;
+
+    for (i=0; i<fixture->threadsCount; i++)
+    {
+        ARSAL_Thread_Join(fixture->threads[i], NULL);
+        ARSAL_Thread_Destroy(&fixture->threads[i]);
+    }
+    fixture->threadsCount = 0;
+}
+
+static void test_medias_downloader_fixture_delete(test_medias_downloader_fixture_t *fixture)
+{
+    int i;
+
+    if (fixture->threadsCount > 0)
+    {
+        ARDATATRANSFER_MediasDownloader_CancelQueueThread(fixture->manager);
+        test_medias_downloader_fixture_join(fixture);
+    }
+
+    ARDATATRANSFER_MediasDownloader_Delete(fixture->manager);
+    ARDATATRANSFER_Manager_Delete(&fixture->manager);
+    test_medias_ftp_connection_delete(&fixture->listConnection);
+    for (i=0; i<fixture->listConnectionsCount; i++)
+    {
+        test_medias_ftp_connection_delete(&fixture->listConnections[i]);
+    }
+    for (i=0; i<fixture->workersCount; i++)
+    {
+        test_medias_ftp_connection_delete(&fixture->queueConnections[i]);
+    }
+    free(fixture);
+}
+
+static void test_medias_downloader_init_media(ARDATATRANSFER_Media_t *media, const char *localDirectory, int index)
+{
+    char name[ARDATATRANSFER_MEDIA_NAME_SIZE];
+    char filePath[ARDATATRANSFER_MEDIA_PATH_SIZE];
+
+    snprintf(name, sizeof(name), "Bebop_Drone_2014-12-15T102030+0100_%04X.mp4", index);
+    snprintf(filePath, sizeof(filePath), "%s/%s", localDirectory, name);
+
+    memset(media, 0, sizeof(ARDATATRANSFER_Media_t));
+    strcpy(media->name, name);
+    snprintf(media->date, ARDATATRANSFER_MEDIA_DATE_SIZE, "2014-12-15T102030+0100");
+    snprintf(media->uuid, ARDATATRANSFER_MEDIA_UUID_SIZE, "%032X", index);
+    strcpy(media->filePath, filePath);
+    snprintf(media->remotePath, ARUTILS_FTP_MAX_PATH_SIZE, TEST_MEDIAS_DOWNLOADER_REMOTE_MEDIA "%s", name);
+    media->size = 1000.f + index;
+}
+
+static ARDATATRANSFER_Media_t * test_medias_downloader_new_media(test_medias_downloader_fixture_t *fixture, int index)
+{
+    ARDATATRANSFER_Media_t *media = &fixture->medias[index];
+
+    test_medias_downloader_init_media(media, fixture->localDirectory, index);
+    test_medias_ftp_add_file(media->remotePath, media->size);
+
+    return media;
+}
+
+static eARDATATRANSFER_ERROR test_medias_downloader_add_media(test_medias_downloader_fixture_t *fixture, int index)
+{
+    return ARDATATRANSFER_MediasDownloader_AddMediaToQueue(fixture->manager, &fixture->medias[index], test_medias_downloader_progress, &fixture->records[index], test_medias_downloader_completion, &fixture->records[index]);
+}
+
+static int test_medias_downloader_priority(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    eARDATATRANSFER_ERROR result;
+    int mediasCount = 6;
+    int expected[6] = { 4, 1, 2, 3, 5, 0 };
+    int badCount = 0;
+    int failed = 0;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "priority", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    // Queued before the worker starts, the medias are downloaded one by one in the order of the heap
+    for (i=0; i<mediasCount; i++)
+    {
+        test_medias_downloader_new_media(fixture, i);
+        badCount += (test_medias_downloader_add_media(fixture, i) != ARDATATRANSFER_OK) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "priority", "every media queued");
+
+    result = ARDATATRANSFER_MediasDownloader_SetMediaPriority(fixture->manager, &fixture->medias[4], ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_INTERACTIVE);
+    failed |= test_medias_downloader_expect(result == ARDATATRANSFER_OK, "priority", "a queued media moved up");
+    result = ARDATATRANSFER_MediasDownloader_SetMediaPriority(fixture->manager, &fixture->medias[0], ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_BULK);
+    failed |= test_medias_downloader_expect(result == ARDATATRANSFER_OK, "priority", "a queued media moved down");
+
+    test_medias_downloader_new_media(fixture, mediasCount);
+    result = ARDATATRANSFER_MediasDownloader_SetMediaPriority(fixture->manager, &fixture->medias[mediasCount], ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_INTERACTIVE);
+    failed |= test_medias_downloader_expect(result == ARDATATRANSFER_ERROR_BAD_PARAMETER, "priority", "a media not queued refused");
+
+    test_medias_downloader_fixture_start(fixture);
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_completions(mediasCount), "priority", "every media completed");
+
+    // The medias of the same priority keep their queueing order
+    badCount = 0;
+    for (i=0; i<mediasCount; i++)
+    {
+        badCount += ((fixture->records[expected[i]].completions != 1) || (fixture->records[expected[i]].order != i)) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "priority", "the medias downloaded by priority, then in queueing order");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_policy_order(const char *baseDirectory, const char *name, eARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY policy, const double *sizes, const char * const *dates, const int *expected, int mediasCount)
+{
+    test_medias_downloader_fixture_t *fixture;
+    ARDATATRANSFER_Media_t *media;
+    int badCount = 0;
+    int failed = 0;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, name, 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    for (i=0; i<mediasCount; i++)
+    {
+        media = &fixture->medias[i];
+        test_medias_downloader_init_media(media, fixture->localDirectory, i);
+        media->size = sizes[i];
+        snprintf(media->date, ARDATATRANSFER_MEDIA_DATE_SIZE, "%s", dates[i]);
+        test_medias_ftp_add_file(media->remotePath, media->size);
+        badCount += (test_medias_downloader_add_media(fixture, i) != ARDATATRANSFER_OK) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, name, "every media queued");
+
+    // The policy reorders the medias already queued
+    failed |= test_medias_downloader_expect(ARDATATRANSFER_MediasDownloader_SetQueuePolicy(fixture->manager, policy) == ARDATATRANSFER_OK, name, "the policy set");
+
+    test_medias_downloader_fixture_start(fixture);
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_completions(mediasCount), name, "every media completed");
+
+    badCount = 0;
+    for (i=0; i<mediasCount; i++)
+    {
+        badCount += ((fixture->records[expected[i]].completions != 1) || (fixture->records[expected[i]].order != i)) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, name, "the medias downloaded in the order of the policy");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_policy(const char *baseDirectory)
+{
+    const double sizes[5] = { 5000., 1000., 3000., 2000., 4000. };
+    const double sameSizes[5] = { 1000., 1000., 1000., 1000., 1000. };
+    const char * const sameDates[5] = { "2014-12-15T102030+0100", "2014-12-15T102030+0100", "2014-12-15T102030+0100", "2014-12-15T102030+0100", "2014-12-15T102030+0100" };
+    const char * const dates[5] = { "2014-12-15T102030+0100", "not a date", "2015-01-01T000000+0000", "2014-12-15T102030-0100", "2014-12-15T103000+0100" };
+    const int smallestFirst[5] = { 1, 3, 2, 4, 0 };
+    const int newestFirst[5] = { 2, 3, 4, 0, 1 };
+    int failed = 0;
+
+    failed |= test_medias_downloader_policy_order(baseDirectory, "policy_smallest_first", ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_SMALLEST_FIRST, sizes, sameDates, smallestFirst, 5);
+
+    // The time zone offsets are applied, a date that can not be parsed goes last
+    failed |= test_medias_downloader_policy_order(baseDirectory, "policy_newest_first", ARDATATRANSFER_MEDIAS_DOWNLOADER_POLICY_NEWEST_FIRST, sameSizes, dates, newestFirst, 5);
+
+    return failed;
+}
+
+static int test_medias_downloader_drain(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    int mediasCount = 40;
+    int badCount = 0;
+    int failed = 0;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "drain", 4);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    test_medias_ftp_set_latency(200, 0);
+    test_medias_ftp_hold(50.f);
+    test_medias_downloader_fixture_start(fixture);
+
+    for (i=0; i<mediasCount; i++)
+    {
+        test_medias_downloader_new_media(fixture, i);
+        badCount += (test_medias_downloader_add_media(fixture, i) != ARDATATRANSFER_OK) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "drain", "every media queued");
+
+    // Each worker downloads a media on its own connection at the same time
+    failed |= test_medias_downloader_expect(test_medias_ftp_wait_held(4, TEST_MEDIAS_DOWNLOADER_TIMEOUT_MS), "drain", "four downloads in parallel");
+    test_medias_ftp_release();
+
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_completions(mediasCount), "drain", "every media completed");
+
+    // A second notification of a media would come right after the first one
+    usleep(20000);
+    badCount = 0;
+    for (i=0; i<mediasCount; i++)
+    {
+        if ((fixture->records[i].completions != 1) || (fixture->records[i].error != ARDATATRANSFER_OK)
+            || (test_medias_ftp_get_count(fixture->medias[i].remotePath) != 1) || (access(fixture->medias[i].filePath, F_OK) != 0))
+        {
+            badCount++;
+        }
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "drain", "every media downloaded and notified exactly once");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_cancel_fan_out(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    int mediasCount = 20;
+    int getsCount = 0;
+    int failed = 0;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "cancel_fan_out", 4);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    test_medias_ftp_set_latency(200, 0);
+    test_medias_ftp_hold(50.f);
+    test_medias_downloader_fixture_start(fixture);
+
+    for (i=0; i<mediasCount; i++)
+    {
+        test_medias_downloader_new_media(fixture, i);
+        test_medias_downloader_add_media(fixture, i);
+    }
+
+    failed |= test_medias_downloader_expect(test_medias_ftp_wait_held(4, TEST_MEDIAS_DOWNLOADER_TIMEOUT_MS), "cancel_fan_out", "four downloads in parallel");
+
+    // The cancel wakes up every worker and aborts every transfer, the join returns only if they all exit
+    failed |= test_medias_downloader_expect(ARDATATRANSFER_MediasDownloader_CancelQueueThread(fixture->manager) == ARDATATRANSFER_OK, "cancel_fan_out", "the queue canceled");
+    test_medias_downloader_fixture_join(fixture);
+
+    for (i=0; i<mediasCount; i++)
+    {
+        getsCount += test_medias_ftp_get_count(fixture->medias[i].remotePath);
+    }
+    failed |= test_medias_downloader_expect(getsCount == 4, "cancel_fan_out", "the queued medias not downloaded");
+    failed |= test_medias_downloader_expect(test_medias_downloader_completions == 0, "cancel_fan_out", "no completion for a canceled queue");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_last_worker_reset(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    int canceledCount = 0;
+    int badCount = 0;
+    int failed = 0;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "last_worker_reset", 3);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    test_medias_ftp_set_latency(200, 0);
+    test_medias_ftp_hold(50.f);
+    test_medias_downloader_fixture_start(fixture);
+
+    for (i=0; i<6; i++)
+    {
+        test_medias_downloader_new_media(fixture, i);
+        test_medias_downloader_add_media(fixture, i);
+    }
+
+    failed |= test_medias_downloader_expect(test_medias_ftp_wait_held(3, TEST_MEDIAS_DOWNLOADER_TIMEOUT_MS), "last_worker_reset", "three downloads in parallel");
+    ARDATATRANSFER_MediasDownloader_CancelQueueThread(fixture->manager);
+    test_medias_downloader_fixture_join(fixture);
+    test_medias_ftp_release();
+
+    // The last worker to exit resets the connections and the canceled state for the next run
+    for (i=0; i<fixture->workersCount; i++)
+    {
+        canceledCount += test_medias_ftp_is_canceled(fixture->queueConnections[i]);
+    }
+    failed |= test_medias_downloader_expect(canceledCount == 0, "last_worker_reset", "the connections reset");
+
+    test_medias_downloader_fixture_start(fixture);
+
+    for (i=6; i<12; i++)
+    {
+        test_medias_downloader_new_media(fixture, i);
+        badCount += (test_medias_downloader_add_media(fixture, i) != ARDATATRANSFER_OK) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "last_worker_reset", "every media queued again");
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_completions(6), "last_worker_reset", "the next run completed");
+
+    usleep(20000);
+    badCount = 0;
+    for (i=6; i<12; i++)
+    {
+        badCount += ((fixture->records[i].completions != 1) || (fixture->records[i].error != ARDATATRANSFER_OK)) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "last_worker_reset", "every media of the next run notified once");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_cancel_pending(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    int badCount = 0;
+    int failed = 0;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "cancel_pending", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    test_medias_ftp_set_latency(200, 0);
+    test_medias_ftp_hold(50.f);
+    test_medias_downloader_fixture_start(fixture);
+
+    for (i=0; i<4; i++)
+    {
+        test_medias_downloader_new_media(fixture, i);
+        test_medias_downloader_add_media(fixture, i);
+    }
+
+    failed |= test_medias_downloader_expect(test_medias_ftp_wait_held(1, TEST_MEDIAS_DOWNLOADER_TIMEOUT_MS), "cancel_pending", "the first media in flight");
+
+    // A pending media is notified before the cancel returns, its queue entry is gone
+    failed |= test_medias_downloader_expect(ARDATATRANSFER_MediasDownloader_CancelMediaDownload(fixture->manager, &fixture->medias[2]) == ARDATATRANSFER_OK, "cancel_pending", "the pending media canceled");
+    failed |= test_medias_downloader_expect((fixture->records[2].completions == 1) && (fixture->records[2].error == ARDATATRANSFER_ERROR_CANCELED), "cancel_pending", "the canceled media notified at once");
+    failed |= test_medias_downloader_expect(ARDATATRANSFER_MediasDownloader_CancelMediaDownload(fixture->manager, &fixture->medias[2]) == ARDATATRANSFER_ERROR_BAD_PARAMETER, "cancel_pending", "a second cancel to find nothing");
+
+    test_medias_ftp_release();
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_completions(4), "cancel_pending", "the other medias completed");
+
+    // The semaphore post of the canceled media makes the worker pop nothing, it then downloads the next media
+    test_medias_downloader_new_media(fixture, 4);
+    test_medias_downloader_add_media(fixture, 4);
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_completions(5), "cancel_pending", "a media queued after the cancel completed");
+
+    usleep(20000);
+    for (i=0; i<5; i++)
+    {
+        if (i == 2)
+        {
+            badCount += ((fixture->records[i].completions != 1) || (test_medias_ftp_get_count(fixture->medias[i].remotePath) != 0)) ? 1 : 0;
+        }
+        else
+        {
+            badCount += ((fixture->records[i].completions != 1) || (fixture->records[i].error != ARDATATRANSFER_OK)) ? 1 : 0;
+        }
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "cancel_pending", "the canceled media not downloaded and every media notified once");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_cancel_in_flight(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    int badCount = 0;
+    int failed = 0;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "cancel_in_flight", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    test_medias_ftp_set_latency(200, 0);
+    test_medias_ftp_hold(50.f);
+    test_medias_downloader_fixture_start(fixture);
+
+    for (i=0; i<3; i++)
+    {
+        test_medias_downloader_new_media(fixture, i);
+        test_medias_downloader_add_media(fixture, i);
+    }
+
+    failed |= test_medias_downloader_expect(test_medias_ftp_wait_held(1, TEST_MEDIAS_DOWNLOADER_TIMEOUT_MS), "cancel_in_flight", "the first media in flight");
+
+    // The transfer aborts on its connection only, the worker notifies it and goes on with the queue
+    failed |= test_medias_downloader_expect(ARDATATRANSFER_MediasDownloader_CancelMediaDownload(fixture->manager, &fixture->medias[0]) == ARDATATRANSFER_OK, "cancel_in_flight", "the media in flight canceled");
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_completions(1), "cancel_in_flight", "the canceled media notified");
+    failed |= test_medias_downloader_expect(fixture->records[0].error == ARDATATRANSFER_ERROR_CANCELED, "cancel_in_flight", "the canceled media notified as canceled");
+
+    test_medias_ftp_release();
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_completions(3), "cancel_in_flight", "the other medias completed");
+
+    usleep(20000);
+    for (i=0; i<3; i++)
+    {
+        badCount += (fixture->records[i].completions != 1) ? 1 : 0;
+        badCount += ((i > 0) && ((fixture->records[i].error != ARDATATRANSFER_OK) || (access(fixture->medias[i].filePath, F_OK) != 0))) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "cancel_in_flight", "the other medias downloaded and every media notified once");
+    failed |= test_medias_downloader_expect((access(fixture->medias[0].filePath, F_OK) != 0) && (test_medias_ftp_is_canceled(fixture->queueConnections[0]) == 0), "cancel_in_flight", "the canceled media not saved and the connection reset");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_duplicate_in_flight(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    eARDATATRANSFER_ERROR result;
+    int duplicatesCount = 8;
+    int badCount = 0;
+    int failed = 0;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "duplicate_in_flight", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    test_medias_ftp_set_latency(2000, 0);
+    test_medias_ftp_hold(10.f);
+    test_medias_downloader_fixture_start(fixture);
+
+    test_medias_downloader_new_media(fixture, 0);
+    test_medias_downloader_add_media(fixture, 0);
+    failed |= test_medias_downloader_expect(test_medias_ftp_wait_held(1, TEST_MEDIAS_DOWNLOADER_TIMEOUT_MS), "duplicate_in_flight", "the media in flight");
+
+    // The duplicates join the listeners while the transfer goes on and walks them at each progress
+    test_medias_ftp_hold(100.f);
+    for (i=1; i<=duplicatesCount; i++)
+    {
+        result = ARDATATRANSFER_MediasDownloader_AddMediaToQueue(fixture->manager, &fixture->medias[0], test_medias_downloader_progress, &fixture->records[i], test_medias_downloader_completion, &fixture->records[i]);
+        badCount += (result != ARDATATRANSFER_OK) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "duplicate_in_flight", "the duplicates attached");
+
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_value(&fixture->records[0].progresses, 9) && test_medias_ftp_wait_held(1, TEST_MEDIAS_DOWNLOADER_TIMEOUT_MS), "duplicate_in_flight", "the transfer held at its end");
+    test_medias_ftp_release();
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_completions(duplicatesCount + 1), "duplicate_in_flight", "every listener notified");
+
+    usleep(20000);
+    badCount = 0;
+    for (i=0; i<=duplicatesCount; i++)
+    {
+        badCount += ((fixture->records[i].completions != 1) || (fixture->records[i].error != ARDATATRANSFER_OK) || (fixture->records[i].progresses == 0)) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "duplicate_in_flight", "each listener to receive the progress and be notified once");
+    failed |= test_medias_downloader_expect(test_medias_ftp_get_count(fixture->medias[0].remotePath) == 1, "duplicate_in_flight", "a single download");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_batch_enqueue(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    ARDATATRANSFER_Media_t *medias[TEST_MEDIAS_DOWNLOADER_MAX_MEDIAS];
+    eARDATATRANSFER_ERROR result;
+    int mediasCount = 24;
+    int badCount = 0;
+    int failed = 0;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "batch_enqueue", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    for (i=0; i<mediasCount; i++)
+    {
+        medias[i] = test_medias_downloader_new_media(fixture, i);
+    }
+
+    // A batch with a missing media is refused as a whole
+    medias[mediasCount] = NULL;
+    result = ARDATATRANSFER_MediasDownloader_AddMediasToQueue(fixture->manager, medias, mediasCount + 1, ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_NORMAL, NULL, NULL, test_medias_downloader_fixture_completion, fixture);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_ERROR_BAD_PARAMETER) && (fixture->manager->mediasDownloader->queue.count == 0), "batch_enqueue", "a batch with a NULL media refused");
+
+    // The same media twice in a batch is downloaded once for both
+    medias[mediasCount] = medias[3];
+    result = ARDATATRANSFER_MediasDownloader_AddMediasToQueue(fixture->manager, medias, mediasCount + 1, ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_NORMAL, NULL, NULL, test_medias_downloader_fixture_completion, fixture);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (fixture->manager->mediasDownloader->queue.count == mediasCount), "batch_enqueue", "the batch queued with the duplicate coalesced");
+
+    test_medias_downloader_fixture_start(fixture);
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_completions(mediasCount + 1), "batch_enqueue", "every media of the batch completed");
+    usleep(20000);
+
+    for (i=0; i<mediasCount; i++)
+    {
+        if ((fixture->records[i].completions != ((i == 3) ? 2 : 1)) || (fixture->records[i].error != ARDATATRANSFER_OK)
+            || (test_medias_ftp_get_count(fixture->medias[i].remotePath) != 1) || (access(fixture->medias[i].filePath, F_OK) != 0))
+        {
+            badCount++;
+        }
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "batch_enqueue", "every media downloaded once and each entry notified once");
+
+    // A single worker downloads the batch in its order, the duplicate listener right after its media
+    badCount = (fixture->orderCount != (mediasCount + 1)) ? 1 : 0;
+    for (i=0; (badCount == 0) && (i < fixture->orderCount); i++)
+    {
+        badCount += (fixture->order[i] != ((i <= 3) ? i : (i - 1))) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "batch_enqueue", "the batch downloaded in its order");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_queue_stats(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    ARDATATRANSFER_MediasDownloader_QueueStats_t stats;
+    eARDATATRANSFER_ERROR result;
+    int mediasCount = 6;
+    int failed = 0;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "queue_stats", 2);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    result = ARDATATRANSFER_MediasDownloader_GetQueueStats(fixture->manager, &stats);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (stats.queuedCount == 0) && (stats.queuedBytes == 0.f) && (stats.inFlightCount == 0)
+                                            && (stats.bytesPerSecond == 0.f) && (stats.estimatedTime == 0.f), "queue_stats", "an empty queue");
+
+    for (i=0; i<mediasCount; i++)
+    {
+        test_medias_downloader_new_media(fixture, i);
+        test_medias_downloader_add_media(fixture, i);
+    }
+    ARDATATRANSFER_MediasDownloader_AddMediaToQueue(fixture->manager, &fixture->medias[2], NULL, NULL, NULL, NULL);
+
+    // The duplicate is a listener of the queued media, not counted again
+    ARDATATRANSFER_MediasDownloader_GetQueueStats(fixture->manager, &stats);
+    failed |= test_medias_downloader_expect((stats.queuedCount == mediasCount) && (stats.queuedBytes == 6015.f) && (stats.inFlightCount == 0)
+                                            && (stats.estimatedTime == -1.f), "queue_stats", "the queued medias counted, the time unknown");
+
+    test_medias_ftp_set_latency(200, 0);
+    test_medias_ftp_hold(50.f);
+    test_medias_downloader_fixture_start(fixture);
+    failed |= test_medias_downloader_expect(test_medias_ftp_wait_held(2, TEST_MEDIAS_DOWNLOADER_TIMEOUT_MS), "queue_stats", "two downloads held");
+
+    // The popped medias move from the queued counters to the in flight ones
+    ARDATATRANSFER_MediasDownloader_GetQueueStats(fixture->manager, &stats);
+    failed |= test_medias_downloader_expect((stats.queuedCount == 4) && (stats.queuedBytes == 4014.f) && (stats.inFlightCount == 2) && (stats.inFlightBytes == 2001.f)
+                                            && (stats.downloadedBytes > 0.f) && (stats.downloadedBytes < stats.inFlightBytes), "queue_stats", "two medias in flight, partly downloaded");
+
+    // The throughput is measured over a period, then the time is estimated from it
+    usleep((ARDATATRANSFER_MEDIAS_DOWNLOADER_RATE_PERIOD_MS + 100) * 1000);
+    ARDATATRANSFER_MediasDownloader_GetQueueStats(fixture->manager, &stats);
+    failed |= test_medias_downloader_expect((stats.bytesPerSecond > 0.f) && (stats.estimatedTime > 0.f), "queue_stats", "a measured throughput and an estimated time");
+
+    test_medias_ftp_release();
+    failed |= test_medias_downloader_expect(test_medias_downloader_wait_completions(mediasCount), "queue_stats", "every media completed");
+
+    result = ARDATATRANSFER_MediasDownloader_GetQueueStats(fixture->manager, &stats);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (stats.queuedCount == 0) && (stats.queuedBytes == 0.f) && (stats.inFlightCount == 0)
+                                            && (stats.inFlightBytes == 0.f) && (stats.downloadedBytes == 0.f) && (stats.estimatedTime == 0.f), "queue_stats", "the counters back to zero once drained");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static void test_medias_downloader_add_dcim_media(const char *folder, int number, int index, int hasThumbnail)
+{
+    char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
+    char productPathName[32];
+
+    // As the Jumping Sumo names them, the thumbnail prefixed by the DCIM folder and the file names tells the product, date and uuid
+    snprintf(remotePath, sizeof(remotePath), TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "%s/JUMP%04d.MOV", folder, number);
+    test_medias_ftp_add_file(remotePath, 2000.f + index);
+
+    if (hasThumbnail == 1)
+    {
+        ARDISCOVERY_getProductPathName(ARDISCOVERY_PRODUCT_JS, productPathName, sizeof(productPathName));
+        snprintf(remotePath, sizeof(remotePath), TEST_MEDIAS_DOWNLOADER_REMOTE_THUMB "%sJUMP%04d.MOV.%s_2014-12-15T102030+0100_%04X.jpg", folder, number, productPathName, index);
+        test_medias_ftp_add_file(remotePath, 10.f);
+    }
+}
+
+static ARDATATRANSFER_Media_t * test_medias_downloader_find_media(test_medias_downloader_fixture_t *fixture, int count, const char *remotePath)
+{
+    ARDATATRANSFER_Media_t *media;
+    eARDATATRANSFER_ERROR result;
+    int i;
+
+    for (i=0; i<count; i++)
+    {
+        media = ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, i, &result);
+        if ((media != NULL) && (strcmp(media->remotePath, remotePath) == 0))
+        {
+            return media;
+        }
+    }
+
+    return NULL;
+}
+
+static int test_medias_downloader_dcim_thumbnails(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    ARDATATRANSFER_Media_t *media;
+    char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
+    char expected[ARUTILS_FTP_MAX_PATH_SIZE];
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int badCount = 0;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "dcim_thumbnails", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    // 100DRONE misses two thumbnails, 101DRONE reuses its file names with a single thumbnail of its own
+    for (i=0; i<10; i++)
+    {
+        test_medias_downloader_add_dcim_media("100DRONE", i, i, ((i == 3) || (i == 7)) ? 0 : 1);
+    }
+    for (i=0; i<4; i++)
+    {
+        test_medias_downloader_add_dcim_media("101DRONE", i, 10 + i, (i == 1) ? 1 : 0);
+    }
+    test_medias_ftp_add_file(TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "100DRONE/README.TXT", 10.f);
+    test_medias_downloader_add_dcim_media("102DRONE", 0, 20, 1);
+    test_medias_ftp_add_file(TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "103DRONE/JUMP0000.MOV", 2000.f);
+
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 10), "dcim_thumbnails", "the medias with a thumbnail listed");
+
+    for (i=0; i<14; i++)
+    {
+        snprintf(remotePath, sizeof(remotePath), TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "%s/JUMP%04d.MOV", (i < 10) ? "100DRONE" : "101DRONE", (i < 10) ? i : (i - 10));
+        media = test_medias_downloader_find_media(fixture, count, remotePath);
+
+        if ((i == 3) || (i == 7) || ((i >= 10) && (i != 11)))
+        {
+            badCount += (media != NULL) ? 1 : 0;
+            continue;
+        }
+
+        // Each media is matched with the thumbnail of its own folder and name
+        snprintf(expected, sizeof(expected), "%04X", i);
+        if ((media == NULL) || (strcmp(media->uuid, expected) != 0) || (media->size != (2000.f + i)) || (media->product != ARDISCOVERY_PRODUCT_JS)
+            || (strcmp(media->date, "2014-12-15T102030+0100") != 0) || (strncmp(media->remoteThumb, TEST_MEDIAS_DOWNLOADER_REMOTE_THUMB, strlen(TEST_MEDIAS_DOWNLOADER_REMOTE_THUMB)) != 0)
+            || (strncmp(media->remoteThumb + strlen(TEST_MEDIAS_DOWNLOADER_REMOTE_THUMB), remotePath + strlen(TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM), 8) != 0)
+            || (strcmp(media->name + strlen(media->name) - 4, ".mov") != 0))
+        {
+            badCount++;
+        }
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "dcim_thumbnails", "each media matched with its own thumbnail");
+
+    // A folder is matched with its own thumbnails only
+    media = test_medias_downloader_find_media(fixture, count, TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "103DRONE/JUMP0000.MOV");
+    failed |= test_medias_downloader_expect((media == NULL) && (test_medias_downloader_find_media(fixture, count, TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "102DRONE/JUMP0000.MOV") != NULL),
+                                            "dcim_thumbnails", "the medias of a folder matched only with its thumbnails");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static void test_medias_downloader_add_product_media(eARDISCOVERY_PRODUCT product, int index)
+{
+    char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
+    char productPathName[32];
+
+    ARDISCOVERY_getProductPathName(product, productPathName, sizeof(productPathName));
+    snprintf(remotePath, sizeof(remotePath), "/%s/media/%s_2014-12-15T102030+0100_%04X.jpg", productPathName, productPathName, index);
+    test_medias_ftp_add_file(remotePath, 3000.f + index);
+}
+
+static int test_medias_downloader_check_thumbnails(test_medias_downloader_fixture_t *fixture, int count)
+{
+    ARDATATRANSFER_Media_t *media;
+    eARDATATRANSFER_ERROR result;
+    int badCount = 0;
+    int i;
+
+    // The thumbnails of the stand-in hold their path
+    for (i=0; i<count; i++)
+    {
+        media = ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, i, &result);
+        if ((media == NULL) || (media->thumbnail == NULL) || (media->thumbnailSize != (strlen(media->remoteThumb) + 1)) || (strcmp((const char *)media->thumbnail, media->remoteThumb) != 0))
+        {
+            badCount++;
+        }
+    }
+
+    return badCount;
+}
+
+static int test_medias_downloader_incremental_relist(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int buffersCount;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "incremental_relist", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    for (i=0; i<6; i++)
+    {
+        test_medias_downloader_add_dcim_media((i < 4) ? "100DRONE" : "101DRONE", i, i, 1);
+    }
+    for (i=6; i<9; i++)
+    {
+        test_medias_downloader_add_product_media(ARDISCOVERY_PRODUCT_ARDRONE, i);
+    }
+
+    buffersCount = test_medias_ftp_buffer_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 9) && ((test_medias_ftp_buffer_count() - buffersCount) == 9)
+                                            && (test_medias_downloader_check_thumbnails(fixture, count) == 0), "incremental_relist", "a first listing fetching every thumbnail");
+
+    // Nothing changed, no thumbnail is fetched again
+    buffersCount = test_medias_ftp_buffer_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 9) && (test_medias_ftp_buffer_count() == buffersCount)
+                                            && (test_medias_downloader_check_thumbnails(fixture, count) == 0), "incremental_relist", "an unchanged listing kept with its thumbnails");
+
+    // A new media in DCIM and one in the product folder, only their thumbnails are fetched
+    test_medias_downloader_add_dcim_media("101DRONE", 9, 9, 1);
+    test_medias_downloader_add_product_media(ARDISCOVERY_PRODUCT_ARDRONE, 10);
+    buffersCount = test_medias_ftp_buffer_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 11) && ((test_medias_ftp_buffer_count() - buffersCount) == 2)
+                                            && (test_medias_downloader_check_thumbnails(fixture, count) == 0), "incremental_relist", "the new medias only fetching their thumbnails");
+
+    // A deleted media leaves the list, the others keep their thumbnails
+    snprintf(remotePath, sizeof(remotePath), TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "100DRONE/JUMP0001.MOV");
+    ARUTILS_Manager_Ftp_Delete(fixture->listConnection, remotePath);
+    buffersCount = test_medias_ftp_buffer_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 10) && (test_medias_ftp_buffer_count() == buffersCount)
+                                            && (test_medias_downloader_find_media(fixture, count, remotePath) == NULL) && (test_medias_downloader_check_thumbnails(fixture, count) == 0),
+                                            "incremental_relist", "the deleted media removed without fetching any thumbnail");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static eARDATATRANSFER_ERROR test_medias_downloader_fixture_restart(test_medias_downloader_fixture_t *fixture)
+{
+    // As the next launch of the application, on the same local directory and Device
+    ARDATATRANSFER_MediasDownloader_Delete(fixture->manager);
+
+    return ARDATATRANSFER_MediasDownloader_New(fixture->manager, fixture->listConnection, fixture->queueConnections[0], "", fixture->localDirectory);
+}
+
+static int test_medias_downloader_catalog_persistent(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    char catalogPath[ARUTILS_FTP_MAX_PATH_SIZE];
+    char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int listsCount;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "catalog_persistent", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    snprintf(catalogPath, sizeof(catalogPath), "%s/" ARDATATRANSFER_MEDIAS_CATALOG_FILE_NAME, fixture->localDirectory);
+
+    for (i=0; i<4; i++)
+    {
+        test_medias_downloader_add_dcim_media("100DRONE", i, i, 1);
+    }
+    for (i=4; i<6; i++)
+    {
+        test_medias_downloader_add_product_media(ARDISCOVERY_PRODUCT_ARDRONE, i);
+    }
+
+    // Not persisted until enabled, then the medias already listed are written at once
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6) && (access(catalogPath, F_OK) != 0), "catalog_persistent", "no catalog written by default");
+    result = ARDATATRANSFER_MediasDownloader_SetCatalogPersistent(fixture->manager, 1);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (access(catalogPath, F_OK) == 0), "catalog_persistent", "the catalog written once enabled");
+
+    // The next launch loads nothing until the catalog is enabled
+    test_medias_downloader_add_dcim_media("100DRONE", 6, 6, 1);
+    result = test_medias_downloader_fixture_restart(fixture);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(fixture->manager, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 0) && (fixture->manager->mediasDownloader->medias.mapping == NULL), "catalog_persistent", "no catalog loaded by default");
+
+    listsCount = test_medias_ftp_list_count();
+    result = ARDATATRANSFER_MediasDownloader_SetCatalogPersistent(fixture->manager, 1);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(fixture->manager, &result);
+    snprintf(remotePath, sizeof(remotePath), TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "100DRONE/JUMP0002.MOV");
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6) && (fixture->manager->mediasDownloader->medias.mapping != NULL)
+                                            && (test_medias_downloader_find_media(fixture, count, remotePath) != NULL) && (test_medias_ftp_list_count() == listsCount),
+                                            "catalog_persistent", "the catalog mapped once enabled, without listing the Device");
+
+    // Listing the Device reconciles the catalog, the new list replaces the mapping and is written
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    snprintf(remotePath, sizeof(remotePath), TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "100DRONE/JUMP0006.MOV");
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 7) && (fixture->manager->mediasDownloader->medias.mapping == NULL)
+                                            && (test_medias_downloader_find_media(fixture, count, remotePath) != NULL), "catalog_persistent", "the catalog reconciled with the Device and unmapped");
+
+    result = test_medias_downloader_fixture_restart(fixture);
+    ARDATATRANSFER_MediasDownloader_SetCatalogPersistent(fixture->manager, 1);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(fixture->manager, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 7), "catalog_persistent", "the reconciled catalog loaded at the next launch");
+
+    // Disabled, the catalog file is removed and the next launch starts empty
+    ARDATATRANSFER_MediasDownloader_SetCatalogPersistent(fixture->manager, 0);
+    result = test_medias_downloader_fixture_restart(fixture);
+    ARDATATRANSFER_MediasDownloader_SetCatalogPersistent(fixture->manager, 1);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(fixture->manager, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 0) && (access(catalogPath, F_OK) != 0), "catalog_persistent", "no catalog once disabled");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static void * test_medias_downloader_add_list_workers(void *arg)
+{
+    test_medias_downloader_fixture_t *fixture = (test_medias_downloader_fixture_t *)arg;
+    int i;
+
+    for (i=0; i<fixture->listConnectionsCount; i++)
+    {
+        ARDATATRANSFER_MediasDownloader_AddListWorker(fixture->manager, fixture->listConnections[i]);
+    }
+
+    return NULL;
+}
+
+static int test_medias_downloader_parallel_listing(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    char folder[16];
+    char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
+    ARSAL_Thread_t thread;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int canceledCount = 0;
+    int badCount = 0;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "parallel_listing", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    for (i=0; i<12; i++)
+    {
+        snprintf(folder, sizeof(folder), "%dDRONE", 100 + (i / 2));
+        test_medias_downloader_add_dcim_media(folder, i, i, 1);
+    }
+    for (i=12; i<14; i++)
+    {
+        test_medias_downloader_add_product_media(ARDISCOVERY_PRODUCT_ARDRONE, i);
+    }
+
+    // The listing connections are added while the listings are canceled and reset
+    fixture->listConnectionsCount = 3;
+    for (i=0; i<fixture->listConnectionsCount; i++)
+    {
+        fixture->listConnections[i] = test_medias_ftp_connection_new();
+    }
+    ARSAL_Thread_Create(&thread, test_medias_downloader_add_list_workers, fixture);
+    for (i=0; i<100; i++)
+    {
+        ARDATATRANSFER_MediasDownloader_CancelGetAvailableMedias(fixture->manager);
+        ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias(fixture->manager);
+    }
+    ARSAL_Thread_Join(thread, NULL);
+    ARSAL_Thread_Destroy(&thread);
+
+    // Every listing connection is canceled and reset
+    ARDATATRANSFER_MediasDownloader_CancelGetAvailableMedias(fixture->manager);
+    canceledCount += test_medias_ftp_is_canceled(fixture->listConnection);
+    for (i=0; i<fixture->listConnectionsCount; i++)
+    {
+        canceledCount += test_medias_ftp_is_canceled(fixture->listConnections[i]);
+    }
+    failed |= test_medias_downloader_expect(canceledCount == 4, "parallel_listing", "every listing connection canceled");
+
+    ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias(fixture->manager);
+    canceledCount = test_medias_ftp_is_canceled(fixture->listConnection);
+    for (i=0; i<fixture->listConnectionsCount; i++)
+    {
+        canceledCount += test_medias_ftp_is_canceled(fixture->listConnections[i]);
+    }
+    failed |= test_medias_downloader_expect(canceledCount == 0, "parallel_listing", "every listing connection reset");
+
+    // The directories listed in parallel are parsed in the same order as one by one
+    test_medias_ftp_set_latency(0, 5000);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    for (i=0; i<count; i++)
+    {
+        if (i < 12)
+        {
+            snprintf(remotePath, sizeof(remotePath), TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "%dDRONE/JUMP%04d.MOV", 100 + (i / 2), i);
+        }
+        badCount += ((i >= 12) || (strcmp(ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, i, &result)->remotePath, remotePath) == 0)) ? 0 : 1;
+    }
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 14) && (badCount == 0), "parallel_listing", "the medias listed in the directories order");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+typedef struct
+{
+    int count;
+    int badCount;
+    int firstListsCount;
+    int completions;
+    int completionCount;
+    eARDATATRANSFER_ERROR completionError;
+    char remotePaths[TEST_MEDIAS_DOWNLOADER_MAX_MEDIAS][ARUTILS_FTP_MAX_PATH_SIZE];
+
+} test_medias_downloader_stream_t;
+
+static void test_medias_downloader_stream_media(void *arg, ARDATATRANSFER_Media_t *media, int index)
+{
+    test_medias_downloader_stream_t *stream = (test_medias_downloader_stream_t *)arg;
+
+    // Notified in the listing order, each with the index it gets in the medias list
+    if (stream->count == 0)
+    {
+        stream->firstListsCount = test_medias_ftp_list_count();
+    }
+    if ((index != stream->count) || (index >= TEST_MEDIAS_DOWNLOADER_MAX_MEDIAS) || (media->thumbnail == NULL))
+    {
+        stream->badCount++;
+    }
+    else
+    {
+        strcpy(stream->remotePaths[index], media->remotePath);
+    }
+    stream->count++;
+}
+
+static void test_medias_downloader_stream_completion(void *arg, int count, eARDATATRANSFER_ERROR error)
+{
+    test_medias_downloader_stream_t *stream = (test_medias_downloader_stream_t *)arg;
+
+    stream->completions++;
+    stream->completionCount = count;
+    stream->completionError = error;
+}
+
+static int test_medias_downloader_stream_check(test_medias_downloader_fixture_t *fixture, const char *what)
+{
+    test_medias_downloader_stream_t *stream;
+    ARDATATRANSFER_Media_t *media;
+    eARDATATRANSFER_ERROR result;
+    int listsCount;
+    int badCount = 0;
+    int i;
+
+    stream = calloc(1, sizeof(test_medias_downloader_stream_t));
+    if (stream == NULL)
+    {
+        return 1;
+    }
+
+    listsCount = test_medias_ftp_list_count();
+    result = ARDATATRANSFER_MediasDownloader_GetAvailableMediasStream(fixture->manager, 1, test_medias_downloader_stream_media, stream, test_medias_downloader_stream_completion, stream);
+
+    // The same medias as the published list, the first one notified before the last directory was listed
+    for (i=0; (i < stream->count) && (i < TEST_MEDIAS_DOWNLOADER_MAX_MEDIAS); i++)
+    {
+        media = ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, i, &result);
+        badCount += ((media == NULL) || (strcmp(media->remotePath, stream->remotePaths[i]) != 0)) ? 1 : 0;
+    }
+
+    badCount += ((result != ARDATATRANSFER_OK) || (stream->count != 8) || (stream->badCount != 0) || (stream->completions != 1)
+                 || (stream->completionCount != 8) || (stream->completionError != ARDATATRANSFER_OK) || (stream->firstListsCount >= test_medias_ftp_list_count())
+                 || (stream->firstListsCount <= listsCount)) ? 1 : 0;
+
+    free(stream);
+
+    return test_medias_downloader_expect(badCount == 0, "stream_listing", what);
+}
+
+static int test_medias_downloader_stream_listing(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    char folder[16];
+    int failed = 0;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "stream_listing", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    for (i=0; i<6; i++)
+    {
+        snprintf(folder, sizeof(folder), "%dDRONE", 100 + (i / 2));
+        test_medias_downloader_add_dcim_media(folder, i, i, 1);
+    }
+    for (i=6; i<8; i++)
+    {
+        test_medias_downloader_add_product_media(ARDISCOVERY_PRODUCT_ARDRONE, i);
+    }
+    test_medias_ftp_set_latency(0, 2000);
+
+    failed |= test_medias_downloader_stream_check(fixture, "the medias notified as their directory is parsed, then the listing end");
+
+    // The Device is listed again, the unchanged directories notify the medias they keep
+    failed |= test_medias_downloader_stream_check(fixture, "the unchanged medias notified again");
+
+    failed |= test_medias_downloader_expect(ARDATATRANSFER_MediasDownloader_GetAvailableMediasStream(fixture->manager, 0, NULL, NULL, NULL, NULL) == ARDATATRANSFER_ERROR_BAD_PARAMETER,
+                                            "stream_listing", "a stream without media callback refused");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+typedef struct
+{
+    test_medias_downloader_fixture_t *fixture;
+    ARSAL_Sem_t discovered;
+    ARSAL_Sem_t resumed;
+    int discoveredCount;
+    eARDATATRANSFER_ERROR result;
+
+} test_medias_downloader_listing_t;
+
+static void test_medias_downloader_listing_discovered(void *arg, ARDATATRANSFER_Media_t *media, int index)
+{
+    test_medias_downloader_listing_t *listing = (test_medias_downloader_listing_t *)arg;
+
+    // The listing stops at its first media, its directory parsed, until the test resumes it
+    if (listing->discoveredCount++ == 0)
+    {
+        ARSAL_Sem_Post(&listing->discovered);
+        ARSAL_Sem_Wait(&listing->resumed);
+    }
+}
+
+static void * test_medias_downloader_run_listing(void *arg)
+{
+    test_medias_downloader_listing_t *listing = (test_medias_downloader_listing_t *)arg;
+
+    listing->result = ARDATATRANSFER_MediasDownloader_GetAvailableMediasStream(listing->fixture->manager, 1, test_medias_downloader_listing_discovered, listing, NULL, NULL);
+    if (listing->discoveredCount == 0)
+    {
+        ARSAL_Sem_Post(&listing->discovered);
+    }
+
+    return NULL;
+}
+
+static int test_medias_downloader_remove_during_listing(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    test_medias_downloader_listing_t listing;
+    ARDATATRANSFER_Media_t *medias[4];
+    ARDATATRANSFER_Media_t *media;
+    ARSAL_Thread_t thread;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int badCount = 0;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "remove_during_listing", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    for (i=0; i<4; i++)
+    {
+        test_medias_downloader_add_dcim_media((i < 2) ? "100DRONE" : "101DRONE", i, i, 1);
+    }
+
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    for (i=0; (i < count) && (i < 4); i++)
+    {
+        medias[i] = ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, i, &result);
+    }
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 4), "remove_during_listing", "the medias listed with their thumbnails");
+    if (count != 4)
+    {
+        test_medias_downloader_fixture_delete(fixture);
+        return 1;
+    }
+
+    // Without a listing in progress, the thumbnail of a removed media is freed at once
+    result = ARDATATRANSFER_MediasDownloader_DeleteMedia(fixture->manager, medias[3], NULL, NULL);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (medias[3]->thumbnail == NULL) && (medias[3]->thumbnailSize == 0)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, 3, &result) == NULL), "remove_during_listing", "the removed media thumbnail freed");
+
+    // The unchanged 100DRONE is parsed first, sharing its thumbnails with the new listing
+    memset(&listing, 0, sizeof(listing));
+    listing.fixture = fixture;
+    ARSAL_Sem_Init(&listing.discovered, 0, 0);
+    ARSAL_Sem_Init(&listing.resumed, 0, 0);
+    ARSAL_Thread_Create(&thread, test_medias_downloader_run_listing, &listing);
+    ARSAL_Sem_Wait(&listing.discovered);
+
+    // The published list stays readable, a media removed meanwhile keeps the thumbnail the listing shares
+    for (i=0; i<3; i++)
+    {
+        badCount += (ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, i, &result) != medias[i]) ? 1 : 0;
+    }
+    result = ARDATATRANSFER_MediasDownloader_DeleteMedia(fixture->manager, medias[0], NULL, NULL);
+    failed |= test_medias_downloader_expect((listing.discoveredCount == 1) && (badCount == 0) && (result == ARDATATRANSFER_OK) && (medias[0]->thumbnail != NULL)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, 0, &result) == NULL), "remove_during_listing", "the list readable and the shared thumbnail kept");
+
+    ARSAL_Sem_Post(&listing.resumed);
+    ARSAL_Thread_Join(thread, NULL);
+    ARSAL_Thread_Destroy(&thread);
+    ARSAL_Sem_Destroy(&listing.discovered);
+    ARSAL_Sem_Destroy(&listing.resumed);
+
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(fixture->manager, &result);
+    failed |= test_medias_downloader_expect((listing.result == ARDATATRANSFER_OK) && (listing.discoveredCount == 3) && (count == 3) && (test_medias_downloader_check_thumbnails(fixture, count) == 0),
+                                            "remove_during_listing", "the new listing published with its thumbnails");
+
+    // Once the listing is published, its thumbnails are no longer shared
+    media = ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, 1, &result);
+    result = ARDATATRANSFER_MediasDownloader_DeleteMedia(fixture->manager, media, NULL, NULL);
+    failed |= test_medias_downloader_expect((media != NULL) && (result == ARDATATRANSFER_OK) && (media->thumbnail == NULL), "remove_during_listing", "the thumbnail freed after the listing");
+
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 1) && (test_medias_downloader_check_thumbnails(fixture, count) == 0),
+                                            "remove_during_listing", "the removed medias gone at the next listing");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_check_lookups(test_medias_downloader_fixture_t *fixture, int count)
+{
+    ARDATATRANSFER_Media_t *media;
+    ARDATATRANSFER_Media_t *byUuid;
+    ARDATATRANSFER_Media_t *byName;
+    ARDATATRANSFER_Media_t *byFilePath;
+    eARDATATRANSFER_ERROR result;
+    int badCount = 0;
+    int i;
+
+    // Each media listed is found by its keys, or the media listed before it with the same keys
+    for (i=0; i<count; i++)
+    {
+        media = ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, i, &result);
+        byUuid = (media != NULL) ? ARDATATRANSFER_MediasDownloader_GetAvailableMediaByUuid(fixture->manager, media->uuid, &result) : NULL;
+        byName = (media != NULL) ? ARDATATRANSFER_MediasDownloader_GetAvailableMediaByName(fixture->manager, media->name, &result) : NULL;
+        byFilePath = (media != NULL) ? ARDATATRANSFER_MediasDownloader_GetAvailableMediaByFilePath(fixture->manager, media->filePath, &result) : NULL;
+        if ((byUuid == NULL) || (byName == NULL) || (byFilePath == NULL) || (strcmp(byUuid->uuid, media->uuid) != 0)
+            || (strcmp(byName->name, media->name) != 0) || (strcmp(byFilePath->filePath, media->filePath) != 0))
+        {
+            badCount++;
+        }
+    }
+
+    return badCount;
+}
+
+static int test_medias_downloader_lookups(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    ARDATATRANSFER_Media_t *removed;
+    ARDATATRANSFER_Media_t *duplicate;
+    char uuid[ARDATATRANSFER_MEDIA_UUID_SIZE];
+    char name[ARDATATRANSFER_MEDIA_NAME_SIZE];
+    char filePath[ARDATATRANSFER_MEDIA_PATH_SIZE];
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "lookups", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    // 101DRONE reuses the uuid of a 100DRONE media
+    for (i=0; i<6; i++)
+    {
+        test_medias_downloader_add_dcim_media("100DRONE", i, i, 1);
+    }
+    test_medias_downloader_add_dcim_media("101DRONE", 10, 2, 1);
+    for (i=0; i<6; i++)
+    {
+        test_medias_downloader_add_product_media(ARDISCOVERY_PRODUCT_ARDRONE, 20 + i);
+    }
+
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 13), "lookups", "the medias listed");
+
+    duplicate = test_medias_downloader_find_media(fixture, count, TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "100DRONE/JUMP0002.MOV");
+    failed |= test_medias_downloader_expect((duplicate != NULL) && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaByUuid(fixture->manager, duplicate->uuid, &result) == duplicate)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaByName(fixture->manager, duplicate->name, &result) == duplicate),
+                                            "lookups", "the first media listed found by shared keys");
+
+    failed |= test_medias_downloader_expect(test_medias_downloader_check_lookups(fixture, count) == 0, "lookups", "each media found by its uuid, name and file path");
+
+    failed |= test_medias_downloader_expect((ARDATATRANSFER_MediasDownloader_GetAvailableMediaByUuid(fixture->manager, "FFFF", &result) == NULL) && (result == ARDATATRANSFER_ERROR_BAD_PARAMETER)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaByName(fixture->manager, "unknown.jpg", &result) == NULL) && (result == ARDATATRANSFER_ERROR_BAD_PARAMETER)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaByFilePath(fixture->manager, "/unknown.jpg", &result) == NULL) && (result == ARDATATRANSFER_ERROR_BAD_PARAMETER)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaByUuid(fixture->manager, NULL, &result) == NULL) && (result == ARDATATRANSFER_ERROR_BAD_PARAMETER),
+                                            "lookups", "an unknown key not found");
+
+    // A removed media is no longer found, the others still are
+    removed = ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, 0, &result);
+    strcpy(uuid, removed->uuid);
+    strcpy(name, removed->name);
+    strcpy(filePath, removed->filePath);
+    result = ARDATATRANSFER_MediasDownloader_DeleteMedia(fixture->manager, removed, NULL, NULL);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaByUuid(fixture->manager, uuid, &result) == NULL)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaByName(fixture->manager, name, &result) == NULL)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaByFilePath(fixture->manager, filePath, &result) == NULL), "lookups", "the removed media not found");
+
+    // The indexes are rebuilt with the next listing
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 12) && (test_medias_downloader_check_lookups(fixture, count) == 0)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaByFilePath(fixture->manager, filePath, &result) == NULL), "lookups", "the medias found after a new listing");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static void test_medias_downloader_add_dated_media(eARDISCOVERY_PRODUCT product, int day, int index)
+{
+    char remotePath[ARUTILS_FTP_MAX_PATH_SIZE];
+    char productPathName[32];
+
+    ARDISCOVERY_getProductPathName(product, productPathName, sizeof(productPathName));
+    snprintf(remotePath, sizeof(remotePath), "/%s/media/%s_2014-12-%02dT102030+0100_%04X.jpg", productPathName, productPathName, day, index);
+    test_medias_ftp_add_file(remotePath, 3000.f + index);
+}
+
+static int test_medias_downloader_check_page_order(test_medias_downloader_fixture_t *fixture, int count, eARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER order)
+{
+    ARDATATRANSFER_Media_t *medias[TEST_MEDIAS_DOWNLOADER_PAGES_MEDIAS_COUNT];
+    ARDATATRANSFER_Media_t *page[3];
+    ARDATATRANSFER_Media_t *previous;
+    ARDATATRANSFER_Media_t *media;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int64_t previousTimestamp;
+    int64_t timestamp;
+    int pageCount;
+    int total = 0;
+    int badCount = 0;
+    int i;
+    int j;
+
+    // The pages, of three medias but the last one, follow each other
+    do
+    {
+        pageCount = ARDATATRANSFER_MediasDownloader_GetAvailableMediasPage(fixture->manager, total, 3, order, page, &result);
+        for (i=0; (i < pageCount) && (total < TEST_MEDIAS_DOWNLOADER_PAGES_MEDIAS_COUNT); i++)
+        {
+            medias[total++] = page[i];
+        }
+    }
+    while ((result == ARDATATRANSFER_OK) && (pageCount == 3));
+
+    badCount += ((result != ARDATATRANSFER_OK) || (total != count) || (pageCount != (count % 3))) ? 1 : 0;
+
+    for (i=0; (badCount == 0) && (i < total); i++)
+    {
+        media = medias[i];
+        previous = (i > 0) ? medias[i - 1] : NULL;
+        timestamp = ARDATATRANSFER_MediasDownloader_GetMediaRecord(media)->timestamp;
+        previousTimestamp = (previous != NULL) ? ARDATATRANSFER_MediasDownloader_GetMediaRecord(previous)->timestamp : INT64_MIN;
+
+        // Each media of the list once
+        for (j=0; j<i; j++)
+        {
+            badCount += (medias[j] == media) ? 1 : 0;
+        }
+
+        switch (order)
+        {
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_LISTING:
+            badCount += (ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, i, &result) != media) ? 1 : 0;
+            break;
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_NEWEST_FIRST:
+            badCount += ((previous != NULL) && (previousTimestamp < timestamp)) ? 1 : 0;
+            break;
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_OLDEST_FIRST:
+            badCount += ((previous != NULL) && (previousTimestamp > timestamp)) ? 1 : 0;
+            break;
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_SMALLEST_FIRST:
+            badCount += ((previous != NULL) && (previous->size > media->size)) ? 1 : 0;
+            break;
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_LARGEST_FIRST:
+            badCount += ((previous != NULL) && (previous->size < media->size)) ? 1 : 0;
+            break;
+        case ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_PRODUCT:
+            badCount += ((previous != NULL) && ((previous->product > media->product) || ((previous->product == media->product) && (previousTimestamp < timestamp)))) ? 1 : 0;
+            break;
+        default:
+            badCount++;
+            break;
+        }
+    }
+
+    return badCount;
+}
+
+static int test_medias_downloader_pages(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    ARDATATRANSFER_MediasCatalog_Header_t header;
+    ARDATATRANSFER_Media_t *media;
+    ARDATATRANSFER_Media_t *page[3];
+    char catalogPath[ARUTILS_FTP_MAX_PATH_SIZE];
+    const int days[TEST_MEDIAS_DOWNLOADER_PAGES_MEDIAS_COUNT] = { 15, 3, 27, 9, 21, 1, 12, 30, 6, 18, 24 };
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    eARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER order;
+    int64_t expected;
+    FILE *file;
+    int badCount = 0;
+    int failed = 0;
+    int count;
+    int day;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "pages", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    snprintf(catalogPath, sizeof(catalogPath), "%s/" ARDATATRANSFER_MEDIAS_CATALOG_FILE_NAME, fixture->localDirectory);
+
+    // Two products, their dates and sizes in orders of their own
+    for (i=0; i<TEST_MEDIAS_DOWNLOADER_PAGES_MEDIAS_COUNT; i++)
+    {
+        test_medias_downloader_add_dated_media((i < 8) ? ARDISCOVERY_PRODUCT_ARDRONE : ARDISCOVERY_PRODUCT_JS, days[i], (i * 7) % TEST_MEDIAS_DOWNLOADER_PAGES_MEDIAS_COUNT);
+    }
+
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == TEST_MEDIAS_DOWNLOADER_PAGES_MEDIAS_COUNT), "pages", "the medias listed");
+
+    // The timestamp is the date of the name, 2014-12-01T00:00:00Z being 1417392000, in UTC
+    for (i=0; i<count; i++)
+    {
+        media = ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, i, &result);
+        day = (media != NULL) ? atoi(media->date + 8) : 0;
+        expected = 1417392000LL + ((day - 1) * 86400LL) + (9 * 3600) + (20 * 60) + 30;
+        badCount += ((media == NULL) || (day < 1) || (ARDATATRANSFER_MediasDownloader_GetMediaRecord(media)->timestamp != expected) || (ARDATATRANSFER_MediasDownloader_GetMediaTimestamp(media) != expected)) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "pages", "each media timestamp parsed from its date");
+
+    badCount = 0;
+    for (order = ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_LISTING; order < ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_MAX; order++)
+    {
+        badCount += test_medias_downloader_check_page_order(fixture, count, order);
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "pages", "the pages of each order");
+
+    failed |= test_medias_downloader_expect((ARDATATRANSFER_MediasDownloader_GetAvailableMediasPage(fixture->manager, count, 3, ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_NEWEST_FIRST, page, &result) == 0) && (result == ARDATATRANSFER_OK)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediasPage(fixture->manager, 0, 3, ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_MAX, page, &result) == 0) && (result == ARDATATRANSFER_ERROR_BAD_PARAMETER)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediasPage(fixture->manager, -1, 3, ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_NEWEST_FIRST, page, &result) == 0) && (result == ARDATATRANSFER_ERROR_BAD_PARAMETER),
+                                            "pages", "no page past the end, an unknown order or offset refused");
+
+    // The timestamps are kept by the catalog, whose records of a previous layout are ignored
+    ARDATATRANSFER_MediasDownloader_SetCatalogPersistent(fixture->manager, 1);
+    result = test_medias_downloader_fixture_restart(fixture);
+    ARDATATRANSFER_MediasDownloader_SetCatalogPersistent(fixture->manager, 1);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(fixture->manager, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == TEST_MEDIAS_DOWNLOADER_PAGES_MEDIAS_COUNT)
+                                            && (test_medias_downloader_check_page_order(fixture, count, ARDATATRANSFER_MEDIAS_DOWNLOADER_ORDER_NEWEST_FIRST) == 0), "pages", "the timestamps loaded from the catalog");
+
+    file = fopen(catalogPath, "r+b");
+    if ((file == NULL) || (fread(&header, sizeof(header), 1, file) != 1))
+    {
+        failed = 1;
+    }
+    else
+    {
+        header.version = ARDATATRANSFER_MEDIAS_CATALOG_VERSION - 1;
+        fseek(file, 0, SEEK_SET);
+        fwrite(&header, sizeof(header), 1, file);
+    }
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+
+    result = test_medias_downloader_fixture_restart(fixture);
+    ARDATATRANSFER_MediasDownloader_SetCatalogPersistent(fixture->manager, 1);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(fixture->manager, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 0), "pages", "a catalog of the previous version ignored");
+
+    ARDATATRANSFER_MediasDownloader_SetCatalogPersistent(fixture->manager, 0);
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_check_filtered(test_medias_downloader_fixture_t *fixture, int count, const ARDATATRANSFER_MediasDownloader_Filter_t *filter)
+{
+    ARDATATRANSFER_Media_t *media;
+    eARDATATRANSFER_ERROR result;
+    int badCount = 0;
+    int isVideo;
+    int i;
+
+    // Each media listed matches the filter
+    for (i=0; i<count; i++)
+    {
+        media = ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, i, &result);
+        if (media == NULL)
+        {
+            badCount++;
+            continue;
+        }
+
+        isVideo = (strcmp(media->name + strlen(media->name) - 4, ".mov") == 0) ? 1 : 0;
+        if (((filter->products != 0) && ((filter->products & (1ULL << media->product)) == 0))
+            || ((filter->types != 0) && ((filter->types & (1 << (isVideo ? ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_VIDEO : ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_PHOTO))) == 0))
+            || ((filter->minTimestamp != 0) && (ARDATATRANSFER_MediasDownloader_GetMediaTimestamp(media) < filter->minTimestamp))
+            || ((filter->maxTimestamp != 0) && (ARDATATRANSFER_MediasDownloader_GetMediaTimestamp(media) > filter->maxTimestamp)))
+        {
+            badCount++;
+        }
+    }
+
+    return badCount;
+}
+
+static int test_medias_downloader_filter(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    ARDATATRANSFER_MediasDownloader_Filter_t filter;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int listsCount;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "filter", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    // Photos of two products on days 1 to 6, videos in two DCIM folders on day 15
+    for (i=0; i<6; i++)
+    {
+        test_medias_downloader_add_dated_media(ARDISCOVERY_PRODUCT_ARDRONE, i + 1, i);
+        test_medias_downloader_add_dated_media(ARDISCOVERY_PRODUCT_JS, i + 1, 6 + i);
+    }
+    for (i=0; i<4; i++)
+    {
+        test_medias_downloader_add_dcim_media((i < 2) ? "100DRONE" : "101DRONE", i, 12 + i, 1);
+    }
+
+    // A single product: neither the other product subfolder nor the DCIM folders of its thumbnails are listed
+    memset(&filter, 0, sizeof(filter));
+    filter.products = 1ULL << ARDISCOVERY_PRODUCT_ARDRONE;
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered(fixture->manager, 0, &filter, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6) && (test_medias_downloader_check_filtered(fixture, count, &filter) == 0)
+                                            && (test_medias_ftp_list_count() == (listsCount + 4)), "filter", "the medias of a product, the other folders not listed");
+
+    // The videos only: the DCIM folders, the photos of the product subfolders skipped
+    memset(&filter, 0, sizeof(filter));
+    filter.types = 1 << ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_VIDEO;
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered(fixture->manager, 0, &filter, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 4) && (test_medias_downloader_check_filtered(fixture, count, &filter) == 0), "filter", "the videos");
+
+    // The photos only: the DCIM folders of videos are not listed
+    filter.types = 1 << ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_PHOTO;
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered(fixture->manager, 0, &filter, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 12) && (test_medias_downloader_check_filtered(fixture, count, &filter) == 0)
+                                            && (test_medias_ftp_list_count() == (listsCount + 5)), "filter", "the photos, the DCIM folders not listed");
+
+    // Days 2 to 4 both bounds included, then a lower bound only
+    memset(&filter, 0, sizeof(filter));
+    filter.minTimestamp = 1417392000LL + (1 * 86400LL);
+    filter.maxTimestamp = 1417392000LL + (4 * 86400LL) - 1;
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered(fixture->manager, 0, &filter, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6) && (test_medias_downloader_check_filtered(fixture, count, &filter) == 0), "filter", "the medias of a date range");
+
+    filter.minTimestamp = 1417392000LL + (5 * 86400LL);
+    filter.maxTimestamp = 0;
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered(fixture->manager, 0, &filter, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6) && (test_medias_downloader_check_filtered(fixture, count, &filter) == 0), "filter", "the medias after a date");
+
+    // The directories listed under a filter are not reused by a listing without it
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered(fixture->manager, 0, NULL, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 16), "filter", "every media without a filter");
+
+    memset(&filter, 0, sizeof(filter));
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered(fixture->manager, 0, &filter, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 16), "filter", "every media with a zeroed filter");
+
+    filter.products = 1ULL << ARDISCOVERY_PRODUCT_JS;
+    filter.types = 1 << ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_VIDEO;
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered(fixture->manager, 0, &filter, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 4) && (test_medias_downloader_check_filtered(fixture, count, &filter) == 0), "filter", "the medias of a product and a type");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+typedef enum
+{
+    TEST_MEDIAS_DOWNLOADER_RECURSIVE_FULL = 0,
+    TEST_MEDIAS_DOWNLOADER_RECURSIVE_MISSING,
+    TEST_MEDIAS_DOWNLOADER_RECURSIVE_ERROR,
+    TEST_MEDIAS_DOWNLOADER_RECURSIVE_FLAT,
+
+} eTEST_MEDIAS_DOWNLOADER_RECURSIVE;
+
+typedef struct
+{
+    eTEST_MEDIAS_DOWNLOADER_RECURSIVE mode;
+    int callsCount;
+
+} test_medias_downloader_recursive_t;
+
+static eARUTILS_ERROR test_medias_downloader_recursive_list(void *arg, ARUTILS_Manager_t *ftpManager, const char *remotePath, char **resultList, uint32_t *resultListLen)
+{
+    test_medias_downloader_recursive_t *recursive = (test_medias_downloader_recursive_t *)arg;
+    eARUTILS_ERROR result;
+
+    recursive->callsCount++;
+
+    switch (recursive->mode)
+    {
+    case TEST_MEDIAS_DOWNLOADER_RECURSIVE_FULL:
+        result = test_medias_ftp_list_recursive(ftpManager, remotePath, NULL, resultList, resultListLen);
+        break;
+    case TEST_MEDIAS_DOWNLOADER_RECURSIVE_MISSING:
+        result = test_medias_ftp_list_recursive(ftpManager, remotePath, TEST_MEDIAS_DOWNLOADER_REMOTE_DCIM "101DRONE", resultList, resultListLen);
+        break;
+    case TEST_MEDIAS_DOWNLOADER_RECURSIVE_FLAT:
+        // A server ignoring -R answers the listing of the directory alone
+        result = ARUTILS_Manager_Ftp_List(ftpManager, remotePath, resultList, resultListLen);
+        break;
+    default:
+        result = ARUTILS_ERROR_FTP_CODE;
+        break;
+    }
+
+    return result;
+}
+
+static int test_medias_downloader_recursive_listing(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    test_medias_downloader_recursive_t recursive;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int recursiveCount;
+    int listsCount;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "recursive_listing", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    for (i=0; i<6; i++)
+    {
+        test_medias_downloader_add_dcim_media((i < 3) ? "100DRONE" : "101DRONE", i, i, 1);
+    }
+    for (i=6; i<9; i++)
+    {
+        test_medias_downloader_add_product_media(ARDISCOVERY_PRODUCT_ARDRONE, i);
+    }
+
+    // Supported, every directory is taken from a single listing
+    memset(&recursive, 0, sizeof(recursive));
+    recursive.mode = TEST_MEDIAS_DOWNLOADER_RECURSIVE_FULL;
+    result = ARDATATRANSFER_MediasDownloader_SetRecursiveList(fixture->manager, test_medias_downloader_recursive_list, &recursive);
+    listsCount = test_medias_ftp_list_count();
+    recursiveCount = test_medias_ftp_recursive_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 9) && (test_medias_downloader_check_thumbnails(fixture, count) == 0)
+                                            && (test_medias_ftp_list_count() == listsCount) && (test_medias_ftp_recursive_list_count() == (recursiveCount + 1)),
+                                            "recursive_listing", "the medias listed in a single recursive listing");
+
+    // A directory missing from the output is listed on its own
+    test_medias_downloader_add_dcim_media("101DRONE", 6, 9, 1);
+    recursive.mode = TEST_MEDIAS_DOWNLOADER_RECURSIVE_MISSING;
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 10) && (test_medias_downloader_check_thumbnails(fixture, count) == 0)
+                                            && (test_medias_ftp_list_count() == (listsCount + 1)), "recursive_listing", "the directory missing from the output listed on its own");
+
+    // An error turns the recursive listing off, the directories are listed one by one from then on
+    recursive.mode = TEST_MEDIAS_DOWNLOADER_RECURSIVE_ERROR;
+    recursive.callsCount = 0;
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 10) && (test_medias_downloader_check_thumbnails(fixture, count) == 0)
+                                            && (recursive.callsCount == 1) && (test_medias_ftp_list_count() == (listsCount + 6)), "recursive_listing", "the directories listed one by one after an error");
+
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 10) && (recursive.callsCount == 1), "recursive_listing", "the recursive listing not asked again");
+
+    // Set again, it is detected again: a flat output is the root listing only
+    recursive.mode = TEST_MEDIAS_DOWNLOADER_RECURSIVE_FLAT;
+    ARDATATRANSFER_MediasDownloader_SetRecursiveList(fixture->manager, test_medias_downloader_recursive_list, &recursive);
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 10) && (recursive.callsCount == 2)
+                                            && (test_medias_ftp_list_count() == (listsCount + 6)), "recursive_listing", "a flat output used as the root listing");
+
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 10) && (recursive.callsCount == 2), "recursive_listing", "the recursive listing off after a flat output");
+
+    // The support is the one of the listing connection, it is detected again once the connection is reset
+    recursive.mode = TEST_MEDIAS_DOWNLOADER_RECURSIVE_FULL;
+    ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias(fixture->manager);
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 10) && (recursive.callsCount == 3)
+                                            && (test_medias_ftp_list_count() == listsCount), "recursive_listing", "the recursive listing detected again after a reset");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+typedef struct
+{
+    test_medias_downloader_fixture_t *fixture;
+    int cancelIndex;
+    int discoveredCount;
+
+} test_medias_downloader_cancel_t;
+
+static void test_medias_downloader_cancel_discovered(void *arg, ARDATATRANSFER_Media_t *media, int index)
+{
+    test_medias_downloader_cancel_t *cancel = (test_medias_downloader_cancel_t *)arg;
+
+    if (cancel->discoveredCount++ == cancel->cancelIndex)
+    {
+        ARDATATRANSFER_MediasDownloader_CancelGetAvailableMedias(cancel->fixture->manager);
+    }
+}
+
+static void * test_medias_downloader_run_cancel(void *arg)
+{
+    test_medias_downloader_cancel_t *cancel = (test_medias_downloader_cancel_t *)arg;
+
+    usleep(20000);
+    ARDATATRANSFER_MediasDownloader_CancelGetAvailableMedias(cancel->fixture->manager);
+
+    return NULL;
+}
+
+static int test_medias_downloader_list_cancel(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    test_medias_downloader_cancel_t cancel;
+    ARDATATRANSFER_Media_t *first;
+    ARSAL_Thread_t thread;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    struct timespec start;
+    struct timespec end;
+    int elapsedMs;
+    int listsCount;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "list_cancel", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    for (i=0; i<10; i++)
+    {
+        test_medias_downloader_add_dcim_media("100DRONE", i, i, 1);
+    }
+    for (i=10; i<20; i++)
+    {
+        test_medias_downloader_add_product_media(ARDISCOVERY_PRODUCT_ARDRONE, i);
+    }
+
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    first = ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 20), "list_cancel", "the medias listed");
+
+    // Canceled while a DCIM folder is parsed, the listing stops at the next line and the published list is kept
+    test_medias_downloader_add_dcim_media("100DRONE", 10, 20, 1);
+    test_medias_downloader_add_product_media(ARDISCOVERY_PRODUCT_ARDRONE, 21);
+    memset(&cancel, 0, sizeof(cancel));
+    cancel.fixture = fixture;
+    cancel.cancelIndex = 2;
+    result = ARDATATRANSFER_MediasDownloader_GetAvailableMediasStream(fixture->manager, 0, test_medias_downloader_cancel_discovered, &cancel, NULL, NULL);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_ERROR_CANCELED) && (cancel.discoveredCount == 3)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(fixture->manager, &result) == 20)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediaAtIndex(fixture->manager, 0, &result) == first), "list_cancel", "the DCIM parse stopped at the next line");
+
+    // Until reset, the next listing fails at its first command
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result != ARDATATRANSFER_OK) && (count == 0) && (test_medias_ftp_list_count() == (listsCount + 1))
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(fixture->manager, &result) == 20), "list_cancel", "the listing canceled until reset");
+
+    // Canceled while a product subfolder is parsed
+    ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias(fixture->manager);
+    cancel.discoveredCount = 0;
+    cancel.cancelIndex = 12;
+    result = ARDATATRANSFER_MediasDownloader_GetAvailableMediasStream(fixture->manager, 0, test_medias_downloader_cancel_discovered, &cancel, NULL, NULL);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_ERROR_CANCELED) && (cancel.discoveredCount == 13)
+                                            && (ARDATATRANSFER_MediasDownloader_GetAvailableMediasCount(fixture->manager, &result) == 20), "list_cancel", "the product parse stopped at the next line");
+
+    // Canceled from another thread while the Device answers slowly
+    ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias(fixture->manager);
+    test_medias_ftp_set_latency(0, 200000);
+    ARSAL_Thread_Create(&thread, test_medias_downloader_run_cancel, &cancel);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ARSAL_Thread_Join(thread, NULL);
+    ARSAL_Thread_Destroy(&thread);
+    elapsedMs = ((end.tv_sec - start.tv_sec) * 1000) + ((end.tv_nsec - start.tv_nsec) / 1000000);
+    failed |= test_medias_downloader_expect((result != ARDATATRANSFER_OK) && (count == 0) && (elapsedMs < 1000), "list_cancel", "the listing canceled from another thread");
+
+    // Reset, the listing goes on
+    ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias(fixture->manager);
+    test_medias_ftp_set_latency(0, 0);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 22), "list_cancel", "the medias listed once reset");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_catalog_ttl(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    test_medias_downloader_cancel_t stream;
+    ARDATATRANSFER_MediasDownloader_Filter_t filter;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    char date[16];
+    time_t now;
+    int listsCount;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "catalog_ttl", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    for (i=0; i<4; i++)
+    {
+        test_medias_downloader_add_dcim_media("100DRONE", i, i, 1);
+    }
+
+    // Without TTL, each call lists the Device
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 4) && (test_medias_ftp_list_count() > listsCount), "catalog_ttl", "the Device listed at each call by default");
+
+    // Within the TTL, the medias list is returned without any command, a change on the Device is not seen
+    result = ARDATATRANSFER_MediasDownloader_SetCatalogTtl(fixture->manager, 500, 0);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    test_medias_downloader_add_dcim_media("100DRONE", 4, 4, 1);
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 4) && (test_medias_ftp_list_count() == listsCount), "catalog_ttl", "the medias list reused within the TTL");
+
+    // Unless the thumbnails or the filter asked were not listed, or the medias are streamed
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 5) && (test_medias_ftp_list_count() > listsCount), "catalog_ttl", "the Device listed for the thumbnails");
+
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 5) && (test_medias_ftp_list_count() == listsCount), "catalog_ttl", "the medias list with thumbnails reused without them");
+
+    memset(&filter, 0, sizeof(filter));
+    filter.types = 1 << ARDATATRANSFER_MEDIAS_DOWNLOADER_MEDIA_TYPE_VIDEO;
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasFiltered(fixture->manager, 0, &filter, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 5) && (test_medias_ftp_list_count() > listsCount), "catalog_ttl", "the Device listed for another filter");
+
+    memset(&stream, 0, sizeof(stream));
+    stream.fixture = fixture;
+    stream.cancelIndex = -1;
+    listsCount = test_medias_ftp_list_count();
+    result = ARDATATRANSFER_MediasDownloader_GetAvailableMediasStream(fixture->manager, 0, test_medias_downloader_cancel_discovered, &stream, NULL, NULL);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (stream.discoveredCount == 5) && (test_medias_ftp_list_count() > listsCount), "catalog_ttl", "the Device listed for a stream");
+
+    // After the TTL, the Device is listed again
+    test_medias_downloader_add_dcim_media("100DRONE", 5, 5, 1);
+    usleep(600000);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6), "catalog_ttl", "the Device listed after the TTL");
+
+    // Probed, an unchanged DCIM folder is a single listing, a new DCIM subdirectory lists the Device
+    result = ARDATATRANSFER_MediasDownloader_SetCatalogTtl(fixture->manager, 50, 1);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    usleep(100000);
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6) && (test_medias_ftp_list_count() == (listsCount + 1)), "catalog_ttl", "an unchanged DCIM folder probed with a single listing");
+
+    test_medias_downloader_add_dcim_media("101DRONE", 0, 6, 1);
+    usleep(100000);
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 7) && (test_medias_ftp_list_count() > (listsCount + 1)), "catalog_ttl", "a changed DCIM folder listed in full");
+
+    // The LIST dates are to the minute, a media added within the minute of the last listing leaves the DCIM folder listing unchanged
+    now = time(NULL);
+    strftime(date, sizeof(date), "%b %d %H:%M", gmtime(&now));
+    test_medias_ftp_set_date(date);
+    ARDATATRANSFER_MediasDownloader_SetCatalogTtl(fixture->manager, 0, 0);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    ARDATATRANSFER_MediasDownloader_SetCatalogTtl(fixture->manager, 50, 1);
+    test_medias_downloader_add_dcim_media("101DRONE", 1, 10, 1);
+    usleep(100000);
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 8) && (test_medias_ftp_list_count() > (listsCount + 1)), "catalog_ttl", "a probe within the minute of the last listing not trusted");
+    test_medias_ftp_set_date(NULL);
+
+    // The medias of a product subfolder are not covered by the probe, a tree with one is listed in full after the TTL
+    test_medias_downloader_add_product_media(ARDISCOVERY_PRODUCT_ARDRONE, 7);
+    ARDATATRANSFER_MediasDownloader_SetCatalogTtl(fixture->manager, 0, 0);
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    ARDATATRANSFER_MediasDownloader_SetCatalogTtl(fixture->manager, 50, 1);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 9), "catalog_ttl", "the product subfolder listed");
+
+    test_medias_downloader_add_product_media(ARDISCOVERY_PRODUCT_ARDRONE, 8);
+    usleep(100000);
+    listsCount = test_medias_ftp_list_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 10) && (test_medias_ftp_list_count() > (listsCount + 1)), "catalog_ttl", "a tree with product subfolders listed in full");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+typedef struct
+{
+    test_medias_downloader_fixture_t *fixture;
+    int cancelCount;
+    int badCount;
+
+} test_medias_downloader_thumbnails_t;
+
+static void test_medias_downloader_thumbnail_available(void *arg, ARDATATRANSFER_Media_t *media, int index)
+{
+    test_medias_downloader_thumbnails_t *thumbnails = (test_medias_downloader_thumbnails_t *)arg;
+    test_medias_downloader_fixture_t *fixture = thumbnails->fixture;
+
+    // The callbacks come from the calling thread, the thumbnail of the stand-in holds its path
+    if ((media == NULL) || (media->thumbnail == NULL) || (strcmp((const char *)media->thumbnail, media->remoteThumb) != 0))
+    {
+        thumbnails->badCount++;
+    }
+
+    if (fixture->orderCount < (TEST_MEDIAS_DOWNLOADER_MAX_MEDIAS * 2))
+    {
+        fixture->order[fixture->orderCount] = index;
+    }
+    fixture->orderCount++;
+
+    if (fixture->orderCount == thumbnails->cancelCount)
+    {
+        ARDATATRANSFER_MediasDownloader_CancelGetAvailableMedias(fixture->manager);
+    }
+}
+
+static int test_medias_downloader_list_without_thumbnails(test_medias_downloader_fixture_t *fixture)
+{
+    eARDATATRANSFER_ERROR result;
+    int i;
+
+    // A new MediasDownloader, whose medias have no thumbnail yet, with the listing connections of the fixture
+    result = test_medias_downloader_fixture_restart(fixture);
+    for (i=0; i<fixture->listConnectionsCount; i++)
+    {
+        ARDATATRANSFER_MediasDownloader_AddListWorker(fixture->manager, fixture->listConnections[i]);
+    }
+    fixture->orderCount = 0;
+
+    return (result == ARDATATRANSFER_OK) ? ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 0, &result) : 0;
+}
+
+static int test_medias_downloader_parallel_thumbnails(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    test_medias_downloader_thumbnails_t thumbnails;
+    char folder[16];
+    int notified[TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT];
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    struct timespec start;
+    struct timespec end;
+    int buffersCount;
+    int elapsedMs;
+    int badCount = 0;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "parallel_thumbnails", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    // More medias than a batch of fetches
+    for (i=0; i<TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT; i++)
+    {
+        snprintf(folder, sizeof(folder), "%dDRONE", 100 + (i / 10));
+        test_medias_downloader_add_dcim_media(folder, i, i, 1);
+    }
+
+    fixture->listConnectionsCount = 3;
+    for (i=0; i<fixture->listConnectionsCount; i++)
+    {
+        fixture->listConnections[i] = test_medias_ftp_connection_new();
+    }
+
+    count = test_medias_downloader_list_without_thumbnails(fixture);
+    failed |= test_medias_downloader_expect(count == TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT, "parallel_thumbnails", "the medias listed without thumbnails");
+
+    // In the list order, from the last media to the first, each thumbnail fetched once over the four connections
+    memset(&thumbnails, 0, sizeof(thumbnails));
+    thumbnails.fixture = fixture;
+    test_medias_ftp_set_latency(10000, 0);
+    buffersCount = test_medias_ftp_buffer_count();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    result = ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsync(fixture->manager, test_medias_downloader_thumbnail_available, &thumbnails);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsedMs = ((end.tv_sec - start.tv_sec) * 1000) + ((end.tv_nsec - start.tv_nsec) / 1000000);
+
+    for (i=0; (i < fixture->orderCount) && (i < TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT); i++)
+    {
+        badCount += (fixture->order[i] != (TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT - 1 - i)) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (fixture->orderCount == TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT) && (badCount == 0) && (thumbnails.badCount == 0)
+                                            && (test_medias_ftp_buffer_count() == (buffersCount + TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT)), "parallel_thumbnails", "the thumbnails notified in the list order");
+
+    // Fetched one by one, the thumbnails would take 10 ms each
+    failed |= test_medias_downloader_expect(elapsedMs < ((TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT * 10) * 2 / 3), "parallel_thumbnails", "the thumbnails fetched in parallel");
+
+    // As soon as fetched, each media notified once
+    thumbnails.badCount = 0;
+    count = test_medias_downloader_list_without_thumbnails(fixture);
+    result = ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsyncWithOrder(fixture->manager, test_medias_downloader_thumbnail_available, &thumbnails, 0);
+    memset(notified, 0, sizeof(notified));
+    badCount = 0;
+    for (i=0; (i < fixture->orderCount) && (i < TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT); i++)
+    {
+        if ((fixture->order[i] < 0) || (fixture->order[i] >= TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT) || (notified[fixture->order[i]]++ != 0))
+        {
+            badCount++;
+        }
+    }
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (fixture->orderCount == TEST_MEDIAS_DOWNLOADER_THUMBNAILS_COUNT) && (badCount == 0) && (thumbnails.badCount == 0),
+                                            "parallel_thumbnails", "each thumbnail notified once as soon as fetched");
+
+    // Canceled, the batch stops at the next delivery
+    thumbnails.cancelCount = 5;
+    count = test_medias_downloader_list_without_thumbnails(fixture);
+    result = ARDATATRANSFER_MediasDownloader_GetAvailableMediasAsync(fixture->manager, test_medias_downloader_thumbnail_available, &thumbnails);
+    failed |= test_medias_downloader_expect((result != ARDATATRANSFER_OK) && (fixture->orderCount == 5), "parallel_thumbnails", "the fetches stopped once canceled");
+
+    ARDATATRANSFER_MediasDownloader_ResetGetAvailableMedias(fixture->manager);
+    test_medias_ftp_set_latency(0, 0);
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static int test_medias_downloader_thumbnails_cache(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    char cachePath[ARUTILS_FTP_MAX_PATH_SIZE];
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int buffersCount;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "thumbnails_cache", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    snprintf(cachePath, sizeof(cachePath), "%s/" ARDATATRANSFER_MEDIAS_THUMBNAILS_DIRECTORY_NAME, fixture->localDirectory);
+
+    for (i=0; i<6; i++)
+    {
+        test_medias_downloader_add_dcim_media((i < 3) ? "100DRONE" : "101DRONE", i, i, 1);
+    }
+
+    // Not cached by default, the next launch fetches every thumbnail again
+    buffersCount = test_medias_ftp_buffer_count();
+    count = ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6) && ((test_medias_ftp_buffer_count() - buffersCount) == 6) && (access(cachePath, F_OK) != 0),
+                                            "thumbnails_cache", "no cache written by default");
+
+    result = test_medias_downloader_fixture_restart(fixture);
+    buffersCount = test_medias_ftp_buffer_count();
+    count = (result == ARDATATRANSFER_OK) ? ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result) : 0;
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6) && ((test_medias_ftp_buffer_count() - buffersCount) == 6) && (access(cachePath, F_OK) != 0),
+                                            "thumbnails_cache", "the thumbnails fetched again by the next launch");
+
+    // Once enabled, the next launch reads the thumbnails from the cache
+    result = test_medias_downloader_fixture_restart(fixture);
+    result = (result == ARDATATRANSFER_OK) ? ARDATATRANSFER_MediasDownloader_SetThumbnailsCacheSize(fixture->manager, ARDATATRANSFER_MEDIAS_THUMBNAILS_DEFAULT_SIZE) : result;
+    buffersCount = test_medias_ftp_buffer_count();
+    count = (result == ARDATATRANSFER_OK) ? ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result) : 0;
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6) && ((test_medias_ftp_buffer_count() - buffersCount) == 6) && (access(cachePath, F_OK) == 0),
+                                            "thumbnails_cache", "the cache written once enabled");
+
+    result = test_medias_downloader_fixture_restart(fixture);
+    result = (result == ARDATATRANSFER_OK) ? ARDATATRANSFER_MediasDownloader_SetThumbnailsCacheSize(fixture->manager, ARDATATRANSFER_MEDIAS_THUMBNAILS_DEFAULT_SIZE) : result;
+    buffersCount = test_medias_ftp_buffer_count();
+    count = (result == ARDATATRANSFER_OK) ? ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result) : 0;
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6) && (test_medias_ftp_buffer_count() == buffersCount)
+                                            && (test_medias_downloader_check_thumbnails(fixture, count) == 0), "thumbnails_cache", "the thumbnails read from the cache by the next launch");
+
+    // Disabled again, the cache files are removed and the next launch fetches every thumbnail
+    result = ARDATATRANSFER_MediasDownloader_SetThumbnailsCacheSize(fixture->manager, 0);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (access(cachePath, F_OK) != 0), "thumbnails_cache", "the cache removed once disabled");
+
+    result = test_medias_downloader_fixture_restart(fixture);
+    buffersCount = test_medias_ftp_buffer_count();
+    count = (result == ARDATATRANSFER_OK) ? ARDATATRANSFER_MediasDownloader_GetAvailableMediasSync(fixture->manager, 1, &result) : 0;
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 6) && ((test_medias_ftp_buffer_count() - buffersCount) == 6)
+                                            && (test_medias_downloader_check_thumbnails(fixture, count) == 0), "thumbnails_cache", "the thumbnails fetched again once disabled");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static void test_medias_downloader_journal_append(ARDATATRANSFER_MediasJournal_t *journal, const char *localDirectory, int index, eARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY priority)
+{
+    ARDATATRANSFER_Media_t media;
+    ARDATATRANSFER_FtpMedia_t *ftpMedia;
+
+    test_medias_downloader_init_media(&media, localDirectory, index);
+    ftpMedia = ARDATATRANSFER_MediasQueue_NewMedia(&media);
+    if (ftpMedia != NULL)
+    {
+        ftpMedia->priority = priority;
+        ARDATATRANSFER_MediasJournal_Append(journal, &ftpMedia, 1);
+        free(ftpMedia);
+    }
+}
+
+static void test_medias_downloader_journal_append_done(ARDATATRANSFER_MediasJournal_t *journal, const char *localDirectory, int index)
+{
+    ARDATATRANSFER_Media_t media;
+
+    test_medias_downloader_init_media(&media, localDirectory, index);
+    ARDATATRANSFER_MediasJournal_AppendDone(journal, media.remotePath);
+}
+
+static int test_medias_downloader_journal_check(const char *localDirectory, const int *expected, int expectedCount, const char *what)
+{
+    ARDATATRANSFER_MediasJournal_t journal;
+    ARDATATRANSFER_FtpMedia_t **ftpMedias = NULL;
+    ARDATATRANSFER_Media_t media;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int badCount = 0;
+    int count;
+    int i;
+
+    ARDATATRANSFER_MediasJournal_New(&journal);
+    count = ARDATATRANSFER_MediasJournal_Restore(&journal, localDirectory, &ftpMedias, &result);
+
+    for (i=0; i<count; i++)
+    {
+        test_medias_downloader_init_media(&media, localDirectory, expected[i]);
+        badCount += ((i >= expectedCount) || (strcmp(ftpMedias[i]->remotePath, media.remotePath) != 0) || (ftpMedias[i]->size != media.size)
+                     || (ftpMedias[i]->nextListener != NULL)) ? 1 : 0;
+        free(ftpMedias[i]);
+    }
+    free(ftpMedias);
+    ARDATATRANSFER_MediasJournal_Delete(&journal);
+
+    return test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == expectedCount) && (badCount == 0), "journal_replay", what);
+}
+
+static int test_medias_downloader_journal_replay(const char *baseDirectory)
+{
+    char localDirectory[TEST_MEDIAS_DOWNLOADER_DIRECTORY_SIZE];
+    char journalPath[ARUTILS_FTP_MAX_PATH_SIZE];
+    char line[ARDATATRANSFER_MEDIAS_JOURNAL_LINE_SIZE];
+    ARDATATRANSFER_MediasJournal_t journal;
+    ARDATATRANSFER_FtpMedia_t **ftpMedias = NULL;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    const int pending[] = { 5, 0, 2, 3, 4 };
+    int linesCount = 0;
+    int badCount = 0;
+    int failed = 0;
+    int count;
+    int i;
+    FILE *file;
+
+    snprintf(localDirectory, sizeof(localDirectory), "%s/journal_replay/", baseDirectory);
+    snprintf(journalPath, sizeof(journalPath), "%s" ARDATATRANSFER_MEDIAS_JOURNAL_FILE_NAME, localDirectory);
+    mkdir(localDirectory, S_IRWXU);
+
+    // Without a journal file, nothing is pending and the journal is enabled
+    ARDATATRANSFER_MediasJournal_New(&journal);
+    count = ARDATATRANSFER_MediasJournal_Restore(&journal, localDirectory, &ftpMedias, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 0), "journal_replay", "an empty journal restored");
+    free(ftpMedias);
+
+    for (i=0; i<5; i++)
+    {
+        test_medias_downloader_journal_append(&journal, localDirectory, i, ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_NORMAL);
+    }
+    test_medias_downloader_journal_append(&journal, localDirectory, 5, ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_INTERACTIVE);
+
+    // Queued twice, done twice, done unknown, then queued again after done
+    test_medias_downloader_journal_append(&journal, localDirectory, 2, ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_NORMAL);
+    test_medias_downloader_journal_append_done(&journal, localDirectory, 1);
+    test_medias_downloader_journal_append_done(&journal, localDirectory, 4);
+    test_medias_downloader_journal_append_done(&journal, localDirectory, 4);
+    test_medias_downloader_journal_append_done(&journal, localDirectory, 9);
+    test_medias_downloader_journal_append(&journal, localDirectory, 4, ARDATATRANSFER_MEDIAS_DOWNLOADER_PRIORITY_NORMAL);
+    ARDATATRANSFER_MediasJournal_Delete(&journal);
+
+    // A record cut by a crash is skipped
+    file = fopen(journalPath, "a");
+    if (file != NULL)
+    {
+        fputs("A\t1\t0\t1000\tBebop_Drone_cut", file);
+        fclose(file);
+    }
+
+    failed |= test_medias_downloader_journal_check(localDirectory, pending, 5, "the pending medias restored by priority then order");
+
+    // The restore compacts the journal to one record per pending media
+    file = fopen(journalPath, "r");
+    while ((file != NULL) && (fgets(line, sizeof(line), file) != NULL))
+    {
+        linesCount++;
+        badCount += (line[0] != 'A') ? 1 : 0;
+    }
+    if (file != NULL)
+    {
+        fclose(file);
+    }
+    failed |= test_medias_downloader_expect((linesCount == 5) && (badCount == 0), "journal_replay", "the journal compacted");
+
+    failed |= test_medias_downloader_expect(test_medias_downloader_journal_check(localDirectory, pending, 5, "the compacted journal restored") == 0, "journal_replay", "the same medias from the compacted journal");
+
+    return failed;
+}
+
+static int test_medias_downloader_journal_cancel_queue(const char *baseDirectory)
+{
+    test_medias_downloader_fixture_t *fixture;
+    char localDirectory[TEST_MEDIAS_DOWNLOADER_DIRECTORY_SIZE + 1];
+    ARDATATRANSFER_MediasJournal_t journal;
+    ARDATATRANSFER_FtpMedia_t **ftpMedias = NULL;
+    eARDATATRANSFER_ERROR result = ARDATATRANSFER_OK;
+    int failed = 0;
+    int count;
+    int i;
+
+    fixture = test_medias_downloader_fixture_new(baseDirectory, "journal_cancel_queue", 1);
+    if (fixture == NULL)
+    {
+        return 1;
+    }
+
+    count = ARDATATRANSFER_MediasDownloader_RestoreQueue(fixture->manager, test_medias_downloader_progress, NULL, test_medias_downloader_completion, NULL, &result);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 0), "journal_cancel_queue", "the journal enabled");
+
+    test_medias_downloader_fixture_start(fixture);
+    usleep(20000);
+
+    // The worker wakes up for a media queued after the cancel flag is raised, as when it races with CancelQueueThread
+    fixture->manager->mediasDownloader->isCanceled = 1;
+    test_medias_downloader_new_media(fixture, 0);
+    test_medias_downloader_add_media(fixture, 0);
+    test_medias_downloader_fixture_join(fixture);
+
+    failed |= test_medias_downloader_expect(test_medias_ftp_get_count(fixture->medias[0].remotePath) == 0, "journal_cancel_queue", "the media not downloaded");
+
+    snprintf(localDirectory, sizeof(localDirectory), "%s/", fixture->localDirectory);
+    ARDATATRANSFER_MediasJournal_New(&journal);
+    count = ARDATATRANSFER_MediasJournal_Restore(&journal, localDirectory, &ftpMedias, &result);
+    for (i=0; i<count; i++)
+    {
+        free(ftpMedias[i]);
+    }
+    free(ftpMedias);
+    ARDATATRANSFER_MediasJournal_Delete(&journal);
+    failed |= test_medias_downloader_expect((result == ARDATATRANSFER_OK) && (count == 1), "journal_cancel_queue", "the popped media still pending");
+
+    test_medias_downloader_fixture_delete(fixture);
+
+    return failed;
+}
+
+static void test_medias_downloader_fill(char *field, size_t size, char c)
+{
+    memset(field, c, size - 1);
+    field[size - 1] = '\0';
+}
+
+static int test_medias_downloader_is_same_media(ARDATATRANSFER_Media_t *media, ARDATATRANSFER_Media_t *expected)
+{
+    return ((media->product == expected->product)
+            && (strcmp(media->name, expected->name) == 0)
+            && (strcmp(media->filePath, expected->filePath) == 0)
+            && (strcmp(media->date, expected->date) == 0)
+            && (strcmp(media->uuid, expected->uuid) == 0)
+            && (strcmp(media->remotePath, expected->remotePath) == 0)
+            && (strcmp(media->remoteThumb, expected->remoteThumb) == 0)
+            && (media->size == expected->size)
+            && (media->thumbnail == NULL)
+            && (media->thumbnailSize == 0)) ? 1 : 0;
+}
+
+static int test_medias_downloader_media_record(const char *baseDirectory)
+{
+    ARDATATRANSFER_Media_t medias[2];
+    ARDATATRANSFER_Media_t *mediaPointers[2] = { &medias[0], &medias[1] };
+    ARDATATRANSFER_Media_t media;
+    ARDATATRANSFER_FtpMedia_t *ftpMedias[2] = { NULL, NULL };
+    ARDATATRANSFER_FtpMedia_t *ftpMedia;
+    ARDATATRANSFER_FtpMediaBlock_t *block;
+    uint8_t thumbnail = 0;
+    int failed = 0;
+
+    // Every string field at its longest, then at its shortest, with a thumbnail that the record does not keep
+    memset(medias, 0, sizeof(medias));
+    medias[0].product = ARDISCOVERY_PRODUCT_JS;
+    test_medias_downloader_fill(medias[0].name, ARDATATRANSFER_MEDIA_NAME_SIZE, 'n');
+    test_medias_downloader_fill(medias[0].filePath, ARDATATRANSFER_MEDIA_PATH_SIZE, 'f');
+    test_medias_downloader_fill(medias[0].date, ARDATATRANSFER_MEDIA_DATE_SIZE, 'd');
+    test_medias_downloader_fill(medias[0].uuid, ARDATATRANSFER_MEDIA_UUID_SIZE, 'u');
+    test_medias_downloader_fill(medias[0].remotePath, ARUTILS_FTP_MAX_PATH_SIZE, 'r');
+    test_medias_downloader_fill(medias[0].remoteThumb, ARUTILS_FTP_MAX_PATH_SIZE, 't');
+    medias[0].size = 4294967296.5;
+    medias[0].thumbnail = &thumbnail;
+    medias[0].thumbnailSize = 1;
+    medias[1].product = ARDISCOVERY_PRODUCT_ARDRONE;
+    medias[1].size = -1.;
+
+    ftpMedia = ARDATATRANSFER_MediasQueue_NewMedia(&medias[0]);
+    failed |= test_medias_downloader_expect(ftpMedia != NULL, "media_record", "a record allocated");
+    if (ftpMedia != NULL)
+    {
+        ARDATATRANSFER_MediasQueue_GetMedia(ftpMedia, &media);
+        failed |= test_medias_downloader_expect(test_medias_downloader_is_same_media(&media, &medias[0]), "media_record", "every field of a single record restored");
+        ARDATATRANSFER_MediasQueue_FreeMedia(ftpMedia);
+    }
+
+    block = ARDATATRANSFER_MediasQueue_NewBlock(mediaPointers, 2, ftpMedias);
+    failed |= test_medias_downloader_expect(block != NULL, "media_record", "a block allocated");
+    if (block != NULL)
+    {
+        failed |= test_medias_downloader_expect((((uintptr_t)ftpMedias[0] % ARDATATRANSFER_FTP_MEDIA_ALIGN) == 0) && (((uintptr_t)ftpMedias[1] % ARDATATRANSFER_FTP_MEDIA_ALIGN) == 0), "media_record", "the records of a block aligned");
+        ARDATATRANSFER_MediasQueue_GetMedia(ftpMedias[0], &media);
+        failed |= test_medias_downloader_expect(test_medias_downloader_is_same_media(&media, &medias[0]), "media_record", "every field of the first block record restored");
+        ARDATATRANSFER_MediasQueue_GetMedia(ftpMedias[1], &media);
+        failed |= test_medias_downloader_expect(test_medias_downloader_is_same_media(&media, &medias[1]), "media_record", "every field of the second block record restored");
+        ARDATATRANSFER_MediasQueue_FreeMedia(ftpMedias[0]);
+        ARDATATRANSFER_MediasQueue_FreeMedia(ftpMedias[1]);
+    }
+
+    return failed;
+}
+
+static int test_medias_downloader_media_list(const char *baseDirectory)
+{
+    ARDATATRANSFER_MediaList_t mediaList;
+    ARDATATRANSFER_MediaSlab_t *slab;
+    ARDATATRANSFER_Media_t *media;
+    char name[ARDATATRANSFER_MEDIA_NAME_SIZE];
+    int mediasCount = 1000;
+    int slabsCount = 0;
+    int recordsCount = 0;
+    int badCount = 0;
+    int failed = 0;
+    int i;
+
+    memset(&mediaList, 0, sizeof(mediaList));
+
+    // Every other record owns a thumbnail, freed with the list
+    for (i=0; i<mediasCount; i++)
+    {
+        media = ARDATATRANSFER_MediasDownloader_NewMediaInList(&mediaList);
+        if (media != NULL)
+        {
+            snprintf(media->name, ARDATATRANSFER_MEDIA_NAME_SIZE, "media_%d", i);
+            media->thumbnail = ((i % 2) == 0) ? malloc(16) : NULL;
+            media->thumbnailSize = (media->thumbnail != NULL) ? 16 : 0;
+        }
+        badCount += ((media == NULL) || (ARDATATRANSFER_MediasDownloader_AddMediaToList(&mediaList, media) != ARDATATRANSFER_OK)) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect((badCount == 0) && (mediaList.count == mediasCount) && (mediaList.capacity >= mediasCount), "media_list", "every media added");
+
+    // The records never move, the pointers handed out before the list grew are still the medias
+    badCount = 0;
+    for (i=0; i<mediaList.count; i++)
+    {
+        snprintf(name, sizeof(name), "media_%d", i);
+        badCount += (strcmp(mediaList.medias[i]->name, name) != 0) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect(badCount == 0, "media_list", "the records kept in place");
+
+    badCount = 0;
+    for (slab = mediaList.slabs; slab != NULL; slab = slab->next)
+    {
+        slabsCount++;
+        recordsCount += slab->count;
+        badCount += ((slab->count > slab->capacity) || (slab->capacity > ARDATATRANSFER_MEDIA_LIST_SLAB_MAX_SIZE)) ? 1 : 0;
+    }
+    failed |= test_medias_downloader_expect((badCount == 0) && (recordsCount == mediasCount) && (slabsCount == 7), "media_list", "the records in seven slabs of at most 256 records");
+
+    ARDATATRANSFER_MediasDownloader_FreeMediaList(&mediaList);
+    failed |= test_medias_downloader_expect((mediaList.medias == NULL) && (mediaList.slabs == NULL) && (mediaList.count == 0), "media_list", "the list freed");
+
+    return failed;
+}
+
+static const struct
+{
+    const char *name;
+    test_medias_downloader_test_t run;
+
+} test_medias_downloader_tests[] =
+{
+    { "media_record", test_medias_downloader_media_record },
+    { "media_list", test_medias_downloader_media_list },
+    { "priority", test_medias_downloader_priority },
+    { "policy", test_medias_downloader_policy },
+    { "drain", test_medias_downloader_drain },
+    { "cancel_fan_out", test_medias_downloader_cancel_fan_out },
+    { "last_worker_reset", test_medias_downloader_last_worker_reset },
+    { "cancel_pending", test_medias_downloader_cancel_pending },
+    { "cancel_in_flight", test_medias_downloader_cancel_in_flight },
+    { "duplicate_in_flight", test_medias_downloader_duplicate_in_flight },
+    { "journal_replay", test_medias_downloader_journal_replay },
+    { "journal_cancel_queue", test_medias_downloader_journal_cancel_queue },
+    { "batch_enqueue", test_medias_downloader_batch_enqueue },
+    { "queue_stats", test_medias_downloader_queue_stats },
+    { "dcim_thumbnails", test_medias_downloader_dcim_thumbnails },
+    { "incremental_relist", test_medias_downloader_incremental_relist },
+    { "catalog_persistent", test_medias_downloader_catalog_persistent },
+    { "parallel_listing", test_medias_downloader_parallel_listing },
+    { "stream_listing", test_medias_downloader_stream_listing },
+    { "remove_during_listing", test_medias_downloader_remove_during_listing },
+    { "lookups", test_medias_downloader_lookups },
+    { "pages", test_medias_downloader_pages },
+    { "filter", test_medias_downloader_filter },
+    { "recursive_listing", test_medias_downloader_recursive_listing },
+    { "list_cancel", test_medias_downloader_list_cancel },
+    { "catalog_ttl", test_medias_downloader_catalog_ttl },
+    { "parallel_thumbnails", test_medias_downloader_parallel_thumbnails },
+    { "thumbnails_cache", test_medias_downloader_thumbnails_cache },
+};
+
+static int test_medias_downloader_remove(const char *path, const struct stat *status, int type, struct FTW *ftw)
+{
+    return remove(path);
+}
+
+static int test_medias_downloader_is_selected(int argc, char *argv[], const char *name)
+{
+    int i;
+
+    for (i=1; i<argc; i++)
+    {
+        if (strcmp(argv[i], name) == 0)
+        {
+            return 1;
+        }
+    }
+
+    return (argc < 2) ? 1 : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    char baseDirectory[] = "/tmp/test_medias_downloader.XXXXXX";
+    int failed = 0;
+    int result;
+    int i;
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "tests Starting");
+
+    if (mkdtemp(baseDirectory) == NULL)
+    {
+        ARSAL_PRINT(ARSAL_PRINT_ERROR, TAG, "%s", "unable to create the local directory");
+        return 1;
+    }
+
+    test_medias_ftp_init();
+
+    for (i=0; i<(int)(sizeof(test_medias_downloader_tests) / sizeof(test_medias_downloader_tests[0])); i++)
+    {
+        if (test_medias_downloader_is_selected(argc, argv, test_medias_downloader_tests[i].name))
+        {
+            result = test_medias_downloader_tests[i].run(baseDirectory);
+            printf("%-32s %s\n", test_medias_downloader_tests[i].name, (result == 0) ? "ok" : "FAILED");
+            failed |= result;
+        }
+    }
+
+    test_medias_ftp_deinit();
+    nftw(baseDirectory, test_medias_downloader_remove, 16, FTW_DEPTH | FTW_PHYS);
+
+    ARSAL_PRINT(ARSAL_PRINT_WARNING, TAG, "tests Completed");
+    return failed;
+}
@@ -0,0 +1,817 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file test_medias_ftp.c
+ * @brief In-memory stand-in of the mftpd server for the libARDataTransfer medias downloader tests.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <libARSAL/ARSAL_Print.h>
+#include <libARSAL/ARSAL_Mutex.h>
+#include <libARUtils/ARUtils.h>
+
+#include "test_medias_ftp.h"
+
+#define TAG                             "test_medias_ftp"
+#define TEST_MEDIAS_FTP_LINE_SIZE       (ARUTILS_FTP_MAX_PATH_SIZE + 64)
+#define TEST_MEDIAS_FTP_STEPS           10
+
+struct ARUTILS_Manager_t
+{
+    int isCanceled;
+};
+
+typedef struct
+{
+    char path[ARUTILS_FTP_MAX_PATH_SIZE];
+    double size;
+    int gets;
+
+} test_medias_ftp_file_t;
+
+typedef struct
+{
+    ARSAL_Mutex_t lock;
+    test_medias_ftp_file_t *files;
+    int filesCount;
+    int filesCapacity;
+    int getStepUs;
+    int listUs;
+    int lists;
+    int recursiveLists;
+    int buffers;
+    float holdPercent;
+    int held;
+    char date[16];
+
+} test_medias_ftp_t;
+
+static test_medias_ftp_t test_medias_ftp;
+
+static void test_medias_ftp_normalize(const char *path, char *normalized)
+{
+    size_t length = 0;
+    const char *c;
+
+    // Absolute, without repeated nor trailing slash, as the server resolves it
+    normalized[length++] = '/';
+    for (c = path; (*c != '\0') && (length < ARUTILS_FTP_MAX_PATH_SIZE - 1); c++)
+    {
+        if ((*c != '/') || (normalized[length - 1] != '/'))
+        {
+            normalized[length++] = *c;
+        }
+    }
+
+    if ((length > 1) && (normalized[length - 1] == '/'))
+    {
+        length--;
+    }
+    normalized[length] = '\0';
+}
+
+static test_medias_ftp_file_t * test_medias_ftp_find(const char *normalized)
+{
+    test_medias_ftp_file_t *file = NULL;
+    int i;
+
+    for (i=0; (file == NULL) && (i < test_medias_ftp.filesCount); i++)
+    {
+        if (strcmp(test_medias_ftp.files[i].path, normalized) == 0)
+        {
+            file = &test_medias_ftp.files[i];
+        }
+    }
+
+    return file;
+}
+
+static int test_medias_ftp_append(char **list, size_t *listLen, size_t *listCapacity, const char *line)
+{
+    size_t lineLen = strlen(line);
+    char *newList;
+
+    if (*listLen + lineLen + 1 > *listCapacity)
+    {
+        *listCapacity = (*listCapacity * 2) + lineLen + 1;
+        newList = realloc(*list, *listCapacity);
+        if (newList == NULL)
+        {
+            return 0;
+        }
+        *list = newList;
+    }
+
+    memcpy(*list + *listLen, line, lineLen + 1);
+    *listLen += lineLen;
+
+    return 1;
+}
+
+static int test_medias_ftp_has_line(const char *list, size_t listLen, const char *line)
+{
+    size_t lineLen = strlen(line);
+    const char *found = list;
+
+    while ((list != NULL) && ((found = strstr(found, line)) != NULL))
+    {
+        if ((found == list) || (found[-1] == '\n'))
+        {
+            return 1;
+        }
+        found += lineLen;
+    }
+
+    return 0;
+}
+
+static int test_medias_ftp_list_directory(const char *directory, char **list, size_t *listLen, size_t *listCapacity)
+{
+    char name[ARUTILS_FTP_MAX_PATH_SIZE];
+    char line[TEST_MEDIAS_FTP_LINE_SIZE];
+    size_t directoryLen = strlen(directory);
+    size_t sectionStart = *listLen;
+    const char *relative;
+    const char *slash;
+    int isFound = 0;
+    int i;
+
+    for (i=0; (*list != NULL) && (i < test_medias_ftp.filesCount); i++)
+    {
+        if (directoryLen == 1)
+        {
+            relative = test_medias_ftp.files[i].path + 1;
+        }
+        else if ((strncmp(test_medias_ftp.files[i].path, directory, directoryLen) == 0) && (test_medias_ftp.files[i].path[directoryLen] == '/'))
+        {
+            relative = test_medias_ftp.files[i].path + directoryLen + 1;
+        }
+        else
+        {
+            continue;
+        }
+
+        // As the unix ls -l of mftpd, a directory once whatever the number of its files
+        isFound = 1;
+        slash = strchr(relative, '/');
+        if (slash != NULL)
+        {
+            snprintf(name, sizeof(name), "%.*s", (int)(slash - relative), relative);
+            snprintf(line, sizeof(line), "drwxr-xr-x 2 ftp ftp 0 %s %s\r\n", test_medias_ftp.date, name);
+            if (test_medias_ftp_has_line(*list + sectionStart, *listLen - sectionStart, line) == 1)
+            {
+                continue;
+            }
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "-rw-r--r-- 1 ftp ftp %.0f %s %s\r\n", test_medias_ftp.files[i].size, test_medias_ftp.date, relative);
+        }
+
+        if (test_medias_ftp_append(list, listLen, listCapacity, line) == 0)
+        {
+            free(*list);
+            *list = NULL;
+        }
+    }
+
+    return isFound;
+}
+
+static int test_medias_ftp_is_connection_canceled(ARUTILS_Manager_t *manager)
+{
+    return __atomic_load_n(&manager->isCanceled, __ATOMIC_ACQUIRE);
+}
+
+static eARUTILS_ERROR test_medias_ftp_progress_hold(ARUTILS_Manager_t *manager, float percent)
+{
+    int isHeld = 0;
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    if ((test_medias_ftp.holdPercent > 0.f) && (percent >= test_medias_ftp.holdPercent))
+    {
+        test_medias_ftp.held++;
+        isHeld = 1;
+    }
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    while ((isHeld == 1) && (test_medias_ftp_is_connection_canceled(manager) == 0))
+    {
+        usleep(1000);
+
+        // Released, or held further on, the download goes on
+        ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+        if ((test_medias_ftp.holdPercent == 0.f) || (percent < test_medias_ftp.holdPercent))
+        {
+            test_medias_ftp.held--;
+            isHeld = 0;
+        }
+        ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+    }
+
+    if (isHeld == 1)
+    {
+        ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+        test_medias_ftp.held--;
+        ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+    }
+
+    return (test_medias_ftp_is_connection_canceled(manager) != 0) ? ARUTILS_ERROR_FTP_CANCELED : ARUTILS_OK;
+}
+
+void test_medias_ftp_init(void)
+{
+    memset(&test_medias_ftp, 0, sizeof(test_medias_ftp_t));
+    ARSAL_Mutex_Init(&test_medias_ftp.lock);
+    test_medias_ftp_set_date(NULL);
+}
+
+void test_medias_ftp_deinit(void)
+{
+    free(test_medias_ftp.files);
+    test_medias_ftp.files = NULL;
+    ARSAL_Mutex_Destroy(&test_medias_ftp.lock);
+}
+
+void test_medias_ftp_reset(void)
+{
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    test_medias_ftp.filesCount = 0;
+    test_medias_ftp.getStepUs = 0;
+    test_medias_ftp.listUs = 0;
+    test_medias_ftp.lists = 0;
+    test_medias_ftp.recursiveLists = 0;
+    test_medias_ftp.buffers = 0;
+    test_medias_ftp.holdPercent = 0.f;
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+}
+
+void test_medias_ftp_add_file(const char *path, double size)
+{
+    char normalized[ARUTILS_FTP_MAX_PATH_SIZE];
+    test_medias_ftp_file_t *file;
+    test_medias_ftp_file_t *files;
+
+    test_medias_ftp_normalize(path, normalized);
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+
+    file = test_medias_ftp_find(normalized);
+    if ((file == NULL) && (test_medias_ftp.filesCount == test_medias_ftp.filesCapacity))
+    {
+        files = realloc(test_medias_ftp.files, ((test_medias_ftp.filesCapacity * 2) + 16) * sizeof(test_medias_ftp_file_t));
+        if (files != NULL)
+        {
+            test_medias_ftp.files = files;
+            test_medias_ftp.filesCapacity = (test_medias_ftp.filesCapacity * 2) + 16;
+        }
+    }
+
+    if ((file == NULL) && (test_medias_ftp.filesCount < test_medias_ftp.filesCapacity))
+    {
+        file = &test_medias_ftp.files[test_medias_ftp.filesCount++];
+        strcpy(file->path, normalized);
+        file->gets = 0;
+    }
+
+    if (file != NULL)
+    {
+        file->size = size;
+    }
+
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+}
+
+void test_medias_ftp_set_latency(int getStepUs, int listUs)
+{
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    test_medias_ftp.getStepUs = getStepUs;
+    test_medias_ftp.listUs = listUs;
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+}
+
+void test_medias_ftp_set_date(const char *date)
+{
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    snprintf(test_medias_ftp.date, sizeof(test_medias_ftp.date), "%s", (date != NULL) ? date : "Dec 15 10:20");
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+}
+
+ARUTILS_Manager_t * test_medias_ftp_connection_new(void)
+{
+    return (ARUTILS_Manager_t *)calloc(1, sizeof(ARUTILS_Manager_t));
+}
+
+void test_medias_ftp_connection_delete(ARUTILS_Manager_t **connectionAddr)
+{
+    if (connectionAddr != NULL)
+    {
+        free(*connectionAddr);
+        *connectionAddr = NULL;
+    }
+}
+
+int test_medias_ftp_is_canceled(ARUTILS_Manager_t *connection)
+{
+    return test_medias_ftp_is_connection_canceled(connection);
+}
+
+int test_medias_ftp_get_count(const char *path)
+{
+    char normalized[ARUTILS_FTP_MAX_PATH_SIZE];
+    test_medias_ftp_file_t *file;
+    int count = -1;
+
+    test_medias_ftp_normalize(path, normalized);
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    file = test_medias_ftp_find(normalized);
+    if (file != NULL)
+    {
+        count = file->gets;
+    }
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    return count;
+}
+
+int test_medias_ftp_list_count(void)
+{
+    int count;
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    count = test_medias_ftp.lists;
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    return count;
+}
+
+int test_medias_ftp_recursive_list_count(void)
+{
+    int count;
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    count = test_medias_ftp.recursiveLists;
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    return count;
+}
+
+int test_medias_ftp_buffer_count(void)
+{
+    int count;
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    count = test_medias_ftp.buffers;
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    return count;
+}
+
+void test_medias_ftp_hold(float percent)
+{
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    test_medias_ftp.holdPercent = percent;
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+}
+
+int test_medias_ftp_wait_held(int count, int timeoutMs)
+{
+    int held = 0;
+    int elapsedMs;
+
+    for (elapsedMs = 0; (held < count) && (elapsedMs < timeoutMs); elapsedMs++)
+    {
+        ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+        held = test_medias_ftp.held;
+        ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+        if (held < count)
+        {
+            usleep(1000);
+        }
+    }
+
+    return (held >= count) ? 1 : 0;
+}
+
+void test_medias_ftp_release(void)
+{
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    test_medias_ftp.holdPercent = 0.f;
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+}
+
+/*****************************************
+ *
+ *     libARUtils FTP manager stand-in:
+ *
+ *****************************************/
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_Connection_Disconnect(ARUTILS_Manager_t *manager)
+{
+    return (manager == NULL) ? ARUTILS_ERROR_BAD_PARAMETER : ARUTILS_OK;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_Connection_Reconnect(ARUTILS_Manager_t *manager)
+{
+    return (manager == NULL) ? ARUTILS_ERROR_BAD_PARAMETER : ARUTILS_OK;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_Connection_Cancel(ARUTILS_Manager_t *manager)
+{
+    if (manager == NULL)
+    {
+        return ARUTILS_ERROR_BAD_PARAMETER;
+    }
+
+    __atomic_store_n(&manager->isCanceled, 1, __ATOMIC_RELEASE);
+
+    return ARUTILS_OK;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_Connection_IsCanceled(ARUTILS_Manager_t *manager)
+{
+    if (manager == NULL)
+    {
+        return ARUTILS_ERROR_BAD_PARAMETER;
+    }
+
+    return (test_medias_ftp_is_connection_canceled(manager) != 0) ? ARUTILS_ERROR_FTP_CANCELED : ARUTILS_OK;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_Connection_Reset(ARUTILS_Manager_t *manager)
+{
+    if (manager == NULL)
+    {
+        return ARUTILS_ERROR_BAD_PARAMETER;
+    }
+
+    __atomic_store_n(&manager->isCanceled, 0, __ATOMIC_RELEASE);
+
+    return ARUTILS_OK;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_List(ARUTILS_Manager_t *manager, const char *namePath, char **resultList, uint32_t *resultListLen)
+{
+    char directory[ARUTILS_FTP_MAX_PATH_SIZE];
+    char *list = NULL;
+    size_t listLen = 0;
+    size_t listCapacity = 0;
+    eARUTILS_ERROR result = ARUTILS_OK;
+    int isFound = 0;
+    int listUs;
+
+    if ((manager == NULL) || (namePath == NULL) || (resultList == NULL) || (resultListLen == NULL))
+    {
+        return ARUTILS_ERROR_BAD_PARAMETER;
+    }
+
+    test_medias_ftp_normalize(namePath, directory);
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    test_medias_ftp.lists++;
+    listUs = test_medias_ftp.listUs;
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    usleep(listUs);
+
+    if (test_medias_ftp_is_connection_canceled(manager) != 0)
+    {
+        return ARUTILS_ERROR_FTP_CANCELED;
+    }
+
+    test_medias_ftp_append(&list, &listLen, &listCapacity, "");
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    isFound = test_medias_ftp_list_directory(directory, &list, &listLen, &listCapacity);
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    if (list == NULL)
+    {
+        result = ARUTILS_ERROR_ALLOC;
+    }
+    else if ((isFound == 0) && (strlen(directory) > 1))
+    {
+        result = ARUTILS_ERROR_FTP_CODE;
+    }
+
+    if (result == ARUTILS_OK)
+    {
+        *resultList = list;
+        *resultListLen = (uint32_t)listLen;
+    }
+    else
+    {
+        free(list);
+    }
+
+    return result;
+}
+
+eARUTILS_ERROR test_medias_ftp_list_recursive(ARUTILS_Manager_t *manager, const char *namePath, const char *skippedPath, char **resultList, uint32_t *resultListLen)
+{
+    char root[ARUTILS_FTP_MAX_PATH_SIZE];
+    char skipped[ARUTILS_FTP_MAX_PATH_SIZE];
+    char directory[ARUTILS_FTP_MAX_PATH_SIZE];
+    char header[ARUTILS_FTP_MAX_PATH_SIZE + 8];
+    char *list = NULL;
+    size_t listLen = 0;
+    size_t listCapacity = 0;
+    size_t rootLen;
+    const char *slash;
+    int listUs;
+    int i;
+
+    if ((manager == NULL) || (namePath == NULL) || (resultList == NULL) || (resultListLen == NULL))
+    {
+        return ARUTILS_ERROR_BAD_PARAMETER;
+    }
+
+    test_medias_ftp_normalize(namePath, root);
+    test_medias_ftp_normalize((skippedPath != NULL) ? skippedPath : "", skipped);
+    rootLen = strlen(root);
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    test_medias_ftp.recursiveLists++;
+    listUs = test_medias_ftp.listUs;
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    usleep(listUs);
+
+    if (test_medias_ftp_is_connection_canceled(manager) != 0)
+    {
+        return ARUTILS_ERROR_FTP_CANCELED;
+    }
+
+    test_medias_ftp_append(&list, &listLen, &listCapacity, "");
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+
+    // As LIST -laR, the listing of the directory then of each subdirectory after a blank line and its "path:" header
+    test_medias_ftp_list_directory(root, &list, &listLen, &listCapacity);
+
+    for (i=0; (list != NULL) && (i < test_medias_ftp.filesCount); i++)
+    {
+        if ((rootLen > 1) && ((strncmp(test_medias_ftp.files[i].path, root, rootLen) != 0) || (test_medias_ftp.files[i].path[rootLen] != '/')))
+        {
+            continue;
+        }
+
+        for (slash = strchr(test_medias_ftp.files[i].path + rootLen + 1, '/'); (list != NULL) && (slash != NULL); slash = strchr(slash + 1, '/'))
+        {
+            snprintf(directory, sizeof(directory), "%.*s", (int)(slash - test_medias_ftp.files[i].path), test_medias_ftp.files[i].path);
+            snprintf(header, sizeof(header), "%s:\r\n", directory);
+            if ((strcmp(directory, skipped) == 0) || (test_medias_ftp_has_line(list, listLen, header) == 1))
+            {
+                continue;
+            }
+
+            if ((test_medias_ftp_append(&list, &listLen, &listCapacity, "\r\n") == 0) || (test_medias_ftp_append(&list, &listLen, &listCapacity, header) == 0))
+            {
+                free(list);
+                list = NULL;
+            }
+            else
+            {
+                test_medias_ftp_list_directory(directory, &list, &listLen, &listCapacity);
+            }
+        }
+    }
+
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    if (list == NULL)
+    {
+        return ARUTILS_ERROR_ALLOC;
+    }
+
+    *resultList = list;
+    *resultListLen = (uint32_t)listLen;
+
+    return ARUTILS_OK;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_Size(ARUTILS_Manager_t *manager, const char *namePath, double *fileSize)
+{
+    char normalized[ARUTILS_FTP_MAX_PATH_SIZE];
+    test_medias_ftp_file_t *file;
+    eARUTILS_ERROR result = ARUTILS_ERROR_FTP_CODE;
+
+    if ((manager == NULL) || (namePath == NULL) || (fileSize == NULL))
+    {
+        return ARUTILS_ERROR_BAD_PARAMETER;
+    }
+
+    test_medias_ftp_normalize(namePath, normalized);
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    file = test_medias_ftp_find(normalized);
+    if (file != NULL)
+    {
+        *fileSize = file->size;
+        result = ARUTILS_OK;
+    }
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    return result;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_Get_WithBuffer(ARUTILS_Manager_t *manager, const char *namePath, uint8_t **data, uint32_t *dataLen, ARUTILS_Ftp_ProgressCallback_t progressCallback, void* progressArg)
+{
+    char normalized[ARUTILS_FTP_MAX_PATH_SIZE];
+    int getStepUs;
+
+    if ((manager == NULL) || (namePath == NULL) || (data == NULL) || (dataLen == NULL))
+    {
+        return ARUTILS_ERROR_BAD_PARAMETER;
+    }
+
+    test_medias_ftp_normalize(namePath, normalized);
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    test_medias_ftp.buffers++;
+    getStepUs = test_medias_ftp.getStepUs;
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    usleep(getStepUs);
+
+    if (test_medias_ftp_is_connection_canceled(manager) != 0)
+    {
+        return ARUTILS_ERROR_FTP_CANCELED;
+    }
+
+    // The thumbnails are generated by the server, their content is their path
+    *data = (uint8_t *)strdup(normalized);
+    if (*data == NULL)
+    {
+        return ARUTILS_ERROR_ALLOC;
+    }
+    *dataLen = (uint32_t)strlen(normalized) + 1;
+
+    if (progressCallback != NULL)
+    {
+        progressCallback(progressArg, 100.f);
+    }
+
+    return ARUTILS_OK;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_Get(ARUTILS_Manager_t *manager, const char *namePath, const char *dstFile, ARUTILS_Ftp_ProgressCallback_t progressCallback, void* progressArg, eARUTILS_FTP_RESUME resume)
+{
+    char normalized[ARUTILS_FTP_MAX_PATH_SIZE];
+    test_medias_ftp_file_t *file;
+    eARUTILS_ERROR result = ARUTILS_OK;
+    FILE *dst;
+    float percent;
+    int getStepUs = 0;
+    int step;
+
+    if ((manager == NULL) || (namePath == NULL) || (dstFile == NULL))
+    {
+        return ARUTILS_ERROR_BAD_PARAMETER;
+    }
+
+    test_medias_ftp_normalize(namePath, normalized);
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    file = test_medias_ftp_find(normalized);
+    if (file != NULL)
+    {
+        file->gets++;
+        getStepUs = test_medias_ftp.getStepUs;
+    }
+    else
+    {
+        result = ARUTILS_ERROR_FTP_CODE;
+    }
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    for (step = 1; (result == ARUTILS_OK) && (step <= TEST_MEDIAS_FTP_STEPS); step++)
+    {
+        usleep(getStepUs);
+
+        percent = (float)(step * 100) / TEST_MEDIAS_FTP_STEPS;
+        result = test_medias_ftp_progress_hold(manager, percent);
+
+        if ((result == ARUTILS_OK) && (progressCallback != NULL))
+        {
+            progressCallback(progressArg, percent);
+        }
+    }
+
+    if (result == ARUTILS_OK)
+    {
+        dst = fopen(dstFile, (resume == FTP_RESUME_TRUE) ? "a" : "w");
+        if (dst == NULL)
+        {
+            result = ARUTILS_ERROR_SYSTEM;
+        }
+        else
+        {
+            fputs(normalized, dst);
+            fclose(dst);
+        }
+    }
+
+    return result;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_Put(ARUTILS_Manager_t *manager, const char *namePath, const char *srcFile, ARUTILS_Ftp_ProgressCallback_t progressCallback, void* progressArg, eARUTILS_FTP_RESUME resume)
+{
+    if ((manager == NULL) || (namePath == NULL) || (srcFile == NULL))
+    {
+        return ARUTILS_ERROR_BAD_PARAMETER;
+    }
+
+    test_medias_ftp_add_file(namePath, 0.f);
+
+    return ARUTILS_OK;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_Delete(ARUTILS_Manager_t *manager, const char *namePath)
+{
+    char normalized[ARUTILS_FTP_MAX_PATH_SIZE];
+    test_medias_ftp_file_t *file;
+    eARUTILS_ERROR result = ARUTILS_ERROR_FTP_CODE;
+
+    if ((manager == NULL) || (namePath == NULL))
+    {
+        return ARUTILS_ERROR_BAD_PARAMETER;
+    }
+
+    test_medias_ftp_normalize(namePath, normalized);
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    file = test_medias_ftp_find(normalized);
+    if (file != NULL)
+    {
+        *file = test_medias_ftp.files[--test_medias_ftp.filesCount];
+        result = ARUTILS_OK;
+    }
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    return result;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_RemoveDir(ARUTILS_Manager_t *manager, const char *namePath)
+{
+    return ((manager == NULL) || (namePath == NULL)) ? ARUTILS_ERROR_BAD_PARAMETER : ARUTILS_OK;
+}
+
+eARUTILS_ERROR ARUTILS_Manager_Ftp_Rename(ARUTILS_Manager_t *manager, const char *oldNamePath, const char *newNamePath)
+{
+    char normalized[ARUTILS_FTP_MAX_PATH_SIZE];
+    test_medias_ftp_file_t *file;
+    eARUTILS_ERROR result = ARUTILS_ERROR_FTP_CODE;
+
+    if ((manager == NULL) || (oldNamePath == NULL) || (newNamePath == NULL))
+    {
+        return ARUTILS_ERROR_BAD_PARAMETER;
+    }
+
+    test_medias_ftp_normalize(oldNamePath, normalized);
+
+    ARSAL_Mutex_Lock(&test_medias_ftp.lock);
+    file = test_medias_ftp_find(normalized);
+    if (file != NULL)
+    {
+        test_medias_ftp_normalize(newNamePath, file->path);
+        result = ARUTILS_OK;
+    }
+    ARSAL_Mutex_Unlock(&test_medias_ftp.lock);
+
+    return result;
+}
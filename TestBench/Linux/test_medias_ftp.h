@@ -0,0 +1,152 @@
+/*
+    Copyright (C) 2014 Parrot SA
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in
+      the documentation and/or other materials provided with the 
+      distribution.
+    * Neither the name of Parrot nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+    OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED 
+    AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+    OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+    SUCH DAMAGE.
+*/
+/**
+ * @file test_medias_ftp.h
+ * @brief In-memory stand-in of the mftpd server for the libARDataTransfer medias downloader tests.
+ * It defines the ARUTILS_Manager_Ftp_* functions in place of the libARUtils ones, so the medias downloader
+ * lists and downloads the files added to it through its connections, with the latency set by the test.
+ */
+
+#ifndef _TEST_MEDIAS_FTP_H_
+#define _TEST_MEDIAS_FTP_H_
+
+#include <libARUtils/ARUtils.h>
+
+/**
+ * @brief Initializes the stand-in, called once before the tests
+ */
+void test_medias_ftp_init(void);
+
+/**
+ * @brief Deinitializes the stand-in, called once after the tests
+ */
+void test_medias_ftp_deinit(void);
+
+/**
+ * @brief Removes the files, the counters, the latency and the hold of the stand-in
+ */
+void test_medias_ftp_reset(void);
+
+/**
+ * @brief Adds a file to the stand-in, its directories exist as long as it does
+ * @param path The remote path of the file
+ * @param size The size listed for the file
+ */
+void test_medias_ftp_add_file(const char *path, double size);
+
+/**
+ * @brief Sets the latency of the stand-in commands
+ * @param getStepUs The time of each of the ten steps of a file download, in microseconds
+ * @param listUs The time of a directory listing, in microseconds
+ */
+void test_medias_ftp_set_latency(int getStepUs, int listUs);
+
+/**
+ * @brief Sets the date of the listed files and directories, as the LIST lines show it
+ * @param date The date (e.g. Dec 15 10:20), NULL for the default one
+ */
+void test_medias_ftp_set_date(const char *date);
+
+/**
+ * @brief Creates a connection to the stand-in
+ * @retval The connection, to be deleted with test_medias_ftp_connection_delete ()
+ */
+ARUTILS_Manager_t * test_medias_ftp_connection_new(void);
+
+/**
+ * @brief Deletes a connection to the stand-in
+ * @param connectionAddr The address of the connection, set to NULL
+ */
+void test_medias_ftp_connection_delete(ARUTILS_Manager_t **connectionAddr);
+
+/**
+ * @brief Tells whether a connection is canceled
+ * @param connection The connection
+ * @retval 1 if it is canceled and not reset, 0 otherwise
+ */
+int test_medias_ftp_is_canceled(ARUTILS_Manager_t *connection);
+
+/**
+ * @brief Gets the number of downloads of a file, finished or not
+ * @param path The remote path of the file
+ * @retval The number of downloads, -1 for an unknown file
+ */
+int test_medias_ftp_get_count(const char *path);
+
+/**
+ * @brief Gets the number of directory listings
+ * @retval The number of listings
+ */
+int test_medias_ftp_list_count(void);
+
+/**
+ * @brief Gets the number of recursive listings
+ * @retval The number of recursive listings
+ */
+int test_medias_ftp_recursive_list_count(void);
+
+/**
+ * @brief Lists a directory and all its subdirectories, as the LIST -laR of a server supporting it
+ * @param manager The connection
+ * @param namePath The remote directory to list
+ * @param skippedPath A subdirectory left out of the listing, NULL for none
+ * @param resultList The address of the allocated listing
+ * @param resultListLen The address of the length of the listing
+ * @retval On success, returns ARUTILS_OK. Otherwise, it returns an error number of eARUTILS_ERROR.
+ */
+eARUTILS_ERROR test_medias_ftp_list_recursive(ARUTILS_Manager_t *manager, const char *namePath, const char *skippedPath, char **resultList, uint32_t *resultListLen);
+
+/**
+ * @brief Gets the number of downloads to a buffer, the thumbnails
+ * @retval The number of downloads to a buffer
+ */
+int test_medias_ftp_buffer_count(void);
+
+/**
+ * @brief Holds the file downloads once they reach a progress, until released, canceled or held further on
+ * @param percent The progress held, between 10 and 100
+ */
+void test_medias_ftp_hold(float percent);
+
+/**
+ * @brief Waits for file downloads to be held
+ * @param count The number of held downloads to wait for
+ * @param timeoutMs The maximum time to wait, in milliseconds
+ * @retval 1 if count downloads are held, 0 on timeout
+ */
+int test_medias_ftp_wait_held(int count, int timeoutMs);
+
+/**
+ * @brief Releases the held file downloads and stops holding the next ones
+ */
+void test_medias_ftp_release(void);
+
+#endif /* _TEST_MEDIAS_FTP_H_ */
@@ -21,8 +21,13 @@ LOCAL_SRC_FILES := \
 	Sources/ARDATATRANSFER_DataDownloader.c \
 	Sources/ARDATATRANSFER_Downloader.c \
 	Sources/ARDATATRANSFER_Manager.c \
+	Sources/ARDATATRANSFER_MediasCatalog.c \
+	Sources/ARDATATRANSFER_MediasDate.c \
 	Sources/ARDATATRANSFER_MediasDownloader.c \
+	Sources/ARDATATRANSFER_MediasIndex.c \
+	Sources/ARDATATRANSFER_MediasJournal.c \
 	Sources/ARDATATRANSFER_MediasQueue.c \
+	Sources/ARDATATRANSFER_MediasThumbnails.c \
 	Sources/ARDATATRANSFER_Uploader.c \
 	gen/Sources/ARDATATRANSFER_Error.c
 